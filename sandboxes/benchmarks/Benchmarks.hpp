@@ -0,0 +1,51 @@
+#ifndef BENCHMARKS_HPP
+#define BENCHMARKS_HPP
+
+// Benchmarks run by the benchmarks sandbox: benchmarks <name> [arguments ...].
+// Each one is the main() of a former standalone sandbox, it receives the
+// arguments following the program name, its own name being argv[0].
+
+#include <string>
+
+#include <libslic3r/TriangleMesh.hpp>
+#include <libslic3r/Format/OBJ.hpp>
+
+#include <libnest2d/tools/benchmark.h>
+
+#include <boost/algorithm/string/predicate.hpp>
+
+namespace Slic3r {
+
+// Load an .obj or .stl file and repair it. Returns false if the file could
+// not be read or contains no triangles.
+inline bool load_mesh(const std::string &path, TriangleMesh &mesh)
+{
+    bool loaded = boost::iends_with(path, ".obj") ? load_obj(path.c_str(), &mesh) : mesh.ReadSTLFile(path.c_str());
+    if (loaded)
+        mesh.repair();
+    return loaded && ! mesh.empty();
+}
+
+namespace benchmarks {
+
+int fill_rectilinear(const int argc, const char *argv[]);
+int aabb_wide(const int argc, const char *argv[]);
+int sla_raster_encoding(const int argc, const char *argv[]);
+int clipper_adapters(const int argc, const char *argv[]);
+int extrusion_export(const int argc, const char *argv[]);
+int arrange_nfp_cache(const int argc, const char *argv[]);
+int mesh_memory(const int argc, const char *argv[]);
+int triangle_selector_brush(const int argc, const char *argv[]);
+int simplify_mesh(const int argc, const char *argv[]);
+int drill_holes(const int argc, const char *argv[]);
+int ray_rings(const int argc, const char *argv[]);
+
+#ifdef SLIC3R_GUI
+int gcode_viewer_lod(const int argc, const char *argv[]);
+int preview_geometry(const int argc, const char *argv[]);
+#endif // SLIC3R_GUI
+
+} // namespace benchmarks
+} // namespace Slic3r
+
+#endif // BENCHMARKS_HPP
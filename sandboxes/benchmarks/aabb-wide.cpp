@@ -0,0 +1,153 @@
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/TriangleMesh.hpp>
+#include <libslic3r/AABBTreeIndirect.hpp>
+#include <libslic3r/AABBTreeWide.hpp>
+
+#include "Benchmarks.hpp"
+
+const std::string USAGE_STR = {
+    "Usage: benchmarks aabb-wide meshfile.{stl,obj} [subdivisions]\n"
+    "Compares the binary AABBTreeIndirect::Tree with the 4-ary and 8-ary quantized AABBTreeIndirect::WideTree,\n"
+    "referencing the source triangles or storing a copy of them:\n"
+    "build time, memory and queries per second of ray casting, closest point and radius queries.\n"
+    "The mesh is optionally subdivided to simulate multi-million triangle meshes."
+};
+
+using namespace Slic3r;
+
+// Split each triangle into four.
+static indexed_triangle_set subdivide(const indexed_triangle_set &its)
+{
+    indexed_triangle_set out;
+    out.vertices = its.vertices;
+    out.indices.reserve(its.indices.size() * 4);
+    for (const stl_triangle_vertex_indices &face : its.indices) {
+        int mid[3];
+        for (int i = 0; i < 3; ++ i) {
+            mid[i] = int(out.vertices.size());
+            out.vertices.emplace_back(0.5f * (its.vertices[face(i)] + its.vertices[face((i + 1) % 3)]));
+        }
+        out.indices.emplace_back(face(0), mid[0], mid[2]);
+        out.indices.emplace_back(mid[0], face(1), mid[1]);
+        out.indices.emplace_back(mid[2], mid[1], face(2));
+        out.indices.emplace_back(mid[0], mid[1], mid[2]);
+    }
+    return out;
+}
+
+struct Queries {
+    std::vector<Vec3d> origins;
+    std::vector<Vec3d> dirs;
+};
+
+template<typename TreeType>
+static void profile(const char *name, const indexed_triangle_set &its, const TreeType &tree, const Queries &queries)
+{
+    Benchmark bench;
+    size_t    num_hits = 0;
+    bench.start();
+    for (size_t i = 0; i < queries.origins.size(); ++ i) {
+        igl::Hit hit;
+        if (AABBTreeIndirect::intersect_ray_first_hit(its.vertices, its.indices, tree, queries.origins[i], queries.dirs[i], hit))
+            ++ num_hits;
+    }
+    bench.stop();
+    double t_first_hit = bench.getElapsedSec();
+
+    size_t num_all_hits = 0;
+    bench.start();
+    for (size_t i = 0; i < queries.origins.size(); ++ i) {
+        std::vector<igl::Hit> hits;
+        AABBTreeIndirect::intersect_ray_all_hits(its.vertices, its.indices, tree, queries.origins[i], queries.dirs[i], hits);
+        num_all_hits += hits.size();
+    }
+    bench.stop();
+    double t_all_hits = bench.getElapsedSec();
+
+    double sum_distance = 0.;
+    bench.start();
+    for (const Vec3d &pt : queries.origins) {
+        size_t hit_idx;
+        Vec3d  hit_point;
+        sum_distance += std::sqrt(AABBTreeIndirect::squared_distance_to_indexed_triangle_set(its.vertices, its.indices, tree, pt, hit_idx, hit_point));
+    }
+    bench.stop();
+    double t_distance = bench.getElapsedSec();
+
+    size_t num_in_radius = 0;
+    bench.start();
+    for (const Vec3d &pt : queries.origins) {
+        double sqr_radius = 1.;
+        if (AABBTreeIndirect::is_any_triangle_in_radius(its.vertices, its.indices, tree, pt, sqr_radius))
+            ++ num_in_radius;
+    }
+    bench.stop();
+    double t_radius = bench.getElapsedSec();
+
+    const double n = double(queries.origins.size());
+    std::cout << name << 
+        ": first hit " << n / t_first_hit << " q/s (" << num_hits << " hits)" <<
+        ", all hits " << n / t_all_hits << " q/s (" << num_all_hits << " hits)" <<
+        ", distance " << n / t_distance << " q/s (sum " << sum_distance << ")" <<
+        ", in radius " << n / t_radius << " q/s (" << num_in_radius << " in radius)" << std::endl;
+}
+
+int Slic3r::benchmarks::aabb_wide(const int argc, const char *argv[])
+{
+    if (argc < 2) {
+        std::cout << USAGE_STR << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    TriangleMesh mesh;
+    if (! load_mesh(argv[1], mesh)) {
+        std::cerr << "Failed to load " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+    indexed_triangle_set its = mesh.its;
+    for (int i = (argc > 2) ? std::atoi(argv[2]) : 0; i > 0; -- i)
+        its = subdivide(its);
+    std::cout << "Triangles: " << its.indices.size() << std::endl;
+
+    // Random rays starting inside the bounding box of the mesh.
+    Queries queries;
+    {
+        BoundingBoxf3 bbox = mesh.bounding_box();
+        std::mt19937 rng(0);
+        std::uniform_real_distribution<double> unit(0., 1.);
+        for (size_t i = 0; i < 100000; ++ i) {
+            queries.origins.emplace_back(bbox.min + Vec3d(unit(rng), unit(rng), unit(rng)).cwiseProduct(bbox.size()));
+            queries.dirs.emplace_back(Vec3d(unit(rng) - 0.5, unit(rng) - 0.5, unit(rng) - 0.5).normalized());
+        }
+    }
+
+    Benchmark bench;
+    bench.start();
+    AABBTreeIndirect::Tree3f tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(its.vertices, its.indices);
+    bench.stop();
+    double t_build = bench.getElapsedSec();
+    std::cout << "Binary tree: build " << t_build << "s, memory " << 
+        (tree.nodes().size() * sizeof(AABBTreeIndirect::Tree3f::Node)) / 1048576. << "MB" << std::endl;
+    profile("Binary tree", its, tree, queries);
+
+    auto profile_wide = [&](const char *name, auto &&wide, bool copy_triangles) {
+        bench.start();
+        wide.build(tree, its.vertices, its.indices, copy_triangles);
+        bench.stop();
+        double t_build_wide = bench.getElapsedSec();
+        std::cout << name << ": build " << t_build + t_build_wide << "s (collapse " << t_build_wide << "s), memory " <<
+            wide.memory_size() / 1048576. << "MB" << (copy_triangles ? " including triangles" : "") << std::endl;
+        profile(name, its, wide, queries);
+    };
+    profile_wide("4-ary tree",                   AABBTreeIndirect::WideTree3f(),   false);
+    profile_wide("4-ary tree, triangles copied", AABBTreeIndirect::WideTree3f(),   true);
+    profile_wide("8-ary tree",                   AABBTreeIndirect::WideTree8x3f(), false);
+    profile_wide("8-ary tree, triangles copied", AABBTreeIndirect::WideTree8x3f(), true);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,113 @@
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <libnest2d/libnest2d.hpp>
+#include <libnest2d/tools/benchmark.h>
+
+#include <boost/multiprecision/integer.hpp>
+#include <boost/rational.hpp>
+
+#include "printer_parts.hpp"
+#include "Benchmarks.hpp"
+
+const std::string USAGE_STR = {
+    "Usage: benchmarks arrange-nfp-cache [copies] [repeats]\n"
+    "Arranges the printer parts of the libnest2d tests, each of them the given number of times,\n"
+    "with the no-fit polygon cache disabled, cold and shared between repeated arrangements.\n"
+    "Prints the timings and the cache statistics and verifies that the arrangements match."
+};
+
+namespace libnest2d {
+
+#if !defined(_MSC_VER) && defined(__SIZEOF_INT128__) && !defined(__APPLE__)
+using LargeInt = __int128;
+#else
+using LargeInt = boost::multiprecision::int128_t;
+template<> struct _NumTag<LargeInt> { using Type = ScalarTag; };
+#endif
+template<class T> struct _NumTag<boost::rational<T>> { using Type = RationalTag; };
+
+namespace nfp {
+
+// Exact convex no-fit polygons, the same as used by the arrangement of PrusaSlicer.
+template<class S> struct NfpImpl<S, NfpLevel::CONVEX_ONLY>
+{
+    NfpResult<S> operator()(const S &sh, const S &other)
+    {
+        return nfpConvexOnly<S, boost::rational<LargeInt>>(sh, other);
+    }
+};
+
+} // namespace nfp
+} // namespace libnest2d
+
+using namespace libnest2d;
+
+using Cache = placers::NfpCache<PolygonImpl>;
+
+static std::vector<Item> make_items(size_t copies)
+{
+    std::vector<Item> items;
+    items.reserve(PRINTER_PART_POLYGONS.size() * copies);
+    for (const ClipperLib::Path &part : PRINTER_PART_POLYGONS)
+        for (size_t i = 0; i < copies; ++ i)
+            items.emplace_back(part);
+    return items;
+}
+
+// Arranges the items repeats times, returns the last arrangement.
+static std::vector<Item> profile(const char *name, const std::vector<Item> &input, size_t repeats, std::shared_ptr<Cache> cache)
+{
+    const Box bin(250000000, 210000000);
+    NestConfig<> cfg;
+    cfg.placer_config.nfp_cache = cache;
+
+    std::vector<Item> items;
+    Benchmark bench;
+    bench.start();
+    for (size_t i = 0; i < repeats; ++ i) {
+        items = input;
+        nest(items, bin, 0, cfg);
+    }
+    bench.stop();
+    std::cout << "  " << name << ": " << bench.getElapsedSec() << " s, cache hits: " << cache->hits()
+              << ", misses: " << cache->misses() << ", polygons: " << cache->size() << std::endl;
+    return items;
+}
+
+static bool same_arrangement(const std::vector<Item> &a, const std::vector<Item> &b)
+{
+    for (size_t i = 0; i < a.size(); ++ i)
+        if (a[i].binId() != b[i].binId() || a[i].translation() != b[i].translation() ||
+            double(a[i].rotation()) != double(b[i].rotation()))
+            return false;
+    return true;
+}
+
+int Slic3r::benchmarks::arrange_nfp_cache(const int argc, const char *argv[])
+{
+    if (argc > 1 && std::string(argv[1]) == "--help") {
+        std::cout << USAGE_STR << std::endl;
+        return EXIT_SUCCESS;
+    }
+    const size_t copies  = argc > 1 ? size_t(std::max(std::atoi(argv[1]), 1)) : 1;
+    const size_t repeats = argc > 2 ? size_t(std::max(std::atoi(argv[2]), 1)) : 3;
+
+    std::vector<Item> input = make_items(copies);
+    std::cout << "Items: " << input.size() << ", arrangements: " << repeats << std::endl;
+
+    // A cache limited to a single polygon is effectively disabled.
+    std::vector<Item> uncached = profile("No cache",     input, repeats, std::make_shared<Cache>(0));
+    std::vector<Item> cold     = profile("Cold cache",   input, 1,       std::make_shared<Cache>());
+    std::shared_ptr<Cache> shared = std::make_shared<Cache>();
+    std::vector<Item> warm     = profile("Shared cache", input, repeats, shared);
+
+    if (! same_arrangement(uncached, cold) || ! same_arrangement(uncached, warm)) {
+        std::cerr << "The cached and the uncached arrangements differ!" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
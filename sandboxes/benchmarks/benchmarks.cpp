@@ -0,0 +1,45 @@
+#include <cstring>
+#include <iostream>
+
+#include "Benchmarks.hpp"
+
+using namespace Slic3r::benchmarks;
+
+struct BenchmarkEntry {
+    const char *name;
+    int (*run)(const int argc, const char *argv[]);
+};
+
+static const BenchmarkEntry BENCHMARKS[] = {
+    { "fill-rectilinear", fill_rectilinear },
+    { "aabb-wide", aabb_wide },
+    { "sla-raster-encoding", sla_raster_encoding },
+    { "clipper-adapters", clipper_adapters },
+    { "extrusion-export", extrusion_export },
+    { "arrange-nfp-cache", arrange_nfp_cache },
+    { "mesh-memory", mesh_memory },
+    { "triangle-selector-brush", triangle_selector_brush },
+    { "simplify-mesh", simplify_mesh },
+    { "drill-holes", drill_holes },
+    { "ray-rings", ray_rings },
+#ifdef SLIC3R_GUI
+    { "gcode-viewer-lod", gcode_viewer_lod },
+    { "preview-geometry", preview_geometry },
+#endif // SLIC3R_GUI
+};
+
+int main(const int argc, const char *argv[])
+{
+    if (argc > 1)
+        for (const BenchmarkEntry &entry : BENCHMARKS)
+            if (std::strcmp(argv[1], entry.name) == 0)
+                return entry.run(argc - 1, argv + 1);
+
+    std::cout << "Usage: benchmarks <name> [arguments ...]\n"
+                 "Runs one of the benchmarks below, the head of its source file describes its arguments.\n";
+    for (const BenchmarkEntry &entry : BENCHMARKS)
+        std::cout << "    " << entry.name << "\n";
+    std::cout << std::flush;
+
+    return argc > 1 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,159 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/TriangleMesh.hpp>
+#include <libslic3r/ClipperUtils.hpp>
+
+#include "Benchmarks.hpp"
+
+const std::string USAGE_STR = {
+    "Usage: benchmarks clipper-adapters meshfile.{stl,obj} [layer_height]\n"
+    "Slices the mesh and runs perimeter and support like workloads of the Clipper library,\n"
+    "once converting the paths through ClipperLib::Paths and once feeding the Slic3r containers\n"
+    "to the Clipper library directly. Prints the timings and verifies that the results match."
+};
+
+using namespace Slic3r;
+
+// Boolean operations and offsets the way ClipperUtils used to implement them:
+// the input is copied into ClipperLib::Paths, the output is copied from ClipperLib::Paths.
+struct ConvertingOps
+{
+    static Polygons clipper(ClipperLib::ClipType clipType, const Polygons &subject, const Polygons &clip)
+    {
+        ClipperLib::Clipper clipper;
+        clipper.AddPaths(Slic3rMultiPoints_to_ClipperPaths(subject), ClipperLib::ptSubject, true);
+        clipper.AddPaths(Slic3rMultiPoints_to_ClipperPaths(clip), ClipperLib::ptClip, true);
+        ClipperLib::Paths out;
+        clipper.Execute(clipType, out, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+        return ClipperPaths_to_Slic3rPolygons(out);
+    }
+
+    static ExPolygons clipper_ex(ClipperLib::ClipType clipType, const Polygons &subject, const Polygons &clip)
+    {
+        ClipperLib::Clipper clipper;
+        clipper.AddPaths(Slic3rMultiPoints_to_ClipperPaths(subject), ClipperLib::ptSubject, true);
+        clipper.AddPaths(Slic3rMultiPoints_to_ClipperPaths(clip), ClipperLib::ptClip, true);
+        ClipperLib::Paths out;
+        clipper.Execute(clipType, out, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+        clipper.Clear();
+        clipper.AddPaths(out, ClipperLib::ptSubject, true);
+        ClipperLib::PolyTree polytree;
+        clipper.Execute(ClipperLib::ctUnion, polytree, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+        return PolyTreeToExPolygons(polytree);
+    }
+
+    static Polygons   diff     (const Polygons &a, const Polygons &b)     { return clipper(ClipperLib::ctDifference, a, b); }
+    static Polygons   union_   (const Polygons &a)                        { return clipper(ClipperLib::ctUnion, a, Polygons()); }
+    static ExPolygons diff_ex  (const ExPolygons &a, const ExPolygons &b) { return clipper_ex(ClipperLib::ctDifference, to_polygons(a), to_polygons(b)); }
+    static ExPolygons union_ex (const ExPolygons &a)                      { return clipper_ex(ClipperLib::ctUnion, to_polygons(a), Polygons()); }
+    static Polygons   offset   (const Polygons &a, float delta)
+        { return ClipperPaths_to_Slic3rPolygons(_offset(Slic3rMultiPoints_to_ClipperPaths(a), ClipperLib::etClosedPolygon, delta, ClipperLib::jtMiter, 3.)); }
+    static ExPolygons offset_ex(const Polygons &a, float delta)
+        { return ClipperPaths_to_Slic3rExPolygons(_offset(Slic3rMultiPoints_to_ClipperPaths(a), ClipperLib::etClosedPolygon, delta, ClipperLib::jtMiter, 3.)); }
+};
+
+// The ClipperUtils functions, feeding the Slic3r containers to the Clipper library directly.
+struct DirectOps
+{
+    static Polygons   diff     (const Polygons &a, const Polygons &b)     { return Slic3r::diff(a, b); }
+    static Polygons   union_   (const Polygons &a)                        { return Slic3r::union_(a); }
+    static ExPolygons diff_ex  (const ExPolygons &a, const ExPolygons &b) { return Slic3r::diff_ex(a, b); }
+    static ExPolygons union_ex (const ExPolygons &a)                      { return Slic3r::union_ex(a); }
+    static Polygons   offset   (const Polygons &a, float delta)           { return Slic3r::offset(a, delta); }
+    static ExPolygons offset_ex(const Polygons &a, float delta)           { return Slic3r::offset_ex(a, delta); }
+};
+
+// Perimeters: three loops inset from each slice, then the gap between the innermost loop and the slice.
+template<typename Ops>
+static std::vector<Polygons> perimeters(const std::vector<ExPolygons> &layers, float spacing)
+{
+    std::vector<Polygons> out;
+    out.reserve(layers.size());
+    for (const ExPolygons &layer : layers) {
+        Polygons loops;
+        Polygons last = to_polygons(layer);
+        for (int i = 0; i < 3 && ! last.empty(); ++ i) {
+            last = Ops::offset(last, - (i == 0 ? 0.5f : 1.f) * spacing);
+            append(loops, last);
+        }
+        ExPolygons inner = Ops::offset_ex(last, - 0.5f * spacing);
+        append(loops, to_polygons(Ops::diff_ex(layer, Ops::union_ex(inner))));
+        out.emplace_back(std::move(loops));
+    }
+    return out;
+}
+
+// Supports: overhangs projected down through the layers, minus the object grown by a gap.
+template<typename Ops>
+static std::vector<Polygons> supports(const std::vector<ExPolygons> &layers, float gap)
+{
+    std::vector<Polygons> out(layers.size());
+    Polygons support;
+    for (int i = int(layers.size()) - 1; i > 0; -- i) {
+        Polygons below = Ops::offset(to_polygons(layers[i - 1]), gap);
+        append(support, Ops::diff(to_polygons(layers[i]), below));
+        support = Ops::diff(Ops::union_(support), below);
+        out[i - 1] = support;
+    }
+    return out;
+}
+
+template<typename Fn>
+static std::vector<Polygons> profile(const char *name, Fn &&fn)
+{
+    Benchmark bench;
+    bench.start();
+    std::vector<Polygons> out = fn();
+    bench.stop();
+    std::cout << "  " << name << ": " << bench.getElapsedSec() << " s" << std::endl;
+    return out;
+}
+
+int Slic3r::benchmarks::clipper_adapters(const int argc, const char *argv[])
+{
+    if (argc < 2) {
+        std::cout << USAGE_STR << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    TriangleMesh mesh;
+    if (! load_mesh(argv[1], mesh)) {
+        std::cerr << "Failed to load " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+    const float layer_height = argc > 2 ? float(std::atof(argv[2])) : 0.2f;
+
+    BoundingBoxf3 bb = mesh.bounding_box();
+    std::vector<float> zs;
+    for (float z = float(bb.min.z()) + 0.5f * layer_height; z < float(bb.max.z()); z += layer_height)
+        zs.emplace_back(z);
+    std::vector<ExPolygons> layers;
+    TriangleMeshSlicer slicer(&mesh);
+    slicer.slice(zs, SlicingMode::Regular, 0.f, &layers, [](){});
+    size_t num_points = 0;
+    for (const ExPolygons &layer : layers)
+        for (const ExPolygon &expoly : layer) {
+            num_points += expoly.contour.points.size();
+            for (const Polygon &hole : expoly.holes)
+                num_points += hole.points.size();
+        }
+    std::cout << "Layers: " << layers.size() << ", points: " << num_points << std::endl;
+
+    const float spacing = float(scale_(0.45));
+    std::cout << "Perimeters:" << std::endl;
+    std::vector<Polygons> perimeters1 = profile("Converting through ClipperLib::Paths", [&layers, spacing]() { return perimeters<ConvertingOps>(layers, spacing); });
+    std::vector<Polygons> perimeters2 = profile("Direct",                               [&layers, spacing]() { return perimeters<DirectOps>(layers, spacing); });
+    std::cout << "Supports:" << std::endl;
+    std::vector<Polygons> supports1   = profile("Converting through ClipperLib::Paths", [&layers, spacing]() { return supports<ConvertingOps>(layers, spacing); });
+    std::vector<Polygons> supports2   = profile("Direct",                               [&layers, spacing]() { return supports<DirectOps>(layers, spacing); });
+
+    if (perimeters1 != perimeters2 || supports1 != supports2) {
+        std::cerr << "The results of the converting and the direct variants differ!" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
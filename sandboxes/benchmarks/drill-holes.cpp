@@ -0,0 +1,97 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/TriangleMesh.hpp>
+#include <libslic3r/MeshBoolean.hpp>
+#include <libslic3r/SLA/Hollowing.hpp>
+
+#include "Benchmarks.hpp"
+
+const std::string USAGE_STR = {
+    "Usage: benchmarks drill-holes [meshfile.{stl,obj}] [number of holes]\n"
+    "Hollows the mesh and drills the drain holes into it, first unioning the holes one by one,\n"
+    "then by merging them with a boolean union of the overlapping ones only, and prints the times.\n"
+    "A sphere with 40 holes is drilled if no mesh is given."
+};
+
+using namespace Slic3r;
+
+// Holes drilled towards the center of the mesh from the points of a Fibonacci sphere around it,
+// every fourth one is doubled by a slightly shifted one to have some overlapping holes.
+static sla::DrainHoles make_holes(const TriangleMesh &mesh, size_t num_holes)
+{
+    BoundingBoxf3 bb     = mesh.bounding_box();
+    Vec3d         center = bb.center();
+    double        radius = 0.5 * bb.size().minCoeff();
+    float         r      = float(0.05 * radius);
+
+    sla::DrainHoles holes;
+    for (size_t i = 0; i < num_holes; ++ i) {
+        double z   = 1. - 2. * (double(i) + 0.5) / double(num_holes);
+        double phi = double(i) * PI * (3. - std::sqrt(5.));
+        Vec3d  dir(std::sqrt(1. - z * z) * std::cos(phi), std::sqrt(1. - z * z) * std::sin(phi), z);
+        Vec3f  pos = (center + 1.05 * radius * dir).cast<float>();
+        Vec3f  n   = - dir.cast<float>();
+        holes.emplace_back(pos, n, r, float(0.3 * radius));
+        if (i % 4 == 0)
+            holes.emplace_back(Vec3f(pos + Vec3f(r, 0.f, 0.f)), n, r, float(0.3 * radius));
+    }
+    return holes;
+}
+
+static void drill(const char *name, const TriangleMesh &hollowed, const TriangleMesh &holes_mesh, double union_time)
+{
+    Benchmark bench;
+    bench.start();
+    auto hollowed_cgal = MeshBoolean::cgal::triangle_mesh_to_cgal(hollowed);
+    auto holes_cgal    = MeshBoolean::cgal::triangle_mesh_to_cgal(holes_mesh);
+    MeshBoolean::cgal::minus(*hollowed_cgal, *holes_cgal);
+    TriangleMesh drilled = MeshBoolean::cgal::cgal_to_triangle_mesh(*hollowed_cgal);
+    bench.stop();
+    std::cout << name << ": union " << union_time << "s, subtraction " << bench.getElapsedSec() << "s, " <<
+        drilled.its.indices.size() << " faces" << std::endl;
+}
+
+int Slic3r::benchmarks::drill_holes(const int argc, const char *argv[])
+{
+    TriangleMesh mesh;
+    if (argc > 1) {
+        if (! load_mesh(argv[1], mesh)) {
+            std::cerr << "Failed to load " << argv[1] << std::endl;
+            return EXIT_FAILURE;
+        }
+    } else {
+        std::cout << USAGE_STR << std::endl;
+        mesh = make_sphere(30., PI / 60.);
+    }
+    size_t num_holes = argc > 2 ? size_t(std::stoul(argv[2])) : 40;
+
+    TriangleMesh hollowed = mesh;
+    sla::hollow_mesh(hollowed, sla::HollowingConfig{});
+    sla::DrainHoles holes = make_holes(mesh, num_holes);
+    std::cout << "Hollowed mesh: " << hollowed.its.indices.size() << " faces, " << holes.size() << " holes" << std::endl;
+
+    // Each hole unioned with all the previous ones.
+    Benchmark bench;
+    bench.start();
+    auto holes_cgal = MeshBoolean::cgal::triangle_mesh_to_cgal({});
+    for (const sla::DrainHole &hole : holes) {
+        TriangleMesh m = sla::to_triangle_mesh(hole.to_mesh());
+        m.require_shared_vertices();
+        auto cgal_m = MeshBoolean::cgal::triangle_mesh_to_cgal(m);
+        MeshBoolean::cgal::plus(*holes_cgal, *cgal_m);
+    }
+    TriangleMesh holes_mesh = MeshBoolean::cgal::cgal_to_triangle_mesh(*holes_cgal);
+    holes_mesh.require_shared_vertices();
+    bench.stop();
+    drill("Incremental union", hollowed, holes_mesh, bench.getElapsedSec());
+
+    bench.start();
+    holes_mesh = sla::merged_holes_mesh(holes);
+    bench.stop();
+    drill("Merged holes", hollowed, holes_mesh, bench.getElapsedSec());
+
+    return EXIT_SUCCESS;
+}
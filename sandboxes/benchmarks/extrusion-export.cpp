@@ -0,0 +1,152 @@
+// Measures the heap traffic of walking the extrusion entities of a layer the way GCode exports them:
+// ordering a collection by ExtrusionEntityCollection::chained_path_from(), which clones all the entities,
+// and simplifying a by-value copy of each path, versus ordering the entities by chain_extrusion_entities()
+// and simplifying the source polylines directly.
+// The layers are synthetic and only the export walk is run, not the slicing nor the G-code generation,
+// so the numbers printed check that the copies are gone, they are not a measure of a real export's speed.
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <random>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/ExtrusionEntity.hpp>
+#include <libslic3r/ExtrusionEntityCollection.hpp>
+#include <libslic3r/ShortestPath.hpp>
+
+#include "Benchmarks.hpp"
+
+// Replaces the global operator new of the whole benchmarks program, only this benchmark reports the counts.
+static std::atomic<size_t> g_num_allocs { 0 };
+static std::atomic<size_t> g_bytes_allocated { 0 };
+
+void* operator new(size_t size)
+{
+    ++ g_num_allocs;
+    g_bytes_allocated += size;
+    if (void *ptr = std::malloc(size))
+        return ptr;
+    throw std::bad_alloc();
+}
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+
+using namespace Slic3r;
+
+// Layers of short infill lines and support zig-zags, similar to what a large print produces.
+static std::vector<ExtrusionEntityCollection> make_layers(size_t num_layers, size_t paths_per_layer)
+{
+    std::mt19937 rng(0);
+    std::uniform_int_distribution<coord_t> coord(0, coord_t(scale_(200.)));
+    std::uniform_int_distribution<coord_t> step(coord_t(scale_(0.2)), coord_t(scale_(2.)));
+    std::vector<ExtrusionEntityCollection> layers(num_layers);
+    for (ExtrusionEntityCollection &layer : layers) {
+        for (size_t i = 0; i < paths_per_layer; ++ i) {
+            Polyline pl;
+            Point    pt(coord(rng), coord(rng));
+            size_t   num_points = 2 + i % 12;
+            for (size_t j = 0; j < num_points; ++ j) {
+                pl.points.emplace_back(pt);
+                pt += Point(step(rng), (j & 1) ? step(rng) : - step(rng));
+            }
+            if (i % 4 == 0) {
+                ExtrusionMultiPath multipath;
+                multipath.paths.emplace_back(ExtrusionPath(std::move(pl), ExtrusionPath(erSupportMaterial, 0.05, 0.45f, 0.2f)));
+                layer.append(std::move(multipath));
+            } else
+                layer.append(ExtrusionPath(std::move(pl), ExtrusionPath(erInternalInfill, 0.05, 0.45f, 0.2f)));
+        }
+    }
+    return layers;
+}
+
+// Stand-in for GCode::_extrude().
+static double consume(const ExtrusionPath &path) { return double(path.polyline.points.size()) + path.polyline.length(); }
+
+struct ConvertingWalk
+{
+    static const char* name() { return "clone + copy"; }
+    static double extrude_path(ExtrusionPath path) { path.simplify(SCALED_RESOLUTION); return consume(path); }
+    static double extrude_multi_path(ExtrusionMultiPath multipath) {
+        double out = 0.;
+        for (ExtrusionPath path : multipath.paths) {
+            path.simplify(SCALED_RESOLUTION);
+            out += consume(path);
+        }
+        return out;
+    }
+    static double extrude_entity(const ExtrusionEntity &ee) {
+        if (auto *path = dynamic_cast<const ExtrusionPath*>(&ee))
+            return extrude_path(*path);
+        return extrude_multi_path(*dynamic_cast<const ExtrusionMultiPath*>(&ee));
+    }
+    static double walk(const ExtrusionEntityCollection &layer, const Point &start) {
+        double out = 0.;
+        for (const ExtrusionEntity *ee : layer.chained_path_from(start).entities)
+            out += extrude_entity(*ee);
+        return out;
+    }
+};
+
+struct DirectWalk
+{
+    static const char* name() { return "direct"; }
+    static ExtrusionPath simplified(const ExtrusionPath &path)
+        { return ExtrusionPath(Polyline(MultiPoint::_douglas_peucker(path.polyline.points, SCALED_RESOLUTION)), path); }
+    static double extrude_entity(const ExtrusionEntity &ee) {
+        if (auto *path = dynamic_cast<const ExtrusionPath*>(&ee))
+            return consume(simplified(*path));
+        double out = 0.;
+        for (const ExtrusionPath &path : dynamic_cast<const ExtrusionMultiPath*>(&ee)->paths)
+            out += consume(simplified(path));
+        return out;
+    }
+    static double walk(const ExtrusionEntityCollection &layer, const Point &start) {
+        double out = 0.;
+        for (const std::pair<size_t, bool> &idx : chain_extrusion_entities(layer.entities, &start)) {
+            const ExtrusionEntity *ee = layer.entities[idx.first];
+            if (idx.second) {
+                std::unique_ptr<ExtrusionEntity> reversed(ee->clone());
+                reversed->reverse();
+                out += extrude_entity(*reversed);
+            } else
+                out += extrude_entity(*ee);
+        }
+        return out;
+    }
+};
+
+template<typename Walk>
+static double run(const std::vector<ExtrusionEntityCollection> &layers)
+{
+    size_t allocs0 = g_num_allocs;
+    size_t bytes0  = g_bytes_allocated;
+    auto   t0      = std::chrono::steady_clock::now();
+    double out     = 0.;
+    for (const ExtrusionEntityCollection &layer : layers)
+        out += Walk::walk(layer, Point(0, 0));
+    auto   t1      = std::chrono::steady_clock::now();
+    std::cout << Walk::name() << ": " << std::chrono::duration<double, std::milli>(t1 - t0).count() << " ms, "
+              << (g_num_allocs - allocs0) << " allocations, "
+              << (g_bytes_allocated - bytes0) / (1024 * 1024) << " MB allocated" << std::endl;
+    return out;
+}
+
+int Slic3r::benchmarks::extrusion_export(const int argc, const char *argv[])
+{
+    size_t num_layers      = argc > 1 ? size_t(atoi(argv[1])) : 200;
+    size_t paths_per_layer = argc > 2 ? size_t(atoi(argv[2])) : 5000;
+    std::vector<ExtrusionEntityCollection> layers = make_layers(num_layers, paths_per_layer);
+    std::cout << num_layers << " layers, " << paths_per_layer << " extrusions per layer" << std::endl;
+    double a = run<ConvertingWalk>(layers);
+    double b = run<DirectWalk>(layers);
+    if (a != b) {
+        std::cerr << "Results differ" << std::endl;
+        return -1;
+    }
+    return 0;
+}
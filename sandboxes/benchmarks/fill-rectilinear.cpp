@@ -0,0 +1,109 @@
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/TriangleMesh.hpp>
+#include <libslic3r/Fill/FillBase.hpp>
+#include <libslic3r/PrintConfig.hpp>
+#include <libslic3r/Surface.hpp>
+
+#include "Benchmarks.hpp"
+
+const std::string USAGE_STR = {
+    "Usage: benchmarks fill-rectilinear meshfile.{stl,obj} [meshfile ...]\n"
+    "Slices the meshes at 0.2mm layers and fills every layer surface with the rectilinear infill\n"
+    "at several densities. Prints the filling time and a checksum of the generated infill,\n"
+    "which shall match between two builds producing identical infill."
+};
+
+using namespace Slic3r;
+
+// Corpus of layer surfaces: All the slices of all the meshes.
+static ExPolygons slice_corpus(const TriangleMesh &mesh, float layer_height)
+{
+    BoundingBoxf3 bb = mesh.bounding_box();
+    std::vector<float> zs;
+    for (float z = float(bb.min.z()) + 0.5f * layer_height; z < float(bb.max.z()); z += layer_height)
+        zs.emplace_back(z);
+    std::vector<ExPolygons> layers;
+    TriangleMeshSlicer slicer(&mesh);
+    slicer.slice(zs, SlicingMode::Regular, 0.f, &layers, [](){});
+    ExPolygons out;
+    for (ExPolygons &layer : layers)
+        append(out, std::move(layer));
+    return out;
+}
+
+struct FillStats {
+    size_t   num_polylines = 0;
+    size_t   num_points    = 0;
+    uint64_t checksum      = 0;
+    double   time          = 0.;
+};
+
+static FillStats profile(const ExPolygons &corpus, float density, float angle, int repeat)
+{
+    FillStats stats;
+    std::unique_ptr<Fill> filler(Fill::new_from_type(ipRectilinear));
+    filler->angle   = angle;
+    filler->spacing = 0.45;
+    FillParams params;
+    params.density     = density;
+    params.dont_adjust = false;
+
+    Benchmark bench;
+    bench.start();
+    for (int i = 0; i < repeat; ++ i)
+        for (const ExPolygon &expoly : corpus) {
+            Surface   surface(stInternal, expoly);
+            Polylines polylines = filler->fill_surface(&surface, params);
+            if (i == 0)
+                for (const Polyline &pl : polylines) {
+                    ++ stats.num_polylines;
+                    stats.num_points += pl.points.size();
+                    for (const Point &pt : pl.points)
+                        stats.checksum = stats.checksum * 31 + uint64_t(pt.x()) * 7 + uint64_t(pt.y());
+                }
+        }
+    bench.stop();
+    stats.time = bench.getElapsedSec() / repeat;
+    return stats;
+}
+
+int Slic3r::benchmarks::fill_rectilinear(const int argc, const char *argv[])
+{
+    if (argc < 2) {
+        std::cout << USAGE_STR << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    ExPolygons corpus;
+    for (int i = 1; i < argc; ++ i) {
+        TriangleMesh mesh;
+        if (! load_mesh(argv[i], mesh)) {
+            std::cerr << "Failed to load " << argv[i] << std::endl;
+            return EXIT_FAILURE;
+        }
+        append(corpus, slice_corpus(mesh, 0.2f));
+    }
+
+    size_t num_points = 0;
+    for (const ExPolygon &expoly : corpus)
+        num_points += expoly.contour.points.size() + std::accumulate(expoly.holes.begin(), expoly.holes.end(), size_t(0), 
+            [](size_t acc, const Polygon &hole) { return acc + hole.points.size(); });
+    std::cout << "Layer surfaces: " << corpus.size() << ", contour points: " << num_points << std::endl;
+
+    for (float density : { 0.15f, 0.4f, 1.f }) {
+        FillStats stats = profile(corpus, density, float(M_PI / 4.), 3);
+        std::cout << "Density " << density << 
+            ": time " << stats.time << "s" <<
+            ", polylines " << stats.num_polylines << 
+            ", points " << stats.num_points << 
+            ", checksum " << stats.checksum << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,99 @@
+// Measures the level of detail pyramid of the G-code viewer without an OpenGL context:
+// for each level, the number of moves kept by GCodeViewer::decimate_moves(), the time to decimate them
+// and the number of vertices and indices generated by GCodeViewer::generate_toolpaths_geometry().
+//
+// Usage: benchmarks gcode-viewer-lod [file.gcode]
+// Without a file, dense synthetic perimeters made of short noisy moves are used, similar to a tessellated curved surface.
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/GCode/GCodeProcessor.hpp>
+#include <slic3r/GUI/GCodeViewer.hpp>
+
+#include "Benchmarks.hpp"
+
+using namespace Slic3r;
+using namespace Slic3r::GUI;
+
+using MoveVertex = GCodeProcessor::MoveVertex;
+
+// Cylinders of circular perimeters with a travel between the layers.
+static std::vector<MoveVertex> make_moves(size_t num_layers, size_t moves_per_loop)
+{
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<float> noise(-0.002f, 0.002f);
+    std::vector<MoveVertex> moves;
+    auto add_move = [&moves](EMoveType type, const Vec3f &position) {
+        MoveVertex move;
+        move.type           = type;
+        move.extrusion_role = type == EMoveType::Extrude ? erPerimeter : erNone;
+        move.position       = position;
+        move.feedrate       = type == EMoveType::Travel ? 120.0f : 40.0f;
+        move.width          = type == EMoveType::Extrude ? 0.45f : 0.0f;
+        move.height         = 0.2f;
+        move.mm3_per_mm     = 0.05f;
+        move.delta_extruder = type == EMoveType::Extrude ? 0.01f : 0.0f;
+        moves.push_back(move);
+    };
+
+    add_move(EMoveType::Noop, Vec3f::Zero());
+    for (size_t layer = 0; layer < num_layers; ++ layer) {
+        float z = 0.2f * float(layer + 1);
+        for (size_t loop = 0; loop < 3; ++ loop) {
+            float r = 40.0f - 0.45f * float(loop);
+            add_move(EMoveType::Travel, Vec3f(100.0f + r, 100.0f, z));
+            for (size_t i = 1; i <= moves_per_loop; ++ i) {
+                float a = 2.0f * float(PI) * float(i) / float(moves_per_loop);
+                add_move(EMoveType::Extrude, Vec3f(100.0f + r * std::cos(a) + noise(rng), 100.0f + r * std::sin(a) + noise(rng), z));
+            }
+        }
+    }
+    return moves;
+}
+
+int Slic3r::benchmarks::gcode_viewer_lod(const int argc, const char *argv[])
+{
+    GCodeProcessor processor;
+    std::vector<MoveVertex> synthetic;
+    const std::vector<MoveVertex> *moves = nullptr;
+    if (argc > 1) {
+        processor.process_file(argv[1], false);
+        moves = &processor.get_result().moves;
+        std::cout << argv[1] << ": ";
+    } else {
+        synthetic = make_moves(500, 2000);
+        moves = &synthetic;
+        std::cout << "synthetic: ";
+    }
+    std::cout << moves->size() << " moves" << std::endl;
+
+    for (size_t level = 0; level <= GCodeViewer::ToolpathsLOD::Tolerances.size(); ++ level) {
+        auto t0 = std::chrono::steady_clock::now();
+        std::vector<size_t> move_ids;
+        if (level > 0)
+            move_ids = GCodeViewer::decimate_moves(*moves, GCodeViewer::ToolpathsLOD::Tolerances[level - 1]);
+        auto t1 = std::chrono::steady_clock::now();
+        GCodeViewer::ToolpathsGeometry geometry = GCodeViewer::generate_toolpaths_geometry(*moves, move_ids);
+        auto t2 = std::chrono::steady_clock::now();
+
+        size_t num_vertices = 0;
+        size_t num_indices  = 0;
+        for (const GCodeViewer::ToolpathsGeometry::Buffer &buffer : geometry.buffers) {
+            num_vertices += buffer.vertices_count;
+            for (const GCodeViewer::ToolpathsGeometry::IndexBufferLayout &ibuffer : buffer.index_buffers)
+                num_indices += ibuffer.count;
+        }
+        std::cout << "level " << level;
+        if (level > 0)
+            std::cout << " (tolerance " << GCodeViewer::ToolpathsLOD::Tolerances[level - 1] << " mm)";
+        std::cout << ": " << (level == 0 ? moves->size() : move_ids.size()) << " moves, "
+                  << num_vertices << " vertices, " << num_indices << " indices, "
+                  << "decimation " << std::chrono::duration<double, std::milli>(t1 - t0).count() << " ms, "
+                  << "geometry " << std::chrono::duration<double, std::milli>(t2 - t1).count() << " ms" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/Geometry.hpp>
+#include <libslic3r/TriangleMesh.hpp>
+
+#include "Benchmarks.hpp"
+
+const std::string USAGE_STR = {
+    "Usage: benchmarks mesh-memory meshfile.{stl,obj} [meshfile ...]\n"
+    "Prints the memory occupied by the stl_file and by the indexed triangle set of the meshes\n"
+    "and compares slicing of a transformed copy of the TriangleMesh with slicing of a transformed\n"
+    "copy of its indexed triangle set only, as done by PrintObject::slice_volume()."
+};
+
+using namespace Slic3r;
+
+static std::vector<float> slicing_zs(const BoundingBoxf3 &bb, float layer_height)
+{
+    std::vector<float> zs;
+    for (float z = float(bb.min.z()) + 0.5f * layer_height; z < float(bb.max.z()); z += layer_height)
+        zs.emplace_back(z);
+    return zs;
+}
+
+static size_t num_points(const std::vector<ExPolygons> &layers)
+{
+    size_t n = 0;
+    for (const ExPolygons &layer : layers)
+        for (const ExPolygon &expoly : layer)
+            n += expoly.contour.points.size();
+    return n;
+}
+
+int Slic3r::benchmarks::mesh_memory(const int argc, const char *argv[])
+{
+    if (argc < 2) {
+        std::cout << USAGE_STR << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    // Rotated, scaled and mirrored, as model volumes placed on the print bed usually are.
+    Transform3d trafo = Geometry::assemble_transform(Vec3d(10., 20., 0.), Vec3d(0., 0., 0.3), Vec3d(1.1, 1.1, 1.1), Vec3d(-1., 1., 1.));
+
+    for (int i = 1; i < argc; ++ i) {
+        TriangleMesh mesh;
+        if (! load_mesh(argv[i], mesh)) {
+            std::cerr << "Failed to load " << argv[i] << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::cout << argv[i] << ": " << mesh.facets_count() << " facets, " << mesh.its.vertices.size() << " shared vertices" << std::endl;
+        std::cout << "\tstl_file: " << mesh.stl.memsize() << " bytes, indexed triangle set: " << mesh.its.memsize() << " bytes" << std::endl;
+
+        std::vector<float> zs = slicing_zs(mesh.transformed_bounding_box(trafo), 0.2f);
+        Benchmark bench;
+
+        // Transformed copy of the whole mesh, as PrintObject::slice_volume() used to slice.
+        bench.start();
+        std::vector<ExPolygons> layers_mesh;
+        {
+            TriangleMesh copy(mesh);
+            copy.transform(trafo, true);
+            stl_check_facets_exact(&copy.stl);
+            copy.require_shared_vertices();
+            slice_mesh(copy, zs, layers_mesh, 0.f);
+        }
+        bench.stop();
+        std::cout << "\tTriangleMesh copy: " << bench.getElapsedSec() << "s, " <<
+            (mesh.stl.memsize() + mesh.its.memsize()) << " bytes copied, " << num_points(layers_mesh) << " contour points" << std::endl;
+
+        // Transformed copy of the indexed triangle set only.
+        bench.start();
+        std::vector<ExPolygons> layers_its;
+        {
+            indexed_triangle_set its = mesh.its;
+            its_transform(its, trafo, true);
+            TriangleMeshSlicer slicer(&its);
+            slicer.slice(zs, SlicingMode::Regular, 0.f, &layers_its, [](){});
+        }
+        bench.stop();
+        std::cout << "\tindexed triangle set copy: " << bench.getElapsedSec() << "s, " <<
+            mesh.its.memsize() << " bytes copied, " << num_points(layers_its) << " contour points" << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,91 @@
+// Measures the generation of the preview geometry of the extrusions of a sliced object without an OpenGL context:
+// the time to build the GLVolumes by GUI::ToolpathsPreview::build() with blocks of layers split by the buffer size limit only
+// and with the default blocks, the number of volumes and the size of their geometry.
+//
+// Usage: benchmarks preview-geometry [model.stl|model.3mf|model.obj] [num_copies]
+// Without a model, a cylinder with an overhanging rim is sliced.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/Layer.hpp>
+#include <libslic3r/Model.hpp>
+#include <libslic3r/Print.hpp>
+#include <libslic3r/TriangleMesh.hpp>
+#include <slic3r/GUI/ToolpathsPreview.hpp>
+
+#include "Benchmarks.hpp"
+
+using namespace Slic3r;
+using namespace Slic3r::GUI;
+
+static void run(const char *name, ToolpathsPreview::Params &params, size_t grain_size)
+{
+    params.grain_size = grain_size;
+    auto         t0      = std::chrono::steady_clock::now();
+    GLVolumePtrs volumes = ToolpathsPreview::build(params);
+    auto         t1      = std::chrono::steady_clock::now();
+    size_t       num_floats  = 0;
+    size_t       num_indices = 0;
+    for (const GLVolume *volume : volumes) {
+        num_floats  += volume->indexed_vertex_array.vertices_and_normals_interleaved.size();
+        num_indices += volume->indexed_vertex_array.triangle_indices.size() + volume->indexed_vertex_array.quad_indices.size();
+    }
+    std::cout << name << ": " << std::chrono::duration<double, std::milli>(t1 - t0).count() << " ms, "
+              << volumes.size() << " volumes, " << num_floats / 6 << " vertices, " << num_indices << " indices, "
+              << (num_floats + num_indices) * 4 / (1024 * 1024) << " MB" << std::endl;
+    for (GLVolume *volume : volumes)
+        delete volume;
+}
+
+int Slic3r::benchmarks::preview_geometry(const int argc, const char *argv[])
+{
+    DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+    config.set_deserialize({ { "support_material", "1" }, { "fill_density", "20%" } });
+
+    Model model;
+    if (argc > 1)
+        model = Model::read_from_file(argv[1], nullptr, false);
+    else {
+        TriangleMesh mesh = make_cylinder(40., 60.);
+        TriangleMesh rim  = make_cylinder(60., 5.);
+        rim.translate(0.f, 0.f, 40.f);
+        mesh.merge(rim);
+        model.add_object()->add_volume(std::move(mesh));
+    }
+    size_t num_copies = argc > 2 ? size_t(atoi(argv[2])) : 4;
+    for (ModelObject *object : model.objects) {
+        object->clear_instances();
+        for (size_t i = 0; i < num_copies; ++ i)
+            object->add_instance()->set_offset(Vec3d(150. * double(i), 0., 0.));
+        object->ensure_on_bed();
+    }
+
+    Print print;
+    print.apply(model, config);
+    auto t0 = std::chrono::steady_clock::now();
+    print.process();
+    std::cout << "Slicing: " << std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count() << " s" << std::endl;
+
+    for (const PrintObject *print_object : print.objects()) {
+        ToolpathsPreview::Params params;
+        for (const Layer *layer : print_object->layers())
+            params.layers.emplace_back(layer);
+        for (const Layer *layer : print_object->support_layers())
+            params.layers.emplace_back(layer);
+        std::sort(params.layers.begin(), params.layers.end(), [](const Layer *l1, const Layer *l2) { return l1->print_z < l2->print_z; });
+        params.instances      = &print_object->instances();
+        params.has_perimeters = true;
+        params.has_infill     = true;
+        params.has_support    = true;
+        params.colors         = { { 1.f, 1.f, 0.f, 1.f }, { 1.f, 0.5f, 0.5f, 1.f }, { 0.5f, 1.f, 0.5f, 1.f } };
+        params.color_idx      = [](size_t, int, ToolpathsPreview::Feature feature) { return size_t(feature); };
+        std::cout << print_object->model_object()->name << ": " << params.layers.size() << " layers, " << params.instances->size() << " copies" << std::endl;
+        run("blocks split by the buffer size only", params, params.layers.size());
+        run("default blocks", params, 0);
+    }
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/TriangleMesh.hpp>
+#include <libslic3r/AABBTreeIndirect.hpp>
+
+#include "Benchmarks.hpp"
+
+const std::string USAGE_STR = {
+    "Usage: benchmarks ray-rings [meshfile.{stl,obj}]\n"
+    "Casts rings of 8 rays around the mesh the way the SLA support tree probes the space around the pinheads\n"
+    "(diverging rays) and the bridges (parallel rays): ray by ray, in packets of 4 rays and a ring at a time.\n"
+    "Prints the times and the sums of the hit distances, which shall match. A finely tesselated sphere is used\n"
+    "if no mesh is given."
+};
+
+using namespace Slic3r;
+
+using Rays = std::vector<std::vector<Vec3d>>;
+
+// Rings of rays starting on a circle of radius 0.5 around points of a sphere enclosing the mesh.
+static void make_rings(const BoundingBoxf3 &bbox, bool parallel, size_t num_rings, Rays &sources, Rays &dirs)
+{
+    static const size_t SAMPLES = 8;
+    std::mt19937 rng(0);
+    std::uniform_real_distribution<double> unit(-1., 1.);
+    for (size_t r = 0; r < num_rings; ++ r) {
+        Vec3d n = Vec3d(unit(rng), unit(rng), unit(rng)).normalized();
+        Vec3d c = bbox.center() + (0.5 * bbox.size().norm() + 1.) * n;
+        Vec3d a = n.unitOrthogonal(), b = n.cross(a);
+        std::vector<Vec3d> s(SAMPLES), d(SAMPLES);
+        for (size_t i = 0; i < SAMPLES; ++ i) {
+            double phi = 2. * PI * double(i) / double(SAMPLES);
+            Vec3d  off = std::cos(phi) * a + std::sin(phi) * b;
+            s[i] = c + 0.5 * off;
+            d[i] = parallel ? Vec3d(- n) : Vec3d((- 3. * n + 1.2 * off).normalized());
+        }
+        sources.emplace_back(std::move(s));
+        dirs.emplace_back(std::move(d));
+    }
+}
+
+template<typename Fn>
+static void profile(const char *name, Fn &&fn)
+{
+    Benchmark bench;
+    bench.start();
+    double sum = fn();
+    bench.stop();
+    std::cout << "    " << name << ": " << 1000. * bench.getElapsedSec() << "ms, sum of hit distances " << sum << std::endl;
+}
+
+int Slic3r::benchmarks::ray_rings(const int argc, const char *argv[])
+{
+    TriangleMesh mesh;
+    if (argc > 1) {
+        if (! load_mesh(argv[1], mesh)) {
+            std::cerr << "Failed to load " << argv[1] << std::endl;
+            return EXIT_FAILURE;
+        }
+    } else {
+        std::cout << USAGE_STR << std::endl;
+        mesh = make_sphere(50., PI / 400.);
+    }
+    mesh.require_shared_vertices();
+    std::cout << "Facets: " << mesh.facets_count() << std::endl;
+
+    const std::vector<Vec3f>                       &vertices = mesh.its.vertices;
+    const std::vector<stl_triangle_vertex_indices> &faces    = mesh.its.indices;
+    auto tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(vertices, faces);
+
+    for (bool parallel : { false, true }) {
+        Rays sources, dirs;
+        make_rings(mesh.bounding_box(), parallel, 20000, sources, dirs);
+        std::cout << (parallel ? "Parallel" : "Diverging") << " rays, " << sources.size() << " rings:" << std::endl;
+
+        profile("ray by ray", [&]() {
+            double sum = 0.;
+            for (size_t r = 0; r < sources.size(); ++ r)
+                for (size_t i = 0; i < sources[r].size(); ++ i) {
+                    igl::Hit hit;
+                    if (AABBTreeIndirect::intersect_ray_first_hit(vertices, faces, tree, sources[r][i], dirs[r][i], hit))
+                        sum += hit.t;
+                }
+            return sum;
+        });
+        profile("packets of 4 rays", [&]() {
+            double sum = 0.;
+            std::vector<Vec3d>    psources, pdirs;
+            std::vector<igl::Hit> hits;
+            for (size_t r = 0; r < sources.size(); ++ r)
+                for (size_t first = 0; first < sources[r].size(); first += 4) {
+                    psources.assign(sources[r].begin() + first, sources[r].begin() + std::min(first + 4, sources[r].size()));
+                    pdirs.assign(dirs[r].begin() + first, dirs[r].begin() + std::min(first + 4, dirs[r].size()));
+                    AABBTreeIndirect::intersect_rays_first_hit(vertices, faces, tree, psources, pdirs, hits);
+                    for (const igl::Hit &hit : hits)
+                        if (hit.id >= 0)
+                            sum += hit.t;
+                }
+            return sum;
+        });
+        profile("a ring at a time", [&]() {
+            double sum = 0.;
+            std::vector<igl::Hit> hits;
+            for (size_t r = 0; r < sources.size(); ++ r) {
+                AABBTreeIndirect::intersect_rays_first_hit(vertices, faces, tree, sources[r], dirs[r], hits);
+                for (const igl::Hit &hit : hits)
+                    if (hit.id >= 0)
+                        sum += hit.t;
+            }
+            return sum;
+        });
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,62 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/TriangleMesh.hpp>
+#include <libslic3r/SimplifyMesh.hpp>
+
+#include "Benchmarks.hpp"
+
+#include <tbb/task_arena.h>
+
+const std::string USAGE_STR = {
+    "Usage: benchmarks simplify-mesh [meshfile.{stl,obj} ...]\n"
+    "Decimates the meshes to a tenth of their faces on a single thread and on all threads\n"
+    "and prints the times. A finely tesselated sphere of 10M faces is decimated if no mesh is given,\n"
+    "the meshes of tests/data are suitable for checking the quality of the result."
+};
+
+using namespace Slic3r;
+
+static void benchmark(const std::string &name, TriangleMesh &mesh)
+{
+    mesh.require_shared_vertices();
+    int target = int(mesh.its.indices.size() / 10);
+    std::cout << name << ": " << mesh.its.indices.size() << " faces, volume " << mesh.volume() << std::endl;
+
+    for (int num_threads : { 1, tbb::task_arena::automatic }) {
+        indexed_triangle_set its = mesh.its;
+        tbb::task_arena arena(num_threads);
+        Benchmark bench;
+        bench.start();
+        arena.execute([&its, target]() { simplify_mesh(its, target); });
+        bench.stop();
+        TriangleMesh simplified{its};
+        simplified.repair();
+        std::cout << "\t" << (num_threads == 1 ? "1 thread: " : "all threads: ") << bench.getElapsedSec() << "s, " <<
+            its.indices.size() << " faces, volume " << simplified.volume() << (simplified.is_manifold() ? "" : ", not manifold") << std::endl;
+    }
+}
+
+int Slic3r::benchmarks::simplify_mesh(const int argc, const char *argv[])
+{
+    if (argc < 2) {
+        std::cout << USAGE_STR << std::endl;
+        // 2 * 1600 * 3200 faces.
+        TriangleMesh mesh = make_sphere(50., PI / 1600.);
+        benchmark("sphere", mesh);
+        return EXIT_SUCCESS;
+    }
+
+    for (int i = 1; i < argc; ++ i) {
+        TriangleMesh mesh;
+        if (! load_mesh(argv[i], mesh)) {
+            std::cerr << "Failed to load " << argv[i] << std::endl;
+            return EXIT_FAILURE;
+        }
+        benchmark(argv[i], mesh);
+    }
+
+    return EXIT_SUCCESS;
+}
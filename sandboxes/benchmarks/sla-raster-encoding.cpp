@@ -0,0 +1,81 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/TriangleMesh.hpp>
+#include <libslic3r/SLA/RasterBase.hpp>
+
+#include "Benchmarks.hpp"
+
+const std::string USAGE_STR = {
+    "Usage: benchmarks sla-raster-encoding meshfile.{stl,obj} [layer_height]\n"
+    "Slices the mesh, rasterizes the layers at the 2K, 4K and 8K resolutions of a 120 x 68 mm\n"
+    "display and prints the encoding throughput and size of the PNG encoders."
+};
+
+using namespace Slic3r;
+
+template<class Encoder>
+static void profile(const char *name, const std::vector<std::unique_ptr<sla::RasterBase>> &rasters)
+{
+    size_t bytes = 0;
+    Benchmark bench;
+    bench.start();
+    for (const std::unique_ptr<sla::RasterBase> &raster : rasters)
+        bytes += raster->encode(Encoder{}).size();
+    bench.stop();
+
+    const sla::RasterBase::Resolution res = rasters.front()->resolution();
+    double t = bench.getElapsedSec();
+    std::cout << "  " << name <<
+        ": " << 1000. * t / rasters.size() << " ms/layer" <<
+        ", " << double(res.pixels()) * rasters.size() / (t * 1e6) << " Mpx/s" <<
+        ", " << bytes / rasters.size() << " bytes/layer" << std::endl;
+}
+
+int Slic3r::benchmarks::sla_raster_encoding(const int argc, const char *argv[])
+{
+    if (argc < 2) {
+        std::cout << USAGE_STR << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    TriangleMesh mesh;
+    if (! load_mesh(argv[1], mesh)) {
+        std::cerr << "Failed to load " << argv[1] << std::endl;
+        return EXIT_FAILURE;
+    }
+    const float layer_height = argc > 2 ? float(std::atof(argv[2])) : 0.05f;
+
+    // Center the mesh on the display.
+    static constexpr double display_w = 120.96, display_h = 68.04;
+    BoundingBoxf3 bb = mesh.bounding_box();
+    mesh.translate(float(0.5 * display_w - bb.center().x()), float(0.5 * display_h - bb.center().y()), - float(bb.min.z()));
+
+    std::vector<float> zs;
+    for (float z = 0.5f * layer_height; z < float(bb.size().z()); z += layer_height)
+        zs.emplace_back(z);
+    std::vector<ExPolygons> layers;
+    TriangleMeshSlicer slicer(&mesh);
+    slicer.slice(zs, SlicingMode::Regular, 0.f, &layers, [](){});
+    std::cout << "Layers: " << layers.size() << std::endl;
+
+    for (const sla::RasterBase::Resolution &res : { sla::RasterBase::Resolution{ 2560, 1440 }, 
+                                                    sla::RasterBase::Resolution{ 3840, 2160 },
+                                                    sla::RasterBase::Resolution{ 7680, 4320 } }) {
+        sla::RasterBase::PixelDim pxdim{ display_w / res.width_px, display_h / res.height_px };
+        std::vector<std::unique_ptr<sla::RasterBase>> rasters;
+        for (const ExPolygons &layer : layers) {
+            rasters.emplace_back(sla::create_raster_grayscale_aa(res, pxdim, 1.));
+            for (const ExPolygon &expoly : layer)
+                rasters.back()->draw(expoly);
+        }
+
+        std::cout << res.width_px << " x " << res.height_px << ":" << std::endl;
+        profile<sla::PNGRasterEncoder>("PNGRasterEncoder", rasters);
+        profile<sla::PNGMaskRasterEncoder>("PNGMaskRasterEncoder", rasters);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,75 @@
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/Model.hpp>
+#include <libslic3r/TriangleMesh.hpp>
+#include <libslic3r/AABBTreeIndirect.hpp>
+#include <libslic3r/TriangleSelector.hpp>
+
+#include "Benchmarks.hpp"
+
+const std::string USAGE_STR = {
+    "Usage: benchmarks triangle-selector-brush [meshfile.{stl,obj}]\n"
+    "Replays a brush stroke painted from above across the mesh with the sphere and the circle cursors\n"
+    "and prints the time per brush event. A finely tesselated sphere is painted if no mesh is given."
+};
+
+using namespace Slic3r;
+
+struct BrushEvent {
+    Vec3f hit;
+    int   facet;
+};
+
+// Brush path along the diagonal of the mesh bounding box, as seen from above.
+static std::vector<BrushEvent> brush_path(const TriangleMesh &mesh, const Vec3f &camera_dir, size_t num_events)
+{
+    auto tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(mesh.its.vertices, mesh.its.indices);
+    BoundingBoxf3 bbox = mesh.bounding_box();
+    Vec3d         dir  = camera_dir.cast<double>();
+    std::vector<BrushEvent> path;
+    for (size_t i = 0; i < num_events; ++ i) {
+        double t = 0.1 + 0.8 * double(i) / double(num_events - 1);
+        Vec3d  origin(bbox.min.x() + t * bbox.size().x(), bbox.min.y() + t * bbox.size().y(), bbox.max.z() + 1.);
+        igl::Hit hit;
+        if (AABBTreeIndirect::intersect_ray_first_hit(mesh.its.vertices, mesh.its.indices, tree, origin, dir, hit))
+            path.push_back({ (origin + hit.t * dir).cast<float>(), hit.id });
+    }
+    return path;
+}
+
+int Slic3r::benchmarks::triangle_selector_brush(const int argc, const char *argv[])
+{
+    TriangleMesh mesh;
+    if (argc > 1) {
+        if (! load_mesh(argv[1], mesh)) {
+            std::cerr << "Failed to load " << argv[1] << std::endl;
+            return EXIT_FAILURE;
+        }
+    } else {
+        std::cout << USAGE_STR << std::endl;
+        mesh = make_sphere(50., PI / 700.);
+    }
+    mesh.require_shared_vertices();
+    std::cout << "Facets: " << mesh.facets_count() << std::endl;
+
+    const Vec3f camera_dir = - Vec3f::UnitZ();
+    std::vector<BrushEvent> path = brush_path(mesh, camera_dir, 200);
+    float radius = 0.02f * float(mesh.bounding_box().size().maxCoeff());
+
+    for (TriangleSelector::CursorType cursor_type : { TriangleSelector::SPHERE, TriangleSelector::CIRCLE }) {
+        TriangleSelector selector(mesh);
+        Benchmark bench;
+        bench.start();
+        for (const BrushEvent &event : path)
+            selector.select_patch(event.hit, event.facet, event.hit - camera_dir, radius, cursor_type, EnforcerBlockerType::ENFORCER, Transform3d::Identity());
+        bench.stop();
+        std::cout << (cursor_type == TriangleSelector::SPHERE ? "Sphere" : "Circle") << " cursor: " << path.size() << " brush events, " <<
+            1000. * bench.getElapsedSec() / std::max<size_t>(path.size(), 1) << "ms per event, " <<
+            selector.get_facets(EnforcerBlockerType::ENFORCER).indices.size() << " painted triangles" << std::endl;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -102,6 +102,12 @@ struct IntPoint {
 typedef std::vector< IntPoint > Path;
 typedef std::vector< Path > Paths;
 
+// Conversion of a point of an input path to IntPoint.
+// The templated ClipperBase::AddPath(), ClipperBase::AddPaths() and ClipperOffset::AddPath() accept any random access
+// range of points, for which an overload of ToIntPoint() is found by argument dependent lookup.
+// This allows the caller to feed its own path types into the Clipper engine without converting them to Path first.
+inline const IntPoint& ToIntPoint(const IntPoint &pt) { return pt; }
+
 inline Path& operator <<(Path& poly, const IntPoint& p) {poly.push_back(p); return poly;}
 inline Paths& operator <<(Paths& polys, const Path& p) {polys.push_back(p); return polys;}
 
@@ -271,7 +277,50 @@ enum EdgeSide { esLeft = 1, esRight = 2};
     OutPt    *Prev;
   };
 
-  struct OutRec;
+  // Output polygon.
+  struct OutRec {
+    int       Idx;
+    bool      IsHole;
+    bool      IsOpen;
+    //The 'FirstLeft' field points to another OutRec that contains or is the
+    //'parent' of OutRec. It is 'first left' because the ActiveEdgeList (AEL) is
+    //parsed left from the current edge (owning OutRec) until the owner OutRec
+    //is found. This field simplifies sorting the polygons into a tree structure
+    //which reflects the parent/child relationships of all polygons.
+    //This field should be renamed Parent, and will be later.
+    OutRec   *FirstLeft;
+    // Used only by void Clipper::BuildResult2(PolyTree& polytree)
+    PolyNode *PolyNd;
+    // Linked list of output points, dynamically allocated.
+    OutPt    *Pts;
+    OutPt    *BottomPt;
+  };
+
+  // Read only range over the points of a closed output path, traversing the OutPt ring in the order
+  // in which Clipper::Execute(ClipType, Paths&, ...) would emit the points.
+  class OutPtRange {
+  public:
+    class iterator {
+    public:
+      iterator(const OutPt *pt, int idx) : m_pt(pt), m_idx(idx) {}
+      const IntPoint& operator*() const { return m_pt->Pt; }
+      const IntPoint* operator->() const { return &m_pt->Pt; }
+      iterator& operator++() { m_pt = m_pt->Prev; ++ m_idx; return *this; }
+      bool operator==(const iterator &rhs) const { return m_idx == rhs.m_idx; }
+      bool operator!=(const iterator &rhs) const { return m_idx != rhs.m_idx; }
+    private:
+      const OutPt *m_pt;
+      int          m_idx;
+    };
+    OutPtRange(const OutPt *first, int size) : m_first(first), m_size(size) {}
+    iterator begin() const { return iterator(m_first, 0); }
+    iterator end()   const { return iterator(m_first, m_size); }
+    size_t   size()  const { return size_t(m_size); }
+  private:
+    const OutPt *m_first;
+    int          m_size;
+  };
+
   struct Join {
     Join(OutPt *OutPt1, OutPt *OutPt2, IntPoint OffPt) :
       OutPt1(OutPt1), OutPt2(OutPt2), OffPt(OffPt) {}
@@ -291,8 +340,12 @@ class ClipperBase
 public:
   ClipperBase() : m_UseFullRange(false), m_HasOpenPaths(false) {}
   ~ClipperBase() { Clear(); }
-  bool AddPath(const Path &pg, PolyType PolyTyp, bool Closed);
-  bool AddPaths(const Paths &ppg, PolyType PolyTyp, bool Closed);
+  // PathInput is a random access range of points convertible to IntPoint by ToIntPoint(), see ToIntPoint().
+  template<typename PathInput = Path>
+  bool AddPath(const PathInput &pg, PolyType PolyTyp, bool Closed);
+  // PathsInput is a forward range of PathInput. It is traversed twice.
+  template<typename PathsInput = Paths>
+  bool AddPaths(const PathsInput &ppg, PolyType PolyTyp, bool Closed);
   void Clear();
   IntRect GetBounds();
   // By default, when three or more vertices are collinear in input polygons (subject or clip), the Clipper object removes the 'inner' vertices before clipping.
@@ -300,7 +353,11 @@ public:
   bool PreserveCollinear() const {return m_PreserveCollinear;};
   void PreserveCollinear(bool value) {m_PreserveCollinear = value;};
 protected:
-  bool AddPathInternal(const Path &pg, int highI, PolyType PolyTyp, bool Closed, TEdge* edges);
+  // Number of points of an input path after trimming the duplicate end points, zero if the path is degenerate.
+  template<typename PathInput>
+  static int NumEdges(const PathInput &pg, bool Closed);
+  // Expects edges[0..highI].Curr to be filled in with the input points.
+  bool AddPathInternal(int highI, PolyType PolyTyp, bool Closed, TEdge* edges);
   TEdge* AddBoundsToLML(TEdge *e, bool IsClosed);
   void Reset();
   TEdge* ProcessBound(TEdge* E, bool IsClockwise);
@@ -344,6 +401,14 @@ public:
       PolyTree &polytree,
       PolyFillType subjFillType,
       PolyFillType clipFillType);
+  // Same as Execute(ClipType, Paths&, ...), but instead of filling in Paths, each closed output path is passed
+  // to path_output(const OutPtRange &path), so that the caller may collect the result into its own containers
+  // without going through ClipperLib::Paths.
+  template<typename PathOutput>
+  bool Execute(ClipType clipType,
+      PolyFillType subjFillType,
+      PolyFillType clipFillType,
+      PathOutput &&path_output);
   bool ReverseSolution() const { return m_ReverseOutput; };
   void ReverseSolution(bool value) {m_ReverseOutput = value;};
   bool StrictlySimple() const {return m_StrictSimple;};
@@ -447,8 +512,12 @@ public:
   ClipperOffset(double miterLimit = 2.0, double roundPrecision = 0.25, double shortestEdgeLength = 0.) :
     MiterLimit(miterLimit), ArcTolerance(roundPrecision), ShortestEdgeLength(shortestEdgeLength), m_lowest(-1, 0) {}
   ~ClipperOffset() { Clear(); }
-  void AddPath(const Path& path, JoinType joinType, EndType endType);
-  void AddPaths(const Paths& paths, JoinType joinType, EndType endType);
+  // PathInput is a random access range of points convertible to IntPoint by ToIntPoint(), see ToIntPoint().
+  template<typename PathInput = Path>
+  void AddPath(const PathInput& path, JoinType joinType, EndType endType);
+  template<typename PathsInput = Paths>
+  void AddPaths(const PathsInput& paths, JoinType joinType, EndType endType)
+    { for (const auto &path : paths) AddPath(path, joinType, endType); }
   void Execute(Paths& solution, double delta);
   void Execute(PolyTree& solution, double delta);
   void Clear();
@@ -465,6 +534,8 @@ private:
   IntPoint m_lowest;
   PolyNode m_polyNodes;
 
+  // Takes ownership of newNode with its Contour filled in, k being the index of the lowest point of the Contour.
+  void AddPathNode(PolyNode *newNode, int k);
   void FixOrientations();
   void DoOffset(double delta);
   void OffsetPoint(int j, int& k, JoinType jointype);
@@ -485,6 +556,162 @@ class clipperException : public std::exception
 };
 //------------------------------------------------------------------------------
 
+template<typename PathInput>
+inline int ClipperBase::NumEdges(const PathInput &pg, bool Closed)
+{
+  // Remove duplicate end point from a closed input path.
+  // Remove duplicate points from the end of the input path.
+  int highI = (int)pg.size() -1;
+  if (highI > 0) {
+    IntPoint ptFirst = ToIntPoint(pg[0]);
+    IntPoint ptLast  = ToIntPoint(pg[highI]);
+    if (Closed)
+      while (highI > 0 && ptLast == ptFirst)
+        ptLast = ToIntPoint(pg[-- highI]);
+    for (IntPoint ptPrev; highI > 0 && ptLast == (ptPrev = ToIntPoint(pg[highI - 1])); -- highI)
+      ptLast = ptPrev;
+  }
+  return ((Closed && highI < 2) || (!Closed && highI < 1)) ? 0 : highI + 1;
+}
+//------------------------------------------------------------------------------
+
+template<typename PathInput>
+bool ClipperBase::AddPath(const PathInput &pg, PolyType PolyTyp, bool Closed)
+{
+  int num_edges = NumEdges(pg, Closed);
+  if (num_edges == 0)
+    return false;
+
+  // Allocate a new edge array, fill in the input points.
+  std::vector<TEdge> edges(num_edges);
+  for (int i = 0; i < num_edges; ++ i)
+    edges[i].Curr = ToIntPoint(pg[i]);
+  // Fill in the edge array.
+  bool result = AddPathInternal(num_edges - 1, PolyTyp, Closed, edges.data());
+  if (result)
+    // Success, remember the edge array.
+    m_edges.emplace_back(std::move(edges));
+  return result;
+}
+//------------------------------------------------------------------------------
+
+template<typename PathsInput>
+bool ClipperBase::AddPaths(const PathsInput &ppg, PolyType PolyTyp, bool Closed)
+{
+  std::vector<int> num_edges;
+  int num_edges_total = 0;
+  for (const auto &pg : ppg) {
+    num_edges.emplace_back(NumEdges(pg, Closed));
+    num_edges_total += num_edges.back();
+  }
+  if (num_edges_total == 0)
+    return false;
+
+  // Allocate a new edge array, fill in the input points.
+  std::vector<TEdge> edges(num_edges_total);
+  {
+    TEdge *p_edge = edges.data();
+    size_t i = 0;
+    for (const auto &pg : ppg) {
+      for (int j = 0; j < num_edges[i]; ++ j)
+        (p_edge ++)->Curr = ToIntPoint(pg[j]);
+      ++ i;
+    }
+  }
+  // Fill in the edge array.
+  bool result = false;
+  TEdge *p_edge = edges.data();
+  for (int n : num_edges)
+    if (n) {
+      if (AddPathInternal(n - 1, PolyTyp, Closed, p_edge))
+        result = true;
+      p_edge += n;
+    }
+  if (result)
+    // At least some edges were generated. Remember the edge array.
+    m_edges.emplace_back(std::move(edges));
+  return result;
+}
+//------------------------------------------------------------------------------
+
+template<typename PathOutput>
+bool Clipper::Execute(ClipType clipType, PolyFillType subjFillType, PolyFillType clipFillType, PathOutput &&path_output)
+{
+  if (m_HasOpenPaths)
+    throw clipperException("Error: PolyTree struct is needed for open path clipping.");
+  m_SubjFillType = subjFillType;
+  m_ClipFillType = clipFillType;
+  m_ClipType = clipType;
+  m_UsingPolyTree = false;
+  bool succeeded = ExecuteInternal();
+  if (succeeded)
+    for (const OutRec *outRec : m_PolyOuts)
+      if (outRec->Pts) {
+        const OutPt *first = outRec->Pts->Prev;
+        int cnt = 0;
+        const OutPt *p = first;
+        do {
+          ++ cnt;
+          p = p->Prev;
+        } while (p != first);
+        if (cnt >= 2)
+          path_output(OutPtRange(first, cnt));
+      }
+  DisposeAllOutRecs();
+  return succeeded;
+}
+//------------------------------------------------------------------------------
+
+template<typename PathInput>
+void ClipperOffset::AddPath(const PathInput& path, JoinType joinType, EndType endType)
+{
+  int highI = (int)path.size() - 1;
+  if (highI < 0) return;
+  PolyNode* newNode = new PolyNode();
+  newNode->m_jointype = joinType;
+  newNode->m_endtype = endType;
+
+  //strip duplicate points from path and also get index to the lowest point ...
+  bool   has_shortest_edge_length = ShortestEdgeLength > 0.;
+  double shortest_edge_length2 = has_shortest_edge_length ? ShortestEdgeLength * ShortestEdgeLength : 0.;
+  const IntPoint ptFirst = ToIntPoint(path[0]);
+  if (endType == etClosedLine || endType == etClosedPolygon)
+    for (; highI > 0; -- highI) {
+      IntPoint pt = ToIntPoint(path[highI]);
+      bool same = false;
+      if (has_shortest_edge_length) {
+        double dx = double(pt.X - ptFirst.X);
+        double dy = double(pt.Y - ptFirst.Y);
+        same = dx*dx + dy*dy < shortest_edge_length2;
+      } else
+        same = ptFirst == pt;
+      if (! same)
+        break;
+    }
+  newNode->Contour.reserve(highI + 1);
+  newNode->Contour.push_back(ptFirst);
+  int j = 0, k = 0;
+  for (int i = 1; i <= highI; i++) {
+    IntPoint pt = ToIntPoint(path[i]);
+    bool same = false;
+    if (has_shortest_edge_length) {
+      double dx = double(pt.X - newNode->Contour[j].X);
+      double dy = double(pt.Y - newNode->Contour[j].Y);
+      same = dx*dx + dy*dy < shortest_edge_length2;
+    } else
+      same = newNode->Contour[j] == pt;
+    if (same)
+      continue;
+    j++;
+    newNode->Contour.push_back(pt);
+    if (pt.Y > newNode->Contour[k].Y ||
+      (pt.Y == newNode->Contour[k].Y &&
+      pt.X < newNode->Contour[k].X)) k = j;
+  }
+  AddPathNode(newNode, k);
+}
+//------------------------------------------------------------------------------
+
 } //ClipperLib namespace
 
 #endif //clipper_hpp
@@ -52,6 +52,8 @@ class _Item {
     mutable bool area_cache_valid_ = false;
     mutable RawShape inflate_cache_;
     mutable bool inflate_cache_valid_ = false;
+    mutable size_t shape_hash_ = 0;
+    mutable bool shape_hash_valid_ = false;
 
     enum class Convexity: char {
         UNCHECKED,
@@ -224,6 +226,29 @@ public:
         return ret;
     }
 
+    /**
+     * @brief Hash of the original shape, the transformations are not applied.
+     *
+     * Items of the same original shape have the same hash, items of different
+     * shapes may collide, so the hash alone does not prove the shapes equal.
+     * The result is cached, subsequent calls will have very little cost.
+     */
+    inline size_t shapeHash() const {
+        if(!shape_hash_valid_) {
+            size_t h = sl::contourVertexCount(sh_);
+            auto combine = [&h](TCoord<Vertex> c) {
+                h ^= std::hash<TCoord<Vertex>>()(c) + 0x9e3779b97f4a7c15ull +
+                     (h << 6) + (h >> 2);
+            };
+            sl::foreachVertex(sh_, [&combine](const Vertex& v) {
+                combine(getX(v)); combine(getY(v));
+            });
+            shape_hash_ = h;
+            shape_hash_valid_ = true;
+        }
+        return shape_hash_;
+    }
+
     inline bool isContourConvex() const {
         bool ret = false;
 
@@ -434,6 +459,7 @@ private:
         lmb_valid_ = false; rmt_valid_ = false;
         area_cache_valid_ = false;
         inflate_cache_valid_ = false;
+        shape_hash_valid_ = false;
         bb_cache_.valid = false;
         convexity_ = Convexity::UNCHECKED;
     }
@@ -2,12 +2,16 @@
 #define NOFITPOLY_HPP
 
 #include <cassert>
+#include <algorithm>
 
 // For parallel for
 #include <functional>
 #include <iterator>
+#include <memory>
 #include <future>
 #include <atomic>
+#include <mutex>
+#include <unordered_map>
 
 #ifndef NDEBUG
 #include <iostream>
@@ -75,6 +79,8 @@ inline void enumerate(
 
 namespace placers {
 
+template<class RawShape> class NfpCache;
+
 template<class RawShape>
 struct NfpPConfig {
 
@@ -169,6 +175,15 @@ struct NfpPConfig {
 
     std::function<void(const ItemGroup &, NfpPConfig &config)> on_preload;
 
+    /**
+     * @brief A cache of the no-fit polygons. (Optional)
+     *
+     * Share a cache between subsequent arrangements to reuse the no-fit
+     * polygons of the items arranged again. If not set, each placer uses its
+     * own cache, reused by the placements into its bin only.
+     */
+    std::shared_ptr<NfpCache<RawShape>> nfp_cache;
+
     NfpPConfig(): rotations({0.0, Pi/2.0, Pi, 3*Pi/2}),
         alignment(Alignment::CENTER), starting_point(Alignment::CENTER) {}
 };
@@ -373,6 +388,200 @@ public:
 template<nfp::NfpLevel lvl>
 struct Lvl { static const nfp::NfpLevel value = lvl; };
 
+/**
+ * A cache of no-fit polygons, reused by subsequent placements and by
+ * subsequent arrangements.
+ *
+ * The no-fit polygon of an orbiting item around a stationary item depends
+ * only on the original shapes, rotations and inflations of the two items, and
+ * on the translation of the stationary item. The polygons are therefore
+ * stored relative to the translation of the stationary item and keyed by the
+ * shape hashes, rotations and inflations. Items of the same shape, for example
+ * multiple copies of a part, share their no-fit polygons.
+ *
+ * The shape hash only selects the candidates: the keys keep the original
+ * shapes, which are compared vertex by vertex on a hash match, so a hash
+ * collision never returns the polygon of another shape. The keys of the
+ * items of the same shape share a single copy of the shape.
+ *
+ * The cache is thread safe. Its size is limited by the total number of
+ * vertices stored, the polygons and the shapes of the keys, the cache is
+ * cleared once the limit is reached.
+ */
+template<class RawShape> class NfpCache {
+    using Item = _Item<RawShape>;
+    using Vertex = TPoint<RawShape>;
+    using Coord = TCoord<Vertex>;
+
+    static bool sameShape(const RawShape& a, const RawShape& b)
+    {
+        auto same_path = [](const TContour<RawShape>& pa,
+                            const TContour<RawShape>& pb) {
+            return pa.size() == pb.size() &&
+                   std::equal(pa.begin(), pa.end(), pb.begin(),
+                              [](const Vertex& va, const Vertex& vb) {
+                                  return getX(va) == getX(vb) &&
+                                         getY(va) == getY(vb);
+                              });
+        };
+        const auto& ha = sl::holes(a);
+        const auto& hb = sl::holes(b);
+        return same_path(sl::contour(a), sl::contour(b)) &&
+               ha.size() == hb.size() &&
+               std::equal(ha.begin(), ha.end(), hb.begin(), same_path);
+    }
+
+    struct ItemKey {
+        size_t shape_hash;
+        // The original shape of the item, owned by the cache for the stored
+        // keys, owned by the item for the keys being looked up.
+        const RawShape *shape;
+        double rotation;
+        Coord inflation;
+
+        ItemKey(const Item& item, const RawShape *shape):
+            shape_hash(item.shapeHash()),
+            shape(shape),
+            rotation(double(item.rotation())),
+            inflation(item.inflation()) {}
+
+        bool operator==(const ItemKey& rhs) const {
+            return shape_hash == rhs.shape_hash &&
+                   rotation == rhs.rotation && inflation == rhs.inflation &&
+                   (shape == rhs.shape || sameShape(*shape, *rhs.shape));
+        }
+    };
+
+public:
+
+    struct Key {
+        ItemKey stationary;
+        ItemKey orbiter;
+
+        Key(const Item& stationary, const Item& orbiter):
+            stationary(stationary, &stationary.rawShape()),
+            orbiter(orbiter, &orbiter.rawShape()) {}
+
+        Key(const Item& stationary, const RawShape *stationary_shape,
+            const Item& orbiter, const RawShape *orbiter_shape):
+            stationary(stationary, stationary_shape),
+            orbiter(orbiter, orbiter_shape) {}
+
+        bool operator==(const Key& rhs) const {
+            return stationary == rhs.stationary && orbiter == rhs.orbiter;
+        }
+    };
+
+    explicit NfpCache(size_t max_vertices = 4000000):
+        max_vertices_(max_vertices) {}
+
+    /**
+     * @brief Find the no-fit polygon of the orbiter around the stationary item.
+     * @param nfp Output: the polygon placed around the stationary item.
+     * @return True if the polygon was found.
+     */
+    bool find(const Item& stationary, const Item& orbiter, RawShape& nfp) const
+    {
+        {
+            std::lock_guard<std::mutex> lk(mutex_);
+            auto it = map_.find(Key(stationary, orbiter));
+            if(it == map_.end()) { ++misses_; return false; }
+            ++hits_;
+            nfp = it->second;
+        }
+        if(stationary.translation() != Vertex{0, 0})
+            sl::translate(nfp, stationary.translation());
+        return true;
+    }
+
+    /// Store a no-fit polygon placed around the stationary item.
+    void insert(const Item& stationary, const Item& orbiter, RawShape nfp)
+    {
+        if(stationary.translation() != Vertex{0, 0})
+            sl::translate(nfp, Vertex{0, 0} - stationary.translation());
+        size_t nverts = sl::contourVertexCount(nfp);
+        std::lock_guard<std::mutex> lk(mutex_);
+        if(vertices_ + nverts > max_vertices_) clear_locked();
+        if(map_.find(Key(stationary, orbiter)) != map_.end()) return;
+        const RawShape *sshape = intern(stationary);
+        const RawShape *oshape = intern(orbiter);
+        map_.emplace(Key(stationary, sshape, orbiter, oshape), std::move(nfp));
+        vertices_ += nverts;
+    }
+
+    void clear()
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        clear_locked();
+    }
+
+    size_t size() const
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        return map_.size();
+    }
+
+    /// Number of successful and failed lookups since the cache was created.
+    size_t hits() const
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        return hits_;
+    }
+
+    size_t misses() const
+    {
+        std::lock_guard<std::mutex> lk(mutex_);
+        return misses_;
+    }
+
+private:
+
+    struct KeyHash {
+        size_t operator()(const Key& k) const {
+            size_t h = 0;
+            auto combine = [&h](size_t v) {
+                h ^= v + 0x9e3779b97f4a7c15ull + (h << 6) + (h >> 2);
+            };
+            for(const ItemKey *ik : { &k.stationary, &k.orbiter }) {
+                combine(ik->shape_hash);
+                combine(std::hash<double>()(ik->rotation));
+                combine(std::hash<Coord>()(ik->inflation));
+            }
+            return h;
+        }
+    };
+
+    void clear_locked()
+    {
+        map_.clear();
+        shapes_.clear();
+        vertices_ = 0;
+    }
+
+    // The shared copy of the original shape of the item, to be called locked.
+    const RawShape* intern(const Item& item)
+    {
+        const RawShape& shape = item.rawShape();
+        auto range = shapes_.equal_range(item.shapeHash());
+        for(auto it = range.first; it != range.second; ++it)
+            if(sameShape(*it->second, shape)) return it->second.get();
+        auto it = shapes_.emplace(item.shapeHash(),
+                                  std::make_unique<RawShape>(shape));
+        size_t nverts = 0;
+        sl::foreachVertex(shape, [&nverts](const Vertex&) { ++nverts; });
+        vertices_ += nverts;
+        return it->second.get();
+    }
+
+    std::unordered_map<Key, RawShape, KeyHash> map_;
+    // Original shapes of the items in the stored keys, by their shape hash.
+    std::unordered_multimap<size_t, std::unique_ptr<RawShape>> shapes_;
+    size_t max_vertices_;
+    size_t vertices_ = 0;
+    mutable size_t hits_ = 0, misses_ = 0;
+    mutable std::mutex mutex_;
+};
+
 template<class RawShape>
 inline void correctNfpPosition(nfp::NfpResult<RawShape>& nfp,
                                const _Item<RawShape>& stationary,
@@ -490,12 +699,15 @@ private:
     // Norming factor for the optimization function
     const double norm_;
     Pile merged_pile_;
+    // Used if no cache is shared through the configuration.
+    std::shared_ptr<NfpCache<RawShape>> nfp_cache_;
 
 public:
 
     inline explicit _NofitPolyPlacer(const BinType& bin):
         Base(bin),
-        norm_(std::sqrt(sl::area(bin)))
+        norm_(std::sqrt(sl::area(bin))),
+        nfp_cache_(std::make_shared<NfpCache<RawShape>>())
     {
         // In order to not have items out of bin, it will be shrinked by an
         // very little empiric offset value.
@@ -612,15 +824,29 @@ private:
         }
         // /////////////////////////////////////////////////////////////////////
 
-        __parallel::enumerate(items_.begin(), items_.end(),
-                              [&nfps, &trsh](const Item& sh, size_t n)
+        // Reuse the cached polygons, calculate the missing ones in parallel.
+        NfpCache<RawShape>& cache = config_.nfp_cache ? *config_.nfp_cache :
+                                                        *nfp_cache_;
+        std::vector<size_t> missing;
+        for(size_t n = 0; n < items_.size(); ++n)
+            if(!cache.find(items_[n], trsh, nfps[n])) missing.emplace_back(n);
+
+        std::launch policy = std::launch::deferred;
+        if(config_.parallel) policy |= std::launch::async;
+
+        auto& items = items_;
+        __parallel::enumerate(missing.begin(), missing.end(),
+                              [&nfps, &trsh, &items](size_t n, size_t)
         {
+            const Item& sh = items[n];
             auto& fixedp = sh.transformedShape();
             auto& orbp = trsh.transformedShape();
             auto subnfp_r = noFitPolygon<NfpLevel::CONVEX_ONLY>(fixedp, orbp);
             correctNfpPosition(subnfp_r, sh, trsh);
             nfps[n] = subnfp_r.first;
-        });
+        }, policy);
+
+        for(size_t n : missing) cache.insert(items_[n], trsh, nfps[n]);
 
         return nfp::merge(nfps);
     }
@@ -819,53 +1045,81 @@ private:
                 using OptResult = opt::Result<double>;
                 using OptResults = std::vector<OptResult>;
 
-                // Local optimization with the four polygon corners as
-                // starting points
+                // Local optimization with the corners of the polygons and of
+                // their holes as starting points. The starting points of all
+                // the polygons are evaluated in parallel.
+                struct StartPoint {
+                    double pos;
+                    unsigned nfpidx;
+                    int hidx;
+                };
+
+                std::vector<StartPoint> startpoints;
                 for(unsigned ch = 0; ch < ecache.size(); ch++) {
                     auto& cache = ecache[ch];
+                    for(double pos : cache.corners())
+                        startpoints.push_back({pos, ch, -1});
+                    for(unsigned hidx = 0; hidx < cache.holeCount(); ++hidx)
+                        for(double pos : cache.corners(hidx))
+                            startpoints.push_back({pos, ch, int(hidx)});
+                }
 
-                    OptResults results(cache.corners().size());
+                OptResults results(startpoints.size());
 
+                {
                     auto& rofn = rawobjfunc;
                     auto& nfpoint = getNfpPoint;
                     float accuracy = config_.accuracy;
 
                     __parallel::enumerate(
-                                cache.corners().begin(),
-                                cache.corners().end(),
-                                [&results, &item, &rofn, &nfpoint, ch, accuracy]
-                                (double pos, size_t n)
+                                startpoints.begin(),
+                                startpoints.end(),
+                                [&results, &item, &rofn, &nfpoint, accuracy]
+                                (const StartPoint& sp, size_t n)
                     {
                         Optimizer solver(accuracy);
 
                         Item itemcpy = item;
-                        auto contour_ofn = [&rofn, &nfpoint, ch, &itemcpy]
+                        auto contour_ofn = [&rofn, &nfpoint, &sp, &itemcpy]
                                 (double relpos)
                         {
-                            Optimum op(relpos, ch);
+                            Optimum op(relpos, sp.nfpidx, sp.hidx);
                             return rofn(nfpoint(op), itemcpy);
                         };
 
                         try {
                             results[n] = solver.optimize_min(contour_ofn,
-                                            opt::initvals<double>(pos),
+                                            opt::initvals<double>(sp.pos),
                                             opt::bound<double>(0, 1.0)
                                             );
                         } catch(std::exception& e) {
                             derr() << "ERROR: " << e.what() << "\n";
                         }
                     }, policy);
+                }
 
-                    auto resultcomp =
-                            []( const OptResult& r1, const OptResult& r2 ) {
-                        return r1.score < r2.score;
-                    };
+                auto resultcomp =
+                        []( const OptResult& r1, const OptResult& r2 ) {
+                    return r1.score < r2.score;
+                };
 
-                    auto mr = *std::min_element(results.begin(), results.end(),
+                // Pick the best result of each contour and of each hole in
+                // the order of the polygons.
+                for(size_t from = 0; from < startpoints.size();) {
+                    size_t to = from + 1;
+                    while(to < startpoints.size() &&
+                          startpoints[to].nfpidx == startpoints[from].nfpidx &&
+                          startpoints[to].hidx == startpoints[from].hidx)
+                        ++to;
+
+                    auto mr = *std::min_element(results.begin() + from,
+                                                results.begin() + to,
                                                 resultcomp);
 
                     if(mr.score < best_score) {
-                        Optimum o(std::get<0>(mr.optimum), ch, -1);
+                        Optimum o(std::get<0>(mr.optimum),
+                                  startpoints[from].nfpidx,
+                                  startpoints[from].hidx);
                         double miss = boundaryCheck(o);
                         if(miss <= 0) {
                             best_score = mr.score;
@@ -875,55 +1129,7 @@ private:
                         }
                     }
 
-                    for(unsigned hidx = 0; hidx < cache.holeCount(); ++hidx) {
-                        results.clear();
-                        results.resize(cache.corners(hidx).size());
-
-                        // TODO : use parallel for
-                        __parallel::enumerate(cache.corners(hidx).begin(),
-                                      cache.corners(hidx).end(),
-                                      [&results, &item, &nfpoint,
-                                       &rofn, ch, hidx, accuracy]
-                                      (double pos, size_t n)
-                        {
-                            Optimizer solver(accuracy);
-
-                            Item itmcpy = item;
-                            auto hole_ofn =
-                                    [&rofn, &nfpoint, ch, hidx, &itmcpy]
-                                    (double pos)
-                            {
-                                Optimum opt(pos, ch, hidx);
-                                return rofn(nfpoint(opt), itmcpy);
-                            };
-
-                            try {
-                                results[n] = solver.optimize_min(hole_ofn,
-                                                opt::initvals<double>(pos),
-                                                opt::bound<double>(0, 1.0)
-                                                );
-
-                            } catch(std::exception& e) {
-                                derr() << "ERROR: " << e.what() << "\n";
-                            }
-                        }, policy);
-
-                        auto hmr = *std::min_element(results.begin(),
-                                                    results.end(),
-                                                    resultcomp);
-
-                        if(hmr.score < best_score) {
-                            Optimum o(std::get<0>(hmr.optimum),
-                                      ch, hidx);
-                            double miss = boundaryCheck(o);
-                            if(miss <= 0.0) {
-                                best_score = hmr.score;
-                                optimum = o;
-                            } else {
-                                best_overfit = std::min(miss, best_overfit);
-                            }
-                        }
-                    }
+                    from = to;
                 }
 
                 if( best_score < global_score ) {
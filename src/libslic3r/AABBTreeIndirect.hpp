@@ -7,6 +7,7 @@
 #define slic3r_AABBTreeIndirect_hpp_
 
 #include <algorithm>
+#include <array>
 #include <limits>
 #include <type_traits>
 #include <vector>
@@ -399,6 +400,128 @@ namespace detail {
 		}
 	}
 
+	// Number of rays traversing the AABB tree together in a single packet.
+	static constexpr size_t RayPacketSize = 8;
+	using RayPacketMask = uint32_t;
+	static_assert(RayPacketSize <= sizeof(RayPacketMask) * 8, "RayPacketMask too short to hold a bit per ray of a packet");
+
+	// Packet of rays stored in the "structure of arrays" layout for the box tests to be vectorized by the compiler.
+	// All rays of a packet point into the same octant, thus the near and far planes of a box are the same for all of them.
+	// Unused slots of a packet are filled with copies of the first ray, they are masked out during the traversal.
+	template<typename AVertexType, typename AIndexedFaceType, typename ATreeType, typename AVectorType>
+	struct RayPacketIntersector {
+		using VertexType 		= AVertexType;
+		using IndexedFaceType 	= AIndexedFaceType;
+		using TreeType			= ATreeType;
+		using VectorType 		= AVectorType;
+		using Scalar 			= typename VectorType::Scalar;
+
+		const std::vector<VertexType> 		&vertices;
+		const std::vector<IndexedFaceType> 	&faces;
+		const TreeType 						&tree;
+
+		// Origins, directions and hits of the whole batch of rays, indexed by ray_idx.
+		const VectorType 					*origins;
+		const VectorType 					*dirs;
+		igl::Hit 							*hits;
+		// Index of each ray of the packet into the batch.
+		size_t 								 ray_idx[RayPacketSize];
+		// Signs of the inverse direction shared by all rays of the packet.
+		bool 								 negative[3];
+		// Origins and inverse directions for the box tests.
+		Scalar 								 origin[3][RayPacketSize];
+		Scalar 								 invdir[3][RayPacketSize];
+		// Parameter of the closest hit found so far.
+		Scalar 								 min_t[RayPacketSize];
+	};
+
+	// Same arithmetics and comparisons as ray_box_intersect_invdir() with t0 = 0, t1 = packet.min_t,
+	// evaluated without branches over all the rays of the packet, so that the results are bitwise identical
+	// to the single ray test while the loop is vectorizable.
+	// Returns a subset of mask with the rays intersecting the box.
+	template<typename RayPacketIntersectorType, typename BoundingBoxType>
+	inline RayPacketMask ray_packet_box_intersect_invdir(
+		const RayPacketIntersectorType 		&packet,
+		const BoundingBoxType 				&box,
+		const RayPacketMask 				 mask)
+	{
+		using Scalar = typename RayPacketIntersectorType::Scalar;
+		// Near and far planes of the box, shared by all the rays of the packet.
+		const Scalar nearx = Scalar(packet.negative[0] ? box.max().x() : box.min().x());
+		const Scalar farx  = Scalar(packet.negative[0] ? box.min().x() : box.max().x());
+		const Scalar neary = Scalar(packet.negative[1] ? box.max().y() : box.min().y());
+		const Scalar fary  = Scalar(packet.negative[1] ? box.min().y() : box.max().y());
+		const Scalar nearz = Scalar(packet.negative[2] ? box.max().z() : box.min().z());
+		const Scalar farz  = Scalar(packet.negative[2] ? box.min().z() : box.max().z());
+		// Intersection flags stored as Scalar, not bool, for the loop to be vectorized.
+		Scalar 		 intersects[RayPacketSize];
+		for (size_t i = 0; i < RayPacketSize; ++ i) {
+			Scalar tmin  = (nearx - packet.origin[0][i]) * packet.invdir[0][i];
+			Scalar tmax  = (farx  - packet.origin[0][i]) * packet.invdir[0][i];
+			Scalar tymin = (neary - packet.origin[1][i]) * packet.invdir[1][i];
+			Scalar tymax = (fary  - packet.origin[1][i]) * packet.invdir[1][i];
+			Scalar tzmin = (nearz - packet.origin[2][i]) * packet.invdir[2][i];
+			Scalar tzmax = (farz  - packet.origin[2][i]) * packet.invdir[2][i];
+			// Bitwise instead of logical operators to not introduce branches.
+			bool   valid = ! (tmin > tymax) & ! (tymin > tmax);
+			// Same as "if (tymin > tmin) tmin = tymin;" etc. in ray_box_intersect_invdir(), therefore NaNs propagate the same way.
+			tmin  = tmin < tymin ? tymin : tmin;
+			tmax  = tymax < tmax ? tymax : tmax;
+			valid = valid & ! (tzmin > tmax) & ! (tmin > tzmax);
+			tmin  = tmin < tzmin ? tzmin : tmin;
+			tmax  = tzmax < tmax ? tzmax : tmax;
+			intersects[i] = (valid & (tmin < packet.min_t[i]) & (tmax > Scalar(0))) ? Scalar(1) : Scalar(0);
+		}
+		RayPacketMask out = 0;
+		for (size_t i = 0; i < RayPacketSize; ++ i)
+			if (intersects[i] != Scalar(0))
+				out |= RayPacketMask(1) << i;
+		return out & mask;
+	}
+
+	// Depth first traversal of the AABB tree by a packet of rays, visiting the nodes in the same order
+	// as intersect_ray_recursive_first_hit(). A node is only tested by the rays, which intersected all its parents,
+	// and a ray accepts a hit only if it is closer than the closest hit found so far, thus each ray
+	// finds the same hit as if traced alone.
+	template<typename RayPacketIntersectorType>
+	static inline void intersect_ray_packet_first_hit(RayPacketIntersectorType &packet, RayPacketMask mask)
+	{
+		// Depth of a balanced tree over 2^32 entities is 33, each level pushes at most two nodes.
+		std::array<std::pair<size_t, RayPacketMask>, 72> stack;
+		size_t stack_size = 0;
+		stack[stack_size ++] = std::make_pair(size_t(0), mask);
+		while (stack_size > 0) {
+			auto [node_idx, node_mask] = stack[-- stack_size];
+			const auto &node = packet.tree.node(node_idx);
+			assert(node.is_valid());
+			node_mask = ray_packet_box_intersect_invdir(packet, node.bbox, node_mask);
+			if (node_mask == 0)
+				continue;
+			if (node.is_leaf()) {
+				// shoot rays, record hits
+				auto face = packet.faces[node.idx];
+				for (size_t i = 0; i < RayPacketSize; ++ i)
+					if (node_mask & (RayPacketMask(1) << i)) {
+						const size_t iray = packet.ray_idx[i];
+						double t, u, v;
+						if (intersect_triangle(
+								packet.origins[iray], packet.dirs[iray],
+								packet.vertices[face(0)], packet.vertices[face(1)], packet.vertices[face(2)],
+								t, u, v)
+							&& t > 0. && float(t) < packet.min_t[i]) {
+							packet.hits[iray] = igl::Hit { int(node.idx), -1, float(u), float(v), float(t) };
+							packet.min_t[i] = float(t);
+						}
+					}
+			} else {
+				assert(stack_size + 2 <= stack.size());
+				// Push the right child first to process the left child first.
+				stack[stack_size ++] = std::make_pair(node_idx * 2 + 2, node_mask);
+				stack[stack_size ++] = std::make_pair(node_idx * 2 + 1, node_mask);
+			}
+		}
+	}
+
 	// Nothing to do with COVID-19 social distancing.
 	template<typename AVertexType, typename AIndexedFaceType, typename ATreeType, typename AVectorType>
 	struct IndexedTriangleSetDistancer {
@@ -665,6 +788,84 @@ inline bool intersect_ray_all_hits(
 	return ! hits.empty();
 }
 
+// Find first intersections of a batch of rays with indexed triangle set.
+// The rays are sorted by the octant of their direction and split into packets of up to detail::RayPacketSize rays.
+// The rays of a packet traverse the AABB tree together, thus a node of the tree is fetched once for all the rays
+// of a packet and the ray / box tests are vectorized.
+// The batch shall be coherent (rays with close origins and similar directions, for example a ring of rays
+// around a support head), otherwise a packet visits the union of the nodes visited by its rays.
+// Intersection test is calculated with the accuracy of VectorType::Scalar
+// even if the triangle mesh and the AABB Tree are built with floats.
+// The hits are bitwise identical to calling intersect_ray_first_hit() for each ray, the rays not intersecting
+// the triangle set are returned with hit.id == -1 and hit.t == infinity.
+// Returns the number of rays intersecting the indexed triangle set.
+template<typename VertexType, typename IndexedFaceType, typename TreeType, typename VectorType>
+inline size_t intersect_rays_first_hit(
+	// Indexed triangle set - 3D vertices.
+	const std::vector<VertexType> 		&vertices,
+	// Indexed triangle set - triangular faces, references to vertices.
+	const std::vector<IndexedFaceType> 	&faces,
+	// AABBTreeIndirect::Tree over vertices & faces, bounding boxes built with the accuracy of vertices.
+	const TreeType 						&tree,
+	// Origins of the rays.
+	const std::vector<VectorType>		&origins,
+	// Directions of the rays.
+	const std::vector<VectorType> 		&dirs,
+	// First intersections of the rays with the indexed triangle set, one per ray.
+	std::vector<igl::Hit> 				&hits)
+{
+    using Scalar = typename VectorType::Scalar;
+    assert(origins.size() == dirs.size());
+    hits.assign(origins.size(), igl::Hit { -1, -1, 0.f, 0.f, std::numeric_limits<float>::infinity() });
+    if (tree.empty())
+    	return 0;
+
+    // Sort the rays by the octant of their direction, keeping the order of rays inside an octant.
+    std::vector<VectorType> invdirs;
+    invdirs.reserve(dirs.size());
+    std::array<size_t, 9>   octant_begin {};
+    std::vector<size_t>     ray_octants(dirs.size());
+    for (size_t iray = 0; iray < dirs.size(); ++ iray) {
+    	invdirs.emplace_back(dirs[iray].cwiseInverse());
+    	const VectorType &invdir = invdirs.back();
+    	// Same sign test as in ray_box_intersect_invdir().
+    	ray_octants[iray] = (invdir.x() < 0 ? 1 : 0) + (invdir.y() < 0 ? 2 : 0) + (invdir.z() < 0 ? 4 : 0);
+    	++ octant_begin[ray_octants[iray] + 1];
+    }
+    for (size_t octant = 1; octant < octant_begin.size(); ++ octant)
+    	octant_begin[octant] += octant_begin[octant - 1];
+    std::vector<size_t> sorted_rays(dirs.size());
+    {
+    	std::array<size_t, 9> octant_end = octant_begin;
+	    for (size_t iray = 0; iray < dirs.size(); ++ iray)
+	    	sorted_rays[octant_end[ray_octants[iray]] ++] = iray;
+	}
+
+    auto packet = detail::RayPacketIntersector<VertexType, IndexedFaceType, TreeType, VectorType> {
+		vertices, faces, tree, origins.data(), dirs.data(), hits.data()
+	};
+    for (size_t octant = 0; octant < 8; ++ octant) {
+    	packet.negative[0] = (octant & 1) != 0;
+    	packet.negative[1] = (octant & 2) != 0;
+    	packet.negative[2] = (octant & 4) != 0;
+	    for (size_t first = octant_begin[octant]; first < octant_begin[octant + 1]; first += detail::RayPacketSize) {
+	    	const size_t num_rays = std::min(detail::RayPacketSize, octant_begin[octant + 1] - first);
+			for (size_t i = 0; i < detail::RayPacketSize; ++ i) {
+				// Fill the unused slots with the first ray.
+				const size_t iray = sorted_rays[first + (i < num_rays ? i : 0)];
+				packet.ray_idx[i] = iray;
+				for (size_t dim = 0; dim < 3; ++ dim) {
+					packet.origin[dim][i] = origins[iray](dim);
+					packet.invdir[dim][i] = invdirs[iray](dim);
+				}
+				packet.min_t[i] = std::numeric_limits<Scalar>::infinity();
+			}
+			detail::intersect_ray_packet_first_hit(packet, detail::RayPacketMask((uint64_t(1) << num_rays) - 1));
+		}
+	}
+	return size_t(std::count_if(hits.begin(), hits.end(), [](const igl::Hit &hit) { return hit.id >= 0; }));
+}
+
 // Finding a closest triangle, its closest point and squared distance to the closest point
 // on a 3D indexed triangle set using a pre-built AABBTreeIndirect::Tree.
 // Closest point to triangle test will be performed with the accuracy of VectorType::Scalar
@@ -752,6 +953,27 @@ void get_candidate_idxs(const TreeType& tree, const VectorType& v, std::vector<s
     return;
 }
 
+// Traverse the tree and collect the indices of the entities whose bounding boxes
+// intersect a given axis aligned box.
+template<typename TreeType>
+void get_candidate_idxs_in_box(const TreeType& tree, const typename TreeType::BoundingBox& box, std::vector<size_t>& candidates, size_t node_idx = 0)
+{
+    if (tree.empty() || ! tree.node(node_idx).bbox.intersects(box))
+        return;
+
+    decltype(tree.node(node_idx)) node = tree.node(node_idx);
+    static_assert(std::is_reference<decltype(node)>::value,
+                  "Nodes shall be addressed by reference.");
+    assert(node.is_valid());
+
+    if (! node.is_leaf()) {
+        if (tree.left_child(node_idx).bbox.intersects(box))
+            get_candidate_idxs_in_box(tree, box, candidates, tree.left_child_idx(node_idx));
+        if (tree.right_child(node_idx).bbox.intersects(box))
+            get_candidate_idxs_in_box(tree, box, candidates, tree.right_child_idx(node_idx));
+    } else
+        candidates.push_back(node.idx);
+}
 
 } // namespace AABBTreeIndirect
 } // namespace Slic3r
@@ -0,0 +1,548 @@
+// Wide (4-ary or 8-ary) AABB tree over an indexed triangle set with quantized child bounding boxes.
+// The tree is collapsed from the binary AABBTreeIndirect::Tree, the leaf triangles are optionally copied
+// in the order of the tree traversal, and it is queried with the same functions as AABBTreeIndirect::Tree.
+
+#ifndef slic3r_AABBTreeWide_hpp_
+#define slic3r_AABBTreeWide_hpp_
+
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+#include "AABBTreeIndirect.hpp"
+
+namespace Slic3r {
+namespace AABBTreeIndirect {
+
+// Static wide AABB tree for raycasting and closest triangle search over large indexed triangle sets,
+// where the traversal of the binary AABBTreeIndirect::Tree is bound by memory latency.
+//
+// Bounding boxes of the children of a node are stored as 8 bit integers relative to the bounding box
+// of the node, rounded outwards, thus the quantized bounding boxes are conservative and the queries
+// return the same closest hits as the binary tree (the triangle index may differ only for hits
+// of the same distance, for example at a shared edge).
+// A 4-ary node fills a single 64 byte cache line. An 8-ary node takes 104 bytes, thus it spans two cache
+// lines, in exchange the tree has about half the levels of the 4-ary tree.
+//
+// By default the leaves reference the triangles of the source indexed triangle set as the binary tree does.
+// If built with copy_triangles, vertices of the triangles are copied into the tree in the order of the depth
+// first traversal, so that a query does not access the source indexed triangle set at all. The copy takes
+// 40 bytes per triangle for float coordinates, more than the nodes of the tree.
+template<typename ACoordType, size_t AArity = 4>
+class WideTree
+{
+public:
+    static constexpr int    NumDimensions = 3;
+    static constexpr size_t Arity         = AArity;
+    static_assert(Arity >= 2 && Arity <= 8, "WideTree: children of a node are collected into a bit mask and sorted by insertion");
+    // Maximum number of levels of inner nodes. The binary tree is balanced over less than 2^31 triangles
+    // (see leaf_flag), thus it has at most 31 levels of inner nodes. The wide tree has no more levels than
+    // the binary tree, as each child of a wide node is at least one level below it in the binary tree.
+    static constexpr size_t MaxDepth      = 31;
+    // Size of the stack of the depth first traversal: a visit pops a node and pushes up to Arity of its children,
+    // thus each level on the path from the root leaves at most Arity - 1 siblings waiting on the stack,
+    // and the last level pushes Arity of them.
+    static constexpr size_t StackSize     = MaxDepth * (Arity - 1) + 1;
+    using					CoordType     = ACoordType;
+    using 					VectorType 	  = Eigen::Matrix<CoordType, NumDimensions, 1, Eigen::DontAlign>;
+    using  					BoundingBox   = Eigen::AlignedBox<CoordType, NumDimensions>;
+    enum : uint32_t {
+    	// Child slot is not used.
+    	npos 	  = uint32_t(-1),
+    	// Child is a triangle, the lower bits index m_triangles.
+    	leaf_flag = uint32_t(1) << 31
+    };
+
+    struct Node {
+    	// Children bounding boxes are quantized to 255 steps of "scale" starting at "origin".
+    	float 		origin[NumDimensions];
+    	float 		scale[NumDimensions];
+    	uint8_t 	qmin[NumDimensions][Arity];
+    	uint8_t 	qmax[NumDimensions][Arity];
+    	// Index of an inner node, leaf_flag | index of a triangle or npos.
+    	uint32_t 	child[Arity];
+
+    	// Decoded bounds of a child, shared by the tree construction and the queries to round the same way.
+    	float 		decode   (size_t dim, uint8_t q)         const { return this->origin[dim] + float(q) * this->scale[dim]; }
+    	float 		child_min(size_t dim, size_t ichild) const { return this->decode(dim, this->qmin[dim][ichild]); }
+    	float 		child_max(size_t dim, size_t ichild) const { return this->decode(dim, this->qmax[dim][ichild]); }
+    	bool 		is_valid(size_t ichild) const { return this->child[ichild] != npos; }
+    	bool 		is_leaf (size_t ichild) const { return this->is_valid(ichild) && (this->child[ichild] & leaf_flag) != 0; }
+    	uint32_t 	idx     (size_t ichild) const { return this->child[ichild] & ~ uint32_t(leaf_flag); }
+    };
+    static_assert(Arity != 4 || sizeof(Node) == 64, "WideTree::Node shall fill a cache line");
+
+    struct Triangle {
+    	VectorType 	vertices[3];
+    	// Index of the triangle in the source indexed triangle set.
+    	uint32_t 	idx;
+    };
+
+	void clear() { m_nodes.clear(); m_triangles.clear(); }
+
+	// Collapse a binary tree built by build_aabb_tree_over_indexed_triangle_set() over vertices and faces.
+	// If copy_triangles, the triangles are copied into the tree, otherwise the leaves reference faces.
+	template<typename VertexType, typename IndexedFaceType>
+	void build(const Tree<3, CoordType> &tree, const std::vector<VertexType> &vertices, const std::vector<IndexedFaceType> &faces, bool copy_triangles = false)
+	{
+		this->clear();
+		if (tree.empty())
+			return;
+		if (faces.size() >= size_t(leaf_flag))
+			throw std::invalid_argument("WideTree: Too many triangles");
+		if (copy_triangles)
+			m_triangles.reserve(faces.size());
+		// A tree of n leaves collapsed to nodes of Arity children has at least (n - 1) / (Arity - 1) inner nodes,
+		// more if some nodes have less children. Trimmed after the build.
+		m_nodes.reserve(faces.size() / (Arity - 1) + 1);
+		if (tree.node(0).is_leaf()) {
+			// Single triangle, wrap it into a root node.
+			const size_t root = 0;
+			this->build_node(tree, vertices, faces, copy_triangles, &root, 1, 1);
+		} else
+			this->build_recursive(tree, vertices, faces, copy_triangles, 0, 1);
+		m_nodes.shrink_to_fit();
+	}
+
+	const std::vector<Node>& 		nodes() const { return m_nodes; }
+	const Node& 					node(size_t idx) const { return m_nodes[idx]; }
+	// Empty if the triangles were not copied into the tree, then the leaves index the source faces.
+	const std::vector<Triangle>& 	triangles() const { return m_triangles; }
+	const Triangle& 				triangle(size_t idx) const { return m_triangles[idx]; }
+	bool 							has_triangles() const { return ! m_triangles.empty(); }
+	bool 							empty() const { return m_nodes.empty(); }
+	size_t 							memory_size() const { return m_nodes.capacity() * sizeof(Node) + m_triangles.capacity() * sizeof(Triangle); }
+
+private:
+	// Children of the binary tree node are collected by replacing the inner node with the largest bounding box
+	// by its two children until there are Arity of them.
+	template<typename VertexType, typename IndexedFaceType>
+	uint32_t build_recursive(const Tree<3, CoordType> &tree, const std::vector<VertexType> &vertices, const std::vector<IndexedFaceType> &faces, bool copy_triangles, size_t binary_idx, size_t depth)
+	{
+		assert(tree.node(binary_idx).is_inner());
+		size_t children[Arity];
+		size_t num_children = 0;
+		children[num_children ++] = tree.left_child_idx(binary_idx);
+		children[num_children ++] = tree.right_child_idx(binary_idx);
+		while (num_children < Arity) {
+			size_t   ibest     = npos;
+			CoordType best_area = CoordType(-1);
+			for (size_t i = 0; i < num_children; ++ i) {
+				const auto &node = tree.node(children[i]);
+				if (node.is_inner()) {
+					const VectorType d    = node.bbox.sizes();
+					const CoordType  area = d.x() * d.y() + d.y() * d.z() + d.z() * d.x();
+					if (area > best_area) {
+						ibest     = i;
+						best_area = area;
+					}
+				}
+			}
+			if (ibest == npos)
+				break;
+			const size_t inner = children[ibest];
+			children[ibest] = tree.left_child_idx(inner);
+			children[num_children ++] = tree.right_child_idx(inner);
+		}
+		return this->build_node(tree, vertices, faces, copy_triangles, children, num_children, depth);
+	}
+
+	template<typename VertexType, typename IndexedFaceType>
+	uint32_t build_node(const Tree<3, CoordType> &tree, const std::vector<VertexType> &vertices, const std::vector<IndexedFaceType> &faces, bool copy_triangles,
+		const size_t *children, size_t num_children, size_t depth)
+	{
+		assert(m_nodes.size() < size_t(leaf_flag));
+		assert(depth <= MaxDepth);
+		const uint32_t node_idx = uint32_t(m_nodes.size());
+		m_nodes.emplace_back();
+		{
+			BoundingBox bbox = tree.node(children[0]).bbox;
+			for (size_t i = 1; i < num_children; ++ i)
+				bbox.extend(tree.node(children[i]).bbox);
+			Node &node = m_nodes.back();
+			for (size_t dim = 0; dim < NumDimensions; ++ dim) {
+				// Origin rounded down to float.
+				float origin = float(bbox.min()(dim));
+				if (double(origin) > double(bbox.min()(dim)))
+					origin = std::nextafter(origin, - std::numeric_limits<float>::infinity());
+				// 254 steps cover the bounding box, the last step is a reserve for rounding the bounds outwards.
+				float scale = float((double(bbox.max()(dim)) - double(origin)) / 254.);
+				while (double(origin + 254.f * scale) < double(bbox.max()(dim)))
+					scale = std::nextafter(scale, std::numeric_limits<float>::infinity());
+				node.origin[dim] = origin;
+				node.scale[dim]  = scale;
+			}
+			for (size_t i = 0; i < Arity; ++ i)
+				node.child[i] = npos;
+			for (size_t i = 0; i < num_children; ++ i) {
+				const BoundingBox &child_bbox = tree.node(children[i]).bbox;
+				for (size_t dim = 0; dim < NumDimensions; ++ dim)
+					if (node.scale[dim] == 0.f) {
+						// Degenerate dimension, the box is exactly origin.
+						node.qmin[dim][i] = 0;
+						node.qmax[dim][i] = 0;
+					} else {
+						const double lo = (double(child_bbox.min()(dim)) - double(node.origin[dim])) / double(node.scale[dim]);
+						const double hi = (double(child_bbox.max()(dim)) - double(node.origin[dim])) / double(node.scale[dim]);
+						int qmin = std::clamp(int(std::floor(lo)), 0, 255);
+						int qmax = std::clamp(int(std::ceil(hi)), 0, 255);
+						node.qmin[dim][i] = uint8_t(qmin);
+						node.qmax[dim][i] = uint8_t(qmax);
+						// Fix the rounding of the division and add a step of reserve for a different rounding of child_min() / child_max()
+						// at the call site, for example when contracted to a fused multiply-add.
+						while (qmin > 0 && double(node.child_min(dim, i)) > double(child_bbox.min()(dim)))
+							node.qmin[dim][i] = uint8_t(-- qmin);
+						while (qmax < 255 && double(node.child_max(dim, i)) < double(child_bbox.max()(dim)))
+							node.qmax[dim][i] = uint8_t(++ qmax);
+						node.qmin[dim][i] = uint8_t(std::max(qmin - 1, 0));
+						node.qmax[dim][i] = uint8_t(std::min(qmax + 1, 255));
+						assert(double(node.child_min(dim, i)) <= double(child_bbox.min()(dim)));
+						assert(double(node.child_max(dim, i)) >= double(child_bbox.max()(dim)));
+					}
+			}
+		}
+		// Leaves first, so that the triangles of a node are stored next to each other.
+		for (size_t i = 0; i < num_children; ++ i) {
+			const auto &child = tree.node(children[i]);
+			if (child.is_leaf()) {
+				if (copy_triangles) {
+					const IndexedFaceType &face = faces[child.idx];
+					m_nodes[node_idx].child[i] = leaf_flag | uint32_t(m_triangles.size());
+					m_triangles.push_back({ { vertices[face(0)], vertices[face(1)], vertices[face(2)] }, uint32_t(child.idx) });
+				} else
+					m_nodes[node_idx].child[i] = leaf_flag | uint32_t(child.idx);
+			}
+		}
+		for (size_t i = 0; i < num_children; ++ i)
+			if (tree.node(children[i]).is_inner()) {
+				// m_nodes may be reallocated by the recursive call.
+				uint32_t child_idx = this->build_recursive(tree, vertices, faces, copy_triangles, children[i], depth + 1);
+				m_nodes[node_idx].child[i] = child_idx;
+			}
+		return node_idx;
+	}
+
+	std::vector<Node> 		m_nodes;
+	std::vector<Triangle> 	m_triangles;
+};
+
+using WideTree3f   = WideTree<float>;
+using WideTree3d   = WideTree<double>;
+using WideTree8x3f = WideTree<float, 8>;
+using WideTree8x3d = WideTree<double, 8>;
+
+// Collapse the binary AABB tree over an indexed triangle set to a wide tree with quantized bounding boxes.
+template<size_t Arity = 4, typename VertexType, typename IndexedFaceType>
+inline WideTree<typename VertexType::Scalar, Arity> build_wide_aabb_tree_over_indexed_triangle_set(
+	// Indexed triangle set - 3D vertices.
+	const std::vector<VertexType> 		&vertices,
+	// Indexed triangle set - triangular faces, references to vertices.
+    const std::vector<IndexedFaceType> 	&faces,
+    const typename VertexType::Scalar 	 eps = 0,
+    // Copy the triangles into the tree, trading memory for less cache misses.
+    bool 								 copy_triangles = false)
+{
+	WideTree<typename VertexType::Scalar, Arity> out;
+	out.build(build_aabb_tree_over_indexed_triangle_set(vertices, faces, eps), vertices, faces, copy_triangles);
+	return out;
+}
+
+namespace detail {
+	// Ray / box intersections of the children of a wide node with the same arithmetics as ray_box_intersect_invdir().
+	// Returns a bit mask of the children intersected, tnear receives the ray parameter of the entry point.
+	template<typename NodeType, typename VectorType, typename Scalar>
+	inline unsigned int ray_wide_node_intersect_invdir(
+		const NodeType 		&node,
+		const VectorType 	&origin,
+		const VectorType 	&invdir,
+		const Scalar 		 t1,
+		Scalar 				*tnear)
+	{
+		static constexpr size_t Arity = std::extent<decltype(node.child)>::value;
+		// Quantized near and far planes of the children.
+		const uint8_t *qnear[3], *qfar[3];
+		for (size_t dim = 0; dim < 3; ++ dim) {
+			const bool negative = invdir(dim) < 0;
+			qnear[dim] = negative ? node.qmax[dim] : node.qmin[dim];
+			qfar [dim] = negative ? node.qmin[dim] : node.qmax[dim];
+		}
+		Scalar 	   intersects[Arity];
+		for (size_t i = 0; i < Arity; ++ i) {
+			Scalar tmin  = (Scalar(node.decode(0, qnear[0][i])) - origin.x()) * invdir.x();
+			Scalar tmax  = (Scalar(node.decode(0, qfar [0][i])) - origin.x()) * invdir.x();
+			Scalar tymin = (Scalar(node.decode(1, qnear[1][i])) - origin.y()) * invdir.y();
+			Scalar tymax = (Scalar(node.decode(1, qfar [1][i])) - origin.y()) * invdir.y();
+			Scalar tzmin = (Scalar(node.decode(2, qnear[2][i])) - origin.z()) * invdir.z();
+			Scalar tzmax = (Scalar(node.decode(2, qfar [2][i])) - origin.z()) * invdir.z();
+			bool   valid = ! (tmin > tymax) & ! (tymin > tmax);
+			tmin  = tmin < tymin ? tymin : tmin;
+			tmax  = tymax < tmax ? tymax : tmax;
+			valid = valid & ! (tzmin > tmax) & ! (tmin > tzmax);
+			tmin  = tmin < tzmin ? tzmin : tmin;
+			tmax  = tzmax < tmax ? tzmax : tmax;
+			intersects[i] = (valid & (tmin < t1) & (tmax > Scalar(0))) ? Scalar(1) : Scalar(0);
+			tnear[i] = tmin;
+		}
+		unsigned int mask = 0;
+		for (size_t i = 0; i < Arity; ++ i)
+			if (intersects[i] != Scalar(0) && node.is_valid(i))
+				mask |= 1u << i;
+		return mask;
+	}
+
+	// Call visitor(v0, v1, v2, face_idx) with the vertices of a triangle referenced by a leaf of a WideTree,
+	// taken either from the copy stored in the tree or from the source indexed triangle set.
+	template<typename CoordType, size_t Arity, typename VertexType, typename IndexedFaceType, typename Visitor>
+	inline void visit_wide_tree_triangle(
+		const WideTree<CoordType, Arity> 	&tree,
+		const std::vector<VertexType> 		&vertices,
+		const std::vector<IndexedFaceType> 	&faces,
+		uint32_t 							 leaf_idx,
+		Visitor 							&&visitor)
+	{
+		if (tree.has_triangles()) {
+			const auto &triangle = tree.triangle(leaf_idx);
+			visitor(triangle.vertices[0], triangle.vertices[1], triangle.vertices[2], size_t(triangle.idx));
+		} else {
+			const auto &face = faces[leaf_idx];
+			visitor(vertices[face(0)], vertices[face(1)], vertices[face(2)], size_t(leaf_idx));
+		}
+	}
+} // namespace detail
+
+// Find a first intersection of a ray with indexed triangle set indexed by a WideTree.
+// The children of a node are visited front to back and a subtree is skipped if it starts behind the closest hit found so far.
+template<typename VertexType, typename IndexedFaceType, typename CoordType, size_t Arity, typename VectorType>
+inline bool intersect_ray_first_hit(
+	// Indexed triangle set - 3D vertices, not accessed if the triangles were copied into the tree.
+	const std::vector<VertexType> 		&vertices,
+	// Indexed triangle set - triangular faces, not accessed if the triangles were copied into the tree.
+	const std::vector<IndexedFaceType> 	&faces,
+	// AABBTreeIndirect::WideTree built over vertices & faces.
+	const WideTree<CoordType, Arity> 	&tree,
+	// Origin of the ray.
+	const VectorType					&origin,
+	// Direction of the ray.
+	const VectorType 					&dir,
+	// First intersection of the ray with the indexed triangle set.
+	igl::Hit 							&hit)
+{
+    using Scalar = typename VectorType::Scalar;
+    if (tree.empty())
+    	return false;
+
+    const VectorType invdir = dir.cwiseInverse();
+    Scalar 			 min_t  = std::numeric_limits<Scalar>::infinity();
+    std::array<std::pair<uint32_t, Scalar>, WideTree<CoordType, Arity>::StackSize> stack;
+    size_t 			 stack_size = 0;
+    stack[stack_size ++] = std::make_pair(uint32_t(0), Scalar(0));
+    while (stack_size > 0) {
+    	auto [node_idx, node_t] = stack[-- stack_size];
+    	if (! (node_t < min_t))
+    		// The closest hit found so far is in front of this subtree.
+    		continue;
+    	const auto  &node = tree.node(node_idx);
+    	Scalar 		 tnear[Arity];
+    	unsigned int mask = detail::ray_wide_node_intersect_invdir(node, origin, invdir, min_t, tnear);
+    	// Sort the children intersected front to back.
+    	size_t 		 order[Arity];
+    	size_t 		 num_children = 0;
+    	for (size_t i = 0; i < Arity; ++ i)
+    		if (mask & (1u << i)) {
+    			size_t j = num_children ++;
+    			for (; j > 0 && tnear[order[j - 1]] > tnear[i]; -- j)
+    				order[j] = order[j - 1];
+    			order[j] = i;
+    		}
+    	// Push the inner nodes back to front, so that the closest one is popped first.
+    	for (size_t k = num_children; k > 0; -- k) {
+    		const size_t i = order[k - 1];
+    		if (! node.is_leaf(i)) {
+    			assert(stack_size < stack.size());
+    			stack[stack_size ++] = std::make_pair(node.idx(i), tnear[i]);
+    		}
+    	}
+    	for (size_t k = 0; k < num_children; ++ k) {
+    		const size_t i = order[k];
+    		if (node.is_leaf(i))
+    			detail::visit_wide_tree_triangle(tree, vertices, faces, node.idx(i), [&](const auto &v0, const auto &v1, const auto &v2, size_t face_idx) {
+				    double t, u, v;
+				    if (detail::intersect_triangle(origin, dir, v0, v1, v2, t, u, v) && t > 0. && float(t) < min_t) {
+		                hit   = igl::Hit { int(face_idx), -1, float(u), float(v), float(t) };
+		                min_t = float(t);
+		            }
+    			});
+    	}
+    }
+    return min_t < std::numeric_limits<Scalar>::infinity();
+}
+
+// Find all intersections of a ray with indexed triangle set indexed by a WideTree.
+// The output hits are sorted by the ray parameter.
+template<typename VertexType, typename IndexedFaceType, typename CoordType, size_t Arity, typename VectorType>
+inline bool intersect_ray_all_hits(
+	// Indexed triangle set - 3D vertices, not accessed if the triangles were copied into the tree.
+	const std::vector<VertexType> 		&vertices,
+	// Indexed triangle set - triangular faces, not accessed if the triangles were copied into the tree.
+	const std::vector<IndexedFaceType> 	&faces,
+	// AABBTreeIndirect::WideTree built over vertices & faces.
+	const WideTree<CoordType, Arity> 	&tree,
+	// Origin of the ray.
+	const VectorType					&origin,
+	// Direction of the ray.
+	const VectorType 					&dir,
+	// All intersections of the ray with the indexed triangle set, sorted by parameter t.
+	std::vector<igl::Hit> 				&hits)
+{
+    using Scalar = typename VectorType::Scalar;
+    hits.clear();
+    if (tree.empty())
+    	return false;
+
+    const VectorType invdir = dir.cwiseInverse();
+    std::array<uint32_t, WideTree<CoordType, Arity>::StackSize> stack;
+    size_t 			 stack_size = 0;
+    stack[stack_size ++] = 0;
+    while (stack_size > 0) {
+    	const auto  &node = tree.node(stack[-- stack_size]);
+    	Scalar 		 tnear[Arity];
+    	unsigned int mask = detail::ray_wide_node_intersect_invdir(node, origin, invdir, std::numeric_limits<Scalar>::infinity(), tnear);
+    	for (size_t i = 0; i < Arity; ++ i)
+    		if (mask & (1u << i)) {
+    			if (node.is_leaf(i)) {
+    				detail::visit_wide_tree_triangle(tree, vertices, faces, node.idx(i), [&](const auto &v0, const auto &v1, const auto &v2, size_t face_idx) {
+					    double t, u, v;
+					    if (detail::intersect_triangle(origin, dir, v0, v1, v2, t, u, v) && t > 0.)
+			                hits.emplace_back(igl::Hit{ int(face_idx), -1, float(u), float(v), float(t) });
+    				});
+    			} else {
+	    			assert(stack_size < stack.size());
+    				stack[stack_size ++] = node.idx(i);
+    			}
+    		}
+    }
+    std::sort(hits.begin(), hits.end(), [](const auto &l, const auto &r) { return l.t < r.t; });
+	return ! hits.empty();
+}
+
+namespace detail {
+	// Closest triangle search over a WideTree, visiting the children of a node ordered by their distance.
+	// Only triangles closer than up_sqr_d are considered. Returns the squared distance to the closest point
+	// or up_sqr_d if there is no triangle closer than up_sqr_d, in that case hit_idx_out and hit_point_out are not modified.
+	template<typename CoordType, size_t Arity, typename VertexType, typename IndexedFaceType, typename VectorType>
+	inline typename VectorType::Scalar squared_distance_to_wide_tree(
+		const WideTree<CoordType, Arity> 	&tree,
+		const std::vector<VertexType> 		&vertices,
+		const std::vector<IndexedFaceType> 	&faces,
+		const VectorType					&point,
+		typename VectorType::Scalar 		 up_sqr_d,
+		size_t 								&hit_idx_out,
+		Eigen::PlainObjectBase<VectorType>	&hit_point_out)
+	{
+	    using Scalar = typename VectorType::Scalar;
+	    std::array<std::pair<uint32_t, Scalar>, WideTree<CoordType, Arity>::StackSize> stack;
+	    size_t stack_size = 0;
+	    stack[stack_size ++] = std::make_pair(uint32_t(0), Scalar(0));
+	    while (stack_size > 0) {
+	    	auto [node_idx, node_sqr_d] = stack[-- stack_size];
+	    	if (! (node_sqr_d < up_sqr_d))
+	    		continue;
+	    	const auto &node = tree.node(node_idx);
+	    	// Squared distances of the point to the bounding boxes of the children, zero if inside.
+	    	Scalar sqr_d[Arity];
+	    	for (size_t i = 0; i < Arity; ++ i) {
+	    		Scalar d2 = 0;
+	    		for (size_t dim = 0; dim < 3; ++ dim) {
+	    			const Scalar lo = Scalar(node.child_min(dim, i)) - point(dim);
+	    			const Scalar hi = point(dim) - Scalar(node.child_max(dim, i));
+	    			const Scalar d  = lo > 0 ? lo : hi > 0 ? hi : Scalar(0);
+	    			d2 += d * d;
+	    		}
+	    		sqr_d[i] = d2;
+	    	}
+	    	size_t order[Arity];
+	    	size_t num_children = 0;
+	    	for (size_t i = 0; i < Arity; ++ i)
+	    		if (node.is_valid(i) && sqr_d[i] < up_sqr_d) {
+	    			size_t j = num_children ++;
+	    			for (; j > 0 && sqr_d[order[j - 1]] > sqr_d[i]; -- j)
+	    				order[j] = order[j - 1];
+	    			order[j] = i;
+	    		}
+	    	for (size_t k = 0; k < num_children; ++ k) {
+	    		const size_t i = order[k];
+	    		if (node.is_leaf(i))
+	    			visit_wide_tree_triangle(tree, vertices, faces, node.idx(i), [&](const auto &v0, const auto &v1, const auto &v2, size_t face_idx) {
+			            VectorType c = closest_point_to_triangle<VectorType>(point,
+			                v0.template cast<Scalar>(), v1.template cast<Scalar>(), v2.template cast<Scalar>());
+			            Scalar d2 = (c - point).squaredNorm();
+			            if (d2 < up_sqr_d) {
+			            	up_sqr_d 	  = d2;
+			            	hit_idx_out   = face_idx;
+			            	hit_point_out = c;
+			            }
+	    			});
+	    	}
+	    	// Push the inner nodes far to near, so that the closest one is popped first.
+	    	for (size_t k = num_children; k > 0; -- k) {
+	    		const size_t i = order[k - 1];
+	    		if (! node.is_leaf(i) && sqr_d[i] < up_sqr_d) {
+	    			assert(stack_size < stack.size());
+	    			stack[stack_size ++] = std::make_pair(node.idx(i), sqr_d[i]);
+	    		}
+	    	}
+	    }
+	    return up_sqr_d;
+	}
+} // namespace detail
+
+// Finding a closest triangle, its closest point and squared distance to the closest point
+// on a 3D indexed triangle set indexed by a WideTree.
+// Returns squared distance to the closest point or -1 if the input is empty.
+template<typename VertexType, typename IndexedFaceType, typename CoordType, size_t Arity, typename VectorType>
+inline typename VectorType::Scalar squared_distance_to_indexed_triangle_set(
+	// Indexed triangle set - 3D vertices, not accessed if the triangles were copied into the tree.
+	const std::vector<VertexType> 		&vertices,
+	// Indexed triangle set - triangular faces, not accessed if the triangles were copied into the tree.
+	const std::vector<IndexedFaceType> 	&faces,
+	// AABBTreeIndirect::WideTree built over vertices & faces.
+	const WideTree<CoordType, Arity> 	&tree,
+	// Point to which the closest point on the indexed triangle set is searched for.
+	const VectorType					&point,
+	// Index of the closest triangle in faces.
+	size_t 								&hit_idx_out,
+	// Position of the closest point on the indexed triangle set.
+	Eigen::PlainObjectBase<VectorType>	&hit_point_out)
+{
+    using Scalar = typename VectorType::Scalar;
+    return tree.empty() ? Scalar(-1) :
+    	detail::squared_distance_to_wide_tree(tree, vertices, faces, point, std::numeric_limits<Scalar>::infinity(), hit_idx_out, hit_point_out);
+}
+
+// Decides if exists some triangle in defined radius on a 3D indexed triangle set indexed by a WideTree.
+// As with AABBTreeIndirect::Tree, max_distance is compared against squared distances.
+template<typename VertexType, typename IndexedFaceType, typename CoordType, size_t Arity, typename VectorType>
+inline bool is_any_triangle_in_radius(
+	// Indexed triangle set - 3D vertices, not accessed if the triangles were copied into the tree.
+	const std::vector<VertexType> 		&vertices,
+	// Indexed triangle set - triangular faces, not accessed if the triangles were copied into the tree.
+	const std::vector<IndexedFaceType> 	&faces,
+	// AABBTreeIndirect::WideTree built over vertices & faces.
+	const WideTree<CoordType, Arity> 	&tree,
+	// Point to which the closest point on the indexed triangle set is searched for.
+	const VectorType					&point,
+	// Maximum distance in which triangle is search for
+	typename VectorType::Scalar 		&max_distance)
+{
+	size_t     hit_idx;
+	VectorType hit_point = VectorType::Ones() * (std::nan(""));
+	if (tree.empty())
+		return false;
+	detail::squared_distance_to_wide_tree(tree, vertices, faces, point, max_distance, hit_idx, hit_point);
+    return hit_point.allFinite();
+}
+
+} // namespace AABBTreeIndirect
+} // namespace Slic3r
+
+#endif /* slic3r_AABBTreeWide_hpp_ */
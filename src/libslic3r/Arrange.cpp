@@ -81,6 +81,16 @@ using ItemGroup = std::vector<std::reference_wrapper<Item>>;
 // A coefficient used in separating bigger items and smaller items.
 const double BIG_ITEM_TRESHOLD = 0.02;
 
+class NfpCache: public placers::NfpCache<clppr::Polygon> {
+public:
+    using placers::NfpCache<clppr::Polygon>::NfpCache;
+};
+
+std::shared_ptr<NfpCache> make_nfp_cache(size_t max_vertices)
+{
+    return std::make_shared<NfpCache>(max_vertices);
+}
+
 // Fill in the placer algorithm configuration with values carefully chosen for
 // Slic3r.
 template<class PConf>
@@ -105,6 +115,8 @@ void fill_config(PConf& pcfg, const ArrangeParams &params) {
     
     // Allow parallel execution.
     pcfg.parallel = params.parallel;
+
+    pcfg.nfp_cache = params.nfp_cache;
 }
 
 // Apply penalty to object function result. This is used only when alignment
@@ -75,6 +75,15 @@ struct ArrangePolygon {
 
 using ArrangePolygons = std::vector<ArrangePolygon>;
 
+/// Cache of the no-fit polygons calculated by the arrangement, opaque to the
+/// callers. Its size is limited by the total number of vertices stored.
+class NfpCache;
+
+/// Create a cache to be shared by subsequent arrangements, so that the objects
+/// arranged again reuse their no-fit polygons. The polygons are released
+/// together with the last copy of the returned pointer.
+std::shared_ptr<NfpCache> make_nfp_cache(size_t max_vertices = 1000000);
+
 struct ArrangeParams {
     
     /// The minimum distance which is allowed for any 
@@ -98,6 +107,10 @@ struct ArrangeParams {
     
     /// A predicate returning true if abort is needed.
     std::function<bool(void)>     stopcondition;
+
+    /// No-fit polygons shared with other arrangements, see make_nfp_cache().
+    /// If empty, the polygons are kept for the duration of a single arrange().
+    std::shared_ptr<NfpCache>     nfp_cache;
     
     ArrangeParams() = default;
     explicit ArrangeParams(coord_t md) : min_obj_distance(md) {}
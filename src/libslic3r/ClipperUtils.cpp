@@ -128,6 +128,7 @@ ExPolygons PolyTreeToExPolygons(ClipperLib::PolyTree& polytree)
 Slic3r::Polygon ClipperPath_to_Slic3rPolygon(const ClipperLib::Path &input)
 {
     Polygon retval;
+    retval.points.reserve(input.size());
     for (ClipperLib::Path::const_iterator pit = input.begin(); pit != input.end(); ++pit)
         retval.points.emplace_back(pit->X, pit->Y);
     return retval;
@@ -136,6 +137,7 @@ Slic3r::Polygon ClipperPath_to_Slic3rPolygon(const ClipperLib::Path &input)
 Slic3r::Polyline ClipperPath_to_Slic3rPolyline(const ClipperLib::Path &input)
 {
     Polyline retval;
+    retval.points.reserve(input.size());
     for (ClipperLib::Path::const_iterator pit = input.begin(); pit != input.end(); ++pit)
         retval.points.emplace_back(pit->X, pit->Y);
     return retval;
@@ -249,6 +251,38 @@ ClipperLib::Paths _offset(ClipperLib::Path &&input, ClipperLib::EndType endType,
 	return _offset(std::move(paths), endType, delta, joinType, miterLimit);
 }
 
+// Same as _offset(ClipperLib::Paths &&input, ...), but the Slic3r paths are scaled while being inserted into ClipperOffset,
+// no intermediate ClipperLib::Paths are created.
+template<typename PathsProvider>
+static ClipperLib::Paths _offset_provider(const PathsProvider &input, ClipperLib::EndType endType, const float delta, ClipperLib::JoinType joinType, double miterLimit)
+{
+    // perform offset
+    ClipperLib::ClipperOffset co;
+    if (joinType == jtRound)
+        co.ArcTolerance = miterLimit;
+    else
+        co.MiterLimit = miterLimit;
+    float delta_scaled = delta * float(CLIPPER_OFFSET_SCALE);
+    co.ShortestEdgeLength = double(std::abs(delta_scaled * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR));
+    co.AddPaths(ClipperUtils::ScaledPathsProvider<PathsProvider>(input), joinType, endType);
+    ClipperLib::Paths retval;
+    co.Execute(retval, delta_scaled);
+    
+    // unscale output
+    unscaleClipperPolygons(retval);
+    return retval;
+}
+
+ClipperLib::Paths _offset(const Slic3r::Polygons &polygons, ClipperLib::EndType endType, const float delta, ClipperLib::JoinType joinType, double miterLimit)
+{
+    return _offset_provider(ClipperUtils::PolygonsProvider(polygons), endType, delta, joinType, miterLimit);
+}
+
+ClipperLib::Paths _offset(const Slic3r::Polylines &polylines, ClipperLib::EndType endType, const float delta, ClipperLib::JoinType joinType, double miterLimit)
+{
+    return _offset_provider(ClipperUtils::PolylinesProvider(polylines), endType, delta, joinType, miterLimit);
+}
+
 // This is a safe variant of the polygon offset, tailored for a single ExPolygon:
 // a single polygon with multiple non-overlapping holes.
 // Each contour and hole is offsetted separately, then the holes are subtracted from the outer contours.
@@ -260,15 +294,13 @@ ClipperLib::Paths _offset(const Slic3r::ExPolygon &expolygon, const float delta,
     const float delta_scaled = delta * float(CLIPPER_OFFSET_SCALE);
     ClipperLib::Paths contours;
     {
-        ClipperLib::Path input = Slic3rMultiPoint_to_ClipperPath(expolygon.contour);
-        scaleClipperPolygon(input);
         ClipperLib::ClipperOffset co;
         if (joinType == jtRound)
             co.ArcTolerance = miterLimit * double(CLIPPER_OFFSET_SCALE);
         else
             co.MiterLimit = miterLimit;
         co.ShortestEdgeLength = double(std::abs(delta_scaled * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR));
-        co.AddPath(input, joinType, ClipperLib::etClosedPolygon);
+        co.AddPath(ClipperUtils::ScaledPath(expolygon.contour.points), joinType, ClipperLib::etClosedPolygon);
         co.Execute(contours, delta_scaled);
     }
 
@@ -277,15 +309,13 @@ ClipperLib::Paths _offset(const Slic3r::ExPolygon &expolygon, const float delta,
     {
         holes.reserve(expolygon.holes.size());
         for (Polygons::const_iterator it_hole = expolygon.holes.begin(); it_hole != expolygon.holes.end(); ++ it_hole) {
-            ClipperLib::Path input = Slic3rMultiPoint_to_ClipperPath_reversed(*it_hole);
-            scaleClipperPolygon(input);
             ClipperLib::ClipperOffset co;
             if (joinType == jtRound)
                 co.ArcTolerance = miterLimit * double(CLIPPER_OFFSET_SCALE);
             else
                 co.MiterLimit = miterLimit;
             co.ShortestEdgeLength = double(std::abs(delta_scaled * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR));
-            co.AddPath(input, joinType, ClipperLib::etClosedPolygon);
+            co.AddPath(ClipperUtils::ScaledPath(it_hole->points, true), joinType, ClipperLib::etClosedPolygon);
             ClipperLib::Paths out;
             co.Execute(out, - delta_scaled);
             holes.insert(holes.end(), out.begin(), out.end());
@@ -326,15 +356,13 @@ ClipperLib::Paths _offset(const Slic3r::ExPolygons &expolygons, const float delt
         // 1) Offset the outer contour.
         ClipperLib::Paths contours;
         {
-            ClipperLib::Path input = Slic3rMultiPoint_to_ClipperPath(it_expoly->contour);
-            scaleClipperPolygon(input);
             ClipperLib::ClipperOffset co;
             if (joinType == jtRound)
                 co.ArcTolerance = miterLimit * double(CLIPPER_OFFSET_SCALE);
             else
                 co.MiterLimit = miterLimit;
             co.ShortestEdgeLength = double(std::abs(delta_scaled * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR));
-            co.AddPath(input, joinType, ClipperLib::etClosedPolygon);
+            co.AddPath(ClipperUtils::ScaledPath(it_expoly->contour.points), joinType, ClipperLib::etClosedPolygon);
             co.Execute(contours, delta_scaled);
         }
         if (contours.empty())
@@ -350,15 +378,13 @@ ClipperLib::Paths _offset(const Slic3r::ExPolygons &expolygons, const float delt
             ClipperLib::Paths holes;
             {
                 for (Polygons::const_iterator it_hole = it_expoly->holes.begin(); it_hole != it_expoly->holes.end(); ++ it_hole) {
-                    ClipperLib::Path input = Slic3rMultiPoint_to_ClipperPath_reversed(*it_hole);
-                    scaleClipperPolygon(input);
                     ClipperLib::ClipperOffset co;
                     if (joinType == jtRound)
                         co.ArcTolerance = miterLimit * double(CLIPPER_OFFSET_SCALE);
                     else
                         co.MiterLimit = miterLimit;
                     co.ShortestEdgeLength = double(std::abs(delta_scaled * CLIPPER_OFFSET_SHORTEST_EDGE_FACTOR));
-                    co.AddPath(input, joinType, ClipperLib::etClosedPolygon);
+                    co.AddPath(ClipperUtils::ScaledPath(it_hole->points, true), joinType, ClipperLib::etClosedPolygon);
                     ClipperLib::Paths out;
                     co.Execute(out, - delta_scaled);
                     holes.insert(holes.end(), out.begin(), out.end());
@@ -422,12 +448,6 @@ ClipperLib::Paths
 _offset2(const Polygons &polygons, const float delta1, const float delta2,
     const ClipperLib::JoinType joinType, const double miterLimit)
 {
-    // read input
-    ClipperLib::Paths input = Slic3rMultiPoints_to_ClipperPaths(polygons);
-    
-    // scale input
-    scaleClipperPolygons(input);
-    
     // prepare ClipperOffset object
     ClipperLib::ClipperOffset co;
     if (joinType == jtRound) {
@@ -441,7 +461,7 @@ _offset2(const Polygons &polygons, const float delta1, const float delta2,
     
     // perform first offset
     ClipperLib::Paths output1;
-    co.AddPaths(input, joinType, ClipperLib::etClosedPolygon);
+    co.AddPaths(ClipperUtils::ScaledPathsProvider<ClipperUtils::PolygonsProvider>(ClipperUtils::PolygonsProvider(polygons)), joinType, ClipperLib::etClosedPolygon);
     co.Execute(output1, delta_scaled1);
     
     // perform second offset
@@ -490,40 +510,74 @@ ExPolygons offset2_ex(const ExPolygons &expolygons, const float delta1,
     return union_ex(polys);
 }
 
-template<class T, class TSubj, class TClip>
-T _clipper_do(const ClipperLib::ClipType     clipType,
-              TSubj &&                        subject,
-              TClip &&                        clip,
-              const ClipperLib::PolyFillType fillType,
-              const bool                     safety_offset_)
+// Path providers of the Slic3r containers, see ClipperUtils::MultiPointsProvider.
+static inline ClipperUtils::PolygonsProvider   paths_provider(const Polygons   &polygons)   { return ClipperUtils::PolygonsProvider(polygons); }
+static inline ClipperUtils::ExPolygonsProvider paths_provider(const ExPolygons &expolygons) { return ClipperUtils::ExPolygonsProvider(expolygons); }
+static inline ClipperUtils::PolylinesProvider  paths_provider(const Polylines  &polylines)  { return ClipperUtils::PolylinesProvider(polylines); }
+
+// Insert the subject and clip paths into the Clipper engine.
+// The Slic3r containers are read by the Clipper engine directly, they are converted to ClipperLib::Paths
+// only if the safety offset is applied to them.
+template<class TSubj, class TClip>
+static void _clipper_add_paths(
+    ClipperLib::Clipper            &clipper,
+    const ClipperLib::ClipType      clipType,
+    const TSubj                    &subject,
+    const bool                      subject_closed,
+    const TClip                    &clip,
+    const bool                      safety_offset_)
+{
+    if (safety_offset_ && clipType == ClipperLib::ctUnion) {
+        ClipperLib::Paths input_subject = Slic3rMultiPoints_to_ClipperPaths(subject);
+        safety_offset(&input_subject);
+        clipper.AddPaths(input_subject, ClipperLib::ptSubject, subject_closed);
+    } else
+        clipper.AddPaths(paths_provider(subject), ClipperLib::ptSubject, subject_closed);
+    if (safety_offset_ && clipType != ClipperLib::ctUnion) {
+        ClipperLib::Paths input_clip = Slic3rMultiPoints_to_ClipperPaths(clip);
+        safety_offset(&input_clip);
+        clipper.AddPaths(input_clip, ClipperLib::ptClip, true);
+    } else
+        clipper.AddPaths(paths_provider(clip), ClipperLib::ptClip, true);
+}
+
+template<class TSubj, class TClip>
+static ClipperLib::PolyTree _clipper_do_polytree(
+    const ClipperLib::ClipType     clipType,
+    const TSubj                   &subject,
+    const TClip                   &clip,
+    const ClipperLib::PolyFillType fillType,
+    const bool                     safety_offset_)
 {
-    // read input
-    ClipperLib::Paths input_subject = Slic3rMultiPoints_to_ClipperPaths(std::forward<TSubj>(subject));
-    ClipperLib::Paths input_clip    = Slic3rMultiPoints_to_ClipperPaths(std::forward<TClip>(clip));
-    
-    // perform safety offset
-    if (safety_offset_) {
-        if (clipType == ClipperLib::ctUnion) {
-            safety_offset(&input_subject);
-        } else {
-            safety_offset(&input_clip);
-        }
-    }
-    
-    // init Clipper
     ClipperLib::Clipper clipper;
-    clipper.Clear();
-    
-    // add polygons
-    clipper.AddPaths(input_subject, ClipperLib::ptSubject, true);
-    clipper.AddPaths(input_clip,    ClipperLib::ptClip,    true);
-    
-    // perform operation
-    T retval;
+    _clipper_add_paths(clipper, clipType, subject, true, clip, safety_offset_);
+    ClipperLib::PolyTree retval;
     clipper.Execute(clipType, retval, fillType, fillType);
     return retval;
 }
 
+// Perform the Clipper operation, collect the output directly into Polygons without going through ClipperLib::Paths.
+template<class TSubj, class TClip>
+static Polygons _clipper_do_polygons(
+    const ClipperLib::ClipType     clipType,
+    const TSubj                   &subject,
+    const TClip                   &clip,
+    const ClipperLib::PolyFillType fillType,
+    const bool                     safety_offset_)
+{
+    ClipperLib::Clipper clipper;
+    _clipper_add_paths(clipper, clipType, subject, true, clip, safety_offset_);
+    Polygons retval;
+    clipper.Execute(clipType, fillType, fillType, [&retval](const ClipperLib::OutPtRange &path) {
+        retval.emplace_back();
+        Points &pts = retval.back().points;
+        pts.reserve(path.size());
+        for (const ClipperLib::IntPoint &pt : path)
+            pts.emplace_back(pt.X, pt.Y);
+    });
+    return retval;
+}
+
 // Fix of #117: A large fractal pyramid takes ages to slice
 // The Clipper library has difficulties processing overlapping polygons.
 // Namely, the function ClipperLib::JoinCommonEdges() has potentially a terrible time complexity if the output
@@ -531,27 +585,20 @@ T _clipper_do(const ClipperLib::ClipType     clipType,
 // This function implmenets a following workaround:
 // 1) Peform the Clipper operation with the output to Paths. This method handles overlaps in a reasonable time.
 // 2) Run Clipper Union once again to extract the PolyTree from the result of 1).
-inline ClipperLib::PolyTree _clipper_do_polytree2(const ClipperLib::ClipType clipType, const Polygons &subject, 
-    const Polygons &clip, const ClipperLib::PolyFillType fillType, const bool safety_offset_)
+template<class TSubj, class TClip>
+static ClipperLib::PolyTree _clipper_do_polytree2(const ClipperLib::ClipType clipType, const TSubj &subject, 
+    const TClip &clip, const ClipperLib::PolyFillType fillType, const bool safety_offset_)
 {
-    // read input
-    ClipperLib::Paths input_subject = Slic3rMultiPoints_to_ClipperPaths(subject);
-    ClipperLib::Paths input_clip    = Slic3rMultiPoints_to_ClipperPaths(clip);
-    
-    // perform safety offset
-    if (safety_offset_)
-        safety_offset((clipType == ClipperLib::ctUnion) ? &input_subject : &input_clip);
-    
     ClipperLib::Clipper clipper;
-    clipper.AddPaths(input_subject, ClipperLib::ptSubject, true);
-    clipper.AddPaths(input_clip,    ClipperLib::ptClip,    true);
-    // Perform the operation with the output to input_subject.
+    _clipper_add_paths(clipper, clipType, subject, true, clip, safety_offset_);
+    // Perform the operation with the output to output.
     // This pass does not generate a PolyTree, which is a very expensive operation with the current Clipper library
     // if there are overapping edges.
-    clipper.Execute(clipType, input_subject, fillType, fillType);
+    ClipperLib::Paths output;
+    clipper.Execute(clipType, output, fillType, fillType);
     // Perform an additional Union operation to generate the PolyTree ordering.
     clipper.Clear();
-    clipper.AddPaths(input_subject, ClipperLib::ptSubject, true);
+    clipper.AddPaths(output, ClipperLib::ptSubject, true);
     ClipperLib::PolyTree retval;
     clipper.Execute(ClipperLib::ctUnion, retval, fillType, fillType);
     return retval;
@@ -561,22 +608,9 @@ ClipperLib::PolyTree _clipper_do_pl(const ClipperLib::ClipType clipType, const P
     const Polygons &clip, const ClipperLib::PolyFillType fillType,
     const bool safety_offset_)
 {
-    // read input
-    ClipperLib::Paths input_subject = Slic3rMultiPoints_to_ClipperPaths(subject);
-    ClipperLib::Paths input_clip    = Slic3rMultiPoints_to_ClipperPaths(clip);
-    
-    // perform safety offset
-    if (safety_offset_) safety_offset(&input_clip);
-    
-    // init Clipper
     ClipperLib::Clipper clipper;
-    clipper.Clear();
-    
-    // add polygons
-    clipper.AddPaths(input_subject, ClipperLib::ptSubject, false);
-    clipper.AddPaths(input_clip,    ClipperLib::ptClip,    true);
-    
-    // perform operation
+    // The safety offset is never applied to the open subject.
+    _clipper_add_paths(clipper, ClipperLib::ctIntersection, subject, false, clip, safety_offset_);
     ClipperLib::PolyTree retval;
     clipper.Execute(clipType, retval, fillType, fillType);
     return retval;
@@ -584,7 +618,12 @@ ClipperLib::PolyTree _clipper_do_pl(const ClipperLib::ClipType clipType, const P
 
 Polygons _clipper(ClipperLib::ClipType clipType, const Polygons &subject, const Polygons &clip, bool safety_offset_)
 {
-    return ClipperPaths_to_Slic3rPolygons(_clipper_do<ClipperLib::Paths>(clipType, subject, clip, ClipperLib::pftNonZero, safety_offset_));
+    return _clipper_do_polygons(clipType, subject, clip, ClipperLib::pftNonZero, safety_offset_);
+}
+
+Polygons _clipper(ClipperLib::ClipType clipType, const ExPolygons &subject, const ExPolygons &clip, bool safety_offset_)
+{
+    return _clipper_do_polygons(clipType, subject, clip, ClipperLib::pftNonZero, safety_offset_);
 }
 
 ExPolygons _clipper_ex(ClipperLib::ClipType clipType, const Polygons &subject, const Polygons &clip, bool safety_offset_)
@@ -593,6 +632,12 @@ ExPolygons _clipper_ex(ClipperLib::ClipType clipType, const Polygons &subject, c
     return PolyTreeToExPolygons(polytree);
 }
 
+ExPolygons _clipper_ex(ClipperLib::ClipType clipType, const ExPolygons &subject, const ExPolygons &clip, bool safety_offset_)
+{
+    ClipperLib::PolyTree polytree = _clipper_do_polytree2(clipType, subject, clip, ClipperLib::pftNonZero, safety_offset_);
+    return PolyTreeToExPolygons(polytree);
+}
+
 Polylines _clipper_pl(ClipperLib::ClipType clipType, const Polylines &subject, const Polygons &clip, bool safety_offset_)
 {
     ClipperLib::Paths output;
@@ -670,22 +715,22 @@ _clipper_ln(ClipperLib::ClipType clipType, const Lines &subject, const Polygons
 
 ClipperLib::PolyTree union_pt(const Polygons &subject, bool safety_offset_)
 {
-    return _clipper_do<ClipperLib::PolyTree>(ClipperLib::ctUnion, subject, Polygons(), ClipperLib::pftEvenOdd, safety_offset_);
+    return _clipper_do_polytree(ClipperLib::ctUnion, subject, Polygons(), ClipperLib::pftEvenOdd, safety_offset_);
 }
 
 ClipperLib::PolyTree union_pt(const ExPolygons &subject, bool safety_offset_)
 {
-    return _clipper_do<ClipperLib::PolyTree>(ClipperLib::ctUnion, subject, Polygons(), ClipperLib::pftEvenOdd, safety_offset_);
+    return _clipper_do_polytree(ClipperLib::ctUnion, subject, Polygons(), ClipperLib::pftEvenOdd, safety_offset_);
 }
 
 ClipperLib::PolyTree union_pt(Polygons &&subject, bool safety_offset_)
 {
-    return _clipper_do<ClipperLib::PolyTree>(ClipperLib::ctUnion, std::move(subject), Polygons(), ClipperLib::pftEvenOdd, safety_offset_);
+    return _clipper_do_polytree(ClipperLib::ctUnion, subject, Polygons(), ClipperLib::pftEvenOdd, safety_offset_);
 }
 
 ClipperLib::PolyTree union_pt(ExPolygons &&subject, bool safety_offset_)
 {
-    return _clipper_do<ClipperLib::PolyTree>(ClipperLib::ctUnion, std::move(subject), Polygons(), ClipperLib::pftEvenOdd, safety_offset_);
+    return _clipper_do_polytree(ClipperLib::ctUnion, subject, Polygons(), ClipperLib::pftEvenOdd, safety_offset_);
 }
 
 // Simple spatial ordering of Polynodes
@@ -759,18 +804,15 @@ Polygons union_pt_chained(const Polygons &subject, bool safety_offset_)
 
 Polygons simplify_polygons(const Polygons &subject, bool preserve_collinear)
 {
-    // convert into Clipper polygons
-    ClipperLib::Paths input_subject = Slic3rMultiPoints_to_ClipperPaths(subject);
-    
     ClipperLib::Paths output;
     if (preserve_collinear) {
         ClipperLib::Clipper c;
         c.PreserveCollinear(true);
         c.StrictlySimple(true);
-        c.AddPaths(input_subject, ClipperLib::ptSubject, true);
+        c.AddPaths(ClipperUtils::PolygonsProvider(subject), ClipperLib::ptSubject, true);
         c.Execute(ClipperLib::ctUnion, output, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
     } else {
-        ClipperLib::SimplifyPolygons(input_subject, output, ClipperLib::pftNonZero);
+        ClipperLib::SimplifyPolygons(Slic3rMultiPoints_to_ClipperPaths(subject), output, ClipperLib::pftNonZero);
     }
     
     // convert into Slic3r polygons
@@ -782,15 +824,12 @@ ExPolygons simplify_polygons_ex(const Polygons &subject, bool preserve_collinear
     if (! preserve_collinear)
         return union_ex(simplify_polygons(subject, false));
 
-    // convert into Clipper polygons
-    ClipperLib::Paths input_subject = Slic3rMultiPoints_to_ClipperPaths(subject);
-    
     ClipperLib::PolyTree polytree;
     
     ClipperLib::Clipper c;
     c.PreserveCollinear(true);
     c.StrictlySimple(true);
-    c.AddPaths(input_subject, ClipperLib::ptSubject, true);
+    c.AddPaths(ClipperUtils::PolygonsProvider(subject), ClipperLib::ptSubject, true);
     c.Execute(ClipperLib::ctUnion, polytree, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
     
     // convert into ExPolygons
@@ -852,7 +891,7 @@ Polygons top_level_islands(const Slic3r::Polygons &polygons)
     ClipperLib::Clipper clipper;
     clipper.Clear();
     // perform union
-    clipper.AddPaths(Slic3rMultiPoints_to_ClipperPaths(polygons), ClipperLib::ptSubject, true);
+    clipper.AddPaths(ClipperUtils::PolygonsProvider(polygons), ClipperLib::ptSubject, true);
     ClipperLib::PolyTree polytree;
     clipper.Execute(ClipperLib::ctUnion, polytree, ClipperLib::pftEvenOdd, ClipperLib::pftEvenOdd); 
     // Convert only the top level islands to the output.
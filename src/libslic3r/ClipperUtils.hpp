@@ -42,19 +42,126 @@ Slic3r::Polygons   ClipperPaths_to_Slic3rPolygons(const ClipperLib::Paths &input
 Slic3r::Polylines  ClipperPaths_to_Slic3rPolylines(const ClipperLib::Paths &input);
 Slic3r::ExPolygons ClipperPaths_to_Slic3rExPolygons(const ClipperLib::Paths &input);
 
+// Slic3r::Point is fed into the templated ClipperLib::ClipperBase::AddPath(), ClipperLib::ClipperBase::AddPaths()
+// and ClipperLib::ClipperOffset::AddPath() directly, see ClipperLib::ToIntPoint().
+inline ClipperLib::IntPoint ToIntPoint(const Point &pt) { return ClipperLib::IntPoint(pt.x(), pt.y()); }
+
+namespace ClipperUtils {
+    // Path providers present the Slic3r containers to the Clipper library as ranges of Points,
+    // so that they are inserted into the Clipper engine without converting them to ClipperLib::Paths first.
+    template<typename MultiPointType>
+    class MultiPointsProvider {
+    public:
+        MultiPointsProvider(const std::vector<MultiPointType> &multipoints) : m_multipoints(multipoints) {}
+
+        class iterator {
+        public:
+            explicit iterator(typename std::vector<MultiPointType>::const_iterator it) : m_it(it) {}
+            const Points& operator*() const { return m_it->points; }
+            iterator& operator++() { ++ m_it; return *this; }
+            bool operator==(const iterator &rhs) const { return m_it == rhs.m_it; }
+            bool operator!=(const iterator &rhs) const { return m_it != rhs.m_it; }
+        private:
+            typename std::vector<MultiPointType>::const_iterator m_it;
+        };
+
+        iterator begin() const { return iterator(m_multipoints.cbegin()); }
+        iterator end()   const { return iterator(m_multipoints.cend()); }
+        size_t   size()  const { return m_multipoints.size(); }
+
+    private:
+        const std::vector<MultiPointType> &m_multipoints;
+    };
+
+    using PolygonsProvider  = MultiPointsProvider<Polygon>;
+    using PolylinesProvider = MultiPointsProvider<Polyline>;
+
+    // Contours and holes of ExPolygons, one ExPolygon after the other.
+    class ExPolygonsProvider {
+    public:
+        ExPolygonsProvider(const ExPolygons &expolygons) : m_expolygons(expolygons) {}
+
+        class iterator {
+        public:
+            explicit iterator(ExPolygons::const_iterator it) : m_it(it), m_idx_hole(-1) {}
+            const Points& operator*() const { return (m_idx_hole < 0) ? m_it->contour.points : m_it->holes[m_idx_hole].points; }
+            iterator& operator++() {
+                if (++ m_idx_hole == int(m_it->holes.size())) {
+                    ++ m_it;
+                    m_idx_hole = -1;
+                }
+                return *this;
+            }
+            bool operator==(const iterator &rhs) const { return m_it == rhs.m_it && m_idx_hole == rhs.m_idx_hole; }
+            bool operator!=(const iterator &rhs) const { return ! (*this == rhs); }
+        private:
+            ExPolygons::const_iterator m_it;
+            // -1 for the contour.
+            int                        m_idx_hole;
+        };
+
+        iterator begin() const { return iterator(m_expolygons.cbegin()); }
+        iterator end()   const { return iterator(m_expolygons.cend()); }
+
+    private:
+        const ExPolygons &m_expolygons;
+    };
+
+    // Points scaled by CLIPPER_OFFSET_SCALE on the fly, optionally traversed in reverse order,
+    // to be fed into ClipperLib::ClipperOffset without building a scaled copy of the input path.
+    class ScaledPath {
+    public:
+        ScaledPath(const Points &points, bool reversed = false) : m_points(points), m_reversed(reversed) {}
+        size_t size() const { return m_points.size(); }
+        ClipperLib::IntPoint operator[](size_t idx) const {
+            const Point &pt = m_points[m_reversed ? m_points.size() - idx - 1 : idx];
+            return ClipperLib::IntPoint(ClipperLib::cInt(pt.x()) << CLIPPER_OFFSET_POWER_OF_2, ClipperLib::cInt(pt.y()) << CLIPPER_OFFSET_POWER_OF_2);
+        }
+    private:
+        const Points &m_points;
+        bool          m_reversed;
+    };
+
+    // Wraps a path provider to provide ScaledPath instead of Points.
+    template<typename PathsProvider>
+    class ScaledPathsProvider {
+    public:
+        ScaledPathsProvider(const PathsProvider &provider) : m_provider(provider) {}
+
+        class iterator {
+        public:
+            explicit iterator(typename PathsProvider::iterator it) : m_it(it) {}
+            ScaledPath operator*() const { return ScaledPath(*m_it); }
+            iterator& operator++() { ++ m_it; return *this; }
+            bool operator==(const iterator &rhs) const { return m_it == rhs.m_it; }
+            bool operator!=(const iterator &rhs) const { return m_it != rhs.m_it; }
+        private:
+            typename PathsProvider::iterator m_it;
+        };
+
+        iterator begin() const { return iterator(m_provider.begin()); }
+        iterator end()   const { return iterator(m_provider.end()); }
+
+    private:
+        const PathsProvider &m_provider;
+    };
+}
+
 // offset Polygons
 ClipperLib::Paths _offset(ClipperLib::Path &&input, ClipperLib::EndType endType, const float delta, ClipperLib::JoinType joinType, double miterLimit);
 ClipperLib::Paths _offset(ClipperLib::Paths &&input, ClipperLib::EndType endType, const float delta, ClipperLib::JoinType joinType, double miterLimit);
+ClipperLib::Paths _offset(const Slic3r::Polygons &polygons, ClipperLib::EndType endType, const float delta, ClipperLib::JoinType joinType, double miterLimit);
+ClipperLib::Paths _offset(const Slic3r::Polylines &polylines, ClipperLib::EndType endType, const float delta, ClipperLib::JoinType joinType, double miterLimit);
 inline Slic3r::Polygons offset(const Slic3r::Polygon &polygon, const float delta, ClipperLib::JoinType joinType = ClipperLib::jtMiter,  double miterLimit = 3)
     { return ClipperPaths_to_Slic3rPolygons(_offset(Slic3rMultiPoint_to_ClipperPath(polygon), ClipperLib::etClosedPolygon, delta, joinType, miterLimit)); }
 inline Slic3r::Polygons offset(const Slic3r::Polygons &polygons, const float delta, ClipperLib::JoinType joinType = ClipperLib::jtMiter, double miterLimit = 3)
-    { return ClipperPaths_to_Slic3rPolygons(_offset(Slic3rMultiPoints_to_ClipperPaths(polygons), ClipperLib::etClosedPolygon, delta, joinType, miterLimit)); }
+    { return ClipperPaths_to_Slic3rPolygons(_offset(polygons, ClipperLib::etClosedPolygon, delta, joinType, miterLimit)); }
 
 // offset Polylines
 inline Slic3r::Polygons offset(const Slic3r::Polyline &polyline, const float delta, ClipperLib::JoinType joinType = ClipperLib::jtSquare, double miterLimit = 3)
     { return ClipperPaths_to_Slic3rPolygons(_offset(Slic3rMultiPoint_to_ClipperPath(polyline), ClipperLib::etOpenButt, delta, joinType, miterLimit)); }
 inline Slic3r::Polygons offset(const Slic3r::Polylines &polylines, const float delta, ClipperLib::JoinType joinType = ClipperLib::jtSquare, double miterLimit = 3)
-    { return ClipperPaths_to_Slic3rPolygons(_offset(Slic3rMultiPoints_to_ClipperPaths(polylines), ClipperLib::etOpenButt, delta, joinType, miterLimit)); }
+    { return ClipperPaths_to_Slic3rPolygons(_offset(polylines, ClipperLib::etOpenButt, delta, joinType, miterLimit)); }
 
 // offset expolygons and surfaces
 ClipperLib::Paths _offset(const Slic3r::ExPolygon &expolygon, const float delta, ClipperLib::JoinType joinType, double miterLimit);
@@ -66,7 +173,7 @@ inline Slic3r::Polygons offset(const Slic3r::ExPolygons &expolygons, const float
 inline Slic3r::ExPolygons offset_ex(const Slic3r::Polygon &polygon, const float delta, ClipperLib::JoinType joinType = ClipperLib::jtMiter, double miterLimit = 3)
     { return ClipperPaths_to_Slic3rExPolygons(_offset(Slic3rMultiPoint_to_ClipperPath(polygon), ClipperLib::etClosedPolygon, delta, joinType, miterLimit)); }    
 inline Slic3r::ExPolygons offset_ex(const Slic3r::Polygons &polygons, const float delta, ClipperLib::JoinType joinType = ClipperLib::jtMiter, double miterLimit = 3)
-    { return ClipperPaths_to_Slic3rExPolygons(_offset(Slic3rMultiPoints_to_ClipperPaths(polygons), ClipperLib::etClosedPolygon, delta, joinType, miterLimit)); }
+    { return ClipperPaths_to_Slic3rExPolygons(_offset(polygons, ClipperLib::etClosedPolygon, delta, joinType, miterLimit)); }
 inline Slic3r::ExPolygons offset_ex(const Slic3r::ExPolygon &expolygon, const float delta, ClipperLib::JoinType joinType = ClipperLib::jtMiter, double miterLimit = 3)
     { return ClipperPaths_to_Slic3rExPolygons(_offset(expolygon, delta, joinType, miterLimit)); }
 inline Slic3r::ExPolygons offset_ex(const Slic3r::ExPolygons &expolygons, const float delta, ClipperLib::JoinType joinType = ClipperLib::jtMiter, double miterLimit = 3)
@@ -87,8 +194,12 @@ Slic3r::ExPolygons offset2_ex(const Slic3r::ExPolygons &expolygons, const float
 
 Slic3r::Polygons _clipper(ClipperLib::ClipType clipType,
     const Slic3r::Polygons &subject, const Slic3r::Polygons &clip, bool safety_offset_ = false);
+Slic3r::Polygons _clipper(ClipperLib::ClipType clipType,
+    const Slic3r::ExPolygons &subject, const Slic3r::ExPolygons &clip, bool safety_offset_ = false);
 Slic3r::ExPolygons _clipper_ex(ClipperLib::ClipType clipType,
     const Slic3r::Polygons &subject, const Slic3r::Polygons &clip, bool safety_offset_ = false);
+Slic3r::ExPolygons _clipper_ex(ClipperLib::ClipType clipType,
+    const Slic3r::ExPolygons &subject, const Slic3r::ExPolygons &clip, bool safety_offset_ = false);
 Slic3r::Polylines _clipper_pl(ClipperLib::ClipType clipType,
     const Slic3r::Polylines &subject, const Slic3r::Polygons &clip, bool safety_offset_ = false);
 Slic3r::Polylines _clipper_pl(ClipperLib::ClipType clipType,
@@ -112,13 +223,13 @@ diff_ex(const Slic3r::Polygons &subject, const Slic3r::Polygons &clip, bool safe
 inline Slic3r::ExPolygons
 diff_ex(const Slic3r::ExPolygons &subject, const Slic3r::ExPolygons &clip, bool safety_offset_ = false)
 {
-    return _clipper_ex(ClipperLib::ctDifference, to_polygons(subject), to_polygons(clip), safety_offset_);
+    return _clipper_ex(ClipperLib::ctDifference, subject, clip, safety_offset_);
 }
 
 inline Slic3r::Polygons
 diff(const Slic3r::ExPolygons &subject, const Slic3r::ExPolygons &clip, bool safety_offset_ = false)
 {
-    return _clipper(ClipperLib::ctDifference, to_polygons(subject), to_polygons(clip), safety_offset_);
+    return _clipper(ClipperLib::ctDifference, subject, clip, safety_offset_);
 }
 
 inline Slic3r::Polylines
@@ -155,13 +266,13 @@ intersection_ex(const Slic3r::Polygons &subject, const Slic3r::Polygons &clip, b
 inline Slic3r::ExPolygons
 intersection_ex(const Slic3r::ExPolygons &subject, const Slic3r::ExPolygons &clip, bool safety_offset_ = false)
 {
-    return _clipper_ex(ClipperLib::ctIntersection, to_polygons(subject), to_polygons(clip), safety_offset_);
+    return _clipper_ex(ClipperLib::ctIntersection, subject, clip, safety_offset_);
 }
 
 inline Slic3r::Polygons
 intersection(const Slic3r::ExPolygons &subject, const Slic3r::ExPolygons &clip, bool safety_offset_ = false)
 {
-    return _clipper(ClipperLib::ctIntersection, to_polygons(subject), to_polygons(clip), safety_offset_);
+    return _clipper(ClipperLib::ctIntersection, subject, clip, safety_offset_);
 }
 
 inline Slic3r::Polylines
@@ -206,7 +317,7 @@ inline Slic3r::ExPolygons union_ex(const Slic3r::Polygons &subject, bool safety_
 
 inline Slic3r::ExPolygons union_ex(const Slic3r::ExPolygons &subject, bool safety_offset_ = false)
 {
-    return _clipper_ex(ClipperLib::ctUnion, to_polygons(subject), Slic3r::Polygons(), safety_offset_);
+    return _clipper_ex(ClipperLib::ctUnion, subject, Slic3r::ExPolygons(), safety_offset_);
 }
 
 inline Slic3r::ExPolygons union_ex(const Slic3r::Surfaces &subject, bool safety_offset_ = false)
@@ -0,0 +1,279 @@
+#include "ConfigBundleCache.hpp"
+#include "libslic3r_version.h"
+
+#include <cstdint>
+#include <cstring>
+
+#include <boost/crc.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/format.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/nowide/fstream.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+namespace Slic3r {
+namespace ConfigBundleCache {
+
+namespace fs = boost::filesystem;
+namespace ip = boost::interprocess;
+namespace pt = boost::property_tree;
+
+// Increase when the layout of the snapshot changes.
+static constexpr uint32_t FORMAT_VERSION = 2;
+static constexpr char     MAGIC[4]       = { 'P', 'S', 'C', 'B' };
+
+// Key of the source config bundle, stored at the start of the snapshot.
+struct SourceKey
+{
+    uint64_t size  = 0;
+    int64_t  mtime = 0;
+    uint32_t crc32 = 0;
+};
+
+static bool source_size_mtime(const fs::path &source_path, SourceKey &key)
+{
+    boost::system::error_code ec;
+    key.size  = uint64_t(fs::file_size(source_path, ec));
+    if (ec)
+        return false;
+    key.mtime = int64_t(fs::last_write_time(source_path, ec));
+    return ! ec;
+}
+
+static bool source_crc32(const fs::path &source_path, SourceKey &key)
+{
+    boost::crc_32_type crc;
+    if (key.size > 0) {
+        try {
+            ip::file_mapping  mapping(source_path.string().c_str(), ip::read_only);
+            ip::mapped_region region(mapping, ip::read_only);
+            crc.process_bytes(region.get_address(), region.get_size());
+        } catch (const std::exception &) {
+            return false;
+        }
+    }
+    key.crc32 = crc.checksum();
+    return true;
+}
+
+fs::path cache_file_path(const fs::path &cache_dir, const fs::path &source_path)
+{
+    // Bundles of the same name may be loaded from different directories (the vendor directory, the resources),
+    // thus the name of the snapshot is made unique by a hash of the source path.
+    std::string        source = fs::absolute(source_path).generic_string();
+    boost::crc_32_type crc;
+    crc.process_bytes(source.data(), source.size());
+    return cache_dir / (boost::format("%1%-%2$08x.bundle") % source_path.stem().string() % crc.checksum()).str();
+}
+
+// Reader of the memory mapped snapshot with bounds checking.
+class Reader
+{
+public:
+    Reader(const char *begin, const char *end) : m_ptr(begin), m_end(end) {}
+
+    bool ok() const { return m_ok; }
+
+    template<typename T> T read_pod() {
+        T out {};
+        if (m_ok && size_t(m_end - m_ptr) >= sizeof(T)) {
+            memcpy(&out, m_ptr, sizeof(T));
+            m_ptr += sizeof(T);
+        } else
+            m_ok = false;
+        return out;
+    }
+
+    std::string read_string() {
+        uint32_t len = this->read_pod<uint32_t>();
+        if (! m_ok || size_t(m_end - m_ptr) < len) {
+            m_ok = false;
+            return std::string();
+        }
+        std::string out(m_ptr, len);
+        m_ptr += len;
+        return out;
+    }
+
+    void read_tree(pt::ptree &tree) {
+        tree.data() = this->read_string();
+        uint32_t num_children = this->read_pod<uint32_t>();
+        for (uint32_t i = 0; m_ok && i < num_children; ++ i) {
+            std::string key = this->read_string();
+            this->read_tree(tree.push_back(std::make_pair(std::move(key), pt::ptree()))->second);
+        }
+    }
+
+    bool at_end() const { return m_ptr == m_end; }
+
+private:
+    const char *m_ptr;
+    const char *m_end;
+    bool        m_ok { true };
+};
+
+template<typename T> static void write_pod(std::string &out, const T &value)
+{
+    out.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+static void write_string(std::string &out, const std::string &str)
+{
+    write_pod(out, uint32_t(str.size()));
+    out += str;
+}
+
+static void write_tree(std::string &out, const pt::ptree &tree)
+{
+    write_string(out, tree.data());
+    write_pod(out, uint32_t(tree.size()));
+    for (const auto &child : tree) {
+        write_string(out, child.first);
+        write_tree(out, child.second);
+    }
+}
+
+// Header of the snapshot: format, PrusaSlicer version, the source path and the key of the source.
+struct Header
+{
+    std::string source_path;
+    SourceKey   source_key;
+};
+
+static bool read_header(Reader &reader, Header &header)
+{
+    char magic[4];
+    for (char &c : magic)
+        c = reader.read_pod<char>();
+    if (! reader.ok() || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 ||
+        reader.read_pod<uint32_t>() != FORMAT_VERSION ||
+        reader.read_string() != SLIC3R_VERSION)
+        return false;
+    header.source_path      = reader.read_string();
+    header.source_key.size  = reader.read_pod<uint64_t>();
+    header.source_key.mtime = reader.read_pod<int64_t>();
+    header.source_key.crc32 = reader.read_pod<uint32_t>();
+    return reader.ok();
+}
+
+static void write_snapshot(const fs::path &cache_path, const fs::path &source_path, const SourceKey &source_key, const pt::ptree &tree)
+{
+    std::string out;
+    out.append(MAGIC, sizeof(MAGIC));
+    write_pod(out, FORMAT_VERSION);
+    write_string(out, SLIC3R_VERSION);
+    write_string(out, fs::absolute(source_path).generic_string());
+    write_pod(out, source_key.size);
+    write_pod(out, source_key.mtime);
+    write_pod(out, source_key.crc32);
+    write_tree(out, tree);
+
+    // Write into a temporary file first, so that a concurrently running instance never maps a partially written snapshot.
+    fs::path path_tmp = cache_path;
+    path_tmp += ".tmp";
+    try {
+        fs::create_directories(cache_path.parent_path());
+        {
+            boost::nowide::ofstream f(path_tmp.string(), std::ios::out | std::ios::binary | std::ios::trunc);
+            f.write(out.data(), out.size());
+            f.close();
+            if (f.fail())
+                throw std::runtime_error("write failed");
+        }
+        fs::rename(path_tmp, cache_path);
+    } catch (const std::exception &err) {
+        BOOST_LOG_TRIVIAL(warning) << "Failed to save config bundle cache " << cache_path.string() << ": " << err.what();
+        boost::system::error_code ec;
+        fs::remove(path_tmp, ec);
+    }
+}
+
+// Remove the snapshots of bundles of the same name as source_path, which will never be loaded again:
+// Snapshots written by a different PrusaSlicer version or format, snapshots of source files, which were removed or moved,
+// and snapshots of source files, which were modified since.
+static void prune_superseded(const fs::path &cache_path, const fs::path &source_path)
+{
+    const std::string prefix = source_path.stem().string() + "-";
+    boost::system::error_code ec;
+    for (fs::directory_iterator it(cache_path.parent_path(), ec), end; ! ec && it != end; it.increment(ec)) {
+        const fs::path    path = it->path();
+        const std::string name = path.filename().string();
+        if (path == cache_path || path.extension() != ".bundle" || name.compare(0, prefix.size(), prefix) != 0 ||
+            // The stem of another bundle may start with our stem followed by a dash.
+            name.size() != prefix.size() + 8 + 7)
+            continue;
+        bool superseded = true;
+        try {
+            ip::file_mapping  mapping(path.string().c_str(), ip::read_only);
+            ip::mapped_region region(mapping, ip::read_only);
+            const char *begin = static_cast<const char*>(region.get_address());
+            Reader      reader(begin, begin + region.get_size());
+            Header      header;
+            SourceKey   source_key;
+            superseded = ! read_header(reader, header) || ! source_size_mtime(header.source_path, source_key) ||
+                source_key.size != header.source_key.size || source_key.mtime != header.source_key.mtime;
+        } catch (const std::exception &) {
+        }
+        if (superseded) {
+            boost::system::error_code ec_remove;
+            if (fs::remove(path, ec_remove))
+                BOOST_LOG_TRIVIAL(debug) << "Removed superseded config bundle cache " << path.string();
+        }
+    }
+}
+
+bool load(const fs::path &cache_path, const fs::path &source_path, pt::ptree &tree)
+{
+    tree.clear();
+    SourceKey source_key;
+    if (! fs::exists(cache_path) || ! source_size_mtime(source_path, source_key))
+        return false;
+
+    // Set if the source was touched without being modified, the snapshot is refreshed with the new modification time then.
+    bool refresh = false;
+    bool loaded  = false;
+    try {
+        ip::file_mapping  mapping(cache_path.string().c_str(), ip::read_only);
+        ip::mapped_region region(mapping, ip::read_only);
+        const char *begin = static_cast<const char*>(region.get_address());
+        Reader      reader(begin, begin + region.get_size());
+        Header      header;
+        if (! read_header(reader, header) || header.source_key.size != source_key.size)
+            return false;
+        if (header.source_key.mtime != source_key.mtime) {
+            // Matching size and modification time validate the snapshot. Only if the source file was touched
+            // (copied, checked out or reinstalled), fall back to comparing the CRC of its content.
+            if (! source_crc32(source_path, source_key) || header.source_key.crc32 != source_key.crc32)
+                return false;
+            refresh = true;
+        }
+        reader.read_tree(tree);
+        loaded = reader.ok() && reader.at_end();
+        if (! loaded)
+            BOOST_LOG_TRIVIAL(warning) << "Config bundle cache " << cache_path.string() << " is damaged, it will be rebuilt.";
+    } catch (const std::exception &err) {
+        BOOST_LOG_TRIVIAL(warning) << "Failed to load config bundle cache " << cache_path.string() << ": " << err.what();
+    }
+    if (! loaded) {
+        tree.clear();
+        return false;
+    }
+    if (refresh)
+        // The snapshot is no more mapped here, thus it may be replaced.
+        write_snapshot(cache_path, source_path, source_key, tree);
+    return true;
+}
+
+void save(const fs::path &cache_path, const fs::path &source_path, const pt::ptree &tree)
+{
+    SourceKey source_key;
+    if (! source_size_mtime(source_path, source_key) || ! source_crc32(source_path, source_key))
+        return;
+    write_snapshot(cache_path, source_path, source_key, tree);
+    prune_superseded(cache_path, source_path);
+}
+
+} // namespace ConfigBundleCache
+} // namespace Slic3r
@@ -0,0 +1,37 @@
+#ifndef slic3r_ConfigBundleCache_hpp_
+#define slic3r_ConfigBundleCache_hpp_
+
+#include <string>
+
+#include <boost/filesystem/path.hpp>
+#include <boost/property_tree/ptree_fwd.hpp>
+
+namespace Slic3r {
+
+// Binary snapshot of a config bundle (a vendor INI file) after it has been parsed and flattened
+// by PresetBundle::load_configbundle(). Loading the snapshot skips boost::property_tree::read_ini()
+// and the resolution of the preset inheritance, which dominate the start up time with large vendor bundles.
+//
+// The snapshot is valid for a single source file only. It is keyed by the format version, the PrusaSlicer version
+// (the flattening rules may change between versions), the source file size and its modification time.
+// The CRC32 of the source is only compared if the source was touched without changing its size.
+// The snapshot is memory mapped when loaded.
+namespace ConfigBundleCache {
+
+    // Path of the snapshot of a source config bundle inside the cache directory.
+    boost::filesystem::path cache_file_path(const boost::filesystem::path &cache_dir, const boost::filesystem::path &source_path);
+
+    // Load the flattened property tree of source_path from the snapshot at cache_path.
+    // Returns false if the snapshot does not exist, if it is stale or if it is damaged, tree is left empty in that case.
+    bool load(const boost::filesystem::path &cache_path, const boost::filesystem::path &source_path, boost::property_tree::ptree &tree);
+
+    // Store the flattened property tree of source_path into the snapshot at cache_path, creating the cache directory if needed.
+    // Snapshots of a bundle of the same name, which were superseded (the source was moved or modified), are removed.
+    // Failure to write the snapshot is not an error, it is just logged.
+    void save(const boost::filesystem::path &cache_path, const boost::filesystem::path &source_path, const boost::property_tree::ptree &tree);
+
+} // namespace ConfigBundleCache
+
+} // namespace Slic3r
+
+#endif /* slic3r_ConfigBundleCache_hpp_ */
@@ -2,6 +2,8 @@
 #include <stdio.h>
 #include <memory>
 
+#include <tbb/parallel_for.h>
+
 #include "../ClipperUtils.hpp"
 #include "../Geometry.hpp"
 #include "../Layer.hpp"
@@ -354,8 +356,8 @@ void Layer::make_fills(FillAdaptive::Octree* adaptive_fill_octree, FillAdaptive:
 	}
 #endif /* SLIC3R_DEBUG_SLICE_PROCESSING */
 
-    for (SurfaceFill &surface_fill : surface_fills) {
-        // Create the filler object.
+    // Create the filler object.
+    auto new_filler = [this, &bbox, adaptive_fill_octree, support_fill_octree](const SurfaceFill &surface_fill) {
         std::unique_ptr<Fill> f = std::unique_ptr<Fill>(Fill::new_from_type(surface_fill.params.pattern));
         f->set_bounding_box(bbox);
         f->layer_id = this->id();
@@ -364,7 +366,6 @@ void Layer::make_fills(FillAdaptive::Octree* adaptive_fill_octree, FillAdaptive:
         f->adapt_fill_octree = (surface_fill.params.pattern == ipSupportCubic) ? support_fill_octree : adaptive_fill_octree;
 
         // calculate flow spacing for infill pattern generation
-        bool using_internal_flow = ! surface_fill.surface.is_solid() && ! surface_fill.params.flow.bridge;
         double link_max_length = 0.;
         if (! surface_fill.params.flow.bridge) {
 #if 0
@@ -380,49 +381,81 @@ void Layer::make_fills(FillAdaptive::Octree* adaptive_fill_octree, FillAdaptive:
         f->link_max_length = (coord_t)scale_(link_max_length);
         // Used by the concentric infill pattern to clip the loops to create extrusion paths.
         f->loop_clipping = coord_t(scale_(surface_fill.params.flow.nozzle_diameter) * LOOP_CLIPPING_LENGTH_OVER_NOZZLE_DIAMETER);
-
-        // apply half spacing using this flow's own spacing and generate infill
-        FillParams params;
-        params.density 		     = float(0.01 * surface_fill.params.density);
-        params.dont_adjust 	     = surface_fill.params.dont_adjust; // false
-        params.anchor_length     = surface_fill.params.anchor_length;
-		params.anchor_length_max = surface_fill.params.anchor_length_max;
-
-        for (ExPolygon &expoly : surface_fill.expolygons) {
-			// Spacing is modified by the filler to indicate adjustments. Reset it for each expolygon.
-			f->spacing = surface_fill.params.spacing;
-			surface_fill.surface.expolygon = std::move(expoly);
-			Polylines polylines;
-			try {
-				polylines = f->fill_surface(&surface_fill.surface, params);
-			} catch (InfillFailedException &) {
-			}
-	        if (! polylines.empty()) {
-		        // calculate actual flow from spacing (which might have been adjusted by the infill
-		        // pattern generator)
-		        double flow_mm3_per_mm = surface_fill.params.flow.mm3_per_mm();
-		        double flow_width      = surface_fill.params.flow.width;
-		        if (using_internal_flow) {
-		            // if we used the internal flow we're not doing a solid infill
-		            // so we can safely ignore the slight variation that might have
-		            // been applied to f->spacing
-		        } else {
-		            Flow new_flow = Flow::new_from_spacing(float(f->spacing), surface_fill.params.flow.nozzle_diameter, surface_fill.params.flow.height, surface_fill.params.flow.bridge);
-		        	flow_mm3_per_mm = new_flow.mm3_per_mm();
-		        	flow_width      = new_flow.width;
-		        }
-		        // Save into layer.
-				ExtrusionEntityCollection* eec = nullptr;
-		        m_regions[surface_fill.region_id]->fills.entities.push_back(eec = new ExtrusionEntityCollection());
-		        // Only concentric fills are not sorted.
-		        eec->no_sort = f->no_sort();
-		        extrusion_entities_append_paths(
-		            eec->entities, std::move(polylines),
-		            surface_fill.params.extrusion_role,
-		            flow_mm3_per_mm, float(flow_width), surface_fill.params.flow.height);
-		    }
-		}
-    }
+        return f;
+    };
+
+    // One task per ExPolygon of each SurfaceFill. Layers are already filled in parallel by PrintObject::infill(),
+    // the tasks of a single layer are nested into that loop, thus a layer with just a few large surfaces
+    // (short and wide objects) does not leave the other cores idle.
+    struct FillTask {
+        SurfaceFill *surface_fill;
+        ExPolygon   *expolygon;
+        // Output of the infill generator.
+        Polylines    polylines;
+        // Spacing, which might have been adjusted by the infill generator.
+        double       spacing { 0. };
+        bool         no_sort { false };
+    };
+    std::vector<FillTask> fill_tasks;
+    for (SurfaceFill &surface_fill : surface_fills)
+        for (ExPolygon &expoly : surface_fill.expolygons)
+            fill_tasks.push_back({ &surface_fill, &expoly });
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, fill_tasks.size(), 1),
+        [&fill_tasks, &new_filler](const tbb::blocked_range<size_t> &range) {
+        for (size_t task_idx = range.begin(); task_idx < range.end(); ++ task_idx) {
+            FillTask              &task         = fill_tasks[task_idx];
+            const SurfaceFill     &surface_fill = *task.surface_fill;
+            std::unique_ptr<Fill>  f            = new_filler(surface_fill);
+
+            // apply half spacing using this flow's own spacing and generate infill
+            FillParams params;
+            params.density 		     = float(0.01 * surface_fill.params.density);
+            params.dont_adjust 	     = surface_fill.params.dont_adjust; // false
+            params.anchor_length     = surface_fill.params.anchor_length;
+            params.anchor_length_max = surface_fill.params.anchor_length_max;
+
+            // Spacing is modified by the filler to indicate adjustments.
+            f->spacing = surface_fill.params.spacing;
+            Surface surface(surface_fill.surface);
+            surface.expolygon = std::move(*task.expolygon);
+            try {
+                task.polylines = f->fill_surface(&surface, params);
+            } catch (InfillFailedException &) {
+            }
+            task.spacing = f->spacing;
+            task.no_sort = f->no_sort();
+        }
+    });
+
+    // Save into layer in the order of the SurfaceFills and their ExPolygons, independent of the order the tasks were finished.
+    for (FillTask &task : fill_tasks)
+        if (! task.polylines.empty()) {
+            const SurfaceFill &surface_fill = *task.surface_fill;
+            bool using_internal_flow = ! surface_fill.surface.is_solid() && ! surface_fill.params.flow.bridge;
+	        // calculate actual flow from spacing (which might have been adjusted by the infill
+	        // pattern generator)
+	        double flow_mm3_per_mm = surface_fill.params.flow.mm3_per_mm();
+	        double flow_width      = surface_fill.params.flow.width;
+	        if (using_internal_flow) {
+	            // if we used the internal flow we're not doing a solid infill
+	            // so we can safely ignore the slight variation that might have
+	            // been applied to f->spacing
+	        } else {
+	            Flow new_flow = Flow::new_from_spacing(float(task.spacing), surface_fill.params.flow.nozzle_diameter, surface_fill.params.flow.height, surface_fill.params.flow.bridge);
+	        	flow_mm3_per_mm = new_flow.mm3_per_mm();
+	        	flow_width      = new_flow.width;
+	        }
+	        // Save into layer.
+			ExtrusionEntityCollection* eec = nullptr;
+	        m_regions[surface_fill.region_id]->fills.entities.push_back(eec = new ExtrusionEntityCollection());
+	        // Only concentric fills are not sorted.
+	        eec->no_sort = task.no_sort;
+	        extrusion_entities_append_paths(
+	            eec->entities, std::move(task.polylines),
+	            surface_fill.params.extrusion_role,
+	            flow_mm3_per_mm, float(flow_width), surface_fill.params.flow.height);
+	    }
 
     // add thin fill regions
     // Unpacks the collection, creates multiple collections per path.
@@ -753,6 +753,30 @@ enum DirectionMask
     DIR_BACKWARD = 2
 };
 
+// Indices of the first and last of the equally spaced vertical lines x0 + i * line_spacing intersected by a segment
+// spanning <l, r> along the x axis. Returns il > ir if no vertical line is intersected.
+static inline std::pair<int, int> vertical_lines_spanned(coord_t l, coord_t r, coord_t x0, coord_t line_spacing, int n_vlines)
+{
+    assert(l <= r);
+    assert(line_spacing > 0);
+    // il = ceil((l - x0) / line_spacing), ir = floor((r - x0) / line_spacing), both rounding correctly for negative numerators.
+    int64_t dl = int64_t(l) - int64_t(x0);
+    int64_t dr = int64_t(r) - int64_t(x0);
+    int64_t il = dl / line_spacing;
+    if (il * line_spacing < dl)
+        ++ il;
+    int64_t ir = dr / line_spacing;
+    if (ir * line_spacing > dr)
+        -- ir;
+    return std::make_pair(int(std::max<int64_t>(0, il)), int(std::min<int64_t>(n_vlines - 1, ir)));
+}
+
+// Intersect the contours of poly_with_offset with n_vlines equally spaced vertical lines starting at x0.
+// The contour segments are swept in two passes: The first pass buckets the segment start / end events by the vertical line index
+// and accumulates the events into an upper bound of the number of intersections per vertical line, so that the intersection
+// vectors are allocated exactly once. The second pass emits the intersections in the same contour / segment order as
+// a naive per segment / per line loop would, so the sorting and classification below produce identical results.
+// The y coordinate of the intersection is evaluated incrementally along a segment using exact 64bit integer arithmetic.
 static std::vector<SegmentedIntersectionLine> slice_region_by_vertical_lines(const ExPolygonWithOffset &poly_with_offset, size_t n_vlines, coord_t x0, coord_t line_spacing)
 {
     // Allocate storage for the segments.
@@ -761,82 +785,115 @@ static std::vector<SegmentedIntersectionLine> slice_region_by_vertical_lines(con
         segs[i].idx = i;
         segs[i].pos = x0 + i * line_spacing;
     }
-    // For each contour
+    if (n_vlines == 0)
+        return segs;
+
+    // First pass: Count the segment start / end events at each vertical line, cache the span of vertical lines for each segment.
+    // Spans of the contour segments, indexed by the contour segment in the order of contours.
+    std::vector<std::pair<int, int>> spans;
+    {
+        size_t n_segments = 0;
+        for (size_t iContour = 0; iContour < poly_with_offset.n_contours; ++ iContour)
+            if (const Points &contour = poly_with_offset.contour(iContour).points; contour.size() >= 2)
+                n_segments += contour.size();
+        spans.reserve(n_segments);
+    }
+    // Number of segments starting at a vertical line minus the number of segments ending just before the vertical line.
+    std::vector<int> events(n_vlines + 1, 0);
+    for (size_t iContour = 0; iContour < poly_with_offset.n_contours; ++ iContour) {
+        const Points &contour = poly_with_offset.contour(iContour).points;
+        if (contour.size() < 2)
+            continue;
+        const Point *p1 = &contour.back();
+        for (const Point &p2 : contour) {
+            std::pair<int, int> span = vertical_lines_spanned(std::min(p1->x(), p2.x()), std::max(p1->x(), p2.x()), x0, line_spacing, int(n_vlines));
+            spans.emplace_back(span);
+            if (span.first <= span.second) {
+                ++ events[span.first];
+                -- events[span.second + 1];
+            }
+            p1 = &p2;
+        }
+    }
+    // Sweep the events to reserve the intersection vectors.
+    int cnt = 0;
+    for (size_t i = 0; i < n_vlines; ++ i) {
+        cnt += events[i];
+        segs[i].intersections.reserve(cnt);
+    }
+    events.clear();
+    events.shrink_to_fit();
+
+    // Second pass: Emit the intersections.
+    auto it_span = spans.begin();
     for (size_t iContour = 0; iContour < poly_with_offset.n_contours; ++ iContour) {
         const Points &contour = poly_with_offset.contour(iContour).points;
         if (contour.size() < 2)
             continue;
+        const bool outer = poly_with_offset.is_contour_outer(iContour);
         // For each segment
-        for (size_t iSegment = 0; iSegment < contour.size(); ++ iSegment) {
-            size_t iPrev = ((iSegment == 0) ? contour.size() : iSegment) - 1;
-            const Point &p1 = contour[iPrev];
-            const Point &p2 = contour[iSegment];
-            // Which of the equally spaced vertical lines is intersected by this segment?
-            coord_t l = p1(0);
-            coord_t r = p2(0);
-            if (l > r)
-                std::swap(l, r);
-            // il, ir are the left / right indices of vertical lines intersecting a segment
-            int il = (l - x0) / line_spacing;
-            while (il * line_spacing + x0 < l)
-                ++ il;
-            il = std::max(int(0), il);
-            int ir = (r - x0 + line_spacing) / line_spacing;
-            while (ir * line_spacing + x0 > r)
-                -- ir;
-            ir = std::min(int(segs.size()) - 1, ir);
+        for (size_t iSegment = 0; iSegment < contour.size(); ++ iSegment, ++ it_span) {
+            const int il = it_span->first;
+            const int ir = it_span->second;
             if (il > ir)
                 // No vertical line intersects this segment.
                 continue;
             assert(il >= 0 && size_t(il) < segs.size());
             assert(ir >= 0 && size_t(ir) < segs.size());
-            for (int i = il; i <= ir; ++ i) {
+            size_t iPrev = ((iSegment == 0) ? contour.size() : iSegment) - 1;
+            const Point &p1 = contour[iPrev];
+            const Point &p2 = contour[iSegment];
+            if (p1.x() == p2.x())
+                // Ignore strictly vertical segments.
+                continue;
+            // Orientation of the segment, classify the intersection points.
+            const bool low = p2.x() > p1.x();
+            SegmentIntersection is;
+            is.iContour = iContour;
+            is.iSegment = iSegment;
+            is.type     = outer ?
+                (low ? SegmentIntersection::OUTER_LOW : SegmentIntersection::OUTER_HIGH) :
+                (low ? SegmentIntersection::INNER_LOW : SegmentIntersection::INNER_HIGH);
+            // Intersection parameter 't' as a rational number with non negative denominator: t = (this_x - p1.x) / (p2.x - p1.x).
+            // The nominator of the intersection point y = (p1.y * q + t_p * (p2.y - p1.y)) / q is linear in this_x,
+            // thus it is advanced by a constant step from one vertical line to the next.
+            const uint32_t q       = uint32_t(low ? p2.x() - p1.x() : p1.x() - p2.x());
+            const int64_t  dy      = int64_t(p2.y() - p1.y());
+            const coord_t  this_x0 = segs[il].pos;
+            const int64_t  t0      = low ? int64_t(this_x0 - p1.x()) : int64_t(p1.x() - this_x0);
+            const int64_t  step    = low ? int64_t(line_spacing) * dy : - int64_t(line_spacing) * dy;
+            int64_t        pos_p   = t0 * dy + int64_t(p1.y()) * int64_t(q);
+            for (int i = il; i <= ir; ++ i, pos_p += step) {
                 coord_t this_x = segs[i].pos;
-				assert(this_x == i * line_spacing + x0);
-                SegmentIntersection is;
-                is.iContour = iContour;
-                is.iSegment = iSegment;
-                assert(l <= this_x);
-                assert(r >= this_x);
+                assert(this_x == i * line_spacing + x0);
+                assert(std::min(p1.x(), p2.x()) <= this_x);
+                assert(std::max(p1.x(), p2.x()) >= this_x);
                 // Calculate the intersection position in y axis. x is known.
-                if (p1(0) == this_x) {
-                    if (p2(0) == this_x) {
-                        // Ignore strictly vertical segments.
-                        continue;
-                    }
-                    is.pos_p = p1(1);
+                if (p1.x() == this_x) {
+                    is.pos_p = p1.y();
                     is.pos_q = 1;
-                } else if (p2(0) == this_x) {
-                    is.pos_p = p2(1);
+                } else if (p2.x() == this_x) {
+                    is.pos_p = p2.y();
                     is.pos_q = 1;
                 } else {
-                    // First calculate the intersection parameter 't' as a rational number with non negative denominator.
-                    if (p2(0) > p1(0)) {
-                        is.pos_p = this_x - p1(0);
-                        is.pos_q = p2(0) - p1(0);
-                    } else {
-                        is.pos_p = p1(0) - this_x;
-                        is.pos_q = p1(0) - p2(0);
-                    }
-                    assert(is.pos_p >= 0 && is.pos_p <= is.pos_q);
-                    // Make an intersection point from the 't'.
-                    is.pos_p *= int64_t(p2(1) - p1(1));
-                    is.pos_p += p1(1) * int64_t(is.pos_q);
+                    is.pos_p = pos_p;
+                    is.pos_q = q;
                 }
                 // +-1 to take rounding into account.
-                assert(is.pos() + 1 >= std::min(p1(1), p2(1)));
-                assert(is.pos() <= std::max(p1(1), p2(1)) + 1);
+                assert(is.pos() + 1 >= std::min(p1.y(), p2.y()));
+                assert(is.pos() <= std::max(p1.y(), p2.y()) + 1);
                 segs[i].intersections.push_back(is);
             }
         }
     }
+    assert(it_span == spans.end());
 
-    // Sort the intersections along their segments, specify the intersection types.
+    // Sort the intersections along their segments, remove duplicate or overlapping intersection points.
     for (size_t i_seg = 0; i_seg < segs.size(); ++ i_seg) {
         SegmentedIntersectionLine &sil = segs[i_seg];
         // Sort the intersection points using exact rational arithmetic.
         std::sort(sil.intersections.begin(), sil.intersections.end());
-        // Assign the intersection types, remove duplicate or overlapping intersection points.
+        // Remove duplicate or overlapping intersection points, the intersection types were assigned when emitting the intersections.
         // When a loop vertex touches a vertical line, intersection point is generated for both segments.
         // If such two segments are oriented equally, then one of them is removed.
         // Otherwise the vertex is tangential to the vertical line and both segments are removed.
@@ -845,15 +902,12 @@ static std::vector<SegmentedIntersectionLine> slice_region_by_vertical_lines(con
         size_t j = 0;
         for (size_t i = 0; i < sil.intersections.size(); ++ i) {
             // What is the orientation of the segment at the intersection point?
-            size_t iContour = sil.intersections[i].iContour;
-            const Points &contour = poly_with_offset.contour(iContour).points;
-            size_t iSegment = sil.intersections[i].iSegment;
-            size_t iPrev    = ((iSegment == 0) ? contour.size() : iSegment) - 1;
-            coord_t dir = contour[iSegment](0) - contour[iPrev](0);
-            bool low = dir > 0;
-            sil.intersections[i].type = poly_with_offset.is_contour_outer(iContour) ? 
-                (low ? SegmentIntersection::OUTER_LOW : SegmentIntersection::OUTER_HIGH) :
-                (low ? SegmentIntersection::INNER_LOW : SegmentIntersection::INNER_HIGH);
+            bool low = sil.intersections[i].is_low();
+#ifdef SLIC3R_DEBUG
+            const Points &contour  = poly_with_offset.contour(sil.intersections[i].iContour).points;
+            size_t        iSegment = sil.intersections[i].iSegment;
+            size_t        iPrev    = ((iSegment == 0) ? contour.size() : iSegment) - 1;
+#endif /* SLIC3R_DEBUG */
             if (j > 0 && sil.intersections[i].iContour == sil.intersections[j-1].iContour) {
                 // Two successive intersection points on a vertical line with the same contour. This may be a special case.
                 if (sil.intersections[i].pos() == sil.intersections[j-1].pos()) {
@@ -14,6 +14,8 @@
 #include <limits>
 #include <stdexcept>
 
+#include <tbb/parallel_for.h>
+
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/split.hpp>
 #include <boost/algorithm/string/predicate.hpp>
@@ -55,6 +57,7 @@ const std::string LAYER_CONFIG_RANGES_FILE = "Metadata/Prusa_Slicer_layer_config
 const std::string SLA_SUPPORT_POINTS_FILE = "Metadata/Slic3r_PE_sla_support_points.txt";
 const std::string SLA_DRAIN_HOLES_FILE = "Metadata/Slic3r_PE_sla_drain_holes.txt";
 const std::string CUSTOM_GCODE_PER_PRINT_Z_FILE = "Metadata/Prusa_Slicer_custom_gcode_per_print_z.xml";
+const std::string CUSTOM_PAINT_FILE = "Metadata/Prusa_Slicer_custom_paint.bin";
 
 static constexpr char* MODEL_TAG = "model";
 static constexpr char* RESOURCES_TAG = "resources";
@@ -393,6 +396,15 @@ namespace Slic3r {
         typedef std::map<int, std::vector<sla::SupportPoint>> IdToSlaSupportPointsMap;
         typedef std::map<int, std::vector<sla::DrainHole>> IdToSlaDrainHolesMap;
 
+        // Painted supports or seam of a single ModelVolume, see CUSTOM_PAINT_FILE.
+        struct CustomPaint
+        {
+            unsigned int          volume_idx;
+            CustomPaintType       type;
+            TriangleSplittingData data;
+        };
+        typedef std::map<int, std::vector<CustomPaint>> IdToCustomPaintMap;
+
         // Version of the 3mf file
         unsigned int m_version;
         bool m_check_version;
@@ -411,6 +423,7 @@ namespace Slic3r {
         IdToLayerConfigRangesMap m_layer_config_ranges;
         IdToSlaSupportPointsMap m_sla_support_points;
         IdToSlaDrainHolesMap    m_sla_drain_holes;
+        IdToCustomPaintMap      m_custom_paint;
         std::string m_curr_metadata_name;
         std::string m_curr_characters;
         std::string m_name;
@@ -431,6 +444,7 @@ namespace Slic3r {
         void _extract_layer_config_ranges_from_archive(mz_zip_archive& archive, const mz_zip_archive_file_stat& stat);
         void _extract_sla_support_points_from_archive(mz_zip_archive& archive, const mz_zip_archive_file_stat& stat);
         void _extract_sla_drain_holes_from_archive(mz_zip_archive& archive, const mz_zip_archive_file_stat& stat);
+        void _extract_custom_paint_from_archive(mz_zip_archive& archive, const mz_zip_archive_file_stat& stat);
 
         void _extract_custom_gcode_per_print_z_from_archive(mz_zip_archive& archive, const mz_zip_archive_file_stat& stat);
 
@@ -643,6 +657,11 @@ namespace Slic3r {
                     // extract sla support points file
                     _extract_sla_drain_holes_from_archive(archive, stat);
                 }
+                else if (boost::algorithm::iequals(name, CUSTOM_PAINT_FILE))
+                {
+                    // extract painted supports and seams
+                    _extract_custom_paint_from_archive(archive, stat);
+                }
                 else if (boost::algorithm::iequals(name, PRINT_CONFIG_FILE))
                 {
                     // extract slic3r print config file
@@ -733,6 +752,20 @@ namespace Slic3r {
 
             if (!_generate_volumes(*model_object, obj_geometry->second, *volumes_ptr))
                 return false;
+
+            // m_custom_paint is indexed by a 1 based model object index.
+            IdToCustomPaintMap::iterator obj_custom_paint = m_custom_paint.find(object.second + 1);
+            if (obj_custom_paint != m_custom_paint.end()) {
+                for (CustomPaint &paint : obj_custom_paint->second) {
+                    if (paint.volume_idx >= model_object->volumes.size() ||
+                        paint.data.triangles_to_split.back().first >= int(model_object->volumes[paint.volume_idx]->mesh().its.indices.size())) {
+                        add_error("Found invalid triangle id of painted supports or seam");
+                        continue;
+                    }
+                    ModelVolume *volume = model_object->volumes[paint.volume_idx];
+                    (paint.type == CustomPaintType::Supports ? volume->supported_facets : volume->seam_facets).set(std::move(paint.data));
+                }
+            }
         }
 
 //        // fixes the min z of the model if negative
@@ -1136,6 +1169,87 @@ namespace Slic3r {
             }
         }
     }
+
+    void _3MF_Importer::_extract_custom_paint_from_archive(mz_zip_archive& archive, const mz_zip_archive_file_stat& stat)
+    {
+        if (stat.m_uncomp_size == 0)
+            return;
+
+        std::string buffer(size_t(stat.m_uncomp_size), 0);
+        mz_bool res = mz_zip_reader_extract_file_to_mem(&archive, stat.m_filename, (void*)buffer.data(), (size_t)stat.m_uncomp_size, 0);
+        if (res == 0)
+        {
+            add_error("Error while reading painted supports and seams data to buffer");
+            return;
+        }
+
+        // Info on format versioning - see 3mf.hpp
+        const std::string key("custom_paint_format_version=");
+        size_t header_end = buffer.find('\n');
+        if (! boost::starts_with(buffer, key) || header_end == std::string::npos || std::atoi(buffer.c_str() + key.size()) != custom_paint_format_version)
+        {
+            add_error("Found unsupported painted supports and seams data");
+            return;
+        }
+
+        // Split the records first, then decode their payloads in parallel.
+        struct Record
+        {
+            int         object_id;
+            CustomPaint paint;
+            size_t      begin;
+            size_t      end;
+            bool        valid { false };
+        };
+        std::vector<Record> records;
+        auto read_uint32 = [&buffer](size_t pos) {
+            uint32_t out = 0;
+            for (int i = 3; i >= 0; -- i)
+                out = (out << 8) | uint8_t(buffer[pos + i]);
+            return out;
+        };
+        // object_id, volume_idx, type, payload size
+        static constexpr size_t record_header_size = 4 + 4 + 1 + 4;
+        for (size_t pos = header_end + 1; pos < buffer.size();)
+        {
+            if (buffer.size() - pos < record_header_size)
+            {
+                add_error("Found invalid painted supports and seams data");
+                return;
+            }
+            Record record;
+            record.object_id        = int(read_uint32(pos));
+            record.paint.volume_idx = read_uint32(pos + 4);
+            record.paint.type       = CustomPaintType(uint8_t(buffer[pos + 8]));
+            size_t size             = read_uint32(pos + 9);
+            pos += record_header_size;
+            if (buffer.size() - pos < size || (record.paint.type != CustomPaintType::Supports && record.paint.type != CustomPaintType::Seam))
+            {
+                add_error("Found invalid painted supports and seams data");
+                return;
+            }
+            record.begin = pos;
+            record.end   = pos + size;
+            records.emplace_back(std::move(record));
+            pos += size;
+        }
+
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, records.size()), [&records, &buffer](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i < range.end(); ++ i)
+            {
+                Record &record = records[i];
+                record.valid = record.paint.data.read_compact(buffer.data() + record.begin, buffer.data() + record.end) && ! record.paint.data.empty();
+            }
+        });
+
+        for (Record &record : records)
+        {
+            if (record.valid)
+                m_custom_paint[record.object_id].emplace_back(std::move(record.paint));
+            else
+                add_error("Found invalid painted supports and seams data");
+        }
+    }
     
 
 
@@ -1904,6 +2018,8 @@ namespace Slic3r {
                 if (! geometry.custom_seam[index].empty())
                     volume->seam_facets.set_triangle_from_string(i, geometry.custom_seam[index]);
             }
+            volume->supported_facets.finalize_set_from_strings();
+            volume->seam_facets.finalize_set_from_strings();
 
 
             // apply the remaining volume's metadata
@@ -2036,6 +2152,7 @@ namespace Slic3r {
         bool _add_layer_config_ranges_file_to_archive(mz_zip_archive& archive, Model& model);
         bool _add_sla_support_points_file_to_archive(mz_zip_archive& archive, Model& model);
         bool _add_sla_drain_holes_file_to_archive(mz_zip_archive& archive, Model& model);
+        bool _add_custom_paint_file_to_archive(mz_zip_archive& archive, Model& model);
         bool _add_print_config_file_to_archive(mz_zip_archive& archive, const DynamicPrintConfig &config);
         bool _add_model_config_file_to_archive(mz_zip_archive& archive, const Model& model, const IdToObjectDataMap &objects_data);
         bool _add_custom_gcode_per_print_z_file_to_archive(mz_zip_archive& archive, Model& model, const DynamicPrintConfig* config);
@@ -2134,6 +2251,16 @@ namespace Slic3r {
             boost::filesystem::remove(filename);
             return false;
         }
+
+        // Adds painted supports and seams file ("Metadata/Prusa_Slicer_custom_paint.bin").
+        // Painted supports and seams of all ModelVolumes are stored here, indexed by 1 based index of the ModelObject in Model
+        // and by 0 based index of the ModelVolume in its ModelObject.
+        if (!_add_custom_paint_file_to_archive(archive, model))
+        {
+            close_zip_writer(&archive);
+            boost::filesystem::remove(filename);
+            return false;
+        }
         
 
         // Adds custom gcode per height file ("Metadata/Prusa_Slicer_custom_gcode_per_print_z.xml").
@@ -2420,13 +2547,7 @@ namespace Slic3r {
                     stream << "v" << j + 1 << "=\"" << its.indices[i][j] + volume_it->second.first_vertex_id << "\" ";
                 }
 
-                std::string custom_supports_data_string = volume->supported_facets.get_triangle_as_string(i);
-                if (! custom_supports_data_string.empty())
-                    stream << CUSTOM_SUPPORTS_ATTR << "=\"" << custom_supports_data_string << "\" ";
-
-                std::string custom_seam_data_string = volume->seam_facets.get_triangle_as_string(i);
-                if (! custom_seam_data_string.empty())
-                    stream << CUSTOM_SEAM_ATTR << "=\"" << custom_seam_data_string << "\" ";
+                // Painted supports and seams are stored into CUSTOM_PAINT_FILE, see _add_custom_paint_file_to_archive().
 
                 stream << "/>\n";
             }
@@ -2664,6 +2785,64 @@ namespace Slic3r {
         return true;
     }
 
+    bool _3MF_Exporter::_add_custom_paint_file_to_archive(mz_zip_archive& archive, Model& model)
+    {
+        struct Record
+        {
+            unsigned int                 object_id;
+            unsigned int                 volume_idx;
+            CustomPaintType              type;
+            const TriangleSplittingData *data;
+            std::string                  payload;
+        };
+        std::vector<Record> records;
+        for (unsigned int object_idx = 0; object_idx < (unsigned int)model.objects.size(); ++ object_idx)
+        {
+            const ModelObject *object = model.objects[object_idx];
+            for (unsigned int volume_idx = 0; volume_idx < (unsigned int)object->volumes.size(); ++ volume_idx)
+            {
+                const ModelVolume *volume = object->volumes[volume_idx];
+                if (! volume->supported_facets.empty())
+                    records.push_back({ object_idx + 1, volume_idx, CustomPaintType::Supports, &volume->supported_facets.get_data(), {} });
+                if (! volume->seam_facets.empty())
+                    records.push_back({ object_idx + 1, volume_idx, CustomPaintType::Seam, &volume->seam_facets.get_data(), {} });
+            }
+        }
+        if (records.empty())
+            return true;
+
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, records.size()), [&records](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i < range.end(); ++ i)
+                records[i].data->write_compact(records[i].payload);
+        });
+
+        // Adds version header at the beginning, then the records with little endian headers.
+        std::string out = std::string("custom_paint_format_version=") + std::to_string(custom_paint_format_version) + std::string("\n");
+        auto write_uint32 = [&out](uint32_t value) {
+            for (int i = 0; i < 4; ++ i, value >>= 8)
+                out.push_back(char(value & 0xff));
+        };
+        size_t size = out.size();
+        for (const Record &record : records)
+            size += 4 + 4 + 1 + 4 + record.payload.size();
+        out.reserve(size);
+        for (const Record &record : records)
+        {
+            write_uint32(record.object_id);
+            write_uint32(record.volume_idx);
+            out.push_back(char(record.type));
+            write_uint32(uint32_t(record.payload.size()));
+            out += record.payload;
+        }
+
+        if (!mz_zip_writer_add_mem(&archive, CUSTOM_PAINT_FILE.c_str(), static_cast<const void*>(out.data()), out.length(), mz_uint(MZ_DEFAULT_COMPRESSION)))
+        {
+            add_error("Unable to add painted supports and seams file to archive");
+            return false;
+        }
+        return true;
+    }
+
     bool _3MF_Exporter::_add_print_config_file_to_archive(mz_zip_archive& archive, const DynamicPrintConfig &config)
     {
         char buffer[1024];
@@ -24,6 +24,23 @@ namespace Slic3r {
         drain_holes_format_version = 1
     };
 
+    /* Painted supports and seams are stored in Prusa_Slicer_custom_paint.bin, replacing the per triangle "slic3rpe:custom_supports"
+     * and "slic3rpe:custom_seam" attributes of the older files, which are still read.
+
+     * version 1 :  custom_paint_format_version=1
+                    followed by binary records, one per painted ModelVolume and paint type, integers in little endian:
+                    uint32 object_id (1 based), uint32 volume_idx (0 based), uint8 type (CustomPaintType), uint32 payload size,
+                    payload (TriangleSplittingData::write_compact(): triangle index deltas and the packed split trees)
+    */
+    enum {
+        custom_paint_format_version = 1
+    };
+
+    enum class CustomPaintType : unsigned char {
+        Supports = 0,
+        Seam     = 1
+    };
+
     class Model;
     class DynamicPrintConfig;
     struct ThumbnailData;
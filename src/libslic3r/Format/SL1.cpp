@@ -438,7 +438,22 @@ uqptr<sla::RasterBase> SL1Archive::create_raster() const
 
 sla::RasterEncoder SL1Archive::get_encoder() const
 {
-    return sla::PNGRasterEncoder{};
+    return sla::PNGMaskRasterEncoder{};
+}
+
+std::string SL1Archive::raster_params() const
+{
+    // The options create_raster() and get_encoder() depend on.
+    static const char *const raster_opts[] = {
+        "display_width", "display_height", "display_pixels_x", "display_pixels_y",
+        "display_mirror_x", "display_mirror_y", "display_orientation", "gamma_correction"
+    };
+    
+    std::string out;
+    for (const char *opt_key : raster_opts)
+        out += std::string(opt_key) + " = " + m_cfg.opt_serialize(opt_key) + "\n";
+    
+    return out;
 }
 
 void SL1Archive::export_print(Zipper& zipper,
@@ -14,6 +14,7 @@ class SL1Archive: public SLAPrinter {
 protected:
     uqptr<sla::RasterBase> create_raster() const override;
     sla::RasterEncoder get_encoder() const override;
+    std::string raster_params() const override;
     
 public:
     
@@ -28,13 +29,13 @@ public:
         export_print(zipper, print, projectname);
     }
     
+    // The rasters are kept, draw_layers() redraws them if the display
+    // parameters changed.
     void apply(const SLAPrinterConfig &cfg) override
     {
         auto diff = m_cfg.diff(cfg);
-        if (!diff.empty()) {
+        if (!diff.empty())
             m_cfg.apply_only(cfg, diff);
-            m_layers = {};
-        }
     }
 };
     
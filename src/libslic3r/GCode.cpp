@@ -2041,7 +2041,7 @@ void GCode::process_layer(
                     path.mm3_per_mm = mm3_per_mm;
                 }
                 //FIXME using the support_material_speed of the 1st object printed.
-                gcode += this->extrude_loop(loop, "skirt", m_config.support_material_speed.value);
+                gcode += this->extrude_loop(std::move(loop), "skirt", m_config.support_material_speed.value);
             }
             m_avoid_crossing_perimeters.use_external_mp(false);
             // Allow a straight travel move to the first object point if this is the first layer (but don't in next layers).
@@ -2093,7 +2093,7 @@ void GCode::process_layer(
                     m_layer = layers[instance_to_print.layer_id].support_layer;
                     gcode += this->extrude_support(
                         // support_extrusion_role is erSupportMaterial, erSupportMaterialInterface or erMixed for all extrusion paths.
-                        instance_to_print.object_by_extruder.support->chained_path_from(m_last_pos, instance_to_print.object_by_extruder.support_extrusion_role));
+                        *instance_to_print.object_by_extruder.support, instance_to_print.object_by_extruder.support_extrusion_role);
                     m_layer = layers[instance_to_print.layer_id].layer();
                 }
                 for (ObjectByExtruder::Island &island : instance_to_print.object_by_extruder.islands) {
@@ -2120,12 +2120,14 @@ void GCode::process_layer(
     // bottom non-spiral layers otherwise it will mess with positions)
     // we apply spiral vase at this stage because it requires a full layer.
     // Just a reminder: A spiral vase mode is allowed for a single object per layer, single material print only.
-    if (m_spiral_vase)
-        gcode = m_spiral_vase->process_layer(gcode);
-
-    // Apply cooling logic; this may alter speeds.
-    if (m_cooling_buffer)
-        gcode = m_cooling_buffer->process_layer(gcode, layer.id());
+    // The layer G-code is tokenized once and the tokenized lines are shared by the spiral vase and the cooling buffer.
+    if (m_spiral_vase || m_cooling_buffer) {
+        LayerGCode layer_gcode(std::move(gcode), m_config.get_extrusion_axis()[0]);
+        if (m_spiral_vase)
+            m_spiral_vase->process_layer(layer_gcode);
+        // Apply cooling logic; this may alter speeds.
+        gcode = m_cooling_buffer ? m_cooling_buffer->process_layer(layer_gcode, layer.id()) : layer_gcode.release();
+    }
 
 #ifdef HAS_PRESSURE_EQUALIZER
     // Apply pressure equalization if enabled;
@@ -2350,18 +2352,43 @@ std::string GCode::extrude_loop(ExtrusionLoop loop, std::string description, dou
     return gcode;
 }
 
-std::string GCode::extrude_multi_path(ExtrusionMultiPath multipath, std::string description, double speed)
+// Extrude extrusion entities in the order minimizing the travel from start_near, see chain_extrusion_entities().
+// Unlike ExtrusionEntityCollection::chained_path_from(), the entities are not cloned, only those to be extruded
+// in the reverse direction are copied and reversed.
+template<typename ExtrudeFn>
+static std::string extrude_chained(const ExtrusionEntitiesPtr &entities, const Point &start_near, ExtrudeFn extrude)
+{
+    std::string gcode;
+    for (const std::pair<size_t, bool> &idx : chain_extrusion_entities(entities, &start_near)) {
+        const ExtrusionEntity *ee = entities[idx.first];
+        if (idx.second) {
+            std::unique_ptr<ExtrusionEntity> reversed(ee->clone());
+            reversed->reverse();
+            gcode += extrude(*reversed);
+        } else
+            gcode += extrude(*ee);
+    }
+    return gcode;
+}
+
+// Copy of an extrusion path simplified for G-code export. The source polyline is simplified directly into the copy
+// instead of copying the source polyline first and simplifying the copy.
+static inline ExtrusionPath simplified_extrusion_path(const ExtrusionPath &path)
+{
+    return ExtrusionPath(Polyline(MultiPoint::_douglas_peucker(path.polyline.points, SCALED_RESOLUTION)), path);
+}
+
+std::string GCode::extrude_multi_path(const ExtrusionMultiPath &multipath, std::string description, double speed)
 {
     // extrude along the path
     std::string gcode;
-    for (ExtrusionPath path : multipath.paths) {
+    for (const ExtrusionPath &path : multipath.paths) {
 //    description += ExtrusionLoop::role_to_string(loop.loop_role());
 //    description += ExtrusionEntity::role_to_string(path->role);
-        path.simplify(SCALED_RESOLUTION);
-        gcode += this->_extrude(path, description, speed);
+        gcode += this->_extrude(simplified_extrusion_path(path), description, speed);
     }
     if (m_wipe.enable) {
-        m_wipe.path = std::move(multipath.paths.back().polyline);  // TODO: don't limit wipe to last path
+        m_wipe.path = multipath.paths.back().polyline;  // TODO: don't limit wipe to last path
         m_wipe.path.reverse();
     }
     // reset acceleration
@@ -2382,10 +2409,10 @@ std::string GCode::extrude_entity(const ExtrusionEntity &entity, std::string des
     return "";
 }
 
-std::string GCode::extrude_path(ExtrusionPath path, std::string description, double speed)
+std::string GCode::extrude_path(const ExtrusionPath &path_src, std::string description, double speed)
 {
 //    description += ExtrusionEntity::role_to_string(path.role());
-    path.simplify(SCALED_RESOLUTION);
+    ExtrusionPath path = simplified_extrusion_path(path_src);
     std::string gcode = this->_extrude(path, description, speed);
     if (m_wipe.enable) {
         m_wipe.path = std::move(path.polyline);
@@ -2428,8 +2455,12 @@ std::string GCode::extrude_infill(const Print &print, const std::vector<ObjectBy
                 for (const ExtrusionEntity *fill : extrusions) {
                     auto *eec = dynamic_cast<const ExtrusionEntityCollection*>(fill);
                     if (eec) {
-                        for (ExtrusionEntity *ee : eec->chained_path_from(m_last_pos).entities)
-                            gcode += this->extrude_entity(*ee, extrusion_name);
+                        if (eec->no_sort) {
+                            for (const ExtrusionEntity *ee : eec->entities)
+                                gcode += this->extrude_entity(*ee, extrusion_name);
+                        } else
+                            gcode += extrude_chained(eec->entities, m_last_pos, [this, extrusion_name](const ExtrusionEntity &ee)
+                                { return this->extrude_entity(ee, extrusion_name); });
                     } else
                         gcode += this->extrude_entity(*fill, extrusion_name);
                 }
@@ -2438,7 +2469,7 @@ std::string GCode::extrude_infill(const Print &print, const std::vector<ObjectBy
     return gcode;
 }
 
-std::string GCode::extrude_support(const ExtrusionEntityCollection &support_fills)
+std::string GCode::extrude_support(const ExtrusionEntityCollection &support_fills, ExtrusionRole support_role)
 {
     std::string gcode;
     if (! support_fills.entities.empty()) {
@@ -2446,21 +2477,29 @@ std::string GCode::extrude_support(const ExtrusionEntityCollection &support_fill
         const char   *support_interface_label  = "support material interface";
         const double  support_speed            = m_config.support_material_speed.value;
         const double  support_interface_speed  = m_config.support_material_interface_speed.get_abs_value(support_speed);
-        for (const ExtrusionEntity *ee : support_fills.entities) {
-            ExtrusionRole role = ee->role();
+        // Chain the support extrusions of the requested role from the last position.
+        auto extrude = [this, support_label, support_interface_label, support_speed, support_interface_speed](const ExtrusionEntity &ee) {
+            std::string gcode;
+            ExtrusionRole role = ee.role();
             assert(role == erSupportMaterial || role == erSupportMaterialInterface);
             const char  *label = (role == erSupportMaterial) ? support_label : support_interface_label;
             const double speed = (role == erSupportMaterial) ? support_speed : support_interface_speed;
-            const ExtrusionPath *path = dynamic_cast<const ExtrusionPath*>(ee);
+            const ExtrusionPath *path = dynamic_cast<const ExtrusionPath*>(&ee);
             if (path)
                 gcode += this->extrude_path(*path, label, speed);
             else {
-                const ExtrusionMultiPath *multipath = dynamic_cast<const ExtrusionMultiPath*>(ee);
+                const ExtrusionMultiPath *multipath = dynamic_cast<const ExtrusionMultiPath*>(&ee);
                 assert(multipath != nullptr);
                 if (multipath)
                     gcode += this->extrude_multi_path(*multipath, label, speed);
             }
-        }
+            return gcode;
+        };
+        if (support_fills.no_sort) {
+            for (const ExtrusionEntity *ee : support_fills.entities)
+                gcode += extrude(*ee);
+        } else
+            gcode += extrude_chained(filter_by_extrusion_role(support_fills.entities, support_role), m_last_pos, extrude);
     }
     return gcode;
 }
@@ -0,0 +1,159 @@
+#include "LayerGCode.hpp"
+
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+
+namespace Slic3r {
+
+static inline bool is_whitespace(char c)          { return c == ' ' || c == '\t'; }
+static inline bool is_end_of_line(char c)         { return c == '\r' || c == '\n' || c == 0; }
+static inline bool is_end_of_gcode_line(char c)   { return c == ';' || is_end_of_line(c); }
+static inline bool is_end_of_word(char c)         { return is_whitespace(c) || is_end_of_gcode_line(c); }
+
+static inline bool starts_with(const char *line, const char *line_end, const char *prefix)
+{
+    size_t len = strlen(prefix);
+    return size_t(line_end - line) >= len && strncmp(line, prefix, len) == 0;
+}
+
+static inline bool contains(const char *begin, const char *end, const char *needle)
+{
+    return std::string_view(begin, end - begin).find(needle) != std::string_view::npos;
+}
+
+void LayerGCode::parse(std::string gcode, char extrusion_axis)
+{
+    m_gcode = std::move(gcode);
+    m_lines.clear();
+    // Typical layer G-code has around 30 characters per line.
+    m_lines.reserve(m_gcode.size() / 24 + 1);
+
+    const char *begin = m_gcode.c_str();
+    for (const char *c = begin; *c != 0;) {
+        Line line;
+        line.start     = uint32_t(c - begin);
+        line.opcode    = Opcode::Other;
+        line.canonical = false;
+        line.axis_mask = 0;
+        line.markers   = 0;
+        memset(line.axis, 0, sizeof(line.axis));
+
+        // Parse the command, skipping the leading whitespaces the same way GCodeReader does.
+        const char *cmd = c;
+        for (; is_whitespace(*cmd); ++ cmd);
+        const char *cmd_end = cmd;
+        for (; ! is_end_of_word(*cmd_end); ++ cmd_end);
+        if (*cmd == 'G') {
+            size_t cmd_len = cmd_end - cmd;
+            if (cmd_len == 2)
+                line.opcode = cmd[1] == '0' ? Opcode::G0 : cmd[1] == '1' ? Opcode::G1 : cmd[1] == '4' ? Opcode::G4 : Opcode::Other;
+            else if (cmd_len == 3 && cmd[1] == '9' && cmd[2] == '2')
+                line.opcode = Opcode::G92;
+            line.canonical = line.opcode != Opcode::Other && cmd == c && *cmd_end == ' ';
+        }
+
+        c = cmd_end;
+        if (line.updates_position()) {
+            // Parse the axes up to the end of line or comment.
+            while (! is_end_of_gcode_line(*c)) {
+                for (; is_whitespace(*c); ++ c);
+                if (is_end_of_gcode_line(*c))
+                    break;
+                int axis = -1;
+                switch (*c) {
+                case 'X': axis = X; break;
+                case 'Y': axis = Y; break;
+                case 'Z': axis = Z; break;
+                case 'F': axis = F; break;
+                default:  if (*c == extrusion_axis) axis = E; break;
+                }
+                if (axis != -1) {
+                    char   *pend = nullptr;
+                    double  v    = strtod(++ c, &pend);
+                    if (pend != nullptr && is_end_of_word(*pend)) {
+                        line.set(Axis(axis), float(v));
+                        c = pend;
+                        continue;
+                    }
+                }
+                // Skip the rest of the word.
+                for (; ! is_end_of_word(*c); ++ c);
+            }
+        }
+
+        // Up to the end of line, remember the start of the comment.
+        const char *comment = c;
+        for (; ! is_end_of_line(*c); ++ c)
+            if (*comment != ';')
+                comment = c;
+        line.raw_end = uint32_t(c - begin);
+        if (*c == '\r')
+            ++ c;
+        if (*c == '\n')
+            ++ c;
+        line.end = uint32_t(c - begin);
+
+        const char *raw     = begin + line.start;
+        const char *raw_end = begin + line.raw_end;
+        if (*raw == ';') {
+            if (starts_with(raw, raw_end, ";_EXTRUDE_END"))
+                line.markers |= MARKER_EXTRUDE_END;
+            else if (starts_with(raw, raw_end, ";_BRIDGE_FAN_START"))
+                line.markers |= MARKER_BRIDGE_FAN_START;
+            else if (starts_with(raw, raw_end, ";_BRIDGE_FAN_END"))
+                line.markers |= MARKER_BRIDGE_FAN_END;
+        } else if (line.updates_position() && *comment == ';') {
+            if (contains(comment, raw_end, ";_EXTRUDE_SET_SPEED"))
+                line.markers |= MARKER_EXTRUDE_SET_SPEED;
+            if (contains(comment, raw_end, ";_EXTERNAL_PERIMETER"))
+                line.markers |= MARKER_EXTERNAL_PERIMETER;
+            if (contains(comment, raw_end, ";_WIPE"))
+                line.markers |= MARKER_WIPE;
+        }
+        m_lines.emplace_back(line);
+    }
+}
+
+void LayerGCode::append(const Line &line, std::string_view raw)
+{
+    Line &dst   = m_lines.emplace_back(line);
+    dst.start   = uint32_t(m_gcode.size());
+    dst.raw_end = dst.start + uint32_t(raw.size());
+    dst.end     = dst.raw_end + 1;
+    m_gcode.append(raw.data(), raw.size());
+    m_gcode += '\n';
+}
+
+void LayerGCode::set_axis(std::string &raw, Line &line, Axis axis, float new_value, char extrusion_axis, int decimal_digits)
+{
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(decimal_digits) << new_value;
+
+    char match[3] = " X";
+    if (int(axis) < 3)
+        match[1] += int(axis);
+    else if (axis == F)
+        match[1] = 'F';
+    else {
+        assert(axis == E);
+        match[1] = extrusion_axis;
+    }
+
+    if (line.has(axis)) {
+        size_t pos = raw.find(match) + 2;
+        size_t end = raw.find(' ', pos + 1);
+        raw.replace(pos, end - pos, ss.str());
+    } else {
+        size_t pos = raw.find(' ');
+        if (pos == std::string::npos)
+            raw += std::string(match) + ss.str();
+        else
+            raw.replace(pos, 0, std::string(match) + ss.str());
+    }
+    line.set(axis, new_value);
+}
+
+} // namespace Slic3r
@@ -0,0 +1,105 @@
+#ifndef slic3r_LayerGCode_hpp_
+#define slic3r_LayerGCode_hpp_
+
+#include "../libslic3r.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Slic3r {
+
+// G-code of a single layer, tokenized once into typed lines.
+// The G-code post-processors working over a complete layer (SpiralVase, CoolingBuffer) share this representation
+// instead of each of them tokenizing the layer G-code again. The text is kept next to the lines, so that
+// the lines not modified by a post-processor are copied verbatim and the output is byte identical
+// to the output produced by the post-processors parsing the text.
+class LayerGCode
+{
+public:
+    enum class Opcode : uint8_t {
+        // Comment only, empty line or a command not interpreted by the post-processors.
+        Other,
+        G0,
+        G1,
+        G4,
+        G92,
+    };
+
+    // Markers emitted by GCode for the CoolingBuffer.
+    enum Marker : uint8_t {
+        // Line starts with ";_EXTRUDE_END"
+        MARKER_EXTRUDE_END          = 1 << 0,
+        // Line starts with ";_BRIDGE_FAN_START"
+        MARKER_BRIDGE_FAN_START     = 1 << 1,
+        // Line starts with ";_BRIDGE_FAN_END"
+        MARKER_BRIDGE_FAN_END       = 1 << 2,
+        // G0 / G1 / G92 line containing ";_EXTRUDE_SET_SPEED"
+        MARKER_EXTRUDE_SET_SPEED    = 1 << 3,
+        // G0 / G1 / G92 line containing ";_EXTERNAL_PERIMETER"
+        MARKER_EXTERNAL_PERIMETER   = 1 << 4,
+        // G0 / G1 / G92 line containing ";_WIPE"
+        MARKER_WIPE                 = 1 << 5,
+    };
+
+    struct Line {
+        // Span of the line in the text: [start, raw_end) is the line without the trailing "\r\n",
+        // [start, end) is the line including the trailing "\r\n".
+        uint32_t    start;
+        uint32_t    raw_end;
+        uint32_t    end;
+        Opcode      opcode;
+        // The command starts at the first column and it is followed by a space, as emitted by GCodeWriter.
+        bool        canonical;
+        // Bit mask of the axes (1 << Axis) parsed from a G0 / G1 / G92 line.
+        uint8_t     axis_mask;
+        // Bit mask of Marker.
+        uint8_t     markers;
+        // X, Y, Z, E, F values as written in the G-code, thus F is in mm/min.
+        float       axis[NUM_AXES];
+
+        bool        has(Axis a) const { return (axis_mask & (1 << int(a))) != 0; }
+        float       value(Axis a) const { return axis[a]; }
+        void        set(Axis a, float v) { axis[a] = v; axis_mask |= uint8_t(1 << int(a)); }
+        bool        has_marker(Marker m) const { return (markers & m) != 0; }
+        // G0, G1 or G92, updating the machine position.
+        bool        updates_position() const { return opcode == Opcode::G0 || opcode == Opcode::G1 || opcode == Opcode::G92; }
+    };
+
+    LayerGCode() = default;
+    LayerGCode(std::string gcode, char extrusion_axis) { this->parse(std::move(gcode), extrusion_axis); }
+
+    // Tokenize the G-code of a layer. The extrusion axis is the first character of PrintConfig::get_extrusion_axis().
+    void                        parse(std::string gcode, char extrusion_axis);
+    void                        clear() { m_gcode.clear(); m_lines.clear(); }
+    void                        reserve(size_t text_size, size_t num_lines) { m_gcode.reserve(text_size); m_lines.reserve(num_lines); }
+
+    const std::string&          gcode() const { return m_gcode; }
+    // Move the text out, leaving this object empty.
+    std::string                 release() { m_lines.clear(); return std::move(m_gcode); }
+    const std::vector<Line>&    lines() const { return m_lines; }
+    bool                        empty() const { return m_lines.empty(); }
+
+    // Line without the trailing "\r\n".
+    std::string_view            raw(const Line &line) const { return std::string_view(m_gcode.data() + line.start, line.raw_end - line.start); }
+    // Line including the trailing "\r\n".
+    std::string_view            text(const Line &line) const { return std::string_view(m_gcode.data() + line.start, line.end - line.start); }
+
+    // Append a line terminated with '\n', keeping the typed data of the line, with its text replaced by raw.
+    void                        append(const Line &line, std::string_view raw);
+    // Append a line of another LayerGCode verbatim, terminated with '\n'.
+    void                        append(const LayerGCode &src, const Line &line) { this->append(line, src.raw(line)); }
+
+    // Replace or insert a value of an axis into a raw G-code line, formatted with a fixed number of decimal digits.
+    // Produces the same text as GCodeReader::GCodeLine::set().
+    static void                 set_axis(std::string &raw, Line &line, Axis axis, float new_value, char extrusion_axis, int decimal_digits = 3);
+
+private:
+    std::string                 m_gcode;
+    std::vector<Line>           m_lines;
+};
+
+} // namespace Slic3r
+
+#endif // slic3r_LayerGCode_hpp_
@@ -1,10 +1,46 @@
 #include "SpiralVase.hpp"
 #include "GCode.hpp"
-#include <sstream>
+#include <cmath>
 
 namespace Slic3r {
 
 std::string SpiralVase::process_layer(const std::string &gcode)
+{
+    LayerGCode layer(gcode, m_extrusion_axis);
+    this->process_layer(layer);
+    return layer.release();
+}
+
+// Mimics the machine position tracking of GCodeReader over the lines of LayerGCode.
+struct SpiralVasePosition
+{
+    SpiralVasePosition(float *position, bool relative_e) : pos(position), relative_e(relative_e) {}
+
+    // To be called before a line is processed.
+    void  begin(const LayerGCode::Line &line) { if (line.has(E) && relative_e) pos[E] = 0; }
+    // To be called after a line is processed.
+    void  end(const LayerGCode::Line &line) {
+        if (line.updates_position())
+            for (size_t i = 0; i < NUM_AXES; ++ i)
+                if (line.has(Axis(i)))
+                    pos[i] = line.value(Axis(i));
+    }
+
+    float dist_XY(const LayerGCode::Line &line) const {
+        float x = line.has(X) ? (line.value(X) - pos[X]) : 0;
+        float y = line.has(Y) ? (line.value(Y) - pos[Y]) : 0;
+        return sqrt(x*x + y*y);
+    }
+    float dist_Z(const LayerGCode::Line &line) const { return line.has(Z) ? (line.value(Z) - pos[Z]) : 0; }
+    float new_Z(const LayerGCode::Line &line) const { return line.has(Z) ? line.value(Z) : pos[Z]; }
+    bool  extruding(const LayerGCode::Line &line) const
+        { return line.opcode == LayerGCode::Opcode::G1 && (line.has(E) ? (line.value(E) - pos[E]) : 0) > 0; }
+
+    float *pos;
+    bool   relative_e;
+};
+
+void SpiralVase::process_layer(LayerGCode &gcode)
 {
     /*  This post-processor relies on several assumptions:
         - all layers are processed through it, including those that are not supposed
@@ -14,11 +50,16 @@ std::string SpiralVase::process_layer(const std::string &gcode)
         - each layer is composed by suitable geometry (i.e. a single complete loop)
         - loops were not clipped before calling this method  */
     
-    // If we're not going to modify G-code, just feed it to the reader
-    // in order to update positions.
+    const bool relative_e = m_config->use_relative_e_distances.value;
+
+    // If we're not going to modify G-code, just update positions.
     if (! m_enabled) {
-        m_reader.parse_buffer(gcode);
-        return gcode;
+        SpiralVasePosition reader(m_position, relative_e);
+        for (const LayerGCode::Line &line : gcode.lines()) {
+            reader.begin(line);
+            reader.end(line);
+        }
+        return;
     }
     
     // Get total XY length for this layer by summing all extrusion moves.
@@ -27,71 +68,80 @@ std::string SpiralVase::process_layer(const std::string &gcode)
     float z = 0.f;
     
     {
-        //FIXME Performance warning: This copies the GCodeConfig of the reader.
-        GCodeReader r = m_reader;  // clone
+        float position[NUM_AXES];
+        memcpy(position, m_position, sizeof(position));
+        SpiralVasePosition reader(position, relative_e);
         bool set_z = false;
-        r.parse_buffer(gcode, [&total_layer_length, &layer_height, &z, &set_z]
-            (GCodeReader &reader, const GCodeReader::GCodeLine &line) {
-            if (line.cmd_is("G1")) {
-                if (line.extruding(reader)) {
-                    total_layer_length += line.dist_XY(reader);
+        for (const LayerGCode::Line &line : gcode.lines()) {
+            reader.begin(line);
+            if (line.opcode == LayerGCode::Opcode::G1) {
+                if (reader.extruding(line)) {
+                    total_layer_length += reader.dist_XY(line);
                 } else if (line.has(Z)) {
-                    layer_height += line.dist_Z(reader);
+                    layer_height += reader.dist_Z(line);
                     if (!set_z) {
-                        z = line.new_Z(reader);
+                        z = reader.new_Z(line);
                         set_z = true;
                     }
                 }
             }
-        });
+            reader.end(line);
+        }
     }
     
-    // Remove layer height from initial Z.
+    // Remove layer height from initial Z.
     z -= layer_height;
     
-    std::string new_gcode;
+    LayerGCode new_gcode;
+    new_gcode.reserve(gcode.gcode().size() + gcode.gcode().size() / 4, gcode.lines().size());
     //FIXME Tapering of the transition layer only works reliably with relative extruder distances.
     // For absolute extruder distances it will be switched off.
     // Tapering the absolute extruder distances requires to process every extrusion value after the first transition
     // layer.
-    bool  transition = m_transition_layer && m_config->use_relative_e_distances.value;
+    bool  transition = m_transition_layer && relative_e;
     float layer_height_factor = layer_height / total_layer_length;
     float len = 0.f;
-    m_reader.parse_buffer(gcode, [&new_gcode, &z, total_layer_length, layer_height_factor, transition, &len]
-        (GCodeReader &reader, GCodeReader::GCodeLine line) {
-        if (line.cmd_is("G1")) {
-            if (line.has_z()) {
+    SpiralVasePosition reader(m_position, relative_e);
+    std::string raw;
+    for (const LayerGCode::Line &src_line : gcode.lines()) {
+        reader.begin(src_line);
+        LayerGCode::Line line = src_line;
+        if (line.opcode == LayerGCode::Opcode::G1) {
+            if (line.has(Z)) {
                 // If this is the initial Z move of the layer, replace it with a
                 // (redundant) move to the last Z of previous layer.
-                line.set(reader, Z, z);
-                new_gcode += line.raw() + '\n';
-                return;
+                raw.assign(gcode.raw(line));
+                LayerGCode::set_axis(raw, line, Z, z, m_extrusion_axis);
+                new_gcode.append(line, raw);
             } else {
-                float dist_XY = line.dist_XY(reader);
+                float dist_XY = reader.dist_XY(line);
                 if (dist_XY > 0) {
                     // horizontal move
-                    if (line.extruding(reader)) {
+                    if (reader.extruding(line)) {
                         len += dist_XY;
-                        line.set(reader, Z, z + len * layer_height_factor);
+                        raw.assign(gcode.raw(line));
+                        LayerGCode::set_axis(raw, line, Z, z + len * layer_height_factor, m_extrusion_axis);
                         if (transition && line.has(E))
                             // Transition layer, modulate the amount of extrusion from zero to the final value.
-                            line.set(reader, E, line.value(E) * len / total_layer_length);
-                        new_gcode += line.raw() + '\n';
+                            LayerGCode::set_axis(raw, line, E, line.value(E) * len / total_layer_length, m_extrusion_axis);
+                        new_gcode.append(line, raw);
                     }
-                    return;
                 
                     /*  Skip travel moves: the move to first perimeter point will
                         cause a visible seam when loops are not aligned in XY; by skipping
                         it we blend the first loop move in the XY plane (although the smoothness
                         of such blend depend on how long the first segment is; maybe we should
                         enforce some minimum length?).  */
-                }
+                } else
+                    new_gcode.append(gcode, line);
             }
-        }
-        new_gcode += line.raw() + '\n';
-    });
+        } else
+            new_gcode.append(gcode, line);
+        // Advance the position with the source line, not with the rewritten one, as GCodeReader::parse_buffer() did.
+        reader.end(src_line);
+    }
     
-    return new_gcode;
+    gcode = std::move(new_gcode);
 }
 
 }
@@ -2,16 +2,16 @@
 #define slic3r_SpiralVase_hpp_
 
 #include "../libslic3r.h"
-#include "../GCodeReader.hpp"
+#include "../PrintConfig.hpp"
+#include "LayerGCode.hpp"
 
 namespace Slic3r {
 
 class SpiralVase {
 public:
-    SpiralVase(const PrintConfig &config) : m_config(&config)
+    SpiralVase(const PrintConfig &config) : m_config(&config), m_extrusion_axis(config.get_extrusion_axis()[0])
     {
-        m_reader.z() = (float)m_config->z_offset;
-        m_reader.apply_config(*m_config);
+        m_position[Z] = (float)m_config->z_offset;
     };
 
     void 		enable(bool en) {
@@ -19,11 +19,15 @@ public:
     	m_enabled 		   = en;
     }
 
+    // Transform the layer in place. Lines not touched by the spiral vase are copied verbatim.
+    void        process_layer(LayerGCode &gcode);
     std::string process_layer(const std::string &gcode);
     
 private:
     const PrintConfig  *m_config;
-    GCodeReader 		m_reader;
+    char                m_extrusion_axis;
+    // Machine position X, Y, Z, E, F at the end of the last processed layer.
+    float               m_position[NUM_AXES] { 0.f, 0.f, 0.f, 0.f, 0.f };
 
     bool 				m_enabled = false;
     // First spiral vase layer. Layer height has to be ramped up from zero to the target layer height.
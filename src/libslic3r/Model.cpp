@@ -1904,9 +1904,13 @@ indexed_triangle_set FacetsAnnotation::get_facets(const ModelVolume& mv, Enforce
 
 bool FacetsAnnotation::set(const TriangleSelector& selector)
 {
-    std::map<int, std::vector<bool>> sel_map = selector.serialize();
-    if (sel_map != m_data) {
-        m_data = sel_map;
+    return this->set(selector.serialize());
+}
+
+bool FacetsAnnotation::set(TriangleSplittingData &&data)
+{
+    if (data != m_data) {
+        m_data = std::move(data);
         this->touch();
         return true;
     }
@@ -1924,35 +1928,30 @@ void FacetsAnnotation::clear()
 // changing it may break backwards compatibility !!!!!
 std::string FacetsAnnotation::get_triangle_as_string(int triangle_idx) const
 {
-    std::string out;
-
-    auto triangle_it = m_data.find(triangle_idx);
-    if (triangle_it != m_data.end()) {
-        const std::vector<bool>& code = triangle_it->second;
-        int offset = 0;
-        while (offset < int(code.size())) {
-            int next_code = 0;
-            for (int i=3; i>=0; --i) {
-                next_code = next_code << 1;
-                next_code |= int(code[offset + i]);
-            }
-            offset += 4;
-
-            assert(next_code >=0 && next_code <= 15);
-            char digit = next_code < 10 ? next_code + '0' : (next_code-10)+'A';
-            out.insert(out.begin(), digit);
+    auto [offset, end] = m_data.bit_range(triangle_idx);
+    // Digits are stored in reverse order of the bitstream.
+    std::string out((end - offset) / 4, '0');
+    for (auto digit_it = out.rbegin(); offset < end; offset += 4, ++ digit_it) {
+        int next_code = 0;
+        for (int i=3; i>=0; --i) {
+            next_code = next_code << 1;
+            next_code |= int(m_data.bitstream[offset + i]);
         }
+
+        assert(next_code >=0 && next_code <= 15);
+        *digit_it = next_code < 10 ? next_code + '0' : (next_code-10)+'A';
     }
     return out;
 }
 
 // Recover triangle splitting & state from string of hexadecimal values previously
 // generated by get_triangle_as_string. Used to load from 3MF.
+// finalize_set_from_strings() has to be called once all the triangles are set.
 void FacetsAnnotation::set_triangle_from_string(int triangle_id, const std::string& str)
 {
     assert(! str.empty());
-    m_data[triangle_id] = std::vector<bool>(); // zero current state or create new
-    std::vector<bool>& code = m_data[triangle_id];
+    m_data.triangles_to_split.emplace_back(triangle_id, int(m_data.bitstream.size()));
+    std::vector<bool>& code = m_data.bitstream;
 
     for (auto it = str.crbegin(); it != str.crend(); ++it) {
         const char ch = *it;
@@ -1966,7 +1965,7 @@ void FacetsAnnotation::set_triangle_from_string(int triangle_id, const std::stri
 
         // Convert to binary and append into code.
         for (int i=0; i<4; ++i) {
-            code.insert(code.end(), bool(dec & (1 << i)));
+            code.push_back(bool(dec & (1 << i)));
         }
     }
 }
@@ -10,6 +10,7 @@
 #include "SLA/SupportPoint.hpp"
 #include "SLA/Hollowing.hpp"
 #include "TriangleMesh.hpp"
+#include "TriangleSplittingData.hpp"
 #include "Arrange.hpp"
 #include "CustomGCode.hpp"
 
@@ -500,13 +501,17 @@ public:
     // Assign the content if the timestamp differs, don't assign an ObjectID.
     void assign(const FacetsAnnotation& rhs) { if (! this->timestamp_matches(rhs)) { this->m_data = rhs.m_data; this->copy_timestamp(rhs); } }
     void assign(FacetsAnnotation&& rhs) { if (! this->timestamp_matches(rhs)) { this->m_data = std::move(rhs.m_data); this->copy_timestamp(rhs); } }
-    const std::map<int, std::vector<bool>>& get_data() const throw() { return m_data; }
+    const TriangleSplittingData& get_data() const throw() { return m_data; }
     bool set(const TriangleSelector& selector);
+    bool set(TriangleSplittingData &&data);
     indexed_triangle_set get_facets(const ModelVolume& mv, EnforcerBlockerType type) const;
     bool empty() const { return m_data.empty(); }
     void clear();
     std::string get_triangle_as_string(int i) const;
     void set_triangle_from_string(int triangle_id, const std::string& str);
+    // To be called once all triangles were set from strings: sorts the triangles, if they were not set
+    // in increasing order of their indices, and releases the memory reserved while setting them.
+    void finalize_set_from_strings() { m_data.sort(); m_data.shrink_to_fit(); }
 
 private:
     // Constructors to be only called by derived classes.
@@ -532,7 +537,7 @@ private:
         ar(cereal::base_class<ObjectWithTimestamp>(this), m_data);
     }
 
-    std::map<int, std::vector<bool>> m_data;
+    TriangleSplittingData m_data;
 
     // To access set_new_unique_id() when copy / pasting a ModelVolume.
     friend class ModelVolume;
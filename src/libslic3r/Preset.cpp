@@ -605,6 +605,18 @@ const std::vector<std::string>& Preset::sla_printer_options()
     return s_opts;
 }
 
+const std::vector<std::string>& Preset::options_not_deferred()
+{
+    static std::vector<std::string> s_opts {
+        "inherits",
+        "compatible_printers", "compatible_printers_condition",
+        "compatible_prints", "compatible_prints_condition",
+        // PreferedPrintProfileMatch, PreferedFilamentProfileMatch
+        "layer_height", "filament_type"
+    };
+    return s_opts;
+}
+
 PresetCollection::PresetCollection(Preset::Type type, const std::vector<std::string> &keys, const Slic3r::StaticPrintConfig &defaults, const std::string &default_name) :
     m_type(type),
     m_edited_preset(type, "", false),
@@ -766,6 +778,8 @@ std::pair<Preset*, bool> PresetCollection::load_external_preset(
 		it = this->find_preset_renamed(original_name);
 		found = it != m_presets.end();
     }
+    if (found)
+        this->deserialize_deferred(*it);
     if (found && profile_print_params_same(it->config, cfg)) {
         // The preset exists and it matches the values stored inside config.
         if (select == LoadAndSelect::Always)
@@ -778,6 +792,8 @@ std::pair<Preset*, bool> PresetCollection::load_external_preset(
         assert(it == m_presets.end());
         it    = this->find_preset_internal(inherits);
         found = it != m_presets.end() && it->name == inherits;
+        if (found)
+            this->deserialize_deferred(*it);
         if (found && profile_print_params_same(it->config, cfg)) {
             // The system preset exists and it matches the values stored inside config.
             if (select == LoadAndSelect::Always)
@@ -848,6 +864,7 @@ Preset& PresetCollection::load_preset(const std::string &path, const std::string
     Preset &preset = *it;
     preset.file = path;
     preset.config = std::move(config);
+    preset.config_deferred.clear();
     preset.loaded = true;
     preset.is_dirty = false;
     if (select)
@@ -1054,6 +1071,46 @@ Preset* PresetCollection::find_preset(const std::string &name, bool first_visibl
         first_visible_if_not_found ? &this->first_visible() : nullptr;
 }
 
+void PresetCollection::deserialize_deferred(const Preset &preset_const) const
+{
+    if (preset_const.config_deferred.empty())
+        return;
+    Preset                   &preset         = const_cast<Preset&>(preset_const);
+    const DynamicPrintConfig &default_config = this->default_preset().config;
+    DynamicPrintConfig        config         = default_config;
+    const std::string         vendor_name    = preset.vendor ? preset.vendor->name : std::string();
+    for (const auto &kvp : preset.config_deferred)
+        try {
+            config.set_deserialize(kvp.first, kvp.second);
+        } catch (const std::exception &err) {
+            // The config bundle has already been loaded, thus the invalid value is reported and ignored.
+            BOOST_LOG_TRIVIAL(error) << "Error in a Vendor Config Bundle of \"" << vendor_name << "\": The " << this->name() << " preset \"" <<
+                preset.name << "\" contains an invalid value of \"" << kvp.first << "\", which is being ignored: " << err.what();
+        }
+    Preset::normalize(config);
+    // Report configuration fields, which are misplaced into a wrong group.
+    std::string incorrect_keys = Preset::remove_invalid_keys(config, default_config);
+    if (! incorrect_keys.empty())
+        BOOST_LOG_TRIVIAL(error) << "Error in a Vendor Config Bundle of \"" << vendor_name << "\": The " << this->name() << " preset \"" <<
+            preset.name << "\" contains the following incorrect keys: " << incorrect_keys << ", which were removed";
+    preset.config = std::move(config);
+    // Release the memory of the key / value pairs.
+    std::vector<std::pair<std::string, std::string>>().swap(preset.config_deferred);
+}
+
+void PresetCollection::deserialize_deferred_all() const
+{
+    for (const Preset &preset : m_presets)
+        this->deserialize_deferred(preset);
+}
+
+void PresetCollection::set_visible_from_appconfig(const AppConfig &app_config)
+{
+    // Iterate over m_presets directly, as set_visible_from_appconfig() does not need the deferred configs.
+    for (size_t i = m_num_default_presets; i < m_presets.size(); ++ i)
+        m_presets[i].set_visible_from_appconfig(app_config);
+}
+
 // Return index of the first visible preset. Certainly at least the '- default -' preset shall be visible.
 size_t PresetCollection::first_visible_idx() const
 {
@@ -1198,6 +1255,7 @@ Preset& PresetCollection::select_preset(size_t idx)
     if (idx >= m_presets.size())
         idx = first_visible_idx();
     m_idx_selected = idx;
+    this->deserialize_deferred(m_presets[idx]);
     m_edited_preset = m_presets[idx];
     bool default_visible = ! m_default_suppressed || m_idx_selected < m_num_default_presets;
     for (size_t i = 0; i < m_num_default_presets; ++i)
@@ -235,6 +235,15 @@ public:
 protected:
     friend class        PresetCollection;
     friend class        PresetBundle;
+
+    // Key / value pairs of a system preset loaded from a config bundle, which were not deserialized into config yet.
+    // Only options_not_deferred() are deserialized when the bundle is loaded, the rest is deserialized by PresetCollection
+    // once the preset is looked up, selected or enumerated, see PresetCollection::deserialize_deferred().
+    std::vector<std::pair<std::string, std::string>> config_deferred;
+
+    // Options of a deferred preset, which are deserialized when the config bundle is loaded, as they are needed
+    // to evaluate the compatibility of the presets and to pick the prefered compatible preset.
+    static const std::vector<std::string>&  options_not_deferred();
 };
 
 bool is_compatible_with_print  (const PresetWithVendorProfile &preset, const PresetWithVendorProfile &active_print, const PresetWithVendorProfile &active_printer);
@@ -260,9 +269,10 @@ public:
 
     typedef std::deque<Preset>::iterator Iterator;
     typedef std::deque<Preset>::const_iterator ConstIterator;
-    Iterator        begin() { return m_presets.begin() + m_num_default_presets; }
-    ConstIterator   begin() const { return m_presets.cbegin() + m_num_default_presets; }
-    ConstIterator   cbegin() const { return m_presets.cbegin() + m_num_default_presets; }
+    // Enumerating the presets deserializes all the deferred presets.
+    Iterator        begin() { this->deserialize_deferred_all(); return m_presets.begin() + m_num_default_presets; }
+    ConstIterator   begin() const { this->deserialize_deferred_all(); return m_presets.cbegin() + m_num_default_presets; }
+    ConstIterator   cbegin() const { this->deserialize_deferred_all(); return m_presets.cbegin() + m_num_default_presets; }
     Iterator        end() { return m_presets.end(); }
     ConstIterator   end() const { return m_presets.cend(); }
     ConstIterator   cend() const { return m_presets.cend(); }
@@ -274,7 +284,7 @@ public:
     std::string     name() const;
     // Name, to be used as a section name in config bundle, and as a folder name for presets.
     std::string     section_name() const;
-    const std::deque<Preset>& operator()() const { return m_presets; }
+    const std::deque<Preset>& operator()() const { this->deserialize_deferred_all(); return m_presets; }
 
     // Add default preset at the start of the collection, increment the m_default_preset counter.
     void            add_default_preset(const std::vector<std::string> &keys, const Slic3r::StaticPrintConfig &defaults, const std::string &preset_name);
@@ -282,6 +292,9 @@ public:
     // Load ini files of the particular type from the provided directory path.
     void            load_presets(const std::string &dir_path, const std::string &subdir);
 
+    // Update the visibility of the presets from the "installed" flags of PrusaSlicer.ini, see Preset::set_visible_from_appconfig().
+    void            set_visible_from_appconfig(const AppConfig &app_config);
+
     // Load a preset from an already parsed config file, insert it into the sorted sequence of presets
     // and select it, losing previous modifications.
     Preset&         load_preset(const std::string &path, const std::string &name, const DynamicPrintConfig &config, bool select = true);
@@ -354,7 +367,7 @@ public:
 	const std::string*		get_preset_name_renamed(const std::string &old_name) const;
 
 	// used to update preset_choice from Tab
-	const std::deque<Preset>&	get_presets() const	{ return m_presets; }
+	const std::deque<Preset>&	get_presets() const	{ this->deserialize_deferred_all(); return m_presets; }
     size_t                      get_idx_selected()	{ return m_idx_selected; }
 	static const std::string&	get_suffix_modified();
 
@@ -363,7 +376,7 @@ public:
 	const Preset&   default_preset(size_t idx = 0) const { assert(idx < m_num_default_presets); return m_presets[idx]; }
 	virtual const Preset& default_preset_for(const DynamicPrintConfig & /* config */) const { return this->default_preset(); }
     // Return a preset by an index. If the preset is active, a temporary copy is returned.
-    Preset&         preset(size_t idx)          { return (idx == m_idx_selected) ? m_edited_preset : m_presets[idx]; }
+    Preset&         preset(size_t idx)          { this->deserialize_deferred(m_presets[idx]); return (idx == m_idx_selected) ? m_edited_preset : m_presets[idx]; }
     const Preset&   preset(size_t idx) const    { return const_cast<PresetCollection*>(this)->preset(idx); }
     void            discard_current_changes()   { m_presets[m_idx_selected].reset_dirty(); m_edited_preset = m_presets[m_idx_selected]; }
     
@@ -501,11 +514,18 @@ private:
     	auto it_renamed = m_map_system_profile_renamed.find(name);
     	auto it = (it_renamed == m_map_system_profile_renamed.end()) ? m_presets.end() : this->find_preset_internal(it_renamed->second);
     	assert((it_renamed == m_map_system_profile_renamed.end()) || (it != m_presets.end() && it->name == it_renamed->second));
+    	if (it != m_presets.end())
+    		this->deserialize_deferred(*it);
     	return it;
     }
     std::deque<Preset>::const_iterator find_preset_renamed(const std::string &name) const
         { return const_cast<PresetCollection*>(this)->find_preset_renamed(name); }
 
+    // Deserialize the config of a system preset, if its deserialization was deferred by PresetBundle::load_configbundle().
+    // The presets are owned by m_presets, thus they may be completed even if accessed through a const PresetCollection.
+    void deserialize_deferred(const Preset &preset) const;
+    void deserialize_deferred_all() const;
+
     size_t update_compatible_internal(const PresetWithVendorProfile &active_printer, const PresetWithVendorProfile *active_print, PresetSelectCompatibleType unselect_if_incompatible);
 
     static std::vector<std::string> dirty_options(const Preset *edited, const Preset *reference, const bool is_printer_type = false);
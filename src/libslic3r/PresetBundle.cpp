@@ -1,6 +1,7 @@
 #include <cassert>
 
 #include "PresetBundle.hpp"
+#include "ConfigBundleCache.hpp"
 #include "libslic3r.h"
 #include "Utils.hpp"
 #include "Model.hpp"
@@ -374,8 +375,7 @@ void PresetBundle::load_installed_filaments(AppConfig &config)
             config.set(AppConfig::SECTION_FILAMENTS, filament->name, "1");
     }
 
-    for (auto &preset : filaments)
-        preset.set_visible_from_appconfig(config);
+    filaments.set_visible_from_appconfig(config);
 }
 
 void PresetBundle::load_installed_sla_materials(AppConfig &config)
@@ -397,8 +397,7 @@ void PresetBundle::load_installed_sla_materials(AppConfig &config)
             config.set(AppConfig::SECTION_MATERIALS, material->name, "1");
     }
 
-    for (auto &preset : sla_materials)
-        preset.set_visible_from_appconfig(config);
+    sla_materials.set_visible_from_appconfig(config);
 }
 
 // Load selections (current print, current filaments, current printer) from config.ini
@@ -1095,11 +1094,19 @@ size_t PresetBundle::load_configbundle(const std::string &path, unsigned int fla
     // 1) Read the complete config file into a boost::property_tree.
     namespace pt = boost::property_tree;
     pt::ptree tree;
-    boost::nowide::ifstream ifs(path);
-    try {
-        pt::read_ini(ifs, tree);
-    } catch (const boost::property_tree::ini_parser::ini_parser_error &err) {
-        throw Slic3r::RuntimeError(format("Failed loading config bundle \"%1%\"\nError: \"%2%\" at line %3%", path, err.message(), err.line()).c_str());
+    // A system config bundle is flattened independently of the presets already loaded, thus the flattened tree
+    // may be cached in a binary form, which is much faster to load than the INI file.
+    boost::filesystem::path cache_path;
+    if ((flags & LOAD_CFGBNDLE_SYSTEM) && ! (flags & LOAD_CFGBUNDLE_VENDOR_ONLY) && ! data_dir().empty())
+        cache_path = ConfigBundleCache::cache_file_path(boost::filesystem::path(data_dir()) / "cache" / "bundles", path);
+    const bool from_cache = ! cache_path.empty() && ConfigBundleCache::load(cache_path, path, tree);
+    if (! from_cache) {
+        boost::nowide::ifstream ifs(path);
+        try {
+            pt::read_ini(ifs, tree);
+        } catch (const boost::property_tree::ini_parser::ini_parser_error &err) {
+            throw Slic3r::RuntimeError(format("Failed loading config bundle \"%1%\"\nError: \"%2%\" at line %3%", path, err.message(), err.line()).c_str());
+        }
     }
 
     const VendorProfile *vendor_profile = nullptr;
@@ -1121,7 +1128,12 @@ size_t PresetBundle::load_configbundle(const std::string &path, unsigned int fla
 
     // 1.5) Flatten the config bundle by applying the inheritance rules. Internal profiles (with names starting with '*') are removed.
     // If loading a user config bundle, do not flatten with the system profiles, but keep the "inherits" flag intact.
-    flatten_configbundle_hierarchy(tree, ((flags & LOAD_CFGBNDLE_SYSTEM) == 0) ? this : nullptr);
+    // The vendor profile above only reads the sections, which are not touched by flattening, thus it may be read from the cached flattened tree.
+    if (! from_cache) {
+        flatten_configbundle_hierarchy(tree, ((flags & LOAD_CFGBNDLE_SYSTEM) == 0) ? this : nullptr);
+        if (! cache_path.empty())
+            ConfigBundleCache::save(cache_path, path, tree);
+    }
 
     // 2) Parse the property_tree, extract the active preset names and the profiles, save them into local config files.
     // Parse the obsolete preset names, to be deleted when upgrading from the old configuration structure.
@@ -1225,7 +1237,15 @@ size_t PresetBundle::load_configbundle(const std::string &path, unsigned int fla
             DynamicPrintConfig        config;
             std::string 			  alias_name;
             std::vector<std::string>  renamed_from;
-            auto parse_config_section = [&section, &alias_name, &renamed_from, &path](DynamicPrintConfig &config) {
+            // Print, filament and SLA presets of a system bundle are only deserialized once they are looked up or selected,
+            // see PresetCollection::deserialize_deferred(). Of these, only the options needed to evaluate their compatibility
+            // are deserialized here, the printer presets are always deserialized to be validated against the vendor profile.
+            std::vector<std::pair<std::string, std::string>> config_deferred;
+            const bool                deferred = (flags & LOAD_CFGBNDLE_SYSTEM) && ! (flags & LOAD_CFGBNDLE_SAVE) && presets != &this->printers;
+            // If config_deferred is provided, only the options already present in config are deserialized, all options are stored into config_deferred.
+            auto parse_config_section = [&section, &alias_name, &renamed_from, &path](DynamicPrintConfig &config, std::vector<std::pair<std::string, std::string>> *config_deferred = nullptr) {
+                if (config_deferred)
+                    config_deferred->reserve(section.second.size());
                 for (auto &kvp : section.second) {
                 	if (kvp.first == "alias")
                 		alias_name = kvp.second.data();
@@ -1235,7 +1255,13 @@ size_t PresetBundle::load_configbundle(const std::string &path, unsigned int fla
 			                    section.first << "\" contains invalid \"renamed_from\" key, which is being ignored.";
                    		}
                 	}
-                    config.set_deserialize(kvp.first, kvp.second.data());
+                    if (config_deferred == nullptr)
+                        config.set_deserialize(kvp.first, kvp.second.data());
+                    else {
+                        if (config.has(kvp.first))
+                            config.set_deserialize(kvp.first, kvp.second.data());
+                        config_deferred->emplace_back(kvp.first, kvp.second.data());
+                    }
                 }
             };
             if (presets == &this->printers) {
@@ -1245,17 +1271,27 @@ size_t PresetBundle::load_configbundle(const std::string &path, unsigned int fla
                 default_config = &presets->default_preset_for(config_src).config;
                 config = *default_config;
                 config.apply(config_src);
+            } else if (deferred) {
+                default_config = &presets->default_preset().config;
+                t_config_option_keys keys;
+                for (const std::string &key : Preset::options_not_deferred())
+                    if (default_config->has(key))
+                        keys.emplace_back(key);
+                config.apply_only(*default_config, keys);
+                parse_config_section(config, &config_deferred);
             } else {
                 default_config = &presets->default_preset().config;
                 config = *default_config;
                 parse_config_section(config);
             }
-            Preset::normalize(config);
-            // Report configuration fields, which are misplaced into a wrong group.
-            std::string incorrect_keys = Preset::remove_invalid_keys(config, *default_config);
-            if (! incorrect_keys.empty())
-                BOOST_LOG_TRIVIAL(error) << "Error in a Vendor Config Bundle \"" << path << "\": The printer preset \"" << 
-                    section.first << "\" contains the following incorrect keys: " << incorrect_keys << ", which were removed";
+            if (! deferred) {
+                Preset::normalize(config);
+                // Report configuration fields, which are misplaced into a wrong group.
+                std::string incorrect_keys = Preset::remove_invalid_keys(config, *default_config);
+                if (! incorrect_keys.empty())
+                    BOOST_LOG_TRIVIAL(error) << "Error in a Vendor Config Bundle \"" << path << "\": The printer preset \"" << 
+                        section.first << "\" contains the following incorrect keys: " << incorrect_keys << ", which were removed";
+            }
             if ((flags & LOAD_CFGBNDLE_SYSTEM) && presets == &printers) {
                 // Filter out printer presets, which are not mentioned in the vendor profile.
                 // These presets are considered not installed.
@@ -1320,6 +1356,7 @@ size_t PresetBundle::load_configbundle(const std::string &path, unsigned int fla
                 / presets->section_name() / file_name).make_preferred();
             // Load the preset into the list of presets, save it to disk.
             Preset &loaded = presets->load_preset(file_path.string(), preset_name, std::move(config), false);
+            loaded.config_deferred = std::move(config_deferred);
             if (flags & LOAD_CFGBNDLE_SAVE)
                 loaded.save();
             if (flags & LOAD_CFGBNDLE_SYSTEM) {
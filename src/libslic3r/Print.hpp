@@ -24,6 +24,7 @@ class GCode;
 enum class SlicingMode : uint32_t;
 class Layer;
 class SupportLayer;
+class PrintObjectSupportMaterialCache;
 
 namespace FillAdaptive {
     struct Octree;
@@ -199,6 +200,9 @@ public:
     // Helpers to project custom facets on slices
     void project_and_append_custom_facets(bool seam, EnforcerBlockerType type, std::vector<ExPolygons>& expolys) const;
 
+    // Intermediate results of the support generator kept for the next regeneration of the supports, null if there are no supports.
+    const PrintObjectSupportMaterialCache* support_material_cache() const { return m_support_material_cache.get(); }
+
 private:
     // to be called from Print only.
     friend class Print;
@@ -256,6 +260,8 @@ private:
     SlicingParameters                       m_slicing_params;
     LayerPtrs                               m_layers;
     SupportLayerPtrs                        m_support_layers;
+    // Contact layers and support areas of the object layers, reused if the supports are regenerated after a localized change.
+    std::shared_ptr<PrintObjectSupportMaterialCache> m_support_material_cache;
 
     // this is set to true when LayerRegion->slices is split in top/internal/bottom
     // so that next call to make_perimeters() performs a union() before computing loops
@@ -422,6 +422,8 @@ void PrintObject::generate_support_material()
             this->_generate_support_material();
             m_print->throw_if_canceled();
         } else {
+            // Release the intermediate results of the support generator.
+            m_support_material_cache.reset();
 #if 0
             // Printing without supports. Empty layer means some objects or object parts are levitating,
             // therefore they cannot be printed without supports.
@@ -2134,6 +2136,35 @@ std::vector<ExPolygons> PrintObject::slice_support_volumes(const ModelVolumeType
     return this->slice_volumes(zs, SlicingMode::Regular, volumes);
 }
 
+// Append the shared vertices and faces of a model volume, transformed into the coordinate system of the sliced object, to its_out.
+// Only the indexed triangle set of the model volume is copied, the stl_file representation of the mesh
+// with its facets and face neighbors is neither copied nor repaired just to be sliced.
+static void append_volume_its_for_slicing(const ModelVolume &volume, const Transform3d &trafo, indexed_triangle_set &its_out)
+{
+    const TriangleMesh &volume_mesh = volume.mesh();
+    indexed_triangle_set its;
+    if (volume_mesh.has_shared_vertices())
+        its = volume_mesh.its;
+    else {
+        // The shared vertices may have been released, regenerate them on a copy of the mesh.
+        TriangleMesh mesh(volume_mesh);
+        mesh.require_shared_vertices();
+        its = std::move(mesh.its);
+    }
+    // Flip the faces if a left handed transformation is being applied.
+    its_transform(its, trafo, true);
+    if (its_out.indices.empty())
+        its_out = std::move(its);
+    else {
+        // Shift the vertex indices of the appended faces.
+        int offset = int(its_out.vertices.size());
+        its_out.vertices.insert(its_out.vertices.end(), its.vertices.begin(), its.vertices.end());
+        its_out.indices.reserve(its_out.indices.size() + its.indices.size());
+        for (const stl_triangle_vertex_indices &face : its.indices)
+            its_out.indices.emplace_back(face + stl_triangle_vertex_indices(offset, offset, offset));
+    }
+}
+
 std::vector<ExPolygons> PrintObject::slice_volumes(
     const std::vector<float> &z, 
     SlicingMode mode, size_t slicing_mode_normal_below_layer, SlicingMode mode_below, 
@@ -2143,30 +2174,17 @@ std::vector<ExPolygons> PrintObject::slice_volumes(
     if (! volumes.empty()) {
         // Compose mesh.
         //FIXME better to perform slicing over each volume separately and then to use a Boolean operation to merge them.
-		TriangleMesh mesh(volumes.front()->mesh());
-        mesh.transform(volumes.front()->get_matrix(), true);
-		assert(mesh.repaired);
-		if (volumes.size() == 1 && mesh.repaired) {
-			//FIXME The admesh repair function may break the face connectivity, rather refresh it here as the slicing code relies on it.
-			stl_check_facets_exact(&mesh.stl);
-		}
-        for (size_t idx_volume = 1; idx_volume < volumes.size(); ++ idx_volume) {
-            const ModelVolume &model_volume = *volumes[idx_volume];
-            TriangleMesh vol_mesh(model_volume.mesh());
-            vol_mesh.transform(model_volume.get_matrix(), true);
-            mesh.merge(vol_mesh);
-        }
-        if (mesh.stl.stats.number_of_facets > 0) {
-            mesh.transform(m_trafo, true);
-            // apply XY shift
-            mesh.translate(- unscale<float>(m_center_offset.x()), - unscale<float>(m_center_offset.y()), 0);
+        // Object transformation followed by the XY shift.
+        Transform3d trafo = Geometry::assemble_transform(Vec3d(- unscale<double>(m_center_offset.x()), - unscale<double>(m_center_offset.y()), 0)) * m_trafo;
+        indexed_triangle_set its;
+        for (const ModelVolume *model_volume : volumes)
+            append_volume_its_for_slicing(*model_volume, trafo * model_volume->get_matrix(), its);
+        if (! its.indices.empty()) {
             // perform actual slicing
             const Print *print = this->print();
             auto callback = TriangleMeshSlicer::throw_on_cancel_callback_type([print](){print->throw_if_canceled();});
-            // TriangleMeshSlicer needs shared vertices, also this calls the repair() function.
-            mesh.require_shared_vertices();
             TriangleMeshSlicer mslicer;
-            mslicer.init(&mesh, callback);
+            mslicer.init(&its, callback);
 			mslicer.slice(z, mode, slicing_mode_normal_below_layer, mode_below, float(m_config.slice_closing_radius.value), &layers, callback);
             m_print->throw_if_canceled();
         }
@@ -2180,23 +2198,15 @@ std::vector<ExPolygons> PrintObject::slice_volume(const std::vector<float> &z, S
     if (! z.empty()) {
 	    // Compose mesh.
 	    //FIXME better to split the mesh into separate shells, perform slicing over each shell separately and then to use a Boolean operation to merge them.
-	    TriangleMesh mesh(volume.mesh());
-	    mesh.transform(volume.get_matrix(), true);
-		if (mesh.repaired) {
-			//FIXME The admesh repair function may break the face connectivity, rather refresh it here as the slicing code relies on it.
-			stl_check_facets_exact(&mesh.stl);
-		}
-	    if (mesh.stl.stats.number_of_facets > 0) {
-	        mesh.transform(m_trafo, true);
-	        // apply XY shift
-	        mesh.translate(- unscale<float>(m_center_offset.x()), - unscale<float>(m_center_offset.y()), 0);
+        Transform3d trafo = Geometry::assemble_transform(Vec3d(- unscale<double>(m_center_offset.x()), - unscale<double>(m_center_offset.y()), 0)) * m_trafo;
+        indexed_triangle_set its;
+        append_volume_its_for_slicing(volume, trafo * volume.get_matrix(), its);
+	    if (! its.indices.empty()) {
 	        // perform actual slicing
 	        TriangleMeshSlicer mslicer;
 	        const Print *print = this->print();
 	        auto callback = TriangleMeshSlicer::throw_on_cancel_callback_type([print](){print->throw_if_canceled();});
-	        // TriangleMeshSlicer needs the shared vertices.
-	        mesh.require_shared_vertices();
-	        mslicer.init(&mesh, callback);
+	        mslicer.init(&its, callback);
 	        mslicer.slice(z, mode, float(m_config.slice_closing_radius.value), &layers, callback);
 	        m_print->throw_if_canceled();
 	    }
@@ -2748,8 +2758,10 @@ void PrintObject::combine_infill()
 
 void PrintObject::_generate_support_material()
 {
+    if (! m_support_material_cache)
+        m_support_material_cache = std::make_shared<PrintObjectSupportMaterialCache>();
     PrintObjectSupportMaterial support_material(this, m_slicing_params);
-    support_material.generate(*this);
+    support_material.generate(*this, m_support_material_cache.get());
 }
 
 
@@ -1,50 +1,140 @@
 #include <functional>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <mutex>
+#include <atomic>
 
 #include <libslic3r/OpenVDBUtils.hpp>
 #include <libslic3r/TriangleMesh.hpp>
 #include <libslic3r/SLA/Hollowing.hpp>
 #include <libslic3r/SLA/IndexedMesh.hpp>
+#include <libslic3r/SLA/SpatIndex.hpp>
 #include <libslic3r/ClipperUtils.hpp>
 #include <libslic3r/SimplifyMesh.hpp>
+#include <libslic3r/MeshBoolean.hpp>
 #include <libslic3r/SLA/SupportTreeMesher.hpp>
+#include <libslic3r/MarchingSquares.hpp>
 
 #include <boost/log/trivial.hpp>
 
+#include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
+
 #include <libslic3r/MTUtils.hpp>
+#include <libslic3r/Utils.hpp>
 #include <libslic3r/I18N.hpp>
 
 //! macro used to mark string used at localization,
 //! return same string
 #define L(s) Slic3r::I18N::translate(s)
 
+namespace Slic3r { namespace sla {
+
+// Horizontal section through the distance field of the interior, negated to
+// have the interior cavity above the iso value for the marching squares.
+struct FieldSection
+{
+    std::vector<float> values;
+    long rows = 0, cols = 0;
+    
+    float get(long r, long c) const { return values[size_t(r * cols + c)]; }
+    
+    // Sub-pixel position of a contour vertex, which the marching squares
+    // snapped to the first pixel inside the cavity: the average of the iso
+    // crossings towards its neighbours outside of the cavity.
+    Vec2d refine(const marchsq::Coord &crd, float isoval) const
+    {
+        static const long dirs[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+        
+        const Vec2d p(double(crd.c), double(crd.r));
+        const float v = get(crd.r, crd.c);
+        Vec2d sum = Vec2d::Zero();
+        int   n   = 0;
+        for (const long *d : dirs) {
+            long r = crd.r + d[0], c = crd.c + d[1];
+            if (r < 0 || r >= rows || c < 0 || c >= cols) continue;
+            float vn = get(r, c);
+            if (vn < isoval && v >= isoval) {
+                double t = double(v - isoval) / double(v - vn);
+                sum += p + t * Vec2d(double(d[1]), double(d[0]));
+                ++n;
+            }
+        }
+        
+        return n > 0 ? Vec2d(sum / double(n)) : p;
+    }
+};
+
+}} // namespace Slic3r::sla
+
+namespace marchsq {
+
+template<> struct _RasterTraits<Slic3r::sla::FieldSection> {
+    using Rst = Slic3r::sla::FieldSection;
+    using ValueType = float;
+    
+    static float get(const Rst &rst, size_t row, size_t col) { return rst.get(long(row), long(col)); }
+    
+    static size_t rows(const Rst &rst) { return size_t(rst.rows); }
+    static size_t cols(const Rst &rst) { return size_t(rst.cols); }
+};
+
+} // namespace marchsq
+
 namespace Slic3r {
 namespace sla {
 
+// Distance field of a mesh scaled to the voxel size, the interior surface is
+// its level set at iso_surface.
+struct Interior {
+    openvdb::FloatGrid::Ptr gridptr;
+    double voxel_scale = 1.;
+    double iso_surface = 0.;
+};
+
+void InteriorDeleter::operator()(Interior *p) { delete p; }
+
 template<class S, class = FloatingOnly<S>>
 inline void _scale(S s, TriangleMesh &m) { m.scale(float(s)); }
 
 template<class S, class = FloatingOnly<S>>
 inline void _scale(S s, Contour3D &m) { for (auto &p : m.points) p *= s; }
 
-static TriangleMesh _generate_interior(const TriangleMesh  &mesh,
-                                       const JobController &ctl,
-                                       double               min_thickness,
-                                       double               voxel_scale,
-                                       double               closing_dist)
+// Offset of the interior surface and the narrow band widths of its distance
+// fields, all in voxels.
+struct InteriorOffsets
 {
-    TriangleMesh imesh{mesh};
-    
-    _scale(voxel_scale, imesh);
-    
-    double offset = voxel_scale * min_thickness;
-    double D = voxel_scale * closing_dist;
-    float  out_range = 0.1f * float(offset);
-    float  in_range = 1.1f * float(offset + D);
-    
-    if (ctl.stopcondition()) return {};
-    else ctl.statuscb(0, L("Hollowing"));
-    
-    auto gridptr = mesh_to_grid(imesh, {}, out_range, in_range);
+    double offset, D;
+    float  out_range, in_range;
+
+    InteriorOffsets(double voxel_scale, double min_thickness, double closing_dist)
+        : offset(voxel_scale * min_thickness)
+        , D(voxel_scale * closing_dist)
+        , out_range(0.1f * float(offset))
+        , in_range(1.1f * float(offset + D))
+    {}
+
+    // The interior surface is not influenced by a cut through the mesh further
+    // than this: the eroded surface lies inside the interior band and the
+    // closing grows it back by D.
+    double cut_margin() const { return std::ceil(double(in_range) + D) + 2.; }
+};
+
+// Interior surface of a mesh already scaled to the voxel size. Optionally
+// returns the memory held by the distance fields at the peak and keeps the
+// distance field the surface was extracted from.
+static Contour3D _interior_contour(const TriangleMesh &   imesh,
+                                   const InteriorOffsets &o,
+                                   const JobController &  ctl,
+                                   size_t *               grid_mem = nullptr,
+                                   Interior *             field    = nullptr)
+{
+    auto gridptr = mesh_to_grid(imesh, {}, o.out_range, o.in_range);
     
     assert(gridptr);
     
@@ -53,33 +143,397 @@ static TriangleMesh _generate_interior(const TriangleMesh  &mesh,
         return {};
     }
     
+    if (grid_mem) *grid_mem = size_t(gridptr->memUsage());
+    
     if (ctl.stopcondition()) return {};
     else ctl.statuscb(30, L("Hollowing"));
     
-    if (closing_dist > .0) {
-        gridptr = redistance_grid(*gridptr, -(offset + D), double(in_range));
+    double iso_surface = o.D;
+    if (o.D > .0) {
+        auto closed = redistance_grid(*gridptr, -(o.offset + o.D), double(o.in_range));
+        // Both grids are alive while the level set is rebuilt.
+        if (grid_mem) *grid_mem += size_t(closed->memUsage());
+        gridptr = std::move(closed);
     } else {
-        D = -offset;
+        iso_surface = -o.offset;
     }
     
     if (ctl.stopcondition()) return {};
     else ctl.statuscb(70, L("Hollowing"));
     
-    double iso_surface = D;
+    if (field) {
+        field->gridptr     = gridptr;
+        field->iso_surface = iso_surface;
+    }
+    
     double adaptivity = 0.;
-    auto omesh = grid_to_mesh(*gridptr, iso_surface, adaptivity);
+    return grid_to_contour3d(*gridptr, iso_surface, adaptivity);
+}
+
+static TriangleMesh _generate_interior(const TriangleMesh &   mesh,
+                                       const JobController &  ctl,
+                                       double                 voxel_scale,
+                                       const InteriorOffsets &o,
+                                       Interior *             field = nullptr)
+{
+    TriangleMesh imesh{mesh};
+    
+    _scale(voxel_scale, imesh);
+    
+    if (ctl.stopcondition()) return {};
+    else ctl.statuscb(0, L("Hollowing"));
     
-    _scale(1. / voxel_scale, omesh);
+    if (field) field->voxel_scale = voxel_scale;
+    
+    Contour3D interior = _interior_contour(imesh, o, ctl, nullptr, field);
     
     if (ctl.stopcondition()) return {};
-    else ctl.statuscb(100, L("Hollowing"));
     
-    return omesh;
+    _scale(1. / voxel_scale, interior);
+    
+    ctl.statuscb(100, L("Hollowing"));
+    
+    return to_triangle_mesh(std::move(interior));
 }
 
-std::unique_ptr<TriangleMesh> generate_interior(const TriangleMesh &   mesh,
-                                                const HollowingConfig &hc,
-                                                const JobController &  ctl)
+// Part of a mesh with shared vertices between two horizontal planes, closed by
+// caps along the planes.
+static TriangleMesh _mesh_between(const TriangleMesh &mesh, float zmin, float zmax)
+{
+    const BoundingBoxf3 bb  = mesh.bounding_box();
+    const TriangleMesh *src = &mesh;
+    
+    TriangleMesh lower, part;
+    if (zmax < bb.max.z()) {
+        TriangleMesh upper;
+        TriangleMeshSlicer(src).cut(zmax, &upper, &lower);
+        lower.repair();
+        src = &lower;
+    }
+    
+    if (zmin > bb.min.z()) {
+        TriangleMesh below;
+        TriangleMeshSlicer(src).cut(zmin, &part, &below);
+        part.repair();
+    } else if (src == &lower)
+        part = std::move(lower);
+    else
+        part = mesh;
+    
+    return part;
+}
+
+// Facets of the mesh overlapping each of the z ranges, with a tolerance of eps.
+// The ranges are sorted by their ends. The mesh is traversed once.
+static std::vector<std::vector<size_t>> _facets_in_ranges(
+    const indexed_triangle_set &its, const std::vector<std::pair<float, float>> &ranges, float eps)
+{
+    std::vector<std::vector<size_t>> out(ranges.size());
+    
+    for (size_t f = 0; f < its.indices.size(); ++f) {
+        float zmin = std::numeric_limits<float>::max();
+        float zmax = std::numeric_limits<float>::lowest();
+        for (int i = 0; i < 3; ++i) {
+            float z = its.vertices[size_t(its.indices[f](i))].z();
+            zmin = std::min(zmin, z);
+            zmax = std::max(zmax, z);
+        }
+        
+        auto it = std::lower_bound(ranges.begin(), ranges.end(), zmin - eps,
+                                   [](const std::pair<float, float> &r, float z) { return r.second < z; });
+        for (; it != ranges.end() && it->first <= zmax + eps; ++it)
+            out[size_t(it - ranges.begin())].emplace_back(f);
+    }
+    
+    return out;
+}
+
+// Mesh of the given facets of an indexed triangle set. It is open where the
+// facets left out were attached.
+static TriangleMesh _slab_mesh(const indexed_triangle_set &its, const std::vector<size_t> &facets)
+{
+    Pointf3s           points;
+    std::vector<Vec3i> faces;
+    std::vector<int>   vertex_map(its.vertices.size(), -1);
+    
+    faces.reserve(facets.size());
+    for (size_t f : facets) {
+        Vec3i face;
+        for (int i = 0; i < 3; ++i) {
+            int &idx = vertex_map[size_t(its.indices[f](i))];
+            if (idx < 0) {
+                idx = int(points.size());
+                points.emplace_back(its.vertices[size_t(its.indices[f](i))].cast<double>());
+            }
+            face(i) = idx;
+        }
+        faces.emplace_back(face);
+    }
+    
+    TriangleMesh mesh(points, faces);
+    mesh.require_shared_vertices();
+    
+    return mesh;
+}
+
+// Faces of the contour with their centroid in [zmin, zmax), only the vertices
+// referenced by these faces are kept.
+static Contour3D _faces_between(const Contour3D &ctr, double zmin, double zmax)
+{
+    Contour3D ret;
+    std::vector<int> vertex_map(ctr.points.size(), -1);
+    
+    auto keep = [&ctr, zmin, zmax](auto &face) {
+        double z = 0.;
+        for (int i = 0; i < face.size(); ++i) z += ctr.points[size_t(face(i))].z();
+        z /= face.size();
+        return z >= zmin && z < zmax;
+    };
+    
+    auto remap = [&ctr, &ret, &vertex_map](auto face) {
+        for (int i = 0; i < face.size(); ++i) {
+            int &idx = vertex_map[size_t(face(i))];
+            if (idx < 0) {
+                idx = int(ret.points.size());
+                ret.points.emplace_back(ctr.points[size_t(face(i))]);
+            }
+            face(i) = idx;
+        }
+        return face;
+    };
+    
+    for (const Vec3i &f : ctr.faces3) if (keep(f)) ret.faces3.emplace_back(remap(f));
+    for (const Vec4i &f : ctr.faces4) if (keep(f)) ret.faces4.emplace_back(remap(f));
+    
+    return ret;
+}
+
+// Vertices of the contour on an edge used by a single face, the contour of
+// a tile is open only along its cuts.
+static std::vector<bool> _open_edge_vertices(const Contour3D &ctr)
+{
+    std::vector<std::pair<int, int>> edges;
+    edges.reserve(3 * ctr.faces3.size() + 4 * ctr.faces4.size());
+    
+    auto add_face = [&edges](const auto &face) {
+        for (int i = 0; i < face.size(); ++i) {
+            int a = face(i), b = face((i + 1) % face.size());
+            if (a != b) edges.emplace_back(std::minmax(a, b));
+        }
+    };
+    for (const Vec3i &f : ctr.faces3) add_face(f);
+    for (const Vec4i &f : ctr.faces4) add_face(f);
+    
+    std::sort(edges.begin(), edges.end());
+    
+    std::vector<bool> ret(ctr.points.size(), false);
+    for (size_t i = 0; i < edges.size();) {
+        size_t j = i + 1;
+        while (j < edges.size() && edges[j] == edges[i]) ++j;
+        if (j - i == 1) ret[size_t(edges[i].first)] = ret[size_t(edges[i].second)] = true;
+        i = j;
+    }
+    
+    return ret;
+}
+
+// Merge the interiors of the tiles into one contour, all in voxels. cuts[i]
+// is the height of the cut between the tiles i and i + 1. The faces along a
+// cut were made from the same distance field values by both neighbouring
+// tiles, so only the vertices on the open edges of a tile close to a cut are
+// welded, each one to the nearest such vertex of the tile on the other side
+// of the cut, if it is closer than a fraction of a voxel.
+static Contour3D _stitch_tiles(const std::vector<Contour3D> &tiles,
+                               const std::vector<double> &   cuts)
+{
+    // The faces are split by their centroid, the open edges of a tile stay
+    // within the cells of the mesher next to the cut.
+    static const double WELD_BAND      = 2.;
+    static const double WELD_TOLERANCE = 0.01;
+    
+    assert(cuts.size() + 1 == tiles.size() || tiles.empty());
+    
+    Contour3D ret;
+    std::vector<std::vector<int>> vertex_map(tiles.size());
+    
+    // Open edge vertices of the tile below the current cut, in the index of
+    // the merged contour.
+    PointIndex below;
+    std::vector<bool> welded;
+    size_t num_welded = 0, num_open = 0;
+    
+    for (size_t t = 0; t < tiles.size(); ++t) {
+        const Contour3D &tile = tiles[t];
+        std::vector<bool> open = _open_edge_vertices(tile);
+        vertex_map[t].assign(tile.points.size(), -1);
+        
+        if (t > 0) {
+            double z = cuts[t - 1];
+            for (size_t i = 0; i < tile.points.size(); ++i) {
+                const Vec3d &p = tile.points[i];
+                if (! open[i] || std::abs(p.z() - z) > WELD_BAND || below.empty()) continue;
+                
+                ++num_open;
+                std::vector<PointIndexEl> nearest = below.nearest(p, 1);
+                if (! nearest.empty() && ! welded[nearest.front().second] &&
+                    (nearest.front().first - p).norm() <= WELD_TOLERANCE) {
+                    vertex_map[t][i] = int(nearest.front().second);
+                    welded[nearest.front().second] = true;
+                    ++num_welded;
+                }
+            }
+        }
+        
+        for (size_t i = 0; i < tile.points.size(); ++i)
+            if (vertex_map[t][i] < 0) {
+                vertex_map[t][i] = int(ret.points.size());
+                ret.points.emplace_back(tile.points[i]);
+            }
+        
+        auto remap = [&vertex_map, t](auto face) {
+            for (int i = 0; i < face.size(); ++i)
+                face(i) = vertex_map[t][size_t(face(i))];
+            return face;
+        };
+        for (const Vec3i &f : tile.faces3) ret.faces3.emplace_back(remap(f));
+        for (const Vec4i &f : tile.faces4) ret.faces4.emplace_back(remap(f));
+        
+        // This tile is below the next cut.
+        below = PointIndex();
+        if (t < cuts.size()) {
+            for (size_t i = 0; i < tile.points.size(); ++i)
+                if (open[i] && std::abs(tile.points[i].z() - cuts[t]) <= WELD_BAND)
+                    below.insert(tile.points[i], unsigned(vertex_map[t][i]));
+            welded.assign(ret.points.size(), false);
+        }
+    }
+    
+    if (num_welded < num_open)
+        BOOST_LOG_TRIVIAL(warning) << "Stitching hollowing tiles: " << num_open - num_welded
+                                   << " of " << num_open << " vertices along the cuts left unwelded";
+    
+    return ret;
+}
+
+// Hollow the mesh in horizontal slabs of tile_height, each one voxelized on
+// its own with an overlap wide enough for the interior surface of the slab to
+// match the one of the whole mesh. The slabs are processed in parallel, peak
+// memory is bounded by the distance fields of the concurrently processed slabs.
+static Contour3D _generate_interior_tiled(const TriangleMesh &   mesh,
+                                             const JobController &  ctl,
+                                             double                 voxel_scale,
+                                             const InteriorOffsets &o,
+                                             double                 tile_height)
+{
+    TriangleMesh smesh{mesh};
+    smesh.require_shared_vertices();
+    
+    // Slab boundaries lie on the voxel lattice, all in voxels.
+    const BoundingBoxf3 bb      = smesh.bounding_box();
+    const double        slab    = std::max(1., std::round(tile_height * voxel_scale));
+    const double        margin  = o.cut_margin();
+    const double        zbottom = std::floor(bb.min.z() * voxel_scale);
+    const size_t        num_tiles = std::max(size_t(1),
+        size_t(std::ceil((bb.max.z() * voxel_scale - zbottom) / slab)));
+    
+    JobController tile_ctl;
+    tile_ctl.stopcondition = ctl.stopcondition;
+    tile_ctl.cancelfn      = ctl.cancelfn;
+    
+    if (ctl.stopcondition()) return {};
+    else ctl.statuscb(0, L("Hollowing"));
+    
+    // Each tile is cut from a slab of the facets overlapping it, instead of
+    // from the whole mesh. The facets are distributed to the slabs at once.
+    // Facets touching the cuts are kept in the slab, its open boundaries lie
+    // strictly outside of the cuts.
+    std::vector<std::pair<float, float>> ranges(num_tiles);
+    for (size_t i = 0; i < num_tiles; ++i) {
+        double zlo = zbottom + double(i) * slab;
+        ranges[i]  = {float((zlo - margin) / voxel_scale), float((zlo + slab + margin) / voxel_scale)};
+    }
+    std::vector<std::vector<size_t>> slab_facets =
+        _facets_in_ranges(smesh.its, ranges, float(1. / voxel_scale));
+    
+    std::vector<double> cuts(num_tiles - 1);
+    for (size_t i = 1; i < num_tiles; ++i) cuts[i - 1] = zbottom + double(i) * slab;
+    
+    std::vector<Contour3D> tiles(num_tiles);
+    std::mutex status_mutex;
+    size_t     tiles_done = 0;
+    
+    tbb::parallel_for(size_t(0), num_tiles, [&](size_t i) {
+        if (ctl.stopcondition() || slab_facets[i].empty()) return;
+        
+        auto   t_start = std::chrono::steady_clock::now();
+        double zlo     = zbottom + double(i) * slab;
+        double zhi     = zlo + slab;
+        
+        TriangleMesh part = _mesh_between(_slab_mesh(smesh.its, slab_facets[i]),
+                                          ranges[i].first, ranges[i].second);
+        std::vector<size_t>().swap(slab_facets[i]);
+        size_t part_facets = part.its.indices.size();
+        _scale(voxel_scale, part);
+        
+        size_t    grid_mem = 0;
+        Contour3D interior = _interior_contour(part, o, tile_ctl, &grid_mem);
+        
+        // The first and the last tile keep everything below resp. above them.
+        tiles[i] = _faces_between(interior,
+                                  i == 0 ? -std::numeric_limits<double>::max() : zlo,
+                                  i + 1 == num_tiles ? std::numeric_limits<double>::max() : zhi);
+        
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - t_start).count();
+        
+        std::lock_guard<std::mutex> lk(status_mutex);
+        BOOST_LOG_TRIVIAL(info) << "Hollowing tile " << i + 1 << "/" << num_tiles
+                                << ": " << part_facets << " facets, "
+                                << tiles[i].faces3.size() + tiles[i].faces4.size()
+                                << " interior faces, " << elapsed << " s, distance fields "
+                                << format_memsize_MB(grid_mem);
+        
+        ctl.statuscb(unsigned(100 * ++tiles_done / (num_tiles + 1)), L("Hollowing"));
+    });
+    
+    if (ctl.stopcondition()) return {};
+    
+    Contour3D interior = _stitch_tiles(tiles, cuts);
+    tiles.clear();
+    
+    _scale(1. / voxel_scale, interior);
+    
+    ctl.statuscb(100, L("Hollowing"));
+    
+    return interior;
+}
+
+// Height of the slabs for hollowing the mesh in tiles, zero if the distance
+// field of the whole mesh fits into the memory budget.
+static double _auto_tile_height(const TriangleMesh &   mesh,
+                                double                 voxel_scale,
+                                const InteriorOffsets &o)
+{
+    // Voxels of the distance fields processed at once, roughly 1GB.
+    static const double MAX_VOXELS = double(1 << 28);
+    
+    double area = 0.;
+    for (const stl_facet &f : mesh.stl.facet_start) {
+        const Vec3d p0 = f.vertex[0].cast<double>();
+        area += 0.5 * (f.vertex[1].cast<double>() - p0).cross(f.vertex[2].cast<double>() - p0).norm();
+    }
+    
+    // The narrow band hugs the surface, the tiles are processed concurrently.
+    double voxels = area * voxel_scale * voxel_scale * double(o.out_range + o.in_range) *
+                    double(tbb::this_task_arena::max_concurrency());
+    if (voxels <= MAX_VOXELS) return 0.;
+    
+    double height = mesh.bounding_box().size().z() * MAX_VOXELS / voxels;
+    
+    // Thinner slabs would voxelize mostly their overlaps.
+    return std::max(height, 4. * o.cut_margin() / voxel_scale);
+}
+
+static double _voxel_scale(const HollowingConfig &hc)
 {
     static const double MIN_OVERSAMPL = 3.;
     static const double MAX_OVERSAMPL = 8.;
@@ -91,10 +545,39 @@ std::unique_ptr<TriangleMesh> generate_interior(const TriangleMesh &   mesh,
     // voxels.
     //
     // max 8x upscale, min is native voxel size
-    auto voxel_scale = MIN_OVERSAMPL + (MAX_OVERSAMPL - MIN_OVERSAMPL) * hc.quality;
+    return MIN_OVERSAMPL + (MAX_OVERSAMPL - MIN_OVERSAMPL) * hc.quality;
+}
+
+std::unique_ptr<TriangleMesh> generate_interior(const TriangleMesh &   mesh,
+                                                const HollowingConfig &hc,
+                                                const JobController &  ctl,
+                                                InteriorPtr *          field)
+{
+    auto voxel_scale = _voxel_scale(hc);
+    InteriorOffsets offsets(voxel_scale, hc.min_thickness, hc.closing_distance);
+    
+    double tile_height = hc.tile_height;
+    if (tile_height == 0.) {
+        tile_height = _auto_tile_height(mesh, voxel_scale, offsets);
+        if (tile_height > 0.)
+            BOOST_LOG_TRIVIAL(info) << "Hollowing: the distance field of the whole mesh exceeds "
+                                    << "the memory budget, hollowing in slabs of " << tile_height << " mm";
+    }
+    
+    // The distance fields of the tiles are not kept, they would take the
+    // memory the tiling saves.
+    if (field) {
+        if (tile_height > 0.) field->reset();
+        else field->reset(new Interior());
+    }
+    
     auto meshptr = std::make_unique<TriangleMesh>(
-        _generate_interior(mesh, ctl, hc.min_thickness, voxel_scale,
-                           hc.closing_distance));
+        tile_height > 0. ?
+            to_triangle_mesh(_generate_interior_tiled(mesh, ctl, voxel_scale, offsets, tile_height)) :
+            _generate_interior(mesh, ctl, voxel_scale, offsets, field ? field->get() : nullptr));
+    
+    if (field && *field && (meshptr->empty() || ! (*field)->gridptr))
+        field->reset();
     
     if (meshptr && !meshptr->empty()) {
         
@@ -114,6 +597,172 @@ std::unique_ptr<TriangleMesh> generate_interior(const TriangleMesh &   mesh,
     return meshptr;
 }
 
+Contour3D generate_interior_tiles(const TriangleMesh &   mesh,
+                                  const HollowingConfig &hc,
+                                  const JobController &  ctl)
+{
+    auto voxel_scale = _voxel_scale(hc);
+    InteriorOffsets offsets(voxel_scale, hc.min_thickness, hc.closing_distance);
+    
+    return _generate_interior_tiled(mesh, ctl, voxel_scale, offsets, hc.tile_height);
+}
+
+std::vector<ExPolygons> slice_interior(const Interior &          interior,
+                                       const std::vector<float> &slicegrid,
+                                       float                     closing_radius,
+                                       std::function<void(void)> thr)
+{
+    std::vector<ExPolygons> slices(slicegrid.size());
+    
+    if (! interior.gridptr) return slices;
+    
+    const openvdb::FloatGrid &grid = *interior.gridptr;
+    const openvdb::CoordBBox  bb   = grid.evalActiveVoxelBoundingBox();
+    
+    if (bb.empty()) return slices;
+    
+    // Inactive voxels beyond the narrow band hold the background value, only
+    // their sign tells whether they are deep inside the cavity or outside.
+    static const float FAR = 1e6f;
+    const float isoval = -float(interior.iso_surface);
+    
+    // The sections are assembled from the leaf nodes crossing their voxel
+    // planes only. The leaves hold the whole narrow band, thus all the
+    // contours of a section lie within the bounding box of its leaves. The
+    // leaves are bucketed by the z of their origin.
+    using Leaf = openvdb::FloatGrid::TreeType::LeafNodeType;
+    const int LEAF_DIM = int(Leaf::DIM);
+    std::map<int, std::vector<const Leaf *>> leaves;
+    for (auto it = grid.tree().cbeginLeaf(); it; ++it)
+        leaves[it->origin().z()].emplace_back(it.getLeaf());
+    
+    auto t_start = std::chrono::steady_clock::now();
+    std::atomic<size_t> sampled{0};
+    
+    tbb::parallel_for(size_t(0), slicegrid.size(), [&](size_t layer) {
+        thr();
+        
+        double z = double(slicegrid[layer]) * interior.voxel_scale;
+        if (z < double(bb.min().z()) || z > double(bb.max().z())) return;
+        
+        int   k = int(std::floor(z));
+        float t = float(z - k);
+        
+        // Both planes fall into the same bucket unless k + 1 starts a new one.
+        std::vector<const Leaf *> layer_leaves;
+        for (int origin : {k & ~(LEAF_DIM - 1), (k + 1) & ~(LEAF_DIM - 1)}) {
+            auto it = leaves.find(origin);
+            if (it != leaves.end() && (layer_leaves.empty() || layer_leaves.front()->origin().z() != origin))
+                layer_leaves.insert(layer_leaves.end(), it->second.begin(), it->second.end());
+        }
+        if (layer_leaves.empty()) return;
+        
+        // Bounding box of the leaves with a border of one voxel outside of
+        // the cavity, so that the marching squares close all the rings.
+        openvdb::Coord lmin = layer_leaves.front()->origin(), lmax = lmin;
+        for (const Leaf *leaf : layer_leaves) {
+            lmin.minComponent(leaf->origin());
+            lmax.maxComponent(leaf->origin());
+        }
+        const int  x0   = lmin.x() - 1, y0 = lmin.y() - 1;
+        const long cols = long(lmax.x() - lmin.x() + LEAF_DIM + 2);
+        const long rows = long(lmax.y() - lmin.y() + LEAF_DIM + 2);
+        
+        // Values of a voxel plane copied from its leaves, NaN where the
+        // plane crosses a tile of the tree.
+        auto plane_values = [&](int plane) {
+            std::vector<float> values(size_t(rows * cols), std::numeric_limits<float>::quiet_NaN());
+            for (const Leaf *leaf : layer_leaves) {
+                const openvdb::Coord &o = leaf->origin();
+                if (plane < o.z() || plane >= o.z() + LEAF_DIM) continue;
+                for (int y = o.y(); y < o.y() + LEAF_DIM; ++y)
+                    for (int x = o.x(); x < o.x() + LEAF_DIM; ++x) {
+                        openvdb::Coord ijk(x, y, plane);
+                        float v = leaf->getValue(ijk);
+                        values[size_t(long(y - y0) * cols + long(x - x0))] =
+                            leaf->isValueOn(ijk) ? -v : (v < 0.f ? FAR : -FAR);
+                    }
+            }
+            
+            // A tile is either deep inside the cavity or outside of it, the
+            // same as the leaf voxels around it, the border is outside.
+            std::vector<long> queue;
+            auto fill = [&](long start, float value) {
+                queue.assign(1, start);
+                values[size_t(start)] = value;
+                while (! queue.empty()) {
+                    long idx = queue.back();
+                    queue.pop_back();
+                    long r = idx / cols, c = idx % cols;
+                    for (long n : {r > 0 ? idx - cols : -1L, r + 1 < rows ? idx + cols : -1L,
+                                   c > 0 ? idx - 1 : -1L, c + 1 < cols ? idx + 1 : -1L})
+                        if (n >= 0 && std::isnan(values[size_t(n)])) {
+                            values[size_t(n)] = value;
+                            queue.emplace_back(n);
+                        }
+                }
+            };
+            auto neighbour_sign = [&](long idx) {
+                long r = idx / cols, c = idx % cols;
+                for (long n : {r > 0 ? idx - cols : -1L, r + 1 < rows ? idx + cols : -1L,
+                               c > 0 ? idx - 1 : -1L, c + 1 < cols ? idx + 1 : -1L})
+                    if (n >= 0 && ! std::isnan(values[size_t(n)]))
+                        return values[size_t(n)] > 0.f ? FAR : -FAR;
+                return std::numeric_limits<float>::quiet_NaN();
+            };
+            
+            fill(0, -FAR);
+            for (long idx = 0; idx < rows * cols; ++idx)
+                if (std::isnan(values[size_t(idx)])) {
+                    float v = neighbour_sign(idx);
+                    if (! std::isnan(v)) fill(idx, v);
+                }
+            
+            return values;
+        };
+        
+        std::vector<float> lower = plane_values(k), upper = plane_values(k + 1);
+        
+        FieldSection section;
+        section.rows = rows;
+        section.cols = cols;
+        section.values.resize(size_t(rows * cols));
+        for (size_t i = 0; i < section.values.size(); ++i)
+            section.values[i] = (1.f - t) * lower[i] + t * upper[i];
+        sampled += section.values.size();
+        
+        std::vector<marchsq::Ring> rings = marchsq::execute(section, isoval, {2, 2});
+        
+        Polygons polys;
+        polys.reserve(rings.size());
+        for (const marchsq::Ring &ring : rings) {
+            Polygon poly;
+            poly.points.reserve(ring.size());
+            // The rings are traced clockwise in the (column, row) plane.
+            for (auto it = ring.rbegin(); it != ring.rend(); ++it) {
+                Vec2d p = section.refine(*it, isoval);
+                poly.points.emplace_back(
+                    scaled((double(x0) + p.x()) / interior.voxel_scale),
+                    scaled((double(y0) + p.y()) / interior.voxel_scale));
+            }
+            polys.emplace_back(std::move(poly));
+        }
+        
+        // Close the gaps the same way the mesh slicer does.
+        slices[layer] = closing_radius > 0.f ?
+            offset2_ex(union_(polys), scaled<float>(closing_radius), -scaled<float>(closing_radius)) :
+            union_ex(polys);
+    });
+    
+    BOOST_LOG_TRIVIAL(debug) << "Slicing the interior: " << slicegrid.size() << " layers in "
+                             << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t_start).count()
+                             << " ms, " << sampled << " voxels sampled of "
+                             << size_t(bb.dim().x()) * size_t(bb.dim().y()) * slicegrid.size()
+                             << " in the sections of the active bounding box";
+    
+    return slices;
+}
+
 Contour3D DrainHole::to_mesh() const
 {
     auto r = double(radius);
@@ -273,6 +922,62 @@ void cut_drainholes(std::vector<ExPolygons> & obj_slices,
         obj_slices[i] = diff_ex(obj_slices[i], hole_slices[i]);
 }
 
+TriangleMesh merged_holes_mesh(const DrainHoles &holes)
+{
+    std::vector<TriangleMesh>  meshes(holes.size());
+    std::vector<BoundingBoxf3> bbs(holes.size());
+    tbb::parallel_for(size_t(0), holes.size(), [&](size_t i) {
+        meshes[i] = to_triangle_mesh(holes[i].to_mesh());
+        meshes[i].require_shared_vertices();
+        bbs[i] = meshes[i].bounding_box();
+    });
+    
+    // Clusters of holes with overlapping bounding boxes, by union-find.
+    std::vector<size_t> parent(holes.size());
+    std::iota(parent.begin(), parent.end(), size_t(0));
+    auto find = [&parent](size_t i) {
+        while (parent[i] != i) i = parent[i] = parent[parent[i]];
+        return i;
+    };
+    
+    for (size_t i = 0; i < holes.size(); ++i)
+        for (size_t j = i + 1; j < holes.size(); ++j)
+            if (bbs[i].intersects(bbs[j])) parent[find(j)] = find(i);
+    
+    std::vector<std::vector<size_t>> clusters;
+    std::vector<size_t> cluster_of(holes.size(), size_t(-1));
+    for (size_t i = 0; i < holes.size(); ++i) {
+        size_t &c = cluster_of[find(i)];
+        if (c == size_t(-1)) {
+            c = clusters.size();
+            clusters.emplace_back();
+        }
+        clusters[c].emplace_back(i);
+    }
+    
+    // Only the overlapping holes need a boolean union.
+    tbb::parallel_for(size_t(0), clusters.size(), [&](size_t c) {
+        const std::vector<size_t> &cluster = clusters[c];
+        if (cluster.size() < 2) return;
+        
+        auto united = MeshBoolean::cgal::triangle_mesh_to_cgal(meshes[cluster.front()]);
+        for (size_t k = 1; k < cluster.size(); ++k) {
+            auto hole = MeshBoolean::cgal::triangle_mesh_to_cgal(meshes[cluster[k]]);
+            MeshBoolean::cgal::plus(*united, *hole);
+        }
+        
+        meshes[cluster.front()] = MeshBoolean::cgal::cgal_to_triangle_mesh(*united);
+    });
+    
+    TriangleMesh ret;
+    for (const std::vector<size_t> &cluster : clusters)
+        ret.merge(meshes[cluster.front()]);
+    
+    ret.require_shared_vertices();
+    
+    return ret;
+}
+
 void hollow_mesh(TriangleMesh &mesh, const HollowingConfig &cfg)
 {
     std::unique_ptr<Slic3r::TriangleMesh> inter_ptr =
@@ -17,6 +17,12 @@ struct HollowingConfig
     double quality          = 0.5;
     double closing_distance = 0.5;
     bool enabled = true;
+    
+    // Height of the horizontal slabs hollowed independently and in parallel
+    // to bound the memory of the distance fields. If zero, the mesh is tiled
+    // only if its distance field would not fit into a memory budget, if
+    // negative, the mesh is never tiled.
+    double tile_height      = 0.;
 };
 
 struct DrainHole
@@ -60,12 +66,40 @@ using DrainHoles = std::vector<DrainHole>;
 
 constexpr float HoleStickOutLength = 1.f;
 
+// Distance field of the interior of a hollowed mesh.
+struct Interior;
+struct InteriorDeleter { void operator()(Interior *p); };
+using InteriorPtr = std::unique_ptr<Interior, InteriorDeleter>;
+
+// Mesh of the interior surface of a hollowed mesh. If field is given, the
+// distance field the surface was extracted from is kept there for slicing the
+// interior by slice_interior(). It stays empty for meshes hollowed in tiles.
 std::unique_ptr<TriangleMesh> generate_interior(const TriangleMesh &mesh,
                                                 const HollowingConfig &  = {},
-                                                const JobController &ctl = {});
+                                                const JobController &ctl = {},
+                                                InteriorPtr *field       = nullptr);
+
+// Interior surface of the mesh hollowed in slabs of hc.tile_height as stitched
+// from the slabs, before generate_interior() repairs and simplifies it. The
+// repair would close gaps left by the stitching, this is for checking it.
+Contour3D generate_interior_tiles(const TriangleMesh &   mesh,
+                                  const HollowingConfig &hc,
+                                  const JobController &  ctl = {});
+
+// Contours of the interior cavity at the slice heights, traced in the distance
+// field by marching squares instead of slicing the interior mesh.
+std::vector<ExPolygons> slice_interior(const Interior &          interior,
+                                       const std::vector<float> &slicegrid,
+                                       float                     closing_radius,
+                                       std::function<void(void)> thr);
 
 void hollow_mesh(TriangleMesh &mesh, const HollowingConfig &cfg);
 
+// Union of the meshes of the drain holes. Only the holes overlapping each other
+// go through a boolean union, cluster by cluster in parallel, the disjoint
+// clusters are merged as they are.
+TriangleMesh merged_holes_mesh(const DrainHoles &holes);
+
 void cut_drainholes(std::vector<ExPolygons> & obj_slices,
                     const std::vector<float> &slicegrid,
                     float                     closing_radius,
@@ -41,6 +41,16 @@ public:
                                                  s, dir, hits);
     }
 
+    void intersect_rays(const TriangleMesh& tm,
+                        const std::vector<Vec3d>& s, const std::vector<Vec3d>& dir,
+                        std::vector<igl::Hit>& hits)
+    {
+        AABBTreeIndirect::intersect_rays_first_hit(tm.its.vertices,
+                                                   tm.its.indices,
+                                                   m_tree,
+                                                   s, dir, hits);
+    }
+
     double squared_distance(const TriangleMesh& tm,
                             const Vec3d& point, int& i, Eigen::Matrix<double, 1, 3>& closest) {
         size_t idx_unsigned = 0;
@@ -149,6 +159,43 @@ IndexedMesh::query_ray_hit(const Vec3d &s, const Vec3d &dir) const
     return ret;
 }
 
+std::vector<IndexedMesh::hit_result>
+IndexedMesh::query_ray_hit(const std::vector<Vec3d> &s,
+                           const std::vector<Vec3d> &dir) const
+{
+    assert(s.size() == dir.size());
+    std::vector<IndexedMesh::hit_result> outs;
+
+#ifdef SLIC3R_HOLE_RAYCASTER
+    if (! m_holes.empty()) {
+        outs.reserve(s.size());
+        for (size_t i = 0; i < s.size(); ++ i)
+            outs.emplace_back(query_ray_hit(s[i], dir[i]));
+        return outs;
+    }
+#endif
+
+    std::vector<igl::Hit> hits;
+    m_aabb->intersect_rays(*m_tm, s, dir, hits);
+
+    //  Convert the igl::Hit into hit_result
+    outs.reserve(hits.size());
+    for (size_t i = 0; i < hits.size(); ++ i) {
+        const igl::Hit &hit = hits[i];
+        assert(is_approx(dir[i].norm(), 1.));
+        outs.emplace_back(IndexedMesh::hit_result(*this));
+        outs.back().m_t = double(hit.t);
+        outs.back().m_dir = dir[i];
+        outs.back().m_source = s[i];
+        if(!std::isinf(hit.t) && !std::isnan(hit.t)) {
+            outs.back().m_normal = this->normal_by_face_id(hit.id);
+            outs.back().m_face_id = hit.id;
+        }
+    }
+
+    return outs;
+}
+
 std::vector<IndexedMesh::hit_result>
 IndexedMesh::query_ray_hits(const Vec3d &s, const Vec3d &dir) const
 {
@@ -117,6 +117,14 @@ public:
     // Casting a ray on the mesh, returns the distance where the hit occures.
     hit_result query_ray_hit(const Vec3d &s, const Vec3d &dir) const;
     
+    // Casting a batch of rays on the mesh, returns the first hit for each
+    // ray, the same as query_ray_hit() would for the individual rays.
+    // Packets of rays traverse the AABB tree together, which is several
+    // times faster if the rays are coherent, e.g. a ring of rays around a
+    // support head.
+    std::vector<hit_result> query_ray_hit(const std::vector<Vec3d> &s,
+                                          const std::vector<Vec3d> &dir) const;
+
     // Casts a ray on the mesh and returns all hits
     std::vector<hit_result> query_ray_hits(const Vec3d &s, const Vec3d &dir) const;
 
@@ -2,6 +2,9 @@
 #define SLARASTER_CPP
 
 #include <functional>
+#include <queue>
+#include <numeric>
+#include <cstring>
 
 #include <libslic3r/SLA/RasterBase.hpp>
 #include <libslic3r/SLA/AGGRaster.hpp>
@@ -38,6 +41,389 @@ EncodedRaster PNGRasterEncoder::operator()(const void *ptr, size_t w, size_t h,
     return EncodedRaster(std::move(buf), "png");
 }
 
+namespace {
+
+// Deflate (RFC 1951) stream writer producing only literals and repetitions
+// of the previous byte (distance 1), which is all that is needed to compress
+// the long runs of a constant value in the SLA mask images.
+class MaskDeflater {
+public:
+    explicit MaskDeflater(std::vector<uint8_t> &out) : m_out(out)
+    {
+        m_tokens.reserve(BlockTokens);
+    }
+
+    // Append n bytes of value v to the deflate stream.
+    void run(uint8_t v, size_t n)
+    {
+        update_adler32(v, n);
+
+        while (n > 0) {
+            if (m_last == int(v) && n >= MinMatch) {
+                size_t len = std::min(n, MaxMatch);
+                // Don't leave a tail shorter than the shortest match.
+                if (n - len > 0 && n - len < MinMatch) len = n - MinMatch;
+                m_tokens.emplace_back(uint16_t(256 + len - MinMatch));
+                n -= len;
+            } else {
+                m_tokens.emplace_back(v);
+                m_last = v;
+                --n;
+            }
+
+            if (m_tokens.size() >= BlockTokens) flush_block(false);
+        }
+    }
+
+    void finish()
+    {
+        flush_block(true);
+        if (m_nbits > 0) m_out.emplace_back(uint8_t(m_bits));
+        m_bits = 0; m_nbits = 0;
+    }
+
+    // Adler-32 checksum of the uncompressed data to be stored after the
+    // deflate stream in the zlib format.
+    uint32_t adler32() const { return (m_s2 << 16) | m_s1; }
+
+private:
+    static constexpr size_t BlockTokens = 1 << 16;
+    static constexpr size_t MinMatch    = 3;
+    static constexpr size_t MaxMatch    = 258;
+    static constexpr uint64_t AdlerMod  = 65521;
+
+    // Match length code: deflate symbol 257..285, its extra bits and base.
+    struct LengthCode { uint16_t symbol = 0; uint8_t extra_bits = 0; uint16_t base = 0; };
+
+    static const LengthCode &length_code(size_t len)
+    {
+        static const std::array<LengthCode, MaxMatch + 1> table = []() {
+            static const uint16_t base[29] = {
+                3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+            static const uint8_t extra[29] = {
+                0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+
+            std::array<LengthCode, MaxMatch + 1> t;
+            for (unsigned i = 0; i < 29; ++i) {
+                // Length 258 has its own symbol 285, not 284 with extra bits 31.
+                unsigned end = i + 1 < 29 ? base[i + 1] : unsigned(MaxMatch + 1);
+                for (unsigned l = base[i]; l < end; ++l)
+                    t[l] = {uint16_t(257 + i), extra[i], base[i]};
+            }
+            return t;
+        }();
+
+        return table[len];
+    }
+
+    // The run of n bytes of value v is accounted for in a closed form.
+    void update_adler32(uint8_t v, size_t n)
+    {
+        uint64_t nm = n % AdlerMod;
+        uint64_t tri = (uint64_t(n) * (n + 1) / 2) % AdlerMod;
+        m_s2 = uint32_t((m_s2 + nm * m_s1 + v * tri) % AdlerMod);
+        m_s1 = uint32_t((m_s1 + v * nm) % AdlerMod);
+    }
+
+    void put_bits(uint32_t bits, unsigned n)
+    {
+        m_bits |= uint64_t(bits) << m_nbits;
+        m_nbits += n;
+        while (m_nbits >= 8) {
+            m_out.emplace_back(uint8_t(m_bits));
+            m_bits >>= 8;
+            m_nbits -= 8;
+        }
+    }
+
+    // Huffman code lengths of at most max_len bits for the symbols with
+    // a non-zero frequency. Over-long codes are shortened the same way as in
+    // miniz tdefl_huffman_enforce_max_code_size().
+    static void huffman_lengths(const uint32_t *freq, size_t n, unsigned max_len, uint8_t *lengths)
+    {
+        std::fill(lengths, lengths + n, uint8_t(0));
+
+        std::vector<uint32_t> syms;
+        for (uint32_t i = 0; i < n; ++i) if (freq[i]) syms.emplace_back(i);
+
+        if (syms.empty()) return;
+        if (syms.size() == 1) {
+            // A complete code needs at least two symbols.
+            lengths[syms.front()] = 1;
+            lengths[syms.front() == 0 ? 1 : 0] = 1;
+            return;
+        }
+
+        // Leaves of the Huffman tree are 0..m-1, inner nodes m..2m-2.
+        size_t m = syms.size();
+        std::vector<uint64_t> weight(2 * m - 1);
+        std::vector<size_t> parent(2 * m - 1, 0);
+        using Item = std::pair<uint64_t, size_t>;
+        std::priority_queue<Item, std::vector<Item>, std::greater<Item>> queue;
+        for (size_t i = 0; i < m; ++i) {
+            weight[i] = freq[syms[i]];
+            queue.emplace(weight[i], i);
+        }
+        for (size_t next = m; next < 2 * m - 1; ++next) {
+            Item a = queue.top(); queue.pop();
+            Item b = queue.top(); queue.pop();
+            weight[next] = a.first + b.first;
+            parent[a.second] = parent[b.second] = next;
+            queue.emplace(weight[next], next);
+        }
+
+        std::vector<unsigned> depth(2 * m - 1, 0);
+        for (size_t i = 2 * m - 2; i-- > 0;) depth[i] = depth[parent[i]] + 1;
+
+        // Number of codes of each length.
+        std::array<uint32_t, 64> count = {};
+        for (size_t i = 0; i < m; ++i) ++count[std::min(depth[i], 63u)];
+        for (unsigned l = max_len + 1; l < 64; ++l) {
+            count[max_len] += count[l];
+            count[l] = 0;
+        }
+
+        uint64_t total = 0;
+        for (unsigned l = 1; l <= max_len; ++l)
+            total += uint64_t(count[l]) << (max_len - l);
+
+        while (total > (uint64_t(1) << max_len)) {
+            --count[max_len];
+            for (unsigned l = max_len - 1; l > 0; --l)
+                if (count[l]) { --count[l]; count[l + 1] += 2; break; }
+            --total;
+        }
+
+        // Shortest codes to the most frequent symbols.
+        std::vector<size_t> order(m);
+        std::iota(order.begin(), order.end(), size_t(0));
+        std::stable_sort(order.begin(), order.end(), [&weight](size_t a, size_t b) {
+            return weight[a] > weight[b];
+        });
+
+        size_t k = 0;
+        for (unsigned l = 1; l <= max_len; ++l)
+            for (uint32_t c = 0; c < count[l]; ++c)
+                lengths[syms[order[k++]]] = uint8_t(l);
+    }
+
+    // Canonical Huffman codes, bit reversed as deflate writes the codes
+    // starting with the most significant bit into a LSB first bit stream.
+    static void huffman_codes(const uint8_t *lengths, size_t n, uint16_t *codes)
+    {
+        std::array<uint16_t, 16> count = {}, next = {};
+        for (size_t i = 0; i < n; ++i) ++count[lengths[i]];
+        count[0] = 0;
+
+        uint16_t code = 0;
+        for (unsigned l = 1; l < 16; ++l) {
+            code    = uint16_t((code + count[l - 1]) << 1);
+            next[l] = code;
+        }
+
+        for (size_t i = 0; i < n; ++i) {
+            unsigned l = lengths[i];
+            if (l == 0) continue;
+            uint16_t c = next[l]++, r = 0;
+            for (unsigned b = 0; b < l; ++b, c >>= 1) r = uint16_t((r << 1) | (c & 1));
+            codes[i] = r;
+        }
+    }
+
+    // Write the collected tokens as a deflate block with dynamic Huffman codes.
+    void flush_block(bool last)
+    {
+        static constexpr size_t NumLitLen = 286;
+
+        std::array<uint32_t, NumLitLen> lfreq = {};
+        for (uint16_t t : m_tokens)
+            ++lfreq[t < 256 ? t : length_code(t - 256 + MinMatch).symbol];
+        lfreq[256] = 1; // end of block
+
+        std::array<uint8_t, NumLitLen> llen;
+        std::array<uint16_t, NumLitLen> lcode = {};
+        huffman_lengths(lfreq.data(), NumLitLen, 15, llen.data());
+        huffman_codes(llen.data(), NumLitLen, lcode.data());
+
+        // Distance 1 (distance code 0) is the only distance used. Two codes
+        // of one bit make a complete distance tree.
+        static const uint8_t dlen[2] = {1, 1};
+        static constexpr unsigned hdist = 2;
+
+        unsigned hlit = NumLitLen;
+        while (hlit > 257 && llen[hlit - 1] == 0) --hlit;
+
+        // Code lengths of both trees, run length encoded by the symbols
+        // 16 (repeat previous), 17 and 18 (repeat zero).
+        std::vector<uint8_t> lens(llen.begin(), llen.begin() + hlit);
+        lens.insert(lens.end(), dlen, dlen + hdist);
+
+        struct CLSymbol { uint8_t symbol, extra; };
+        std::vector<CLSymbol> cl;
+        for (size_t i = 0; i < lens.size();) {
+            size_t j = i;
+            while (j < lens.size() && lens[j] == lens[i]) ++j;
+            size_t n = j - i;
+
+            if (lens[i] == 0) {
+                for (; n >= 11; ) {
+                    size_t k = std::min(n, size_t(138));
+                    cl.push_back({18, uint8_t(k - 11)}); n -= k;
+                }
+                if (n >= 3) { cl.push_back({17, uint8_t(n - 3)}); n = 0; }
+            } else {
+                cl.push_back({lens[i], 0}); --n;
+                for (; n >= 3; ) {
+                    size_t k = std::min(n, size_t(6));
+                    cl.push_back({16, uint8_t(k - 3)}); n -= k;
+                }
+            }
+
+            for (; n > 0; --n) cl.push_back({lens[i], 0});
+            i = j;
+        }
+
+        std::array<uint32_t, 19> cfreq = {};
+        for (const CLSymbol &c : cl) ++cfreq[c.symbol];
+        std::array<uint8_t, 19> clen;
+        std::array<uint16_t, 19> ccode = {};
+        huffman_lengths(cfreq.data(), 19, 7, clen.data());
+        huffman_codes(clen.data(), 19, ccode.data());
+
+        static const uint8_t cl_order[19] = {16, 17, 18, 0, 8,  7, 9,  6, 10, 5,
+                                             11, 4,  12, 3, 13, 2, 14, 1, 15};
+        unsigned hclen = 19;
+        while (hclen > 4 && clen[cl_order[hclen - 1]] == 0) --hclen;
+
+        // Block header.
+        put_bits(last ? 1 : 0, 1);
+        put_bits(2, 2); // compressed with dynamic Huffman codes
+        put_bits(hlit - 257, 5);
+        put_bits(hdist - 1, 5);
+        put_bits(hclen - 4, 4);
+        for (unsigned i = 0; i < hclen; ++i) put_bits(clen[cl_order[i]], 3);
+        for (const CLSymbol &c : cl) {
+            put_bits(ccode[c.symbol], clen[c.symbol]);
+            switch (c.symbol) {
+            case 16: put_bits(c.extra, 2); break;
+            case 17: put_bits(c.extra, 3); break;
+            case 18: put_bits(c.extra, 7); break;
+            default:;
+            }
+        }
+
+        // Block data.
+        for (uint16_t t : m_tokens) {
+            if (t < 256) {
+                put_bits(lcode[t], llen[t]);
+            } else {
+                size_t len = t - 256 + MinMatch;
+                const LengthCode &lc = length_code(len);
+                put_bits(lcode[lc.symbol], llen[lc.symbol]);
+                if (lc.extra_bits) put_bits(uint32_t(len - lc.base), lc.extra_bits);
+                put_bits(0, 1); // distance code 0: distance 1
+            }
+        }
+        put_bits(lcode[256], llen[256]);
+
+        m_tokens.clear();
+    }
+
+    std::vector<uint8_t> &m_out;
+    uint64_t m_bits  = 0;
+    unsigned m_nbits = 0;
+
+    // 0..255: literal, 256 + length - MinMatch: repetition of the previous byte.
+    std::vector<uint16_t> m_tokens;
+    int m_last = -1;
+
+    uint32_t m_s1 = 1, m_s2 = 0;
+};
+
+void write_be32(std::vector<uint8_t> &out, uint32_t v)
+{
+    for (int i = 3; i >= 0; --i) out.emplace_back(uint8_t(v >> (8 * i)));
+}
+
+// Append a PNG chunk, fill in its length and CRC.
+template<class Fn> void write_png_chunk(std::vector<uint8_t> &out, const char *type, Fn &&fn)
+{
+    size_t len_pos = out.size();
+    write_be32(out, 0);
+    size_t type_pos = out.size();
+    out.insert(out.end(), type, type + 4);
+    fn();
+
+    auto len = uint32_t(out.size() - type_pos - 4);
+    for (int i = 0; i < 4; ++i) out[len_pos + i] = uint8_t(len >> (24 - 8 * i));
+
+    write_be32(out, uint32_t(mz_crc32(MZ_CRC32_INIT, out.data() + type_pos, out.size() - type_pos)));
+}
+
+} // namespace
+
+EncodedRaster PNGMaskRasterEncoder::operator()(const void *ptr, size_t w, size_t h,
+                                               size_t      num_components)
+{
+    static const uint8_t signature[8] = {0x89, 'P', 'N', 'G', 0x0d, 0x0a, 0x1a, 0x0a};
+    // PNG color types for 1 to 4 channels (gray, gray + alpha, RGB, RGBA).
+    static const uint8_t color_type[5] = {0, 0, 4, 2, 6};
+
+    if (num_components < 1 || num_components > 4) return EncodedRaster({}, "png");
+
+    std::vector<uint8_t> buf;
+    // The masks usually compress to about 1 % of their raw size.
+    buf.reserve(w * h * num_components / 64 + 1024);
+    buf.insert(buf.end(), signature, signature + 8);
+
+    write_png_chunk(buf, "IHDR", [&] {
+        write_be32(buf, uint32_t(w));
+        write_be32(buf, uint32_t(h));
+        buf.emplace_back(8); // bit depth
+        buf.emplace_back(color_type[num_components]);
+        buf.emplace_back(0); // deflate compression
+        buf.emplace_back(0); // adaptive filtering
+        buf.emplace_back(0); // no interlace
+    });
+
+    write_png_chunk(buf, "IDAT", [&] {
+        // zlib header: deflate with 32K window, no preset dictionary.
+        buf.emplace_back(0x78);
+        buf.emplace_back(0x01);
+
+        MaskDeflater deflater(buf);
+        const size_t bpl = w * num_components;
+        for (size_t y = 0; y < h; ++y) {
+            deflater.run(0, 1); // filter type None
+
+            const auto *px  = static_cast<const uint8_t *>(ptr) + y * bpl;
+            const auto *end = px + bpl;
+            while (px < end) {
+                // Find the end of the run, 8 pixels at a time.
+                const uint8_t *e = px + 1;
+                const uint64_t pattern = UINT64_C(0x0101010101010101) * *px;
+                for (uint64_t word; e + 8 <= end; e += 8) {
+                    std::memcpy(&word, e, 8);
+                    if (word != pattern) break;
+                }
+                while (e < end && *e == *px) ++e;
+
+                deflater.run(*px, size_t(e - px));
+                px = e;
+            }
+        }
+
+        deflater.finish();
+        write_be32(buf, deflater.adler32());
+    });
+
+    write_png_chunk(buf, "IEND", [] {});
+
+    return EncodedRaster(std::move(buf), "png");
+}
+
 std::ostream &operator<<(std::ostream &stream, const EncodedRaster &bytes)
 {
     stream.write(reinterpret_cast<const char *>(bytes.data()),
@@ -106,6 +106,15 @@ struct PNGRasterEncoder {
     EncodedRaster operator()(const void *ptr, size_t w, size_t h, size_t num_components);
 };
 
+// PNG encoder tuned for the SLA masks: Large areas of a constant value (mostly black) separated by short
+// anti-aliased edges. The rows are not filtered and the deflate stream only contains literals and
+// repetitions of the previous byte (run length encoding within deflate), coded with dynamic Huffman codes.
+// The output is a standard 8 bit PNG of the same size as PNGRasterEncoder produces for such images,
+// while the encoding is several times faster, as no match search over the deflate window is performed.
+struct PNGMaskRasterEncoder {
+    EncodedRaster operator()(const void *ptr, size_t w, size_t h, size_t num_components);
+};
+
 struct PPMRasterEncoder {
     EncodedRaster operator()(const void *ptr, size_t w, size_t h, size_t num_components);
 };
@@ -91,28 +91,43 @@ void SupportPointGenerator::project_onto_mesh(std::vector<sla::SupportPoint>& po
 {
     // The function  makes sure that all the points are really exactly placed on the mesh.
 
+    // Points are projected in batches of neighbouring points (the points are generated layer by layer),
+    // the parallel rays of a batch are cast on the mesh together.
+    static constexpr size_t batch_size = 8;
     // Use a reasonable granularity to account for the worker thread synchronization cost.
-    static constexpr size_t gransize = 64;
+    static constexpr size_t gransize = 64 / batch_size;
 
-    ccr_par::for_each(size_t(0), points.size(), [this, &points](size_t idx)
+    ccr_par::for_each(size_t(0), (points.size() + batch_size - 1) / batch_size, [this, &points](size_t batch_idx)
     {
-        if ((idx % 16) == 0)
+        if ((batch_idx % 2) == 0)
             // Don't call the following function too often as it flushes CPU write caches due to synchronization primitves.
             m_throw_on_cancel();
 
-        Vec3f& p = points[idx].pos;
-        // Project the point upward and downward and choose the closer intersection with the mesh.
-        sla::IndexedMesh::hit_result hit_up   = m_emesh.query_ray_hit(p.cast<double>(), Vec3d(0., 0., 1.));
-        sla::IndexedMesh::hit_result hit_down = m_emesh.query_ray_hit(p.cast<double>(), Vec3d(0., 0., -1.));
+        const size_t first = batch_idx * batch_size;
+        const size_t last  = std::min(first + batch_size, points.size());
+        std::vector<Vec3d> sources;
+        sources.reserve(last - first);
+        for (size_t idx = first; idx < last; ++ idx)
+            sources.emplace_back(points[idx].pos.cast<double>());
 
-        bool up   = hit_up.is_hit();
-        bool down = hit_down.is_hit();
+        // Project the points upward and downward and choose the closer intersection with the mesh.
+        std::vector<sla::IndexedMesh::hit_result> hits_up   = m_emesh.query_ray_hit(sources, std::vector<Vec3d>(sources.size(), Vec3d(0., 0., 1.)));
+        std::vector<sla::IndexedMesh::hit_result> hits_down = m_emesh.query_ray_hit(sources, std::vector<Vec3d>(sources.size(), Vec3d(0., 0., -1.)));
 
-        if (!up && !down)
-            return;
+        for (size_t i = 0; i < sources.size(); ++ i) {
+            sla::IndexedMesh::hit_result &hit_up   = hits_up[i];
+            sla::IndexedMesh::hit_result &hit_down = hits_down[i];
 
-        sla::IndexedMesh::hit_result& hit = (!down || (hit_up.distance() < hit_down.distance())) ? hit_up : hit_down;
-        p = p + (hit.distance() * hit.direction()).cast<float>();
+            bool up   = hit_up.is_hit();
+            bool down = hit_down.is_hit();
+
+            if (!up && !down)
+                continue;
+
+            Vec3f& p = points[first + i].pos;
+            sla::IndexedMesh::hit_result& hit = (!down || (hit_up.distance() < hit_down.distance())) ? hit_up : hit_down;
+            p = p + (hit.distance() * hit.direction()).cast<float>();
+        }
     }, gransize);
 }
 
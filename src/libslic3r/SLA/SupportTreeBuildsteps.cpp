@@ -4,6 +4,8 @@
 #include <libslic3r/Optimize/NLoptOptimizer.hpp>
 #include <boost/log/trivial.hpp>
 
+#include <optional>
+
 namespace Slic3r {
 namespace sla {
 
@@ -32,6 +34,42 @@ static Hit min_hit(const C &hits)
     return *mit;
 }
 
+// Cast the rays of a ring around a pinhead or a bridge given by the sources
+// and the directions. The rays of a ring are coherent, they are cast by the
+// batched query of the mesh, which traverses the tree with packets of up to
+// AABBTreeIndirect::detail::RayPacketSize rays sharing the octant of their
+// direction. The recast function is called with the index and the hit of each
+// ray: it may modify the hit, and it returns the source of the ray to be
+// re-cast in the same direction if the ray started inside the model.
+template<class RecastFn>
+static std::vector<IndexedMesh::hit_result> cast_ring(
+    const IndexedMesh &m, const std::vector<Vec3d> &sources,
+    const std::vector<Vec3d> &dirs, RecastFn &&recast_fn)
+{
+    using Hit = IndexedMesh::hit_result;
+
+    std::vector<Hit> hits = m.query_ray_hit(sources, dirs);
+
+    // Rays starting inside the model are re-cast from the outside, all of
+    // them in a single batch again.
+    std::vector<size_t> recast;
+    std::vector<Vec3d>  rsources, rdirs;
+    for (size_t i = 0; i < hits.size(); ++i)
+        if (std::optional<Vec3d> src = recast_fn(i, hits[i])) {
+            recast.emplace_back(i);
+            rsources.emplace_back(*src);
+            rdirs.emplace_back(dirs[i]);
+        }
+
+    if (! recast.empty()) {
+        std::vector<Hit> recast_hits = m.query_ray_hit(rsources, rdirs);
+        for (size_t i = 0; i < recast.size(); ++i)
+            hits[recast[i]] = recast_hits[i];
+    }
+
+    return hits;
+}
+
 SupportTreeBuildsteps::SupportTreeBuildsteps(SupportTreeBuilder &   builder,
                                              const SupportableMesh &sm)
     : m_cfg(sm.cfg)
@@ -191,9 +229,6 @@ IndexedMesh::hit_result SupportTreeBuildsteps::pinhead_mesh_intersect(
     auto& m = m_mesh;
     using HitResult = IndexedMesh::hit_result;
 
-    // Hit results
-    std::array<HitResult, SAMPLES> hits;
-
     struct Rings {
         double rpin;
         double rback;
@@ -207,50 +242,51 @@ IndexedMesh::hit_result SupportTreeBuildsteps::pinhead_mesh_intersect(
 
     // We will shoot multiple rays from the head pinpoint in the direction
     // of the pinhead robe (side) surface. The result will be the smallest
-    // hit distance.
-
-    ccr::for_each(size_t(0), hits.size(),
-                  [&m, &rings, sd, &hits](size_t i) {
-
-       // Point on the circle on the pin sphere
-       Vec3d ps = rings.pinring(i);
-       // This is the point on the circle on the back sphere
-       Vec3d p = rings.backring(i);
-
-       auto &hit = hits[i];
-
-       // Point ps is not on mesh but can be inside or
-       // outside as well. This would cause many problems
-       // with ray-casting. To detect the position we will
-       // use the ray-casting result (which has an is_inside
-       // predicate).
-
-       Vec3d n = (p - ps).normalized();
-       auto  q = m.query_ray_hit(ps + sd * n, n);
-
-       if (q.is_inside()) { // the hit is inside the model
-           if (q.distance() > rings.rpin) {
-               // If we are inside the model and the hit
-               // distance is bigger than our pin circle
-               // diameter, it probably indicates that the
-               // support point was already inside the
-               // model, or there is really no space
-               // around the point. We will assign a zero
-               // hit distance to these cases which will
-               // enforce the function return value to be
-               // an invalid ray with zero hit distance.
-               // (see min_element at the end)
-               hit = HitResult(0.0);
-           } else {
-               // re-cast the ray from the outside of the
-               // object. The starting point has an offset
-               // of 2*safety_distance because the
-               // original ray has also had an offset
-               auto q2 = m.query_ray_hit(ps + (q.distance() + 2 * sd) * n, n);
-               hit = q2;
-           }
-       } else
-           hit = q;
+    // hit distance. The rays of the ring are cast in packets, see cast_ring().
+
+    std::array<Vec3d, SAMPLES> pins;
+    std::vector<Vec3d> sources(SAMPLES), dirs(SAMPLES);
+    for (size_t i = 0; i < SAMPLES; ++i) {
+        // Point on the circle on the pin sphere
+        const Vec3d &ps = pins[i] = rings.pinring(i);
+        // This is the point on the circle on the back sphere
+        Vec3d p = rings.backring(i);
+
+        // Point ps is not on mesh but can be inside or
+        // outside as well. This would cause many problems
+        // with ray-casting. To detect the position we will
+        // use the ray-casting result (which has an is_inside
+        // predicate).
+
+        dirs[i]    = (p - ps).normalized();
+        sources[i] = ps + sd * dirs[i];
+    }
+
+    // Hit results
+    std::vector<HitResult> hits = cast_ring(m, sources, dirs,
+        [&rings, &pins, &dirs, sd](size_t i, HitResult &q) -> std::optional<Vec3d> {
+        if (q.is_inside()) { // the hit is inside the model
+            if (q.distance() > rings.rpin) {
+                // If we are inside the model and the hit
+                // distance is bigger than our pin circle
+                // diameter, it probably indicates that the
+                // support point was already inside the
+                // model, or there is really no space
+                // around the point. We will assign a zero
+                // hit distance to these cases which will
+                // enforce the function return value to be
+                // an invalid ray with zero hit distance.
+                // (see min_element at the end)
+                q = HitResult(0.0);
+            } else {
+                // re-cast the ray from the outside of the
+                // object. The starting point has an offset
+                // of 2*safety_distance because the
+                // original ray has also had an offset
+                return pins[i] + (q.distance() + 2 * sd) * dirs[i];
+            }
+        }
+        return {};
     });
 
     return min_hit(hits);
@@ -264,26 +300,25 @@ IndexedMesh::hit_result SupportTreeBuildsteps::bridge_mesh_intersect(
 
     using Hit = IndexedMesh::hit_result;
 
-    // Hit results
-    std::array<Hit, SAMPLES> hits;
-
-    ccr::for_each(size_t(0), hits.size(),
-                 [this, r, src, /*ins_check,*/ &ring, dir, sd, &hits] (size_t i)
-    {
-        Hit &hit = hits[i];
-
+    // The rays of the ring are cast in packets, see cast_ring().
+    std::vector<Vec3d> sources(SAMPLES), dirs(SAMPLES, dir);
+    for (size_t i = 0; i < SAMPLES; ++i) {
         // Point on the circle on the pin sphere
         Vec3d p = ring.get(i, src, r + sd);
+        sources[i] = p + r * dir;
+    }
 
-        auto hr = m_mesh.query_ray_hit(p + r * dir, dir);
-
+    // Hit results
+    std::vector<Hit> hits = cast_ring(m_mesh, sources, dirs,
+        [&ring, &src, &dir, r, sd](size_t i, Hit &hr) -> std::optional<Vec3d> {
         if(/*ins_check && */hr.is_inside()) {
-            if(hr.distance() > 2 * r + sd) hit = Hit(0.0);
+            if(hr.distance() > 2 * r + sd) hr = Hit(0.0);
             else {
                 // re-cast the ray from the outside of the object
-                hit = m_mesh.query_ray_hit(p + (hr.distance() + EPSILON) * dir, dir);
+                return ring.get(i, src, r + sd) + (hr.distance() + EPSILON) * dir;
             }
-        } else hit = hr;
+        }
+        return {};
     });
 
     return min_hit(hits);
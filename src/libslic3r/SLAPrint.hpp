@@ -3,9 +3,11 @@
 
 #include <cstdint>
 #include <mutex>
+#include <unordered_map>
 #include "PrintBase.hpp"
 #include "SLA/RasterBase.hpp"
 #include "SLA/SupportTree.hpp"
+#include "SLA/Hollowing.hpp"
 #include "Point.hpp"
 #include "MTUtils.hpp"
 #include "Zipper.hpp"
@@ -329,6 +331,11 @@ private:
     public:
         
         TriangleMesh interior;
+        // Distance field of the interior, the interior is sliced from it if
+        // present. It holds the narrow band of the field around the interior
+        // surface, which takes several times the memory of the interior mesh,
+        // thus it is only kept from hollow_model() until slice_model().
+        sla::InteriorPtr interior_field;
         mutable TriangleMesh hollow_mesh_with_holes; // caching the complete hollowed mesh
     };
     
@@ -375,22 +382,57 @@ struct SLAPrintStatistics
 class SLAPrinter {
 protected:
     std::vector<sla::EncodedRaster> m_layers;
+    // Contents of each of m_layers as returned by the KeyFn of draw_layers(),
+    // and the raster parameters m_layers were drawn with. The contents are
+    // kept to compare them byte by byte, a hash match alone may be a
+    // collision. They take about as much memory as the slices they describe.
+    std::vector<std::string>        m_layer_keys;
+    std::string                     m_layers_raster_params;
     
     virtual uqptr<sla::RasterBase> create_raster() const = 0;
     virtual sla::RasterEncoder get_encoder() const = 0;
+    // Serialized parameters the rasters are created and encoded with.
+    virtual std::string raster_params() const = 0;
     
 public:
     virtual ~SLAPrinter() = default;
     
     virtual void apply(const SLAPrinterConfig &cfg) = 0;
     
+    // Drop the rasters, none of them will be reused.
+    void clear_layers() { m_layers = {}; m_layer_keys = {}; m_layers_raster_params.clear(); }
+    
     // Fn have to be thread safe: void(sla::RasterBase& raster, size_t lyrid);
-    template<class Fn> void draw_layers(size_t layer_num, Fn &&drawfn)
+    // KeyFn have to be thread safe: std::string(size_t lyrid), the contents
+    // drawfn draws into the layer, serialized. A layer of the same contents
+    // as one drawn by the previous call with the same raster parameters
+    // reuses its encoded raster without calling drawfn.
+    // ReuseFn have to be thread safe: void(size_t lyrid), called instead of
+    // drawfn for the reused layers, for example to advance the progress.
+    template<class Fn, class KeyFn, class ReuseFn>
+    void draw_layers(size_t layer_num, Fn &&drawfn, KeyFn &&keyfn, ReuseFn &&reusefn)
     {
-        m_layers.resize(layer_num);
+        std::string params = raster_params();
+        std::unordered_map<std::string, sla::EncodedRaster> prev_layers;
+        if (params == m_layers_raster_params)
+            for (size_t i = 0; i < m_layers.size() && i < m_layer_keys.size(); ++i)
+                prev_layers.emplace(std::move(m_layer_keys[i]), std::move(m_layers[i]));
+        
+        m_layers_raster_params = std::move(params);
+        m_layers.assign(layer_num, {});
+        m_layer_keys.assign(layer_num, {});
         sla::ccr::for_each(size_t(0), m_layers.size(),
-                           [this, &drawfn] (size_t idx) {
+                           [this, &drawfn, &keyfn, &reusefn, &prev_layers] (size_t idx) {
+                               m_layer_keys[idx] = keyfn(idx);
+                               
                                sla::EncodedRaster& enc = m_layers[idx];
+                               auto it = prev_layers.find(m_layer_keys[idx]);
+                               if (it != prev_layers.end()) {
+                                   enc = it->second;
+                                   reusefn(idx);
+                                   return;
+                               }
+                               
                                auto rst = create_raster();
                                drawfn(*rst, idx);
                                enc = rst->encode(get_encoder());
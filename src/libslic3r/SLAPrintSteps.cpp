@@ -131,13 +131,15 @@ void SLAPrint::Steps::hollow_model(SLAPrintObject &po)
     double quality  = po.m_config.hollowing_quality.getFloat();
     double closing_d = po.m_config.hollowing_closing_distance.getFloat();
     sla::HollowingConfig hlwcfg{thickness, quality, closing_d};
-    auto meshptr = generate_interior(po.transformed_mesh(), hlwcfg);
+    sla::InteriorPtr field;
+    auto meshptr = generate_interior(po.transformed_mesh(), hlwcfg, {}, &field);
 
     if (meshptr->empty())
         BOOST_LOG_TRIVIAL(warning) << "Hollowed interior is empty!";
     else {
         po.m_hollowing_data.reset(new SLAPrintObject::HollowingData());
         po.m_hollowing_data->interior = *meshptr;
+        po.m_hollowing_data->interior_field = std::move(field);
     }
 }
 
@@ -177,17 +179,16 @@ void SLAPrint::Steps::drill_holes(SLAPrintObject &po)
     sla::DrainHoles drainholes = po.transformed_drainhole_points();
     
     std::uniform_real_distribution<float> dist(0., float(EPSILON));
-    auto holes_mesh_cgal = MeshBoolean::cgal::triangle_mesh_to_cgal({});
-    for (sla::DrainHole holept : drainholes) {
+    for (sla::DrainHole &holept : drainholes) {
         holept.normal += Vec3f{dist(m_rng), dist(m_rng), dist(m_rng)};
         holept.normal.normalize();
         holept.pos += Vec3f{dist(m_rng), dist(m_rng), dist(m_rng)};
-        TriangleMesh m = sla::to_triangle_mesh(holept.to_mesh());
-        m.require_shared_vertices();
-        auto cgal_m = MeshBoolean::cgal::triangle_mesh_to_cgal(m);
-        MeshBoolean::cgal::plus(*holes_mesh_cgal, *cgal_m);
     }
     
+    // All the holes are subtracted at once, the hollowed mesh is converted
+    // to and from CGAL only once.
+    auto holes_mesh_cgal = MeshBoolean::cgal::triangle_mesh_to_cgal(sla::merged_holes_mesh(drainholes));
+    
     if (MeshBoolean::cgal::does_self_intersect(*holes_mesh_cgal))
         throw Slic3r::SlicingError(L("Too many overlapping holes."));
     
@@ -261,10 +262,20 @@ void SLAPrint::Steps::slice_model(SLAPrintObject &po)
     slicer.slice(slice_grid, SlicingMode::Regular, closing_r, &po.m_model_slices, thr);
     
     if (po.m_hollowing_data && ! po.m_hollowing_data->interior.empty()) {
-        po.m_hollowing_data->interior.repair(true);
-        TriangleMeshSlicer interior_slicer(&po.m_hollowing_data->interior);
         std::vector<ExPolygons> interior_slices;
-        interior_slicer.slice(slice_grid, SlicingMode::Regular, closing_r, &interior_slices, thr);
+        if (po.m_hollowing_data->interior_field) {
+            // Trace the interior in its distance field, the interior mesh
+            // does not need to be sliced.
+            interior_slices = sla::slice_interior(*po.m_hollowing_data->interior_field,
+                                                  slice_grid, closing_r, thr);
+            // The field is not needed anymore, release it. If the slices are
+            // invalidated without the hollowing, the interior mesh is sliced.
+            po.m_hollowing_data->interior_field.reset();
+        } else {
+            po.m_hollowing_data->interior.repair(true);
+            TriangleMeshSlicer interior_slicer(&po.m_hollowing_data->interior);
+            interior_slicer.slice(slice_grid, SlicingMode::Regular, closing_r, &interior_slices, thr);
+        }
 
         sla::ccr::for_each(size_t(0), interior_slices.size(),
                            [&po, &interior_slices] (size_t i) {
@@ -839,10 +850,20 @@ void SLAPrint::Steps::rasterize()
     sla::ccr::SpinningMutex slck;
     using Lock = std::lock_guard<sla::ccr::SpinningMutex>;
     
+    // Status indication of a layer drawn or reused, guarded with the spinlock
+    auto layer_done = [this, &slck, increment, &dstatus, &pst]()
+    {
+        Lock lck(slck);
+        dstatus += increment;
+        double st = std::round(dstatus);
+        if(st > pst) {
+            report_status(st, PRINT_STEP_LABELS(slapsRasterize));
+            pst = st;
+        }
+    };
+    
     // procedure to process one height level. This will run in parallel
-    auto lvlfn =
-        [this, &slck, increment, &dstatus, &pst]
-        (sla::RasterBase& raster, size_t idx)
+    auto lvlfn = [this, &layer_done] (sla::RasterBase& raster, size_t idx)
     {
         PrintLayer& printlayer = m_print->m_printer_input[idx];
         if(canceled()) return;
@@ -850,23 +871,44 @@ void SLAPrint::Steps::rasterize()
         for (const ClipperLib::Polygon& poly : printlayer.transformed_slices())
             raster.draw(poly);
         
-        // Status indication guarded with the spinlock
-        {
-            Lock lck(slck);
-            dstatus += increment;
-            double st = std::round(dstatus);
-            if(st > pst) {
-                report_status(st, PRINT_STEP_LABELS(slapsRasterize));
-                pst = st;
-            }
+        layer_done();
+    };
+    
+    // The rasters of the layers which did not change since the last run are
+    // reused.
+    auto reusefn = [&layer_done](size_t) { layer_done(); };
+    
+    // Contents of a layer, the transformed slices serialized.
+    auto keyfn = [this](size_t idx)
+    {
+        std::string key;
+        auto append = [&key](const void *data, size_t size) {
+            key.append(static_cast<const char*>(data), size);
+        };
+        auto append_path = [&append](const ClipperLib::Path &path) {
+            size_t n = path.size();
+            append(&n, sizeof(n));
+            append(path.data(), n * sizeof(ClipperLib::IntPoint));
+        };
+        
+        for (const ClipperLib::Polygon& poly : m_print->m_printer_input[idx].transformed_slices()) {
+            append_path(poly.Contour);
+            size_t nholes = poly.Holes.size();
+            append(&nholes, sizeof(nholes));
+            for (const ClipperLib::Path &hole : poly.Holes) append_path(hole);
         }
+        
+        return key;
     };
     
     // last minute escape
     if(canceled()) return;
     
     // Print all the layers in parallel
-    m_print->m_printer->draw_layers(m_print->m_printer_input.size(), lvlfn);
+    m_print->m_printer->draw_layers(m_print->m_printer_input.size(), lvlfn, keyfn, reusefn);
+    
+    // The layers skipped after cancellation are empty, none may be reused.
+    if(canceled()) m_print->m_printer->clear_layers();
 }
 
 std::string SLAPrint::Steps::label(SLAPrintObjectStep step)
@@ -63,4 +63,10 @@ void simplify_mesh(indexed_triangle_set &m)
     sm.simplify_mesh_lossless();
 }
 
+void simplify_mesh(indexed_triangle_set &m, int face_count, float agressiveness)
+{
+    SimplifyMesh::implementation::SimplifiableMesh sm{&m};
+    sm.simplify_mesh(size_t(std::max(face_count, 0)), double(agressiveness));
+}
+
 }
@@ -7,10 +7,13 @@
 
 namespace Slic3r {
 
+// Remove the faces, which can be collapsed without changing the shape of the mesh.
 void simplify_mesh(indexed_triangle_set &);
 
-// TODO: (but this can be done with IGL as well)
-// void simplify_mesh(indexed_triangle_set &, int face_count, float agressiveness = 0.5f);
+// Decimate the mesh to at most face_count faces by collapsing the edges of the
+// smallest quadric error first. Higher agressiveness collapses edges of higher
+// error in earlier iterations, which is faster, but of lower quality.
+void simplify_mesh(indexed_triangle_set &, int face_count, float agressiveness = 7.f);
 
 template<class...Args> void simplify_mesh(TriangleMesh &m, Args &&...a)
 {
@@ -21,7 +21,11 @@
 #include <array>
 #include <type_traits>
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <limits>
+
+#include <tbb/parallel_for.h>
 
 #ifndef NDEBUG
 #include <ostream>
@@ -210,6 +214,10 @@ template<class Mesh> class SimplifiableMesh {
         size_t idx;
         size_t tstart = 0, tcount = 0;
         bool border = false;
+        // Spatial cell of the vertex in the current pass and whether all
+        // the faces around the vertex lie in the same cell.
+        int  cell = 0;
+        bool interior = true;
         SymMat q;
         explicit VertexInfo(size_t id): idx(id) {}
     };
@@ -219,6 +227,10 @@ template<class Mesh> class SimplifiableMesh {
     std::vector<Ref> m_refs;
     std::vector<FaceInfo> m_faceinfo;
     std::vector<VertexInfo> m_vertexinfo;
+    // Faces of the current pass bucketed by their spatial cell,
+    // cell i owns m_cell_faces[m_cell_start[i] .. m_cell_start[i + 1]).
+    std::vector<size_t> m_cell_faces;
+    std::vector<size_t> m_cell_start;
     
     void compact_faces();
     void compact();
@@ -299,12 +311,28 @@ template<class Mesh> class SimplifiableMesh {
     
     void update_mesh(int iteration);
     
+    // Assign the vertices and faces to a grid of cells_per_axis^3 cells,
+    // shifted by half a cell if requested.
+    void partition(int cells_per_axis, bool shifted);
+    
+    // Collapse the edges of the faces below the threshold, returns the number of deleted faces.
+    size_t collapse_edges(const size_t *faces_begin, const size_t *faces_end, double threshold,
+                          size_t max_deleted, std::atomic<size_t> &deleted);
+    
+    template<class ThresholdFn, class ProgressFn>
+    void simplify(size_t target_count, int max_iterations, bool lossless,
+                  ThresholdFn &&threshold_fn, ProgressFn &&fn);
+    
     // Update triangle connections and edge error after a edge is collapsed
-    void update_triangles(size_t i, VertexInfo &vi, std::vector<bool> &deleted, int &deleted_triangles);
+    void update_triangles(size_t i, VertexInfo &vi, std::vector<bool> &deleted, size_t &deleted_triangles);
     
     // Check if a triangle flips when this edge is removed
     bool flipped(const Vertex &p, size_t i0, size_t i1, VertexInfo &v0, VertexInfo &v1, std::vector<bool> &deleted);
     
+    // Check if the edge may be collapsed without making the mesh non-manifold:
+    // the vertices adjacent to both ends have to be the tips of the faces sharing the edge.
+    bool link_condition(size_t i0, size_t i1, const VertexInfo &v0, const VertexInfo &v1, std::vector<size_t> &neighbors) const;
+    
 public:
     
     explicit SimplifiableMesh(Mesh *m) : m_mesh{m}
@@ -322,6 +350,11 @@ public:
     
     template<class ProgressFn> void simplify_mesh_lossless(ProgressFn &&fn);
     void simplify_mesh_lossless() { simplify_mesh_lossless([](int){}); }
+    
+    // Collapse edges of increasing error until the mesh has at most target_count faces.
+    // Higher agressiveness allows edges of higher error to be collapsed in earlier iterations.
+    template<class ProgressFn> void simplify_mesh(size_t target_count, double agressiveness, ProgressFn &&fn);
+    void simplify_mesh(size_t target_count, double agressiveness = 7.) { simplify_mesh(target_count, agressiveness, [](int){}); }
 };
 
 template<class Mesh> void SimplifiableMesh<Mesh>::compact_faces()
@@ -403,30 +436,6 @@ template<class Mesh> void SimplifiableMesh<Mesh>::update_mesh(int iteration)
     if (iteration > 0) compact_faces();
     
     assert(mesh_vcount() == m_vertexinfo.size());
-        
-    //
-    // Init Quadrics by Plane & Edge Errors
-    //
-    // required at the beginning ( iteration == 0 )
-    // recomputing during the simplification is not required,
-    // but mostly improves the result for closed meshes
-    //
-    if (iteration == 0) {
-                
-        for (VertexInfo &vinf : m_vertexinfo) vinf.q = SymMat{};
-        for (FaceInfo   &finf : m_faceinfo) {
-            Index3 t = read_triangle(finf);
-            std::array<Vertex, 3> p = triangle_vertices(t);
-            Vertex                n = cross(Vertex(p[1] - p[0]), Vertex(p[2] - p[0]));
-            normalize(n);
-            finf.n = n;
-            
-            for (size_t fi : t)
-                m_vertexinfo[fi].q += SymMat(x(n), y(n), z(n), -dot(n, p[0]));
-            
-            calculate_error(finf);
-        }
-    }
     
     // Init Reference ID list
     for (VertexInfo &vi : m_vertexinfo) { vi.tstart = 0; vi.tcount = 0; }
@@ -459,49 +468,154 @@ template<class Mesh> void SimplifiableMesh<Mesh>::update_mesh(int iteration)
         }
     }
     
-    // Identify boundary : vertices[].border=0,1
+    //
+    // Init Quadrics by Plane & Edge Errors
+    //
+    // required at the beginning ( iteration == 0 )
+    // recomputing during the simplification is not required,
+    // but mostly improves the result for closed meshes
+    //
+    // The face normals are calculated in parallel, the quadrics are then
+    // gathered from the faces around each vertex, so that no two threads
+    // write to the same vertex.
+    //
     if (iteration == 0) {
-        for (VertexInfo &vi: m_vertexinfo) vi.border = false;
-        
-        std::vector<size_t> vcount, vids;
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, m_faceinfo.size()),
+                          [this](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i < range.end(); ++ i) {
+                FaceInfo &finf = m_faceinfo[i];
+                std::array<Vertex, 3> p = triangle_vertices(read_triangle(finf));
+                Vertex                n = cross(Vertex(p[1] - p[0]), Vertex(p[2] - p[0]));
+                normalize(n);
+                finf.n = n;
+            }
+        });
         
-        for (VertexInfo &vi: m_vertexinfo) {
-            vcount.clear();
-            vids.clear();
-            
-            for(size_t j = 0; j < vi.tcount; ++j) {
-                assert(vi.tstart + j < m_refs.size());
-                FaceInfo &fi = m_faceinfo[m_refs[vi.tstart + j].face];
-                Index3 t = read_triangle(fi);
+        // Identify boundary : vertices[].border=0,1
+        // A vertex is on the boundary if an edge starting at it is shared by
+        // a single face only, that is if a neighbor occurs once around the vertex.
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, m_vertexinfo.size()),
+                          [this](const tbb::blocked_range<size_t> &range) {
+            std::vector<size_t> vcount, vids;
+            for (size_t vidx = range.begin(); vidx < range.end(); ++ vidx) {
+                VertexInfo &vi = m_vertexinfo[vidx];
+                vi.q = SymMat{};
+                vcount.clear();
+                vids.clear();
                 
-                for (size_t fid : t) {
-                    size_t ofs=0;
-                    while (ofs < vcount.size())
-                    {
-                        if (vids[ofs] == fid) break;
-                        ofs++;
+                for(size_t j = 0; j < vi.tcount; ++j) {
+                    assert(vi.tstart + j < m_refs.size());
+                    FaceInfo &fi = m_faceinfo[m_refs[vi.tstart + j].face];
+                    Index3 t = read_triangle(fi);
+                    const Vertex &n = fi.n;
+                    vi.q += SymMat(x(n), y(n), z(n), -dot(n, read_vertex(t[0])));
+                    
+                    for (size_t fid : t) {
+                        size_t ofs=0;
+                        while (ofs < vcount.size())
+                        {
+                            if (vids[ofs] == fid) break;
+                            ofs++;
+                        }
+                        if (ofs == vcount.size())
+                        {
+                            vcount.emplace_back(1);
+                            vids.emplace_back(fid);
+                        }
+                        else
+                            vcount[ofs]++;
                     }
-                    if (ofs == vcount.size())
-                    {
-                        vcount.emplace_back(1);
-                        vids.emplace_back(fid);
-                    }
-                    else
-                        vcount[ofs]++;
                 }
+                
+                vi.border = std::find(vcount.begin(), vcount.end(), size_t(1)) != vcount.end();
             }
-            
-            for (size_t j = 0; j < vcount.size(); ++j)
-                if(vcount[j] == 1) m_vertexinfo[vids[j]].border = true;
+        });
+        
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, m_faceinfo.size()),
+                          [this](const tbb::blocked_range<size_t> &range) {
+            for (size_t i = range.begin(); i < range.end(); ++ i)
+                calculate_error(m_faceinfo[i]);
+        });
+    }
+}
+
+template<class Mesh> void SimplifiableMesh<Mesh>::partition(int cells_per_axis, bool shifted)
+{
+    using Bound = std::array<double, 3>;
+    Bound bmin, bmax;
+    bmin.fill(std::numeric_limits<double>::max());
+    bmax.fill(std::numeric_limits<double>::lowest());
+    for (size_t i = 0; i < mesh_vcount(); ++ i) {
+        Vertex v = read_vertex(i);
+        Bound  p { double(x(v)), double(y(v)), double(z(v)) };
+        for (size_t j = 0; j < 3; ++ j) {
+            bmin[j] = std::min(bmin[j], p[j]);
+            bmax[j] = std::max(bmax[j], p[j]);
         }
     }
+    
+    // Shifting the grid by half a cell moves the cell borders, where
+    // the vertices are locked, into the middle of the cells of the previous pass.
+    int    dims  = cells_per_axis + (shifted ? 1 : 0);
+    double shift = shifted ? 0.5 : 0.;
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, m_vertexinfo.size()),
+                      [this, &bmin, &bmax, cells_per_axis, dims, shift](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i) {
+            Vertex v = read_vertex(m_vertexinfo[i]);
+            Bound  p { double(x(v)), double(y(v)), double(z(v)) };
+            int    cell = 0;
+            for (int j = 2; j >= 0; -- j) {
+                double size = bmax[j] - bmin[j];
+                int    c    = size > 0. ? int(std::floor((p[j] - bmin[j]) / size * cells_per_axis + shift)) : 0;
+                cell = cell * dims + std::max(0, std::min(dims - 1, c));
+            }
+            m_vertexinfo[i].cell = cell;
+        }
+    });
+    
+    // Vertices, whose faces reach into another cell, are locked for this pass.
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, m_vertexinfo.size()),
+                      [this](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i) {
+            VertexInfo &vi = m_vertexinfo[i];
+            vi.interior = true;
+            for (size_t k = 0; k < vi.tcount && vi.interior; ++ k)
+                for (size_t vidx : read_triangle(m_faceinfo[m_refs[vi.tstart + k].face]))
+                    if (m_vertexinfo[vidx].cell != vi.cell) {
+                        vi.interior = false;
+                        break;
+                    }
+        }
+    });
+    
+    // Bucket the faces lying completely inside a cell, faces crossing the cell borders are skipped.
+    size_t num_cells = size_t(dims) * size_t(dims) * size_t(dims);
+    std::vector<int> face_cell(m_faceinfo.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, m_faceinfo.size()),
+                      [this, &face_cell](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i) {
+            Index3 t = read_triangle(m_faceinfo[i]);
+            int    cell = m_vertexinfo[t[0]].cell;
+            face_cell[i] = m_vertexinfo[t[1]].cell == cell && m_vertexinfo[t[2]].cell == cell ? cell : -1;
+        }
+    });
+    
+    m_cell_start.assign(num_cells + 1, 0);
+    for (int cell : face_cell)
+        if (cell >= 0) ++ m_cell_start[cell + 1];
+    for (size_t i = 0; i < num_cells; ++ i)
+        m_cell_start[i + 1] += m_cell_start[i];
+    m_cell_faces.resize(m_cell_start.back());
+    std::vector<size_t> cell_end(m_cell_start.begin(), m_cell_start.end() - 1);
+    for (size_t i = 0; i < face_cell.size(); ++ i)
+        if (face_cell[i] >= 0) m_cell_faces[cell_end[face_cell[i]] ++] = i;
 }
 
 template<class Mesh>
 void SimplifiableMesh<Mesh>::update_triangles(size_t             i0,
                                               VertexInfo &       vi,
                                               std::vector<bool> &deleted,
-                                              int &deleted_triangles)
+                                              size_t &deleted_triangles)
 {
     Vertex p;
     for (size_t k = 0; k < vi.tcount; ++k) {
@@ -527,7 +641,6 @@ void SimplifiableMesh<Mesh>::update_triangles(size_t             i0,
         fi.err[1] = calculate_error(t[1], t[2], p);
         fi.err[2] = calculate_error(t[2], t[0], p);
         fi.err[3] = std::min(fi.err[0], std::min(fi.err[1], fi.err[2]));
-        m_refs.emplace_back(r);
     }
 }
 
@@ -575,95 +688,186 @@ bool SimplifiableMesh<Mesh>::flipped(const Vertex &    p,
 }
 
 template<class Mesh>
-template<class Fn> void SimplifiableMesh<Mesh>::simplify_mesh_lossless(Fn &&fn)
+bool SimplifiableMesh<Mesh>::link_condition(size_t              i0,
+                                            size_t              i1,
+                                            const VertexInfo &  v0,
+                                            const VertexInfo &  v1,
+                                            std::vector<size_t> &neighbors) const
+{
+    size_t num_shared_faces = 0;
+    neighbors.clear();
+    for (size_t k = 0; k < v0.tcount; ++k) {
+        const FaceInfo &fi = m_faceinfo[m_refs[v0.tstart + k].face];
+        if (fi.deleted) continue;
+        Index3 t = read_triangle(fi);
+        if (t[0] == i1 || t[1] == i1 || t[2] == i1) ++ num_shared_faces;
+        for (size_t vidx : t)
+            if (vidx != i0 && vidx != i1) neighbors.emplace_back(vidx);
+    }
+    std::sort(neighbors.begin(), neighbors.end());
+    neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+    
+    size_t num_shared_neighbors = 0;
+    size_t last = std::numeric_limits<size_t>::max();
+    for (size_t k = 0; k < v1.tcount; ++k) {
+        const FaceInfo &fi = m_faceinfo[m_refs[v1.tstart + k].face];
+        if (fi.deleted) continue;
+        for (size_t vidx : read_triangle(fi))
+            if (vidx != i0 && vidx != i1 && vidx != last && std::binary_search(neighbors.begin(), neighbors.end(), vidx)) {
+                // Count each neighbor once, mark it by moving it out of the search range.
+                auto it = std::lower_bound(neighbors.begin(), neighbors.end(), vidx);
+                neighbors.erase(it);
+                last = vidx;
+                ++ num_shared_neighbors;
+            }
+    }
+    
+    return num_shared_neighbors == num_shared_faces;
+}
+
+template<class Mesh>
+size_t SimplifiableMesh<Mesh>::collapse_edges(const size_t *faces_begin,
+                                              const size_t *faces_end,
+                                              double        threshold,
+                                              size_t        max_deleted,
+                                              std::atomic<size_t> &deleted)
+{
+    size_t deleted_triangles = 0;
+    std::vector<bool> deleted0, deleted1;
+    std::vector<size_t> neighbors;
+    
+    for (const size_t *it = faces_begin; it != faces_end; ++ it) {
+        FaceInfo &fi = m_faceinfo[*it];
+        if (fi.err[3] > threshold || fi.deleted || fi.dirty) continue;
+        if (deleted.load(std::memory_order_relaxed) >= max_deleted) break;
+        
+        for (size_t j = 0; j < 3; ++j) {
+            if (fi.err[j] > threshold) continue;
+            
+            Index3 t = read_triangle(fi);
+            size_t i0 = t[j];
+            VertexInfo &v0 = m_vertexinfo[i0];
+            
+            size_t i1 = t[(j + 1) % 3];
+            VertexInfo &v1 = m_vertexinfo[i1];
+            
+            // Border check
+            if(v0.border != v1.border) continue;
+            
+            // The faces around the edge have to be owned by the cell being processed.
+            if (! v0.interior || ! v1.interior) continue;
+            
+            if (! link_condition(i0, i1, v0, v1, neighbors)) continue;
+            
+            // Compute vertex to collapse to
+            Vertex p;
+            calculate_error(i0, i1, p);
+            
+            deleted0.resize(v0.tcount); // normals temporarily
+            deleted1.resize(v1.tcount); // normals temporarily
+            
+            // don't remove if flipped
+            if (flipped(p, i0, i1, v0, v1, deleted0)) continue;
+            if (flipped(p, i1, i0, v1, v0, deleted1)) continue;
+            
+            // not flipped, so remove edge
+            write_vertex(v0, p);
+            v0.q = v1.q + v0.q;
+            
+            // All the faces around the merged vertex are marked dirty, thus neither
+            // the merged vertex nor its faces are touched again in this pass and
+            // its references are rebuilt by update_mesh() before the next pass.
+            size_t deleted_now = 0;
+            update_triangles(i0, v0, deleted0, deleted_now);
+            update_triangles(i0, v1, deleted1, deleted_now);
+            deleted_triangles += deleted_now;
+            deleted.fetch_add(deleted_now, std::memory_order_relaxed);
+            break;
+        }
+    }
+    
+    return deleted_triangles;
+}
+
+template<class Mesh>
+template<class ThresholdFn, class ProgressFn>
+void SimplifiableMesh<Mesh>::simplify(size_t        target_count,
+                                      int           max_iterations,
+                                      bool          lossless,
+                                      ThresholdFn &&threshold_fn,
+                                      ProgressFn  &&fn)
 {
     // init
     for (FaceInfo &fi : m_faceinfo) fi.deleted = false;
     
-    // main iteration loop
-    int deleted_triangles=0;
-    std::vector<bool> deleted0, deleted1;
+    size_t face_count = m_faceinfo.size();
     
-    for (int iteration = 0; iteration < 9999; iteration ++) {
+    // Edges are collapsed in parallel in the cells of a spatial grid, each cell
+    // owning the faces completely inside of it. Small meshes are processed as a whole.
+    static constexpr double faces_per_cell = 8192.;
+    bool partitioned = true;
+    
+    for (int iteration = 0; iteration < max_iterations && face_count > target_count; iteration ++) {
         // update mesh constantly
         update_mesh(iteration);
         
         // clear dirty flag
         for (FaceInfo &fi : m_faceinfo) fi.dirty = false;
         
-        //
-        // All triangles with edges below the threshold will be removed
-        //
-        // The following numbers works well for most models.
-        // If it does not, try to adjust the 3 parameters
-        //
-        double threshold = std::numeric_limits<double>::epsilon(); //1.0E-3 EPS; // Really? (tm)
-        
         fn(iteration);
         
-        for (FaceInfo &fi : m_faceinfo) {
-            if (fi.err[3] > threshold || fi.deleted || fi.dirty) continue;
-            
-            for (size_t j = 0; j < 3; ++j) {
-                if (fi.err[j] > threshold) continue;
-                
-                Index3 t = read_triangle(fi);
-                size_t i0 = t[j];
-                VertexInfo &v0 = m_vertexinfo[i0];
-                
-                size_t i1 = t[(j + 1) % 3];
-                VertexInfo &v1 = m_vertexinfo[i1];
-
-                // Border check
-                if(v0.border != v1.border) continue;
-
-                // Compute vertex to collapse to
-                Vertex p;
-                calculate_error(i0, i1, p);
-
-                deleted0.resize(v0.tcount); // normals temporarily
-                deleted1.resize(v1.tcount); // normals temporarily
-
-                // don't remove if flipped
-                if (flipped(p, i0, i1, v0, v1, deleted0)) continue;
-                if (flipped(p, i1, i0, v1, v0, deleted1)) continue;
-
-                // not flipped, so remove edge
-                write_vertex(v0, p);
-                v0.q = v1.q + v0.q;
-                size_t tstart = m_refs.size();
-
-                update_triangles(i0, v0, deleted0, deleted_triangles);
-                update_triangles(i0, v1, deleted1, deleted_triangles);
-                
-                assert(m_refs.size() >= tstart);
-                
-                size_t tcount = m_refs.size() - tstart;
-
-                if(tcount <= v0.tcount)
-                {
-                    // save ram
-                    if (tcount) {
-                        auto from = m_refs.begin() + tstart, to = from + tcount;
-                        std::copy(from, to, m_refs.begin() + v0.tstart);
-                    }
-                }
-                else
-                    // append
-                    v0.tstart = tstart;
-
-                v0.tcount = tcount;
-                break;
-            }
-        }
+        int cells_per_axis = partitioned ?
+            std::max(1, std::min(64, int(std::cbrt(double(m_faceinfo.size()) / faces_per_cell)))) : 1;
+        partition(cells_per_axis, cells_per_axis > 1 && iteration % 2 == 1);
+        
+        double              threshold   = threshold_fn(iteration);
+        size_t              max_deleted = face_count - target_count;
+        std::atomic<size_t> deleted{0};
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, m_cell_start.size() - 1),
+                          [this, threshold, max_deleted, &deleted](const tbb::blocked_range<size_t> &range) {
+            for (size_t cell = range.begin(); cell < range.end(); ++ cell)
+                collapse_edges(m_cell_faces.data() + m_cell_start[cell], m_cell_faces.data() + m_cell_start[cell + 1],
+                               threshold, max_deleted, deleted);
+        });
         
-        if (deleted_triangles <= 0) break;
-        deleted_triangles = 0;
+        face_count -= std::min(face_count, deleted.load());
+        
+        if (deleted == 0 && lossless) {
+            // Edges with their faces crossing the cell borders may be left,
+            // finish by processing the mesh as a whole.
+            if (cells_per_axis == 1) break;
+            partitioned = false;
+        } else
+            partitioned = true;
     }
     
     compact();
 }
 
+template<class Mesh>
+template<class Fn> void SimplifiableMesh<Mesh>::simplify_mesh_lossless(Fn &&fn)
+{
+    //
+    // All triangles with edges below the threshold will be removed
+    //
+    // The following numbers works well for most models.
+    // If it does not, try to adjust the 3 parameters
+    //
+    double threshold = std::numeric_limits<double>::epsilon(); //1.0E-3 EPS; // Really? (tm)
+    
+    simplify(0, 9999, true, [threshold](int) { return threshold; }, std::forward<Fn>(fn));
+}
+
+template<class Mesh>
+template<class Fn> void SimplifiableMesh<Mesh>::simplify_mesh(size_t target_count, double agressiveness, Fn &&fn)
+{
+    // The threshold of the edge error grows with the iterations, see
+    // https://github.com/sp4cerat/Fast-Quadric-Mesh-Simplification
+    simplify(target_count, 100, false,
+             [agressiveness](int iteration) { return 0.000000001 * std::pow(double(iteration + 3), agressiveness); },
+             std::forward<Fn>(fn));
+}
+
 } // namespace implementation
 } // namespace SimplifyMesh
 
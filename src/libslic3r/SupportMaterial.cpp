@@ -7,8 +7,10 @@
 #include "EdgeGrid.hpp"
 #include "Geometry.hpp"
 
+#include <chrono>
 #include <cmath>
 #include <memory>
+#include <type_traits>
 #include <boost/log/trivial.hpp>
 
 #include <tbb/parallel_for.h>
@@ -139,6 +141,8 @@ void export_print_z_polygons_and_extrusions_to_svg(
 }
 #endif /* SLIC3R_DEBUG */
 
+int PrintObjectSupportMaterial::sweep_block_size = 16;
+
 PrintObjectSupportMaterial::PrintObjectSupportMaterial(const PrintObject *object, const SlicingParameters &slicing_params) :
     m_object                (object),
     m_print_config          (&object->print()->config()),
@@ -215,7 +219,201 @@ struct MyLayersPtrCompare
     }
 };
 
-void PrintObjectSupportMaterial::generate(PrintObject &object)
+namespace SupportMaterialInternal {
+    // Serialization of the inputs of the support generator. A cached result is reused only if its serialized inputs
+    // are equal to the current ones, a hash collision would silently produce wrong supports.
+    template<typename T>
+    static inline void key_append(std::string &key, const T &value)
+    {
+        static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value, "Only scalars are serialized by value");
+        key.append(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+    static inline void key_append(std::string &key, const std::string &str)
+    {
+        key_append(key, str.size());
+        key.append(str);
+    }
+    static inline void key_append(std::string &key, const Points &pts)
+    {
+        key_append(key, pts.size());
+        for (const Point &pt : pts) {
+            key_append(key, pt.x());
+            key_append(key, pt.y());
+        }
+    }
+    static inline void key_append(std::string &key, const Polygons &polygons)
+    {
+        key_append(key, polygons.size());
+        for (const Polygon &polygon : polygons)
+            key_append(key, polygon.points);
+    }
+    static inline void key_append(std::string &key, const Polylines &polylines)
+    {
+        key_append(key, polylines.size());
+        for (const Polyline &polyline : polylines)
+            key_append(key, polyline.points);
+    }
+    static inline void key_append(std::string &key, const ExPolygon &expolygon)
+    {
+        key_append(key, expolygon.contour.points);
+        key_append(key, expolygon.holes);
+    }
+    static inline void key_append(std::string &key, const ExPolygons &expolygons)
+    {
+        key_append(key, expolygons.size());
+        for (const ExPolygon &expolygon : expolygons)
+            key_append(key, expolygon);
+    }
+
+    static std::string layer_key(const Layer &layer, const PrintConfig &print_config);
+}
+
+void PrintObjectSupportMaterialCache::reset_counters()
+{
+    top_contacts_reused     = 0;
+    top_contacts_generated  = 0;
+    support_areas_reused    = 0;
+    support_areas_generated = 0;
+    toolpaths_reused        = 0;
+    toolpaths_generated     = 0;
+    layers_changed          = 0;
+}
+
+void PrintObjectSupportMaterialCache::clear()
+{
+    this->clear_results();
+    this->reset_counters();
+}
+
+void PrintObjectSupportMaterialCache::clear_results()
+{
+    // Release the memory, not just the elements.
+    std::string().swap(m_config_key);
+    std::vector<std::string>().swap(m_layer_keys);
+    std::vector<TopContacts>().swap(m_top_contacts);
+    std::vector<SupportArea>().swap(m_support_areas);
+    std::unordered_map<std::string, Toolpaths>().swap(m_toolpaths);
+}
+
+void PrintObjectSupportMaterialCache::update_layer_keys(std::vector<std::string> &&layer_keys)
+{
+    size_t num_layers = layer_keys.size();
+    if (m_layer_keys.size() != num_layers) {
+        // The object was sliced differently, the results of the object layers cannot be matched.
+        std::vector<TopContacts>(num_layers).swap(m_top_contacts);
+        std::vector<SupportArea>(num_layers).swap(m_support_areas);
+        layers_changed = num_layers;
+    } else {
+        layers_changed = 0;
+        for (size_t layer_id = 0; layer_id < num_layers; ++ layer_id)
+            if (m_layer_keys[layer_id] != layer_keys[layer_id]) {
+                ++ layers_changed;
+                // The top contacts depend on the layer and the layer below,
+                // the support areas on the layer and the layer above.
+                m_top_contacts[layer_id].valid = false;
+                if (layer_id + 1 < num_layers)
+                    m_top_contacts[layer_id + 1].valid = false;
+                m_support_areas[layer_id].valid = false;
+                if (layer_id > 0)
+                    m_support_areas[layer_id - 1].valid = false;
+            }
+    }
+    m_layer_keys = std::move(layer_keys);
+}
+
+static size_t polygons_memsize(const Polygons &polygons)
+{
+    size_t out = polygons.capacity() * sizeof(Polygon);
+    for (const Polygon &polygon : polygons)
+        out += polygon.points.capacity() * sizeof(Point);
+    return out;
+}
+
+static size_t support_layer_memsize(const PrintObjectSupportMaterial::MyLayer *layer)
+{
+    if (layer == nullptr)
+        return 0;
+    size_t out = sizeof(PrintObjectSupportMaterial::MyLayer) + polygons_memsize(layer->polygons);
+    if (layer->contact_polygons != nullptr)
+        out += polygons_memsize(*layer->contact_polygons);
+    if (layer->overhang_polygons != nullptr)
+        out += polygons_memsize(*layer->overhang_polygons);
+    return out;
+}
+
+static size_t extrusions_memsize(const ExtrusionEntity &entity)
+{
+    if (const ExtrusionPath *path = dynamic_cast<const ExtrusionPath*>(&entity))
+        return sizeof(ExtrusionPath) + path->polyline.points.capacity() * sizeof(Point);
+    size_t out = 0;
+    if (const ExtrusionMultiPath *multipath = dynamic_cast<const ExtrusionMultiPath*>(&entity)) {
+        out = sizeof(ExtrusionMultiPath);
+        for (const ExtrusionPath &path : multipath->paths)
+            out += extrusions_memsize(path);
+    } else if (const ExtrusionLoop *loop = dynamic_cast<const ExtrusionLoop*>(&entity)) {
+        out = sizeof(ExtrusionLoop);
+        for (const ExtrusionPath &path : loop->paths)
+            out += extrusions_memsize(path);
+    } else if (const ExtrusionEntityCollection *collection = dynamic_cast<const ExtrusionEntityCollection*>(&entity)) {
+        out = sizeof(ExtrusionEntityCollection) + collection->entities.capacity() * sizeof(ExtrusionEntity*);
+        for (const ExtrusionEntity *ee : collection->entities)
+            out += extrusions_memsize(*ee);
+    }
+    return out;
+}
+
+size_t PrintObjectSupportMaterialCache::memsize() const
+{
+    size_t out = m_config_key.capacity() + m_layer_keys.capacity() * sizeof(std::string) +
+        m_top_contacts.capacity() * sizeof(TopContacts) + m_support_areas.capacity() * sizeof(SupportArea);
+    for (const std::string &key : m_layer_keys)
+        out += key.capacity();
+    for (const TopContacts &top : m_top_contacts) {
+        out += top.inputs.capacity();
+        for (const std::unique_ptr<MyLayer> &layer : top.layers)
+            out += support_layer_memsize(layer.get());
+    }
+    for (const SupportArea &area : m_support_areas)
+        out += area.inputs.capacity() + polygons_memsize(area.projection) + polygons_memsize(area.support_area) + polygons_memsize(area.touching) +
+            support_layer_memsize(area.bottom_contact.get());
+    for (const auto &kvp : m_toolpaths) {
+        out += sizeof(kvp) + kvp.first.capacity() + extrusions_memsize(kvp.second.fills) + kvp.second.islands.capacity() * sizeof(ExPolygon);
+        for (const ExPolygon &expolygon : kvp.second.islands)
+            out += expolygon.contour.points.capacity() * sizeof(Point) + polygons_memsize(expolygon.holes);
+    }
+    return out;
+}
+
+std::string PrintObjectSupportMaterial::config_key() const
+{
+    using namespace SupportMaterialInternal;
+    std::string key;
+    for (const ConfigBase *config : { static_cast<const ConfigBase*>(m_print_config), static_cast<const ConfigBase*>(m_object_config) })
+        for (const t_config_option_key &opt_key : config->keys()) {
+            key_append(key, opt_key);
+            key_append(key, config->opt_serialize(opt_key));
+        }
+    for (const Flow *flow : { &m_first_layer_flow, &m_support_material_flow, &m_support_material_interface_flow }) {
+        key_append(key, flow->width);
+        key_append(key, flow->height);
+        key_append(key, flow->nozzle_diameter);
+        key_append(key, flow->bridge);
+    }
+    key_append(key, m_support_layer_height_min);
+    key_append(key, m_gap_xy);
+    key_append(key, m_slicing_params.base_raft_layers);
+    key_append(key, m_slicing_params.interface_raft_layers);
+    key_append(key, m_slicing_params.contact_raft_layer_height);
+    key_append(key, m_slicing_params.layer_height);
+    key_append(key, m_slicing_params.first_print_layer_height);
+    key_append(key, m_slicing_params.soluble_interface);
+    key_append(key, m_slicing_params.raft_interface_top_z);
+    key_append(key, m_slicing_params.raft_contact_top_z);
+    key_append(key, m_slicing_params.object_print_z_min);
+    return key;
+}
+
+void PrintObjectSupportMaterial::generate(PrintObject &object, PrintObjectSupportMaterialCache *cache)
 {
     BOOST_LOG_TRIVIAL(info) << "Support generator - Start";
 
@@ -227,7 +425,28 @@ void PrintObjectSupportMaterial::generate(PrintObject &object)
     // The layers will be referenced by various LayersPtr (of type std::vector<Layer*>)
     MyLayerStorage layer_storage;
 
+    // Compare the object layers with the ones the cached results were generated from, invalidate the results depending on the changed ones.
+    auto time_start = std::chrono::steady_clock::now();
+    if (cache != nullptr) {
+        std::string config_key = this->config_key();
+        if (cache->m_config_key != config_key) {
+            cache->clear();
+            cache->m_config_key = std::move(config_key);
+        }
+        cache->reset_counters();
+        std::vector<std::string> layer_keys(object.layer_count());
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, object.layer_count()),
+            [this, &object, &layer_keys](const tbb::blocked_range<size_t>& range) {
+                for (size_t layer_id = range.begin(); layer_id < range.end(); ++ layer_id)
+                    layer_keys[layer_id] = SupportMaterialInternal::layer_key(*object.layers()[layer_id], *m_print_config);
+            });
+        cache->update_layer_keys(std::move(layer_keys));
+        BOOST_LOG_TRIVIAL(info) << "Support generator - " << cache->layers_changed << " of " << object.layer_count() << " object layers changed, compared in " <<
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - time_start).count() << " ms";
+    }
+
     BOOST_LOG_TRIVIAL(info) << "Support generator - Creating top contacts";
+    auto time_contacts_start = std::chrono::steady_clock::now();
 
     // Determine the top contact surfaces of the support, defined as:
     // contact = overhangs - clearance + margin
@@ -235,7 +454,7 @@ void PrintObjectSupportMaterial::generate(PrintObject &object)
     // should the support material expose to the object in order to guarantee
     // that it will be effective, regardless of how it's built below.
     // If raft is to be generated, the 1st top_contact layer will contain the 1st object layer silhouette without holes.
-    MyLayersPtr top_contacts = this->top_contact_layers(object, layer_storage);
+    MyLayersPtr top_contacts = this->top_contact_layers(object, layer_storage, cache);
     if (top_contacts.empty())
         // Nothing is supported, no supports are generated.
         return;
@@ -258,7 +477,13 @@ void PrintObjectSupportMaterial::generate(PrintObject &object)
     std::vector<Polygons> layer_support_areas;
     MyLayersPtr bottom_contacts = this->bottom_contact_layers_and_layer_support_areas(
         object, top_contacts, layer_storage,
-        layer_support_areas);
+        layer_support_areas, cache);
+
+    if (cache != nullptr)
+        BOOST_LOG_TRIVIAL(info) << "Support generator - Contacts of " << cache->top_contacts_reused << " layers and support areas of " <<
+            cache->support_areas_reused << " layers reused, contacts of " << cache->top_contacts_generated << " layers and support areas of " <<
+            cache->support_areas_generated << " layers generated in " <<
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - time_contacts_start).count() << " ms";
 
 #ifdef SLIC3R_DEBUG
     for (size_t layer_id = 0; layer_id < object.layers().size(); ++ layer_id)
@@ -388,7 +613,22 @@ void PrintObjectSupportMaterial::generate(PrintObject &object)
     BOOST_LOG_TRIVIAL(info) << "Support generator - Generating tool paths";
 
     // Generate the actual toolpaths and save them into each layer.
-    this->generate_toolpaths(object, raft_layers, bottom_contacts, top_contacts, intermediate_layers, interface_layers);
+    auto time_toolpaths_start = std::chrono::steady_clock::now();
+    this->generate_toolpaths(object, raft_layers, bottom_contacts, top_contacts, intermediate_layers, interface_layers, cache);
+
+    if (cache != nullptr) {
+        size_t memsize = cache->memsize();
+        BOOST_LOG_TRIVIAL(info) << "Support generator - Tool paths of " << cache->toolpaths_reused << " support layers reused, of " <<
+            cache->toolpaths_generated << " support layers generated in " <<
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - time_toolpaths_start).count() << " ms, total " <<
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - time_start).count() << " ms, cache size " <<
+            memsize / 1024 << " kB";
+        if (memsize > cache->max_memsize) {
+            // Don't keep copies of the supports of a huge object, regenerate them on the next run.
+            BOOST_LOG_TRIVIAL(info) << "Support generator - Cache exceeds " << cache->max_memsize / 1024 << " kB, released";
+            cache->clear_results();
+        }
+    }
 
 #ifdef SLIC3R_DEBUG
     {
@@ -932,6 +1172,74 @@ namespace SupportMaterialInternal {
         // Remove bridged areas from the supported areas.
         contact_polygons = diff(contact_polygons, bridges, true);
     }
+
+    // Serialized data of an object layer read by the support generator: the slices and their surface types,
+    // the bridging extrusions and the flows of the regions. Changing any of them changes the supports
+    // generated for this layer and for the layer above.
+    static std::string layer_key(const Layer &layer, const PrintConfig &print_config)
+    {
+        std::string key;
+        key_append(key, layer.print_z);
+        key_append(key, layer.height);
+        key_append(key, layer.lslices);
+        key_append(key, layer.regions().size());
+        for (const LayerRegion *layerm : layer.regions()) {
+            key_append(key, layerm->flow(frExternalPerimeter).scaled_width());
+            Flow bridge_flow = layerm->flow(frPerimeter, true);
+            key_append(key, bridge_flow.scaled_width());
+            key_append(key, bridge_flow.scaled_spacing());
+            key_append(key, print_config.nozzle_diameter.get_at(layerm->region()->config().perimeter_extruder - 1));
+            key_append(key, layerm->region()->bridging_height_avg(print_config));
+            key_append(key, layerm->slices.surfaces.size());
+            for (const Surface &surface : layerm->slices.surfaces) {
+                key_append(key, int(surface.surface_type));
+                key_append(key, surface.expolygon);
+            }
+            for (const Surface &surface : layerm->fill_surfaces.surfaces)
+                if (surface.surface_type == stBottomBridge) {
+                    key_append(key, surface.bridge_angle);
+                    key_append(key, surface.expolygon);
+                }
+            key_append(key, has_bridging_perimeters(layerm->perimeters));
+            key_append(key, has_bridging_fills(layerm->fills));
+            key_append(key, layerm->perimeters.as_polylines());
+            key_append(key, layerm->unsupported_bridge_edges);
+        }
+        return key;
+    }
+
+    // Serialized support layer including its contact and overhang polygons.
+    static void key_append(std::string &key, const PrintObjectSupportMaterial::MyLayer &layer)
+    {
+        key_append(key, layer.layer_type);
+        key_append(key, layer.print_z);
+        key_append(key, layer.bottom_z);
+        key_append(key, layer.height);
+        key_append(key, layer.bridging);
+        key_append(key, layer.polygons);
+        for (const Polygons *polygons : { layer.contact_polygons, layer.overhang_polygons }) {
+            key_append(key, polygons != nullptr);
+            if (polygons != nullptr)
+                key_append(key, *polygons);
+        }
+    }
+
+    // Deep copy of a support layer including its contact and overhang polygons.
+    static void copy_support_layer(const PrintObjectSupportMaterial::MyLayer &src, PrintObjectSupportMaterial::MyLayer &dst)
+    {
+        dst.layer_type              = src.layer_type;
+        dst.print_z                 = src.print_z;
+        dst.bottom_z                = src.bottom_z;
+        dst.height                  = src.height;
+        dst.idx_object_layer_above  = src.idx_object_layer_above;
+        dst.idx_object_layer_below  = src.idx_object_layer_below;
+        dst.bridging                = src.bridging;
+        dst.polygons                = src.polygons;
+        delete dst.contact_polygons;
+        dst.contact_polygons        = src.contact_polygons  ? new Polygons(*src.contact_polygons)  : nullptr;
+        delete dst.overhang_polygons;
+        dst.overhang_polygons       = src.overhang_polygons ? new Polygons(*src.overhang_polygons) : nullptr;
+    }
 }
 
 #if 0
@@ -962,7 +1270,8 @@ static int run_support_test = Test();
 // For a soluble interface material synchronize the layer heights with the object, otherwise leave the layer height undefined.
 // If supports over bed surface only are requested, don't generate contact layers over an object.
 PrintObjectSupportMaterial::MyLayersPtr PrintObjectSupportMaterial::top_contact_layers(
-    const PrintObject &object, MyLayerStorage &layer_storage) const
+    const PrintObject &object, MyLayerStorage &layer_storage,
+    PrintObjectSupportMaterialCache *cache) const
 {
 #ifdef SLIC3R_DEBUG
     static int iRun = 0;
@@ -1018,14 +1327,57 @@ PrintObjectSupportMaterial::MyLayersPtr PrintObjectSupportMaterial::top_contact_
     // For each overhang layer, two supporting layers may be generated: One for the overhangs extruded with a bridging flow, 
     // and the other for the overhangs extruded with a normal flow.
     contact_out.assign(num_layers * 2, nullptr);
+
+    // The contacts of a layer depend on the layer and the layer below, on the support enforcers and blockers
+    // and on the regions covering the print bed. The cached contacts were invalidated if the layer or the layer below changed,
+    // they are reused if the other inputs did not change either.
+    std::vector<std::string> inputs;
+    std::vector<char>        reused;
+    if (cache != nullptr) {
+        inputs.assign(num_layers, std::string());
+        reused.assign(num_layers, false);
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers),
+            [&buildplate_covered, &enforcers, &blockers, &inputs](const tbb::blocked_range<size_t>& range) {
+                for (size_t layer_id = range.begin(); layer_id < range.end(); ++ layer_id) {
+                    std::string &key = inputs[layer_id];
+                    // Adding an enforcer or a blocker to some layers does not change the inputs of the other layers.
+                    if (! enforcers.empty() && ! enforcers[layer_id].empty()) {
+                        SupportMaterialInternal::key_append(key, EnforcerBlockerType::ENFORCER);
+                        SupportMaterialInternal::key_append(key, enforcers[layer_id]);
+                    }
+                    if (! blockers.empty() && ! blockers[layer_id].empty()) {
+                        SupportMaterialInternal::key_append(key, EnforcerBlockerType::BLOCKER);
+                        SupportMaterialInternal::key_append(key, blockers[layer_id]);
+                    }
+                    if (! buildplate_covered.empty())
+                        SupportMaterialInternal::key_append(key, buildplate_covered[layer_id]);
+                }
+            });
+    }
+
     tbb::spin_mutex layer_storage_mutex;
     tbb::parallel_for(tbb::blocked_range<size_t>(this->has_raft() ? 0 : 1, num_layers),
-        [this, &object, &buildplate_covered, &enforcers, &blockers, support_auto, threshold_rad, &layer_storage, &layer_storage_mutex, &contact_out]
+        [this, &object, &buildplate_covered, &enforcers, &blockers, support_auto, threshold_rad, &layer_storage, &layer_storage_mutex, &contact_out,
+         cache, &inputs, &reused]
         (const tbb::blocked_range<size_t>& range) {
             for (size_t layer_id = range.begin(); layer_id < range.end(); ++ layer_id) 
             {
                 const Layer &layer = *object.layers()[layer_id];
 
+                if (cache != nullptr) {
+                    const PrintObjectSupportMaterialCache::TopContacts &cached = cache->m_top_contacts[layer_id];
+                    if (cached.valid && cached.inputs == inputs[layer_id]) {
+                        for (size_t i = 0; i < 2; ++ i)
+                            if (cached.layers[i]) {
+                                MyLayer &new_layer = layer_allocate(layer_storage, layer_storage_mutex, sltTopContact);
+                                SupportMaterialInternal::copy_support_layer(*cached.layers[i], new_layer);
+                                contact_out[layer_id * 2 + i] = &new_layer;
+                            }
+                        reused[layer_id] = true;
+                        continue;
+                    }
+                }
+
                 // Detect overhangs and contact areas needed to support them.
                 // Collect overhangs and contacts of all regions of this layer supported by the layer immediately below.
                 Polygons overhang_polygons;
@@ -1355,6 +1707,25 @@ PrintObjectSupportMaterial::MyLayersPtr PrintObjectSupportMaterial::top_contact_
             }
         });
 
+    if (cache != nullptr) {
+        // Store the contacts of the layers processed just now, before they are merged.
+        for (size_t layer_id = this->has_raft() ? 0 : 1; layer_id < num_layers; ++ layer_id)
+            if (reused[layer_id])
+                ++ cache->top_contacts_reused;
+            else {
+                PrintObjectSupportMaterialCache::TopContacts &cached = cache->m_top_contacts[layer_id];
+                cached.valid  = true;
+                cached.inputs = std::move(inputs[layer_id]);
+                for (size_t i = 0; i < 2; ++ i)
+                    if (const MyLayer *layer = contact_out[layer_id * 2 + i]; layer != nullptr) {
+                        cached.layers[i] = std::make_unique<MyLayer>();
+                        SupportMaterialInternal::copy_support_layer(*layer, *cached.layers[i]);
+                    } else
+                        cached.layers[i].reset();
+                ++ cache->top_contacts_generated;
+            }
+    }
+
     // Compress contact_out, remove the nullptr items.
     remove_nulls(contact_out);
     // Sort the layers, as one layer may produce bridging and non-bridging contact layers with different print_z.
@@ -1425,7 +1796,8 @@ PrintObjectSupportMaterial::MyLayersPtr PrintObjectSupportMaterial::top_contact_
 // otherwise set the layer height to a bridging flow of a support interface nozzle.
 PrintObjectSupportMaterial::MyLayersPtr PrintObjectSupportMaterial::bottom_contact_layers_and_layer_support_areas(
     const PrintObject &object, const MyLayersPtr &top_contacts, MyLayerStorage &layer_storage,
-    std::vector<Polygons> &layer_support_areas) const
+    std::vector<Polygons> &layer_support_areas,
+    PrintObjectSupportMaterialCache *cache) const
 {
 #ifdef SLIC3R_DEBUG
     static int iRun = 0;
@@ -1441,162 +1813,248 @@ PrintObjectSupportMaterial::MyLayersPtr PrintObjectSupportMaterial::bottom_conta
 
     if (! top_contacts.empty()) 
     {
+        // Trim the already created base layers above the current layer intersecting with the new bottom contacts layer.
+        //FIXME Maybe this is no more needed, as the overlapping base layers are trimmed by the bottom layers at the final stage?
+        auto trim_support_areas_above = [&object, &layer_support_areas](int layer_id, const MyLayer &layer_new, const Polygons &touching) {
+#ifdef SLIC3R_DEBUG
+            const Layer &layer = *object.layers()[layer_id];
+#endif /* SLIC3R_DEBUG */
+            for (int layer_id_above = layer_id + 1; layer_id_above < int(object.total_layer_count()); ++ layer_id_above) {
+                const Layer &layer_above = *object.layers()[layer_id_above];
+                if (layer_above.print_z > layer_new.print_z - EPSILON)
+                    break; 
+                if (! layer_support_areas[layer_id_above].empty()) {
+#ifdef SLIC3R_DEBUG
+                    {
+                        BoundingBox bbox = get_extents(touching);
+                        bbox.merge(get_extents(layer_support_areas[layer_id_above]));
+                        ::Slic3r::SVG svg(debug_out_path("support-support-areas-raw-before-trimming-%d-with-%f-%lf.svg", iRun, layer.print_z, layer_above.print_z), bbox);
+                        svg.draw(union_ex(touching, false), "blue", 0.5f);
+                        svg.draw(union_ex(layer_support_areas[layer_id_above], true), "red", 0.5f);
+                        svg.draw_outline(union_ex(layer_support_areas[layer_id_above], true), "red", "blue", scale_(0.1f));
+                    }
+#endif /* SLIC3R_DEBUG */
+                    layer_support_areas[layer_id_above] = diff(layer_support_areas[layer_id_above], touching);
+#ifdef SLIC3R_DEBUG
+                    Slic3r::SVG::export_expolygons(
+                        debug_out_path("support-support-areas-raw-after-trimming-%d-with-%f-%lf.svg", iRun, layer.print_z, layer_above.print_z),
+                        union_ex(layer_support_areas[layer_id_above], false));
+#endif /* SLIC3R_DEBUG */
+                }
+            }
+        };
+
         // There is some support to be built, if there are non-empty top surfaces detected.
+        // The projection of the contact areas is swept from the top down: the projection continuing below a layer is
+        // the projection from above trimmed by the layer and stretched into the support grid. Only this chain
+        // is processed sequentially. The inputs of the chain are prepared in parallel for a block of layers, while
+        // the bottom contacts and the support areas, which the chain does not depend on, are extracted by tasks
+        // running alongside the chain. The results are then applied layer by layer in the order of the sweep.
+        struct LayerSweep {
+            bool                                          active    { false };
+            bool                                          cache_hit { false };
+            PrintObjectSupportMaterialCache::SupportArea *cached    { nullptr };
+            // Layer slices inflated by SCALED_EPSILON, trimming the projection.
+            Polygons                                      trimming;
+            // Projection from above before trimming, used to place the bottom contact layer.
+            Polygons                                      projection_raw;
+            // Trimmed projection and its grid, from which the support area of this layer is extracted.
+            Polygons                                      support_polygons;
+            std::unique_ptr<SupportGridPattern>           support_grid_pattern;
+            // Bottom contact layer placed over the top surfaces of this layer and the area it trims from the support areas above.
+            MyLayer                                      *bottom_contact    { nullptr };
+            Polygons                                      touching;
+            // Projection continuing below this layer, to be stored into the cache.
+            Polygons                                      projection_below;
+        };
+        // Number of layers, for which the inputs are prepared at once, see sweep_block_size. Bounds the memory held by the pending tasks.
+        const int               block_size = std::max(1, sweep_block_size);
+        std::vector<LayerSweep> sweep(object.total_layer_count());
+        // Contact areas of the top contact layers merged for the projection, prepared in parallel with the trimming polygons.
+        std::vector<Polygons>   contact_projections(top_contacts.size());
+        tbb::spin_mutex         layer_storage_mutex;
+        tbb::task_group         task_group;
+
         // Sum of unsupported contact areas above the current layer.print_z.
         Polygons  projection;
         // Last top contact layer visited when collecting the projection of contact areas.
         int       contact_idx = int(top_contacts.size()) - 1;
-        for (int layer_id = int(object.total_layer_count()) - 2; layer_id >= 0; -- layer_id) {
-            BOOST_LOG_TRIVIAL(trace) << "Support generator - bottom_contact_layers - layer " << layer_id;
-            const Layer &layer = *object.get_layer(layer_id);
-            // Collect projections of all contact areas above or at the same level as this top surface.
-            for (; contact_idx >= 0 && top_contacts[contact_idx]->print_z > layer.print_z - EPSILON; -- contact_idx) {
-                Polygons polygons_new;
-                // Contact surfaces are expanded away from the object, trimmed by the object.
-                // Use a slight positive offset to overlap the touching regions.
+        for (int block_end = int(object.total_layer_count()) - 2; block_end >= 0; block_end -= block_size) {
+            int block_begin   = std::max(0, block_end - block_size + 1);
+            // Top contact layers collected by the layers of this block are (contact_begin, contact_idx].
+            int contact_begin = contact_idx;
+            for (; contact_begin >= 0 && top_contacts[contact_begin]->print_z > object.get_layer(block_begin)->print_z - EPSILON; -- contact_begin) ;
+            if (projection.empty() && contact_begin == contact_idx)
+                // Nothing to support by this block of layers.
+                continue;
+
+            int num_layers = block_end + 1 - block_begin;
+            tbb::parallel_for(tbb::blocked_range<int>(0, num_layers + contact_idx - contact_begin),
+                [this, &object, &top_contacts, &sweep, &contact_projections, block_begin, contact_begin, num_layers](const tbb::blocked_range<int> &range) {
+                for (int i = range.begin(); i < range.end(); ++ i)
+                    if (i < num_layers) {
+                        const Layer &layer = *object.get_layer(block_begin + i);
+                        sweep[block_begin + i].trimming = offset(layer.lslices, float(SCALED_EPSILON));
+                    } else {
+                        int      idx = contact_begin + 1 + i - num_layers;
+                        Polygons polygons_new;
+                        // Contact surfaces are expanded away from the object, trimmed by the object.
+                        // Use a slight positive offset to overlap the touching regions.
 #if 0
-                // Merge and collect the contact polygons. The contact polygons are inflated, but not extended into a grid form.
-                polygons_append(polygons_new, offset(*top_contacts[contact_idx]->contact_polygons, SCALED_EPSILON));
+                        // Merge and collect the contact polygons. The contact polygons are inflated, but not extended into a grid form.
+                        polygons_append(polygons_new, offset(*top_contacts[idx]->contact_polygons, SCALED_EPSILON));
 #else
-                // Consume the contact_polygons. The contact polygons are already expanded into a grid form, and they are a tiny bit smaller
-                // than the grid cells.
-                polygons_append(polygons_new, std::move(*top_contacts[contact_idx]->contact_polygons));
+                        // Consume the contact_polygons. The contact polygons are already expanded into a grid form, and they are a tiny bit smaller
+                        // than the grid cells.
+                        polygons_append(polygons_new, std::move(*top_contacts[idx]->contact_polygons));
 #endif
-                // These are the overhang surfaces. They are touching the object and they are not expanded away from the object.
-                // Use a slight positive offset to overlap the touching regions.
-                polygons_append(polygons_new, offset(*top_contacts[contact_idx]->overhang_polygons, float(SCALED_EPSILON)));
-                polygons_append(projection, union_(polygons_new));
-            }
-            if (projection.empty())
-                continue;
-            Polygons projection_raw = union_(projection);
-
-            tbb::task_group task_group;
-            if (! m_object_config->support_material_buildplate_only)
-                // Find the bottom contact layers above the top surfaces of this layer.
-                task_group.run([this, &object, &top_contacts, contact_idx, &layer, layer_id, &layer_storage, &layer_support_areas, &bottom_contacts, &projection_raw] {
-                    Polygons top = collect_region_slices_by_type(layer, stTop);
-        #ifdef SLIC3R_DEBUG
-                    {
-                        BoundingBox bbox = get_extents(projection_raw);
-                        bbox.merge(get_extents(top));
-                        ::Slic3r::SVG svg(debug_out_path("support-bottom-layers-raw-%d-%lf.svg", iRun, layer.print_z), bbox);
-                        svg.draw(union_ex(top, false), "blue", 0.5f);
-                        svg.draw(union_ex(projection_raw, true), "red", 0.5f);
-                        svg.draw_outline(union_ex(projection_raw, true), "red", "blue", scale_(0.1f));
-                        svg.draw(layer.lslices, "green", 0.5f);
+                        // These are the overhang surfaces. They are touching the object and they are not expanded away from the object.
+                        // Use a slight positive offset to overlap the touching regions.
+                        polygons_append(polygons_new, offset(*top_contacts[idx]->overhang_polygons, float(SCALED_EPSILON)));
+                        contact_projections[idx] = union_(polygons_new);
                     }
-        #endif /* SLIC3R_DEBUG */
+            });
 
-                    // Now find whether any projection of the contact surfaces above layer.print_z not yet supported by any 
-                    // top surfaces above layer.print_z falls onto this top surface. 
-                    // Touching are the contact surfaces supported exclusively by this top surfaces.
-                    // Don't use a safety offset as it has been applied during insertion of polygons.
-                    if (! top.empty()) {
-                        Polygons touching = intersection(top, projection_raw, false);
-                        if (! touching.empty()) {
-                            // Allocate a new bottom contact layer.
-                            MyLayer &layer_new = layer_allocate(layer_storage, sltBottomContact);
-                            bottom_contacts.push_back(&layer_new);
-                            // Grow top surfaces so that interface and support generation are generated
-                            // with some spacing from object - it looks we don't need the actual
-                            // top shapes so this can be done here
-                            //FIXME calculate layer height based on the actual thickness of the layer:
-                            // If the layer is extruded with no bridging flow, support just the normal extrusions.
-                            layer_new.height  = m_slicing_params.soluble_interface ? 
-                                // Align the interface layer with the object's layer height.
-                                object.layers()[layer_id + 1]->height :
-                                // Place a bridge flow interface layer over the top surface.
-                                //FIXME Check whether the bottom bridging surfaces are extruded correctly (no bridging flow correction applied?)
-                                // According to Jindrich the bottom surfaces work well.
-                                //FIXME test the bridging flow instead?
-                                m_support_material_interface_flow.nozzle_diameter;
-                            layer_new.print_z = m_slicing_params.soluble_interface ? object.layers()[layer_id + 1]->print_z :
-                                layer.print_z + layer_new.height + m_object_config->support_material_contact_distance.value;
-                            layer_new.bottom_z = layer.print_z;
-                            layer_new.idx_object_layer_below = layer_id;
-                            layer_new.bridging = ! m_slicing_params.soluble_interface;
-                            //FIXME how much to inflate the bottom surface, as it is being extruded with a bridging flow? The following line uses a normal flow.
-                            //FIXME why is the offset positive? It will be trimmed by the object later on anyway, but then it just wastes CPU clocks.
-                            layer_new.polygons = offset(touching, float(m_support_material_flow.scaled_width()), SUPPORT_SURFACES_OFFSET_PARAMETERS);
-                            if (! m_slicing_params.soluble_interface) {
-                                // Walk the top surfaces, snap the top of the new bottom surface to the closest top of the top surface,
-                                // so there will be no support surfaces generated with thickness lower than m_support_layer_height_min.
-                                for (size_t top_idx = size_t(std::max<int>(0, contact_idx)); 
-                                    top_idx < top_contacts.size() && top_contacts[top_idx]->print_z < layer_new.print_z + this->m_support_layer_height_min + EPSILON; 
-                                    ++ top_idx) {
-                                    if (top_contacts[top_idx]->print_z > layer_new.print_z - this->m_support_layer_height_min - EPSILON) {
-                                        // A top layer has been found, which is close to the new bottom layer.
-                                        coordf_t diff = layer_new.print_z - top_contacts[top_idx]->print_z;
-                                        assert(std::abs(diff) <= this->m_support_layer_height_min + EPSILON);
-                                        if (diff > 0.) {
-                                            // The top contact layer is below this layer. Make the bridging layer thinner to align with the existing top layer.
-                                            assert(diff < layer_new.height + EPSILON);
-                                            assert(layer_new.height - diff >= m_support_layer_height_min - EPSILON);
-                                            layer_new.print_z  = top_contacts[top_idx]->print_z;
-                                            layer_new.height  -= diff;
-                                        } else {
-                                            // The top contact layer is above this layer. One may either make this layer thicker or thinner.
-                                            // By making the layer thicker, one will decrease the number of discrete layers with the price of extruding a bit too thick bridges.
-                                            // By making the layer thinner, one adds one more discrete layer.
-                                            layer_new.print_z  = top_contacts[top_idx]->print_z;
-                                            layer_new.height  -= diff;
-                                        }
-                                        break;
-                                    }
-                                }
-                            }
-                #ifdef SLIC3R_DEBUG
-                            Slic3r::SVG::export_expolygons(
-                                debug_out_path("support-bottom-contacts-%d-%lf.svg", iRun, layer_new.print_z),
-                                union_ex(layer_new.polygons, false));
-                #endif /* SLIC3R_DEBUG */
-                            // Trim the already created base layers above the current layer intersecting with the new bottom contacts layer.
-                            //FIXME Maybe this is no more needed, as the overlapping base layers are trimmed by the bottom layers at the final stage?
-                            touching = offset(touching, float(SCALED_EPSILON));
-                            for (int layer_id_above = layer_id + 1; layer_id_above < int(object.total_layer_count()); ++ layer_id_above) {
-                                const Layer &layer_above = *object.layers()[layer_id_above];
-                                if (layer_above.print_z > layer_new.print_z - EPSILON)
-                                    break; 
-                                if (! layer_support_areas[layer_id_above].empty()) {
-#ifdef SLIC3R_DEBUG
-                                    {
-                                        BoundingBox bbox = get_extents(touching);
-                                        bbox.merge(get_extents(layer_support_areas[layer_id_above]));
-                                        ::Slic3r::SVG svg(debug_out_path("support-support-areas-raw-before-trimming-%d-with-%f-%lf.svg", iRun, layer.print_z, layer_above.print_z), bbox);
-                                        svg.draw(union_ex(touching, false), "blue", 0.5f);
-                                        svg.draw(union_ex(layer_support_areas[layer_id_above], true), "red", 0.5f);
-                                        svg.draw_outline(union_ex(layer_support_areas[layer_id_above], true), "red", "blue", scale_(0.1f));
-                                    }
-#endif /* SLIC3R_DEBUG */
-                                    layer_support_areas[layer_id_above] = diff(layer_support_areas[layer_id_above], touching);
-#ifdef SLIC3R_DEBUG
-                                    Slic3r::SVG::export_expolygons(
-                                        debug_out_path("support-support-areas-raw-after-trimming-%d-with-%f-%lf.svg", iRun, layer.print_z, layer_above.print_z),
-                                        union_ex(layer_support_areas[layer_id_above], false));
-#endif /* SLIC3R_DEBUG */
-                                }
-                            }
-                        }
-                    } // ! top.empty()
-                });
+            for (int layer_id = block_end; layer_id >= block_begin; -- layer_id) {
+                BOOST_LOG_TRIVIAL(trace) << "Support generator - bottom_contact_layers - layer " << layer_id;
+                const Layer &layer = *object.get_layer(layer_id);
+                LayerSweep  &state = sweep[layer_id];
+                // Collect projections of all contact areas above or at the same level as this top surface.
+                for (; contact_idx >= 0 && top_contacts[contact_idx]->print_z > layer.print_z - EPSILON; -- contact_idx)
+                    polygons_append(projection, std::move(contact_projections[contact_idx]));
+                if (projection.empty()) {
+                    state.trimming.clear();
+                    continue;
+                }
+                state.active = true;
+
+                // The support area of this layer and the projection continuing below depend on the projection from above, on this layer
+                // and the layer above and on the print_z of the top contacts a bottom contact placed over this layer may snap to.
+                // The cached results were invalidated if this layer or the layer above changed, they are reused if the other inputs
+                // did not change either.
+                if (cache != nullptr) {
+                    PrintObjectSupportMaterialCache::SupportArea *cached = &cache->m_support_areas[layer_id];
+                    state.cached = cached;
+                    std::string inputs;
+                    SupportMaterialInternal::key_append(inputs, projection);
+                    coordf_t snap_z_max = layer.print_z + m_support_material_interface_flow.nozzle_diameter +
+                        m_object_config->support_material_contact_distance.value + m_support_layer_height_min + EPSILON;
+                    for (size_t top_idx = size_t(std::max<int>(0, contact_idx)); top_idx < top_contacts.size() && top_contacts[top_idx]->print_z < snap_z_max; ++ top_idx)
+                        SupportMaterialInternal::key_append(inputs, top_contacts[top_idx]->print_z);
+                    if (cached->valid && cached->inputs == inputs) {
+                        state.cache_hit = true;
+                        state.trimming.clear();
+                        projection = cached->projection;
+                        continue;
+                    }
+                    cached->valid  = false;
+                    cached->inputs = std::move(inputs);
+                }
 
-            Polygons &layer_support_area = layer_support_areas[layer_id];
-            task_group.run([this, &projection, &projection_raw, &layer, &layer_support_area, layer_id] {
+                state.projection_raw = union_(projection);
                 // Remove the areas that touched from the projection that will continue on next, lower, top surfaces.
     //            Polygons trimming = union_(to_polygons(layer.slices), touching, true);
-                Polygons trimming = offset(layer.lslices, float(SCALED_EPSILON));
-                projection = diff(projection_raw, trimming, false);
+                projection = diff(state.projection_raw, state.trimming, false);
     #ifdef SLIC3R_DEBUG
                 {
-                    BoundingBox bbox = get_extents(projection_raw);
-                    bbox.merge(get_extents(trimming));
+                    BoundingBox bbox = get_extents(state.projection_raw);
+                    bbox.merge(get_extents(state.trimming));
                     ::Slic3r::SVG svg(debug_out_path("support-support-areas-raw-%d-%lf.svg", iRun, layer.print_z), bbox);
-                    svg.draw(union_ex(trimming, false), "blue", 0.5f);
+                    svg.draw(union_ex(state.trimming, false), "blue", 0.5f);
                     svg.draw(union_ex(projection, true), "red", 0.5f);
                     svg.draw_outline(union_ex(projection, true), "red", "blue", scale_(0.1f));
                 }
     #endif /* SLIC3R_DEBUG */
+
+                if (m_object_config->support_material_buildplate_only)
+                    state.projection_raw.clear();
+                else
+                    // Find the bottom contact layers above the top surfaces of this layer.
+                    task_group.run([this, &object, &top_contacts, contact_idx, &layer, layer_id, &layer_storage, &layer_storage_mutex, &state] {
+                        Polygons top = collect_region_slices_by_type(layer, stTop);
+            #ifdef SLIC3R_DEBUG
+                        {
+                            BoundingBox bbox = get_extents(state.projection_raw);
+                            bbox.merge(get_extents(top));
+                            ::Slic3r::SVG svg(debug_out_path("support-bottom-layers-raw-%d-%lf.svg", iRun, layer.print_z), bbox);
+                            svg.draw(union_ex(top, false), "blue", 0.5f);
+                            svg.draw(union_ex(state.projection_raw, true), "red", 0.5f);
+                            svg.draw_outline(union_ex(state.projection_raw, true), "red", "blue", scale_(0.1f));
+                            svg.draw(layer.lslices, "green", 0.5f);
+                        }
+            #endif /* SLIC3R_DEBUG */
+
+                        // Now find whether any projection of the contact surfaces above layer.print_z not yet supported by any 
+                        // top surfaces above layer.print_z falls onto this top surface. 
+                        // Touching are the contact surfaces supported exclusively by this top surfaces.
+                        // Don't use a safety offset as it has been applied during insertion of polygons.
+                        if (! top.empty()) {
+                            state.touching = intersection(top, state.projection_raw, false);
+                            if (! state.touching.empty()) {
+                                // Allocate a new bottom contact layer.
+                                MyLayer &layer_new = layer_allocate(layer_storage, layer_storage_mutex, sltBottomContact);
+                                state.bottom_contact = &layer_new;
+                                // Grow top surfaces so that interface and support generation are generated
+                                // with some spacing from object - it looks we don't need the actual
+                                // top shapes so this can be done here
+                                //FIXME calculate layer height based on the actual thickness of the layer:
+                                // If the layer is extruded with no bridging flow, support just the normal extrusions.
+                                layer_new.height  = m_slicing_params.soluble_interface ? 
+                                    // Align the interface layer with the object's layer height.
+                                    object.layers()[layer_id + 1]->height :
+                                    // Place a bridge flow interface layer over the top surface.
+                                    //FIXME Check whether the bottom bridging surfaces are extruded correctly (no bridging flow correction applied?)
+                                    // According to Jindrich the bottom surfaces work well.
+                                    //FIXME test the bridging flow instead?
+                                    m_support_material_interface_flow.nozzle_diameter;
+                                layer_new.print_z = m_slicing_params.soluble_interface ? object.layers()[layer_id + 1]->print_z :
+                                    layer.print_z + layer_new.height + m_object_config->support_material_contact_distance.value;
+                                layer_new.bottom_z = layer.print_z;
+                                layer_new.idx_object_layer_below = layer_id;
+                                layer_new.bridging = ! m_slicing_params.soluble_interface;
+                                //FIXME how much to inflate the bottom surface, as it is being extruded with a bridging flow? The following line uses a normal flow.
+                                //FIXME why is the offset positive? It will be trimmed by the object later on anyway, but then it just wastes CPU clocks.
+                                layer_new.polygons = offset(state.touching, float(m_support_material_flow.scaled_width()), SUPPORT_SURFACES_OFFSET_PARAMETERS);
+                                if (! m_slicing_params.soluble_interface) {
+                                    // Walk the top surfaces, snap the top of the new bottom surface to the closest top of the top surface,
+                                    // so there will be no support surfaces generated with thickness lower than m_support_layer_height_min.
+                                    for (size_t top_idx = size_t(std::max<int>(0, contact_idx)); 
+                                        top_idx < top_contacts.size() && top_contacts[top_idx]->print_z < layer_new.print_z + this->m_support_layer_height_min + EPSILON; 
+                                        ++ top_idx) {
+                                        if (top_contacts[top_idx]->print_z > layer_new.print_z - this->m_support_layer_height_min - EPSILON) {
+                                            // A top layer has been found, which is close to the new bottom layer.
+                                            coordf_t diff = layer_new.print_z - top_contacts[top_idx]->print_z;
+                                            assert(std::abs(diff) <= this->m_support_layer_height_min + EPSILON);
+                                            if (diff > 0.) {
+                                                // The top contact layer is below this layer. Make the bridging layer thinner to align with the existing top layer.
+                                                assert(diff < layer_new.height + EPSILON);
+                                                assert(layer_new.height - diff >= m_support_layer_height_min - EPSILON);
+                                                layer_new.print_z  = top_contacts[top_idx]->print_z;
+                                                layer_new.height  -= diff;
+                                            } else {
+                                                // The top contact layer is above this layer. One may either make this layer thicker or thinner.
+                                                // By making the layer thicker, one will decrease the number of discrete layers with the price of extruding a bit too thick bridges.
+                                                // By making the layer thinner, one adds one more discrete layer.
+                                                layer_new.print_z  = top_contacts[top_idx]->print_z;
+                                                layer_new.height  -= diff;
+                                            }
+                                            break;
+                                        }
+                                    }
+                                }
+                    #ifdef SLIC3R_DEBUG
+                                Slic3r::SVG::export_expolygons(
+                                    debug_out_path("support-bottom-contacts-%d-%lf.svg", iRun, layer_new.print_z),
+                                    union_ex(layer_new.polygons, false));
+                    #endif /* SLIC3R_DEBUG */
+                                // The support areas above the current layer will be trimmed by the new bottom contacts layer.
+                                state.touching = offset(state.touching, float(SCALED_EPSILON));
+                            }
+                        } // ! top.empty()
+                        // The projection is no more needed, release its data.
+                        state.projection_raw.clear();
+                    });
+
                 remove_sticks(projection);
                 remove_degenerate(projection);
         #ifdef SLIC3R_DEBUG
@@ -1604,23 +2062,24 @@ PrintObjectSupportMaterial::MyLayersPtr PrintObjectSupportMaterial::bottom_conta
                     debug_out_path("support-support-areas-raw-cleaned-%d-%lf.svg", iRun, layer.print_z),
                     union_ex(projection, false));
         #endif /* SLIC3R_DEBUG */
-                SupportGridPattern support_grid_pattern(
+                state.support_polygons     = std::move(projection);
+                state.support_grid_pattern = std::make_unique<SupportGridPattern>(
                     // Support islands, to be stretched into a grid.
-                    projection, 
+                    state.support_polygons, 
                     // Trimming polygons, to trim the stretched support islands.
-                    trimming,
+                    state.trimming,
                     // Grid spacing.
                     m_object_config->support_material_spacing.value + m_support_material_flow.spacing(),
                     Geometry::deg2rad(m_object_config->support_material_angle.value));
-                tbb::task_group task_group_inner;
                 // 1) Cache the slice of a support volume. The support volume is expanded by 1/2 of support material flow spacing
                 // to allow a placement of suppot zig-zag snake along the grid lines.
-                task_group_inner.run([this, &support_grid_pattern, &layer_support_area
+                Polygons &layer_support_area = layer_support_areas[layer_id];
+                task_group.run([this, &state, &layer_support_area
         #ifdef SLIC3R_DEBUG 
                     , &layer
         #endif /* SLIC3R_DEBUG */
                     ] {
-                    layer_support_area = support_grid_pattern.extract_support(m_support_material_flow.scaled_spacing()/2 + 25, true);
+                    layer_support_area = state.support_grid_pattern->extract_support(m_support_material_flow.scaled_spacing()/2 + 25, true);
         #ifdef SLIC3R_DEBUG
                     Slic3r::SVG::export_expolygons(
                         debug_out_path("support-layer_support_area-gridded-%d-%lf.svg", iRun, layer.print_z),
@@ -1628,23 +2087,57 @@ PrintObjectSupportMaterial::MyLayersPtr PrintObjectSupportMaterial::bottom_conta
         #endif /* SLIC3R_DEBUG */
                 });
                 // 2) Support polygons will be projected down. To keep the interface and base layers from growing, return a contour a tiny bit smaller than the grid cells.
-                Polygons projection_new;
-                task_group_inner.run([&projection_new, &support_grid_pattern
-        #ifdef SLIC3R_DEBUG 
-                    , &layer
-        #endif /* SLIC3R_DEBUG */
-                    ] {
-                    projection_new = support_grid_pattern.extract_support(-5, true);
+                projection = state.support_grid_pattern->extract_support(-5, true);
         #ifdef SLIC3R_DEBUG
-                    Slic3r::SVG::export_expolygons(
-                        debug_out_path("support-projection_new-gridded-%d-%lf.svg", iRun, layer.print_z),
-                        union_ex(projection_new, false));
+                Slic3r::SVG::export_expolygons(
+                    debug_out_path("support-projection_new-gridded-%d-%lf.svg", iRun, layer.print_z),
+                    union_ex(projection, false));
         #endif /* SLIC3R_DEBUG */
-                });
-                task_group_inner.wait();
-                projection = std::move(projection_new);
-            });
+                if (state.cached != nullptr)
+                    state.projection_below = projection;
+            }
             task_group.wait();
+
+            // Apply the results of this block in the order of the sweep: the bottom contacts trim the support areas above them
+            // and the cache stores the support areas before they are trimmed by the bottom contacts below.
+            for (int layer_id = block_end; layer_id >= block_begin; -- layer_id) {
+                LayerSweep &state = sweep[layer_id];
+                if (! state.active)
+                    continue;
+                PrintObjectSupportMaterialCache::SupportArea *cached = state.cached;
+                if (state.cache_hit) {
+                    if (cached->bottom_contact) {
+                        MyLayer &layer_new = layer_allocate(layer_storage, sltBottomContact);
+                        SupportMaterialInternal::copy_support_layer(*cached->bottom_contact, layer_new);
+                        bottom_contacts.push_back(&layer_new);
+                        trim_support_areas_above(layer_id, layer_new, cached->touching);
+                    }
+                    layer_support_areas[layer_id] = cached->support_area;
+                    ++ cache->support_areas_reused;
+                } else {
+                    if (state.bottom_contact != nullptr) {
+                        bottom_contacts.push_back(state.bottom_contact);
+                        trim_support_areas_above(layer_id, *state.bottom_contact, state.touching);
+                    }
+                    if (cached != nullptr) {
+                        // Store the results before the bottom contact layer is trimmed by the object.
+                        cached->valid        = true;
+                        cached->projection   = std::move(state.projection_below);
+                        cached->support_area = layer_support_areas[layer_id];
+                        if (state.bottom_contact != nullptr) {
+                            cached->bottom_contact = std::make_unique<MyLayer>();
+                            SupportMaterialInternal::copy_support_layer(*state.bottom_contact, *cached->bottom_contact);
+                            cached->touching = state.touching;
+                        } else {
+                            cached->bottom_contact.reset();
+                            cached->touching.clear();
+                        }
+                        ++ cache->support_areas_generated;
+                    }
+                }
+                // Release the data of this layer.
+                state = LayerSweep();
+            }
         }
         std::reverse(bottom_contacts.begin(), bottom_contacts.end());
 //        trim_support_layers_by_object(object, bottom_contacts, 0., 0., m_gap_xy);
@@ -2936,7 +3429,8 @@ void PrintObjectSupportMaterial::generate_toolpaths(
     const MyLayersPtr   &bottom_contacts,
     const MyLayersPtr   &top_contacts,
     const MyLayersPtr   &intermediate_layers,
-    const MyLayersPtr   &interface_layers) const
+    const MyLayersPtr   &interface_layers,
+    PrintObjectSupportMaterialCache *cache) const
 {
 //    Slic3r::debugf "Generating patterns\n";
     // loop_interface_processor with a given circle radius.
@@ -3104,9 +3598,53 @@ void PrintObjectSupportMaterial::generate_toolpaths(
     };
     std::vector<LayerCache>             layer_caches(object.support_layers().size(), LayerCache());
 
+    // The extrusions of a support layer depend on the support layers at its print_z and on the support layers below overlapping them.
+    // These are serialized before any of them is modified by the tool path generation, a support layer with the same inputs
+    // as a support layer of the previous run takes the extrusions from the cache.
+    std::vector<std::string>                                 toolpaths_keys;
+    std::vector<PrintObjectSupportMaterialCache::Toolpaths*> toolpaths_cached;
+    std::vector<PrintObjectSupportMaterialCache::Toolpaths>  toolpaths_generated;
+    if (cache != nullptr) {
+        toolpaths_keys.assign(object.support_layers().size(), std::string());
+        toolpaths_cached.assign(object.support_layers().size(), nullptr);
+        toolpaths_generated.resize(object.support_layers().size());
+        tbb::parallel_for(tbb::blocked_range<size_t>(n_raft_layers, object.support_layers().size()),
+            [&object, &bottom_contacts, &top_contacts, &intermediate_layers, &interface_layers, &angles, cache, &toolpaths_keys, &toolpaths_cached]
+                (const tbb::blocked_range<size_t>& range) {
+            const MyLayersPtr* const layers_all[] = { &bottom_contacts, &top_contacts, &intermediate_layers, &interface_layers };
+            // The layers are sorted by print_z.
+            auto lower = [](const MyLayersPtr &layers, coordf_t z) {
+                return std::lower_bound(layers.begin(), layers.end(), z, [](const MyLayer *l, coordf_t z) { return l->print_z < z; });
+            };
+            for (size_t support_layer_id = range.begin(); support_layer_id < range.end(); ++ support_layer_id) {
+                const SupportLayer &support_layer = *object.support_layers()[support_layer_id];
+                // Bottom of the layers extruded at this print_z.
+                coordf_t bottom_z = support_layer.print_z;
+                for (const MyLayersPtr *layers : layers_all)
+                    if (auto it = lower(*layers, support_layer.print_z - EPSILON); it != layers->end() && (*it)->print_z < support_layer.print_z + EPSILON)
+                        bottom_z = std::min(bottom_z, (*it)->bottom_print_z());
+                std::string &key = toolpaths_keys[support_layer_id];
+                // The infill angle alternates with the support layer index, the first layer is printed differently.
+                SupportMaterialInternal::key_append(key, support_layer_id % angles.size());
+                SupportMaterialInternal::key_append(key, support_layer_id == 0);
+                SupportMaterialInternal::key_append(key, support_layer.print_z);
+                SupportMaterialInternal::key_append(key, support_layer.height);
+                for (const MyLayersPtr *layers : layers_all) {
+                    auto begin = lower(*layers, bottom_z - EPSILON);
+                    auto end   = lower(*layers, support_layer.print_z + EPSILON);
+                    SupportMaterialInternal::key_append(key, size_t(end - begin));
+                    for (auto it = begin; it != end; ++ it)
+                        SupportMaterialInternal::key_append(key, **it);
+                }
+                if (auto it = cache->m_toolpaths.find(key); it != cache->m_toolpaths.end())
+                    toolpaths_cached[support_layer_id] = &it->second;
+            }
+        });
+    }
+
     tbb::parallel_for(tbb::blocked_range<size_t>(n_raft_layers, object.support_layers().size()),
         [this, &object, &bottom_contacts, &top_contacts, &intermediate_layers, &interface_layers, &layer_caches, &loop_interface_processor, 
-            infill_pattern, &bbox_object, support_density, interface_density, interface_angle, &angles, link_max_length_factor, with_sheath]
+            infill_pattern, &bbox_object, support_density, interface_density, interface_angle, &angles, link_max_length_factor, with_sheath, &toolpaths_cached]
             (const tbb::blocked_range<size_t>& range) {
         // Indices of the 1st layer in their respective container at the support layer height.
         size_t idx_layer_bottom_contact   = size_t(-1);
@@ -3135,6 +3673,8 @@ void PrintObjectSupportMaterial::generate_toolpaths(
                 idx_layer_intermediate    = idx_higher_or_equal(intermediate_layers, idx_layer_intermediate,    fun);
                 idx_layer_inteface        = idx_higher_or_equal(interface_layers,    idx_layer_inteface,        fun);
             }
+            // The extrusions will be taken from the cache.
+            bool reuse = ! toolpaths_cached.empty() && toolpaths_cached[support_layer_id] != nullptr;
             // Copy polygons from the layers.
             if (idx_layer_bottom_contact < bottom_contacts.size() && bottom_contacts[idx_layer_bottom_contact]->print_z < support_layer.print_z + EPSILON)
                 bottom_contact_layer.layer = bottom_contacts[idx_layer_bottom_contact];
@@ -3158,7 +3698,8 @@ void PrintObjectSupportMaterial::generate_toolpaths(
                         std::swap(base_layer, bottom_contact_layer);
                 }
             } else {
-                loop_interface_processor.generate(top_contact_layer, m_support_material_interface_flow);
+                if (! reuse)
+                    loop_interface_processor.generate(top_contact_layer, m_support_material_interface_flow);
                 // If no loops are allowed, we treat the contact layer exactly as a generic interface layer.
                 // Merge interface_layer into top_contact_layer, as the top_contact_layer is not synchronized and therefore it will be used
                 // to trim other layers.
@@ -3175,6 +3716,11 @@ void PrintObjectSupportMaterial::generate_toolpaths(
                 base_layer.layer->polygons = diff(base_layer.layer->polygons, islands);
             }
 
+            if (reuse)
+                // The polygons merged above modulate the extrusions of the support layers overlapping this one,
+                // the extrusions of this layer are taken from the cache.
+                continue;
+
             // Top and bottom contacts, interface layers.
             for (size_t i = 0; i < 3; ++ i) {
                 MyLayerExtruded &layer_ex = (i == 0) ? top_contact_layer : (i == 1 ? bottom_contact_layer : interface_layer);
@@ -3318,17 +3864,42 @@ void PrintObjectSupportMaterial::generate_toolpaths(
 
     // Now modulate the support layer height in parallel.
     tbb::parallel_for(tbb::blocked_range<size_t>(n_raft_layers, object.support_layers().size()),
-        [this, &object, &layer_caches]
+        [this, &object, &layer_caches, &toolpaths_cached, &toolpaths_generated]
             (const tbb::blocked_range<size_t>& range) {
         for (size_t support_layer_id = range.begin(); support_layer_id < range.end(); ++ support_layer_id) {
             SupportLayer &support_layer = *object.support_layers()[support_layer_id];
+            if (! toolpaths_cached.empty() && toolpaths_cached[support_layer_id] != nullptr) {
+                const PrintObjectSupportMaterialCache::Toolpaths &cached = *toolpaths_cached[support_layer_id];
+                support_layer.support_fills              = cached.fills;
+                support_layer.support_islands.expolygons = cached.islands;
+                continue;
+            }
             LayerCache   &layer_cache   = layer_caches[support_layer_id];
             for (LayerCacheItem &layer_cache_item : layer_cache.overlaps) {
                 modulate_extrusion_by_overlapping_layers(layer_cache_item.layer_extruded->extrusions, *layer_cache_item.layer_extruded->layer, layer_cache_item.overlapping);
                 support_layer.support_fills.append(std::move(layer_cache_item.layer_extruded->extrusions));
             }
+            if (! toolpaths_generated.empty()) {
+                toolpaths_generated[support_layer_id].fills   = support_layer.support_fills;
+                toolpaths_generated[support_layer_id].islands = support_layer.support_islands.expolygons;
+            }
         }
     });
+
+    if (cache != nullptr) {
+        // Keep the extrusions of this run only.
+        std::unordered_map<std::string, PrintObjectSupportMaterialCache::Toolpaths> toolpaths;
+        toolpaths.reserve(object.support_layers().size() - n_raft_layers);
+        for (size_t support_layer_id = n_raft_layers; support_layer_id < object.support_layers().size(); ++ support_layer_id)
+            if (PrintObjectSupportMaterialCache::Toolpaths *cached = toolpaths_cached[support_layer_id]; cached != nullptr) {
+                toolpaths.emplace(std::move(toolpaths_keys[support_layer_id]), std::move(*cached));
+                ++ cache->toolpaths_reused;
+            } else {
+                toolpaths.emplace(std::move(toolpaths_keys[support_layer_id]), std::move(toolpaths_generated[support_layer_id]));
+                ++ cache->toolpaths_generated;
+            }
+        cache->m_toolpaths = std::move(toolpaths);
+    }
 }
 
 /*
@@ -1,6 +1,10 @@
 #ifndef slic3r_SupportMaterial_hpp_
 #define slic3r_SupportMaterial_hpp_
 
+#include <string>
+#include <unordered_map>
+
+#include "ExtrusionEntityCollection.hpp"
 #include "Flow.hpp"
 #include "PrintConfig.hpp"
 #include "Slicing.hpp"
@@ -10,6 +14,7 @@ namespace Slic3r {
 class PrintObject;
 class PrintConfig;
 class PrintObjectConfig;
+class PrintObjectSupportMaterialCache;
 
 // how much we extend support around the actual contact area
 //FIXME this should be dependent on the nozzle diameter!
@@ -160,20 +165,33 @@ public:
 	// Generate support material for the object.
 	// New support layers will be added to the object,
 	// with extrusion paths and islands filled in for each support layer.
-	void 		generate(PrintObject &object);
+	// If a cache is provided, the contact layers and the support areas of the object layers with unchanged inputs
+	// and the extrusions of the support layers with unchanged inputs are reused from the previous run
+	// and the cache is updated with the newly generated ones.
+	void 		generate(PrintObject &object, PrintObjectSupportMaterialCache *cache = nullptr);
+
+	// Number of object layers, for which bottom_contact_layers_and_layer_support_areas() prepares the inputs
+	// of the projection sweep and extracts the bottom contacts and support areas at once.
+	// With a single layer the layers are processed one after the other, the tests compare the supports against this order.
+	static int 	sweep_block_size;
 
 private:
+	// Serialized configuration and parameters the support generator depends on.
+	std::string config_key() const;
+
 	// Generate top contact layers supporting overhangs.
 	// For a soluble interface material synchronize the layer heights with the object, otherwise leave the layer height undefined.
 	// If supports over bed surface only are requested, don't generate contact layers over an object.
-	MyLayersPtr top_contact_layers(const PrintObject &object, MyLayerStorage &layer_storage) const;
+	MyLayersPtr top_contact_layers(const PrintObject &object, MyLayerStorage &layer_storage,
+		PrintObjectSupportMaterialCache *cache) const;
 
 	// Generate bottom contact layers supporting the top contact layers.
 	// For a soluble interface material synchronize the layer heights with the object, 
 	// otherwise set the layer height to a bridging flow of a support interface nozzle.
 	MyLayersPtr bottom_contact_layers_and_layer_support_areas(
 		const PrintObject &object, const MyLayersPtr &top_contacts, MyLayerStorage &layer_storage,
-		std::vector<Polygons> &layer_support_areas) const;
+		std::vector<Polygons> &layer_support_areas,
+		PrintObjectSupportMaterialCache *cache) const;
 
 	// Trim the top_contacts layers with the bottom_contacts layers if they overlap, so there would not be enough vertical space for both of them.
 	void trim_top_contacts_by_bottom_contacts(const PrintObject &object, const MyLayersPtr &bottom_contacts, MyLayersPtr &top_contacts) const;
@@ -229,7 +247,8 @@ private:
         const MyLayersPtr   &bottom_contacts,
         const MyLayersPtr   &top_contacts,
         const MyLayersPtr   &intermediate_layers,
-        const MyLayersPtr   &interface_layers) const;
+        const MyLayersPtr   &interface_layers,
+        PrintObjectSupportMaterialCache *cache) const;
 
 	// Following objects are not owned by SupportMaterial class.
 	const PrintObject 		*m_object;
@@ -251,6 +270,97 @@ private:
 	coordf_t			 m_gap_xy;
 };
 
+// Intermediate results of the support generator kept by a PrintObject between the invalidations of its supports.
+// The inputs of each cached result are stored serialized next to it and a result is only reused if its inputs are
+// equal to the current ones, thus a reused result is the same as a result generated from scratch.
+// The dependencies are tracked per object layer and per support layer:
+//  - The top contacts of an object layer depend on the layer, the layer below, the support enforcers and blockers
+//    sliced at the layer and the area covering the print bed.
+//  - The support area and the bottom contacts of an object layer depend on the layer, the layer above, the support
+//    areas projected from above and the print_z of the top contacts a bottom contact may snap to.
+//  - The extrusions of a support layer depend on the support layers overlapping its print_z range.
+// After a localized change, for example a painted support enforcer or a modifier of a single layer range,
+// only the contacts and support areas of the changed object layers and the layers below them, which the changed
+// projection reaches, are generated again, and only the support layers of changed polygons are extruded again.
+// The intermediate, base, interface and raft layers are still generated from the contacts on each run.
+// The cache holds the results of the last run only. It is dropped if the support configuration changes,
+// if the supports are disabled and if its size exceeds max_memsize at the end of a run.
+class PrintObjectSupportMaterialCache
+{
+public:
+	void 		clear();
+	// Estimate of the memory allocated by the cached results and their inputs, in bytes.
+	size_t 		memsize() const;
+
+	// The cache is not kept if it would hold more than this at the end of PrintObjectSupportMaterial::generate().
+	size_t 		max_memsize 			{ size_t(128) << 20 };
+
+	// Number of object layers, for which the top contacts resp. the support areas were reused
+	// by the last PrintObjectSupportMaterial::generate() call.
+	size_t 		top_contacts_reused 	{ 0 };
+	size_t 		top_contacts_generated 	{ 0 };
+	size_t 		support_areas_reused 	{ 0 };
+	size_t 		support_areas_generated { 0 };
+	// Number of support layers, for which the extrusions were reused by the last PrintObjectSupportMaterial::generate() call.
+	size_t 		toolpaths_reused 		{ 0 };
+	size_t 		toolpaths_generated 	{ 0 };
+	// Number of object layers, which changed since the previous run.
+	size_t 		layers_changed 			{ 0 };
+
+private:
+	friend class PrintObjectSupportMaterial;
+	using MyLayer = PrintObjectSupportMaterial::MyLayer;
+
+	// Release the cached results, keep the counters of the last run.
+	void 		clear_results();
+	void 		reset_counters();
+	// Store the serialized object layers of this run, invalidate the results depending on the changed ones.
+	void 		update_layer_keys(std::vector<std::string> &&layer_keys);
+
+	// Contact layers generated for a single object layer, before the close contact layers are merged.
+	struct TopContacts
+	{
+		bool 					 valid 		 { false };
+		// Serialized support enforcers, blockers and print bed coverage of the layer.
+		std::string 			 inputs;
+		// Contact layer printed with a normal flow and the one below a bridging flow, either may be missing.
+		std::unique_ptr<MyLayer> layers[2];
+	};
+
+	// State of the top to bottom projection of the contact areas at a single object layer.
+	struct SupportArea
+	{
+		bool 					 valid 		 { false };
+		// Serialized projection from above and the print_z of the top contacts a bottom contact may snap to.
+		std::string 			 inputs;
+		// Projection of the contact areas continuing below this layer.
+		Polygons 				 projection;
+		// Support area of this layer, before it is trimmed by the bottom contacts below.
+		Polygons 				 support_area;
+		// Bottom contact layer placed over the top surfaces of this layer and the area it trims from the support areas above.
+		std::unique_ptr<MyLayer> bottom_contact;
+		Polygons 				 touching;
+	};
+
+	// Extrusions of a single support layer.
+	struct Toolpaths
+	{
+		ExtrusionEntityCollection fills;
+		ExPolygons 				  islands;
+	};
+
+	// Serialized configuration of the last run, see PrintObjectSupportMaterial::config_key(). All the results are dropped if it changes.
+	std::string 				m_config_key;
+	// Serialized object layers of the last run. The results depending on a layer are invalidated once it changes,
+	// therefore the valid results were generated from the layers as stored here.
+	std::vector<std::string> 	m_layer_keys;
+	// Indexed by the object layer.
+	std::vector<TopContacts> 	m_top_contacts;
+	std::vector<SupportArea> 	m_support_areas;
+	// Indexed by the serialized support layers overlapping a support layer, which include its print_z.
+	std::unordered_map<std::string, Toolpaths> m_toolpaths;
+};
+
 } // namespace Slic3r
 
 #endif /* slic3r_SupportMaterial_hpp_ */
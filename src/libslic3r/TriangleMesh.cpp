@@ -14,12 +14,14 @@
 #include <map>
 #include <utility>
 #include <algorithm>
+#include <limits>
 #include <math.h>
 #include <type_traits>
 
 #include <boost/log/trivial.hpp>
 
 #include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
 
 #include <Eigen/Core>
 #include <Eigen/Dense>
@@ -564,34 +566,119 @@ BoundingBoxf3 TriangleMesh::transformed_bounding_box(const Transform3d &trafo) c
     return bbox;
 }
 
+// Discard the points lying inside the convex hull of the points extreme in a set of directions (the Akl-Toussaint heuristic
+// generalized to 3D), as such points cannot be vertices of the convex hull. Returns the points to be passed to qhull.
+static std::vector<realT> convex_hull_3d_prefilter(std::vector<realT> &&pts)
+{
+    // Not worth the overhead for small point sets.
+    static constexpr const size_t min_points = 1024;
+    const size_t num_points = pts.size() / 3;
+    if (num_points < min_points)
+        return std::move(pts);
+
+    // Directions towards the faces, edges and corners of a cube.
+    std::vector<Vec3d> directions;
+    for (int i = -1; i <= 1; ++ i)
+        for (int j = -1; j <= 1; ++ j)
+            for (int k = -1; k <= 1; ++ k)
+                if (i != 0 || j != 0 || k != 0)
+                    directions.emplace_back(double(i), double(j), double(k));
+    auto point = [&pts](size_t idx) { return Vec3d(double(pts[idx * 3]), double(pts[idx * 3 + 1]), double(pts[idx * 3 + 2])); };
+
+    // Find the extreme point in each direction in parallel.
+    using Extremes = std::vector<std::pair<double, size_t>>;
+    Extremes extremes = tbb::parallel_reduce(tbb::blocked_range<size_t>(0, num_points), 
+        Extremes(directions.size(), std::make_pair(- std::numeric_limits<double>::max(), size_t(0))),
+        [&directions, &point](const tbb::blocked_range<size_t> &range, Extremes extremes) {
+            for (size_t i = range.begin(); i < range.end(); ++ i) {
+                Vec3d p = point(i);
+                for (size_t j = 0; j < directions.size(); ++ j)
+                    if (double d = directions[j].dot(p); d > extremes[j].first)
+                        extremes[j] = std::make_pair(d, i);
+            }
+            return extremes;
+        },
+        [](Extremes a, const Extremes &b) {
+            for (size_t j = 0; j < a.size(); ++ j)
+                if (b[j].first > a[j].first || (b[j].first == a[j].first && b[j].second < a[j].second))
+                    a[j] = b[j];
+            return a;
+        });
+
+    std::vector<size_t> extreme_ids;
+    for (const std::pair<double, size_t> &e : extremes)
+        extreme_ids.emplace_back(e.second);
+    sort_remove_duplicates(extreme_ids);
+    if (extreme_ids.size() < 4)
+        return std::move(pts);
+
+    // Hull of the extreme points, its inside points are discarded.
+    std::vector<realT> extreme_pts;
+    BoundingBoxf3 bbox;
+    for (size_t id : extreme_ids) {
+        for (int i = 0; i < 3; ++ i)
+            extreme_pts.emplace_back(pts[id * 3 + i]);
+        bbox.merge(point(id));
+    }
+    std::vector<std::pair<Vec3d, double>> planes;
+    try {
+        orgQhull::Qhull qhull;
+        qhull.disableOutputStream();
+        qhull.runQhull("", 3, int(extreme_ids.size()), extreme_pts.data(), "Qt");
+        for (const orgQhull::QhullFacet &facet : qhull.facetList().toStdVector()) {
+            orgQhull::QhullHyperplane plane = facet.hyperplane();
+            planes.emplace_back(Vec3d(plane.coordinates()[0], plane.coordinates()[1], plane.coordinates()[2]), plane.offset());
+        }
+    } catch (...) {
+        // Degenerate, for example planar set of extreme points.
+        return std::move(pts);
+    }
+
+    // Keep the points on the hull of the extreme points and the points slightly inside it, to stay on the safe side.
+    const double eps = 1e-5 * bbox.size().norm();
+    std::vector<char> keep(num_points, false);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_points), [&planes, &point, &keep, eps](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i) {
+            Vec3d p = point(i);
+            keep[i] = std::any_of(planes.begin(), planes.end(), [&p, eps](const std::pair<Vec3d, double> &plane) { return plane.first.dot(p) + plane.second > - eps; });
+        }
+    });
+    size_t j = 0;
+    for (size_t i = 0; i < num_points; ++ i)
+        if (keep[i]) {
+            if (i != j)
+                std::copy(pts.begin() + i * 3, pts.begin() + i * 3 + 3, pts.begin() + j * 3);
+            ++ j;
+        }
+    pts.resize(j * 3);
+    return std::move(pts);
+}
+
 TriangleMesh TriangleMesh::convex_hull_3d() const
 {
+	std::vector<realT> src_vertices;
+	if (this->has_shared_vertices()) {
+		src_vertices.reserve(this->its.vertices.size() * 3);
+		// We will now fill the vector with input points for computation:
+		for (const stl_vertex &v : this->its.vertices)
+			for (int i = 0; i < 3; ++ i)
+				src_vertices.emplace_back(v(i));
+	} else {
+		src_vertices.reserve(this->stl.facet_start.size() * 9);
+		// We will now fill the vector with input points for computation:
+		for (const stl_facet &f : this->stl.facet_start)
+			for (int i = 0; i < 3; ++ i)
+				for (int j = 0; j < 3; ++ j)
+					src_vertices.emplace_back(f.vertex[i](j));
+	}
+	src_vertices = convex_hull_3d_prefilter(std::move(src_vertices));
+
     // The qhull call:
     orgQhull::Qhull qhull;
     qhull.disableOutputStream(); // we want qhull to be quiet
-	std::vector<realT> src_vertices;
 	try
     {
-    	if (this->has_shared_vertices()) {
-#if REALfloat
-	    	qhull.runQhull("", 3, (int)this->its.vertices.size(), (const realT*)(this->its.vertices.front().data()), "Qt");
-#else
-	    	src_vertices.reserve(this->its.vertices.size() * 3);
-	    	// We will now fill the vector with input points for computation:
-			for (const stl_vertex &v : this->its.vertices)
-				for (int i = 0; i < 3; ++ i)
-		        	src_vertices.emplace_back(v(i));
-	        qhull.runQhull("", 3, (int)src_vertices.size() / 3, src_vertices.data(), "Qt");
-#endif
-	    } else {
-	    	src_vertices.reserve(this->stl.facet_start.size() * 9);
-	    	// We will now fill the vector with input points for computation:
-			for (const stl_facet &f : this->stl.facet_start)
-				for (int i = 0; i < 3; ++ i)
-					for (int j = 0; j < 3; ++ j)
-		        		src_vertices.emplace_back(f.vertex[i](j));
-	        qhull.runQhull("", 3, (int)src_vertices.size() / 3, src_vertices.data(), "Qt");
-	    }
+        qhull.runQhull("", 3, (int)src_vertices.size() / 3, src_vertices.data(), "Qt");
     }
     catch (...)
     {
@@ -599,26 +686,49 @@ TriangleMesh TriangleMesh::convex_hull_3d() const
         return TriangleMesh();
     }
 
-    // Let's collect results:
-    Pointf3s dst_vertices;
-    std::vector<Vec3i> facets;
+    // Let's collect results into an indexed triangle set, sharing the vertices between the facets.
+    indexed_triangle_set its;
+    std::vector<int> map_point_to_vertex(src_vertices.size() / 3, -1);
     auto facet_list = qhull.facetList().toStdVector();
+    its.indices.reserve(facet_list.size());
     for (const orgQhull::QhullFacet& facet : facet_list)
     {   // iterate through facets
         orgQhull::QhullVertexSet vertices = facet.vertices();
+        stl_triangle_vertex_indices face;
         for (int i = 0; i < 3; ++i)
         {   // iterate through facet's vertices
-
             orgQhull::QhullPoint p = vertices[i].point();
-            const auto* coords = p.coordinates();
-            dst_vertices.emplace_back(coords[0], coords[1], coords[2]);
+            int &idx = map_point_to_vertex[p.id()];
+            if (idx == -1) {
+                const auto* coords = p.coordinates();
+                idx = int(its.vertices.size());
+                its.vertices.emplace_back(float(coords[0]), float(coords[1]), float(coords[2]));
+            }
+            face(i) = idx;
         }
-        unsigned int size = (unsigned int)dst_vertices.size();
-        facets.emplace_back(size - 3, size - 2, size - 1);
+        // Orient the face along the outer normal of the qhull facet.
+        const coordT *normal = facet.hyperplane().coordinates();
+        Vec3d n = (its.vertices[face(1)] - its.vertices[face(0)]).cast<double>().cross((its.vertices[face(2)] - its.vertices[face(0)]).cast<double>());
+        if (n.dot(Vec3d(normal[0], normal[1], normal[2])) < 0.)
+            std::swap(face(1), face(2));
+        its.indices.emplace_back(face);
     }
 
-    TriangleMesh output_mesh(dst_vertices, facets);
-    output_mesh.repair();
+    TriangleMesh output_mesh(its);
+    // The hull is a closed and consistently oriented manifold, thus only its face connectivity has to be established.
+    // Fall back to the full repair if the float conversion produced degenerate faces.
+    stl_check_facets_exact(&output_mesh.stl);
+    if (output_mesh.stl.stats.number_of_facets == its.indices.size() &&
+        output_mesh.stl.stats.connected_facets_3_edge == int(output_mesh.stl.stats.number_of_facets)) {
+        stl_calculate_volume(&output_mesh.stl);
+        if (output_mesh.stl.stats.facets_reversed > 0)
+            // Inside out hull was reversed by stl_calculate_volume(), reverse the indexed faces the same way.
+            for (stl_triangle_vertex_indices &face : its.indices)
+                std::swap(face(0), face(1));
+        output_mesh.its      = std::move(its);
+        output_mesh.repaired = true;
+    } else
+        output_mesh.repair();
     return output_mesh;
 }
 
@@ -682,15 +792,23 @@ void TriangleMesh::restore_optional()
 
 void TriangleMeshSlicer::init(const TriangleMesh *_mesh, throw_on_cancel_callback_type throw_on_cancel)
 {
-    mesh = _mesh;
-    if (! mesh->has_shared_vertices())
+    if (! _mesh->has_shared_vertices())
         throw Slic3r::InvalidArgument("TriangleMeshSlicer was passed a mesh without shared vertices.");
+    assert(_mesh->its.indices.size() == _mesh->stl.stats.number_of_facets);
+    this->init(&_mesh->its, throw_on_cancel);
+    mesh = _mesh;
+}
+
+void TriangleMeshSlicer::init(const indexed_triangle_set *_its, throw_on_cancel_callback_type throw_on_cancel)
+{
+    mesh = nullptr;
+    its  = _its;
 
     throw_on_cancel();
-    facets_edges.assign(_mesh->stl.stats.number_of_facets * 3, -1);
-	v_scaled_shared.assign(_mesh->its.vertices.size(), stl_vertex());
+    facets_edges.assign(_its->indices.size() * 3, -1);
+	v_scaled_shared.assign(_its->vertices.size(), stl_vertex());
 	for (size_t i = 0; i < v_scaled_shared.size(); ++ i)
-        this->v_scaled_shared[i] = _mesh->its.vertices[i] / float(SCALING_FACTOR);
+        this->v_scaled_shared[i] = _its->vertices[i] / float(SCALING_FACTOR);
 
     // Create a mapping from triangle edge into face.
     struct EdgeToFace {
@@ -706,12 +824,12 @@ void TriangleMeshSlicer::init(const TriangleMesh *_mesh, throw_on_cancel_callbac
         bool operator<(const EdgeToFace &other) const { return vertex_low < other.vertex_low || (vertex_low == other.vertex_low && vertex_high < other.vertex_high); }
     };
     std::vector<EdgeToFace> edges_map;
-    edges_map.assign(this->mesh->stl.stats.number_of_facets * 3, EdgeToFace());
-    for (uint32_t facet_idx = 0; facet_idx < this->mesh->stl.stats.number_of_facets; ++ facet_idx)
+    edges_map.assign(this->its->indices.size() * 3, EdgeToFace());
+    for (uint32_t facet_idx = 0; facet_idx < uint32_t(this->its->indices.size()); ++ facet_idx)
         for (int i = 0; i < 3; ++ i) {
             EdgeToFace &e2f = edges_map[facet_idx*3+i];
-            e2f.vertex_low  = this->mesh->its.indices[facet_idx][i];
-            e2f.vertex_high = this->mesh->its.indices[facet_idx][(i + 1) % 3];
+            e2f.vertex_low  = this->its->indices[facet_idx][i];
+            e2f.vertex_high = this->its->indices[facet_idx][(i + 1) % 3];
             e2f.face        = facet_idx;
             // 1 based indexing, to be always strictly positive.
             e2f.face_edge   = i + 1;
@@ -814,7 +932,7 @@ void TriangleMeshSlicer::slice(
     {
         boost::mutex lines_mutex;
         tbb::parallel_for(
-            tbb::blocked_range<int>(0,this->mesh->stl.stats.number_of_facets),
+            tbb::blocked_range<int>(0, int(this->its->indices.size())),
             [&lines, &lines_mutex, &z, throw_on_cancel, this](const tbb::blocked_range<int>& range) {
                 for (int facet_idx = range.begin(); facet_idx < range.end(); ++ facet_idx) {
                     if ((facet_idx & 0x0ffff) == 0)
@@ -908,7 +1026,16 @@ void TriangleMeshSlicer::slice(
 void TriangleMeshSlicer::_slice_do(size_t facet_idx, std::vector<IntersectionLines>* lines, boost::mutex* lines_mutex, 
     const std::vector<float> &z) const
 {
-    const stl_facet &facet = m_use_quaternion ? (this->mesh->stl.facet_start.data() + facet_idx)->rotated(m_quaternion) : *(this->mesh->stl.facet_start.data() + facet_idx);
+    // Compose the facet from the shared vertices. Only the sign of the Z component of the normal is used by slice_facet(),
+    // thus the normal does not need to be normalized.
+    const stl_triangle_vertex_indices &indices = this->its->indices[facet_idx];
+    stl_facet facet;
+    facet.vertex[0] = this->its->vertices[indices[0]];
+    facet.vertex[1] = this->its->vertices[indices[1]];
+    facet.vertex[2] = this->its->vertices[indices[2]];
+    stl_calculate_normal(facet.normal, &facet);
+    if (m_use_quaternion)
+        facet = facet.rotated(m_quaternion);
     
     // find facet extents
     const float min_z = fminf(facet.vertex[0](2), fminf(facet.vertex[1](2), facet.vertex[2](2)));
@@ -988,7 +1115,7 @@ TriangleMeshSlicer::FacetSliceType TriangleMeshSlicer::slice_facet(
     // Reorder vertices so that the first one is the one with lowest Z.
     // This is needed to get all intersection lines in a consistent order
     // (external on the right of the line)
-    const stl_triangle_vertex_indices &vertices = this->mesh->its.indices[facet_idx];
+    const stl_triangle_vertex_indices &vertices = this->its->indices[facet_idx];
     int i = (facet.vertex[1].z() == min_z) ? 1 : ((facet.vertex[2].z() == min_z) ? 2 : 0);
 
     // These are used only if the cut plane is tilted:
@@ -1812,6 +1939,8 @@ void TriangleMeshSlicer::cut(float z, TriangleMesh* upper, TriangleMesh* lower)
 {
     IntersectionLines upper_lines, lower_lines;
     
+    // The facets are taken from the stl_file of the source mesh.
+    assert(this->mesh != nullptr);
     BOOST_LOG_TRIVIAL(trace) << "TriangleMeshSlicer::cut - slicing object";
     float scaled_z = scale_(z);
     for (uint32_t facet_idx = 0; facet_idx < this->mesh->stl.stats.number_of_facets; ++ facet_idx) {
@@ -176,9 +176,13 @@ class TriangleMeshSlicer
 {
 public:
     typedef std::function<void()> throw_on_cancel_callback_type;
-    TriangleMeshSlicer() : mesh(nullptr) {}
+    TriangleMeshSlicer() : mesh(nullptr), its(nullptr) {}
 	TriangleMeshSlicer(const TriangleMesh* mesh) { this->init(mesh, [](){}); }
+	TriangleMeshSlicer(const indexed_triangle_set* its) { this->init(its, [](){}); }
     void init(const TriangleMesh *mesh, throw_on_cancel_callback_type throw_on_cancel);
+    // Slice an indexed triangle set directly, without the stl_file representation of a TriangleMesh.
+    // The facet normals are calculated on the fly. The cut() method is not available for a slicer initialized this way.
+    void init(const indexed_triangle_set *its, throw_on_cancel_callback_type throw_on_cancel);
     void slice(
         const std::vector<float> &z, SlicingMode mode, size_t alternate_mode_first_n_layers, SlicingMode alternate_mode,
         std::vector<Polygons>* layers, throw_on_cancel_callback_type throw_on_cancel) const;
@@ -201,10 +205,13 @@ public:
     void set_up_direction(const Vec3f& up);
     
 private:
+    // Source mesh, only needed by cut(). Null if the slicer was initialized with an indexed triangle set.
     const TriangleMesh      *mesh;
+    // Indexed triangle set to be sliced, either this->mesh->its or a standalone one.
+    const indexed_triangle_set *its;
     // Map from a facet to an edge index.
     std::vector<int>         facets_edges;
-    // Scaled copy of this->mesh->stl.v_shared
+    // Scaled copy of this->its->vertices
     std::vector<stl_vertex>  v_scaled_shared;
     // Quaternion that will be used to rotate every facet before the slicing
     Eigen::Quaternion<float, Eigen::DontAlign> m_quaternion;
@@ -1,5 +1,11 @@
 #include "TriangleSelector.hpp"
 #include "Model.hpp"
+#include "AABBTreeIndirect.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#include <tbb/parallel_for.h>
 
 
 namespace Slic3r {
@@ -50,29 +56,81 @@ void TriangleSelector::select_patch(const Vec3f& hit, int facet_start,
         m_old_cursor_radius = radius;
     }
 
+    uint32_t generation = next_visited_generation();
+    // A sphere cursor is bounded, only the facets intersecting its bounding box may be selected.
+    // Triangles crossing the cursor axis outside of the sphere are not traversed then.
+    bool bounded = m_cursor.type == SPHERE;
+    if (bounded)
+        mark_facets_in_cursor_bbox();
+
     // Now start with the facet the pointer points to and check all adjacent facets.
-    std::vector<int> facets_to_check{facet_start};
-    std::vector<bool> visited(m_orig_size_indices, false); // keep track of facets we already processed
+    m_facets_to_check.clear();
+    m_facets_to_check.emplace_back(facet_start);
     int facet_idx = 0; // index into facets_to_check
-    while (facet_idx < int(facets_to_check.size())) {
-        int facet = facets_to_check[facet_idx];
-        if (! visited[facet]) {
+    while (facet_idx < int(m_facets_to_check.size())) {
+        int facet = m_facets_to_check[facet_idx];
+        if (m_visited[facet] != generation) {
             if (select_triangle(facet, new_state)) {
                 // add neighboring facets to list to be proccessed later
                 for (int n=0; n<3; ++n) {
                     int neighbor_idx = m_mesh->stl.neighbors_start[facet].neighbor[n];
-                    if (neighbor_idx >=0 && (m_cursor.type == SPHERE || faces_camera(neighbor_idx)))
-                        facets_to_check.push_back(neighbor_idx);
+                    if (neighbor_idx >=0 && m_visited[neighbor_idx] != generation &&
+                        (! bounded || m_in_cursor_bbox[neighbor_idx] == generation) &&
+                        (m_cursor.type == SPHERE || faces_camera(neighbor_idx)))
+                        m_facets_to_check.push_back(neighbor_idx);
                 }
             }
         }
-        visited[facet] = true;
+        m_visited[facet] = generation;
         ++facet_idx;
     }
 }
 
 
 
+// Start a new select_patch() call, so that the facets marked by the previous calls are considered unmarked.
+uint32_t TriangleSelector::next_visited_generation()
+{
+    if (++ m_visited_generation == 0) {
+        // Wrapped around, clear the marks.
+        std::fill(m_visited.begin(), m_visited.end(), 0);
+        std::fill(m_in_cursor_bbox.begin(), m_in_cursor_bbox.end(), 0);
+        m_visited_generation = 1;
+    }
+    return m_visited_generation;
+}
+
+
+
+// Mark the original facets, whose bounding boxes intersect the bounding box of the current sphere cursor.
+void TriangleSelector::mark_facets_in_cursor_bbox()
+{
+    assert(m_cursor.type == SPHERE);
+    if (! m_aabb_tree)
+        m_aabb_tree = std::make_unique<AABBTreeIndirect::Tree3f>(
+            AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(m_mesh->its.vertices, m_mesh->its.indices));
+
+    float radius = std::sqrt(m_cursor.radius_sqr);
+    Vec3f center = m_cursor.center;
+    Vec3f half_size;
+    if (m_cursor.uniform_scaling)
+        half_size = Vec3f(radius, radius, radius);
+    else {
+        // The cursor is in world coords, its bounding box in mesh coords encloses the inverse image of the sphere, an ellipsoid.
+        Transform3f trafo_inv = m_cursor.trafo.inverse();
+        center = trafo_inv * center;
+        for (int i = 0; i < 3; ++ i)
+            half_size(i) = radius * trafo_inv.linear().row(i).norm();
+    }
+
+    m_cursor_bbox_facets.clear();
+    AABBTreeIndirect::get_candidate_idxs_in_box(*m_aabb_tree, AABBTreeIndirect::Tree3f::BoundingBox(center - half_size, center + half_size), m_cursor_bbox_facets);
+    for (size_t facet_idx : m_cursor_bbox_facets)
+        m_in_cursor_bbox[facet_idx] = m_visited_generation;
+}
+
+
+
 // Selects either the whole triangle (discarding any children it had), or divides
 // the triangle recursively, selecting just subtriangles truly inside the circle.
 // This is done by an actual recursive call. Returns false if the triangle is
@@ -414,6 +472,8 @@ TriangleSelector::TriangleSelector(const TriangleMesh& mesh)
     reset();
 }
 
+TriangleSelector::~TriangleSelector() = default;
+
 
 void TriangleSelector::reset()
 {
@@ -428,6 +488,9 @@ void TriangleSelector::reset()
     m_orig_size_vertices = m_vertices.size();
     m_orig_size_indices = m_triangles.size();
     m_invalid_triangles = 0;
+    m_visited.assign(m_orig_size_indices, 0);
+    m_in_cursor_bbox.assign(m_orig_size_indices, 0);
+    m_visited_generation = 0;
 }
 
 
@@ -541,73 +604,89 @@ indexed_triangle_set TriangleSelector::get_facets(EnforcerBlockerType state) con
 
 
 
-std::map<int, std::vector<bool>> TriangleSelector::serialize() const
+void TriangleSelector::serialize_recursive(int facet_idx, std::vector<bool> &data) const
+{
+    const Triangle& tr = m_triangles[facet_idx];
+
+    // Always save number of split sides. It is zero for unsplit triangles.
+    int split_sides = tr.number_of_split_sides();
+    assert(split_sides >= 0 && split_sides <= 3);
+
+    data.push_back(split_sides & 0b01);
+    data.push_back(split_sides & 0b10);
+
+    if (tr.is_split()) {
+        // If this triangle is split, save which side is split (in case
+        // of one split) or kept (in case of two splits). The value will
+        // be ignored for 3-side split.
+        assert(split_sides > 0);
+        assert(tr.special_side() >= 0 && tr.special_side() <= 3);
+        data.push_back(tr.special_side() & 0b01);
+        data.push_back(tr.special_side() & 0b10);
+        // Now save all children.
+        for (int child_idx=0; child_idx<=split_sides; ++child_idx)
+            serialize_recursive(tr.children[child_idx], data);
+    } else {
+        // In case this is leaf, we better save information about its state.
+        assert(int(tr.get_state()) <= 3);
+        data.push_back(int(tr.get_state()) & 0b01);
+        data.push_back(int(tr.get_state()) & 0b10);
+    }
+}
+
+TriangleSplittingData TriangleSelector::serialize() const
 {
     // Each original triangle of the mesh is assigned a number encoding its state
     // or how it is split. Each triangle is encoded by 4 bits (xxyy):
     // leaf triangle: xx = EnforcerBlockerType, yy = 0
     // non-leaf:      xx = special side, yy = number of split sides
-    // These are bitwise appended and formed into one 64-bit integer.
-
-    // The function returns a map from original triangle indices to
-    // stream of bits encoding state and offsprings.
-
-    std::map<int, std::vector<bool>> out;
-    for (int i=0; i<m_orig_size_indices; ++i) {
-        const Triangle& tr = m_triangles[i];
-
-        if (! tr.is_split() && tr.get_state() == EnforcerBlockerType::NONE)
-            continue; // no need to save anything, unsplit and unselected is default
-
-        std::vector<bool> data; // complete encoding of this mesh triangle
-        int stored_triangles = 0; // how many have been already encoded
-
-        std::function<void(int)> serialize_recursive;
-        serialize_recursive = [this, &serialize_recursive, &stored_triangles, &data](int facet_idx) {
-            const Triangle& tr = m_triangles[facet_idx];
-
-            // Always save number of split sides. It is zero for unsplit triangles.
-            int split_sides = tr.number_of_split_sides();
-            assert(split_sides >= 0 && split_sides <= 3);
-
-            //data |= (split_sides << (stored_triangles * 4));
-            data.push_back(split_sides & 0b01);
-            data.push_back(split_sides & 0b10);
-
-            if (tr.is_split()) {
-                // If this triangle is split, save which side is split (in case
-                // of one split) or kept (in case of two splits). The value will
-                // be ignored for 3-side split.
-                assert(split_sides > 0);
-                assert(tr.special_side() >= 0 && tr.special_side() <= 3);
-                data.push_back(tr.special_side() & 0b01);
-                data.push_back(tr.special_side() & 0b10);
-                ++stored_triangles;
-                // Now save all children.
-                for (int child_idx=0; child_idx<=split_sides; ++child_idx)
-                    serialize_recursive(tr.children[child_idx]);
-            } else {
-                // In case this is leaf, we better save information about its state.
-                assert(int(tr.get_state()) <= 3);
-                data.push_back(int(tr.get_state()) & 0b01);
-                data.push_back(int(tr.get_state()) & 0b10);
-                ++stored_triangles;
+    // The split trees of the painted triangles are appended one after another
+    // into a single bitstream, unpainted triangles are not stored at all.
+
+    // The split trees are independent, they are encoded in parallel into chunks,
+    // which are then concatenated in the order of the original triangles.
+    static constexpr int chunk_size = 4096;
+    std::vector<TriangleSplittingData> chunks((m_orig_size_indices + chunk_size - 1) / chunk_size);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, chunks.size()), [this, &chunks](const tbb::blocked_range<size_t> &range) {
+        for (size_t chunk_idx = range.begin(); chunk_idx < range.end(); ++ chunk_idx) {
+            TriangleSplittingData &chunk = chunks[chunk_idx];
+            int end = std::min(m_orig_size_indices, int(chunk_idx + 1) * chunk_size);
+            for (int i = int(chunk_idx) * chunk_size; i < end; ++ i) {
+                const Triangle& tr = m_triangles[i];
+                if (! tr.is_split() && tr.get_state() == EnforcerBlockerType::NONE)
+                    continue; // no need to save anything, unsplit and unselected is default
+                chunk.triangles_to_split.emplace_back(i, int(chunk.bitstream.size()));
+                serialize_recursive(i, chunk.bitstream);
             }
-        };
-
-        serialize_recursive(i);
-        out[i] = data;
+        }
+    });
+
+    TriangleSplittingData out;
+    size_t num_triangles = 0;
+    size_t num_bits      = 0;
+    for (const TriangleSplittingData &chunk : chunks) {
+        num_triangles += chunk.triangles_to_split.size();
+        num_bits      += chunk.bitstream.size();
+    }
+    out.triangles_to_split.reserve(num_triangles);
+    out.bitstream.reserve(num_bits);
+    for (const TriangleSplittingData &chunk : chunks) {
+        int offset = int(out.bitstream.size());
+        for (const std::pair<int, int> &triangle : chunk.triangles_to_split)
+            out.triangles_to_split.emplace_back(triangle.first, triangle.second + offset);
+        out.bitstream.insert(out.bitstream.end(), chunk.bitstream.begin(), chunk.bitstream.end());
     }
-
     return out;
 }
 
-void TriangleSelector::deserialize(const std::map<int, std::vector<bool>> data)
+void TriangleSelector::deserialize(const TriangleSplittingData &data)
 {
     reset(); // dump any current state
-    for (const auto& [triangle_id, code] : data) {
+    // Splitting pushes new vertices and triangles to the shared lists,
+    // thus the split trees are restored sequentially.
+    for (const auto& [triangle_id, ibit] : data.triangles_to_split) {
         assert(triangle_id < int(m_triangles.size()));
-        assert(! code.empty());
+        assert(ibit < int(data.bitstream.size()));
         int processed_triangles = 0;
         struct ProcessingInfo {
             int facet_id = 0;
@@ -623,7 +702,7 @@ void TriangleSelector::deserialize(const std::map<int, std::vector<bool>> data)
             int next_code = 0;
             for (int i=3; i>=0; --i) {
                 next_code = next_code << 1;
-                next_code |= int(code[4 * processed_triangles + i]);
+                next_code |= int(data.bitstream[ibit + 4 * processed_triangles + i]);
             }
             ++processed_triangles;
 
@@ -688,6 +767,151 @@ void TriangleSelector::deserialize(const std::map<int, std::vector<bool>> data)
 }
 
 
+std::pair<int, int> TriangleSplittingData::bit_range(int triangle_idx) const
+{
+    auto it = std::lower_bound(triangles_to_split.begin(), triangles_to_split.end(), triangle_idx,
+        [](const std::pair<int, int> &l, int r) { return l.first < r; });
+    if (it == triangles_to_split.end() || it->first != triangle_idx)
+        return { 0, 0 };
+    return { it->second, std::next(it) == triangles_to_split.end() ? int(bitstream.size()) : std::next(it)->second };
+}
+
+size_t TriangleSplittingData::tree_size(size_t bit_offset) const
+{
+    // Count the nodes of the tree until all children of all split nodes are consumed.
+    size_t num_bits = 0;
+    for (int num_pending = 1; num_pending > 0; -- num_pending) {
+        if (bit_offset + num_bits + 4 > bitstream.size())
+            // Truncated tree.
+            return 0;
+        int num_of_split_sides = int(bitstream[bit_offset + num_bits]) | (int(bitstream[bit_offset + num_bits + 1]) << 1);
+        if (num_of_split_sides != 0)
+            num_pending += num_of_split_sides + 1;
+        num_bits += 4;
+    }
+    return num_bits;
+}
+
+void TriangleSplittingData::sort()
+{
+    auto strictly_increasing = [this]() {
+        for (size_t i = 1; i < triangles_to_split.size(); ++ i)
+            if (triangles_to_split[i - 1].first >= triangles_to_split[i].first)
+                return false;
+        return true;
+    };
+    if (strictly_increasing())
+        return;
+
+    // Bit ranges of the split trees in the order they were added.
+    std::vector<std::pair<int, int>> ranges(triangles_to_split.size());
+    for (size_t i = 0; i < triangles_to_split.size(); ++ i)
+        ranges[i] = { triangles_to_split[i].second, i + 1 == triangles_to_split.size() ? int(bitstream.size()) : triangles_to_split[i + 1].second };
+    std::vector<size_t> order(triangles_to_split.size());
+    for (size_t i = 0; i < order.size(); ++ i)
+        order[i] = i;
+    // Stable sort, so that the split tree added last is the last one of the same triangle.
+    std::stable_sort(order.begin(), order.end(), [this](size_t l, size_t r) { return triangles_to_split[l].first < triangles_to_split[r].first; });
+
+    TriangleSplittingData out;
+    out.triangles_to_split.reserve(order.size());
+    out.bitstream.reserve(bitstream.size());
+    for (size_t i = 0; i < order.size(); ++ i) {
+        if (i + 1 < order.size() && triangles_to_split[order[i]].first == triangles_to_split[order[i + 1]].first)
+            continue;
+        out.triangles_to_split.emplace_back(triangles_to_split[order[i]].first, int(out.bitstream.size()));
+        const std::pair<int, int> &range = ranges[order[i]];
+        out.bitstream.insert(out.bitstream.end(), bitstream.begin() + range.first, bitstream.begin() + range.second);
+    }
+    *this = std::move(out);
+}
+
+void TriangleSplittingData::write_compact(std::string &out) const
+{
+    auto write_varint = [&out](uint64_t value) {
+        for (; value >= 0x80; value >>= 7)
+            out.push_back(char(uint8_t(value) | 0x80));
+        out.push_back(char(value));
+    };
+    assert(std::is_sorted(triangles_to_split.begin(), triangles_to_split.end()));
+    write_varint(triangles_to_split.size());
+    for (size_t i = 0; i < triangles_to_split.size(); ++ i)
+        write_varint(uint64_t(triangles_to_split[i].first - (i == 0 ? 0 : triangles_to_split[i - 1].first)));
+    write_varint(bitstream.size());
+    out.reserve(out.size() + (bitstream.size() + 7) / 8);
+    auto it_bit = bitstream.begin();
+    for (size_t num_bits = bitstream.size(); num_bits > 0;) {
+        size_t  n    = std::min<size_t>(num_bits, 8);
+        uint8_t byte = 0;
+        for (size_t i = 0; i < n; ++ i, ++ it_bit)
+            byte |= uint8_t(*it_bit) << i;
+        out.push_back(char(byte));
+        num_bits -= n;
+    }
+}
+
+bool TriangleSplittingData::read_compact(const char *begin, const char *end)
+{
+    this->clear();
+    bool ok = true;
+    auto read_varint = [&begin, end, &ok]() {
+        uint64_t value = 0;
+        for (int shift = 0; ok; shift += 7) {
+            if (begin == end || shift > 56) {
+                ok = false;
+                break;
+            }
+            uint8_t byte = uint8_t(*begin ++);
+            value |= uint64_t(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0)
+                break;
+        }
+        return value;
+    };
+    const uint64_t num_triangles = read_varint();
+    if (! ok || num_triangles > uint64_t(end - begin))
+        // Each triangle takes at least one byte.
+        return false;
+    std::vector<int> triangles;
+    triangles.reserve(size_t(num_triangles));
+    for (uint64_t i = 0; ok && i < num_triangles; ++ i) {
+        uint64_t delta = read_varint();
+        // The first index may be zero, the following ones are strictly increasing.
+        int64_t  idx   = (triangles.empty() ? 0 : int64_t(triangles.back())) + int64_t(delta);
+        if ((! triangles.empty() && delta == 0) || idx > std::numeric_limits<int>::max())
+            ok = false;
+        triangles.emplace_back(int(idx));
+    }
+    const uint64_t num_bits = read_varint();
+    if (! ok || (num_bits + 7) / 8 != uint64_t(end - begin))
+        return false;
+    bitstream.assign(size_t(num_bits), false);
+    auto it_bit = bitstream.begin();
+    for (size_t i = 0; i < bitstream.size(); i += 8) {
+        uint8_t byte = uint8_t(begin[i / 8]);
+        for (size_t j = 0; j < 8 && i + j < bitstream.size(); ++ j, ++ it_bit)
+            *it_bit = (byte >> j) & 1;
+    }
+    // Recover the bit offsets by walking the split trees.
+    triangles_to_split.reserve(triangles.size());
+    size_t offset = 0;
+    for (int idx : triangles) {
+        size_t size = this->tree_size(offset);
+        if (size == 0) {
+            this->clear();
+            return false;
+        }
+        triangles_to_split.emplace_back(idx, int(offset));
+        offset += size;
+    }
+    if (offset != bitstream.size()) {
+        this->clear();
+        return false;
+    }
+    return true;
+}
+
+
 TriangleSelector::Cursor::Cursor(
         const Vec3f& center_, const Vec3f& source_, float radius_world,
         CursorType type_, const Transform3d& trafo_)
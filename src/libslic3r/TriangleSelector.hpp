@@ -6,11 +6,18 @@
 
 #include "Point.hpp"
 #include "TriangleMesh.hpp"
+#include "TriangleSplittingData.hpp"
+
+#include <memory>
 
 namespace Slic3r {
 
 enum class EnforcerBlockerType : int8_t;
 
+namespace AABBTreeIndirect {
+    template<int ANumDimensions, typename ACoordType> class Tree;
+}
+
 
 
 // Following class holds information about selected triangles. It also has power
@@ -24,9 +31,13 @@ public:
 
     void set_edge_limit(float edge_limit);
 
+    // Split trees of all painted triangles of the mesh, stored contiguously.
+    using TriangleSplittingData = Slic3r::TriangleSplittingData;
+
     // Create new object on a TriangleMesh. The referenced mesh must
     // stay valid, a ptr to it is saved and used.
     explicit TriangleSelector(const TriangleMesh& mesh);
+    ~TriangleSelector();
 
     // Select all triangles fully inside the circle, subdivide where needed.
     void select_patch(const Vec3f& hit,    // point where to start
@@ -50,11 +61,11 @@ public:
     void garbage_collect();
 
     // Store the division trees in compact form (a long stream of
-    // bits for each triangle of the original mesh).
-    std::map<int, std::vector<bool>> serialize() const;
+    // bits for all painted triangles of the original mesh).
+    TriangleSplittingData serialize() const;
 
     // Load serialized data. Assumes that correct mesh is loaded.
-    void deserialize(const std::map<int, std::vector<bool>> data);
+    void deserialize(const TriangleSplittingData &data);
 
 
 protected:
@@ -148,9 +159,23 @@ protected:
     Cursor m_cursor;
     float m_old_cursor_radius;
 
+    // Original triangles visited by the last select_patch() call are marked with the current generation,
+    // so that the marks do not need to be cleared for each brush stroke.
+    std::vector<uint32_t> m_visited;
+    // Original triangles intersecting the bounding box of a sphere cursor, marked with the current generation.
+    std::vector<uint32_t> m_in_cursor_bbox;
+    uint32_t m_visited_generation = 0;
+    // Work buffers of select_patch(), kept to reuse their memory.
+    std::vector<int> m_facets_to_check;
+    std::vector<size_t> m_cursor_bbox_facets;
+    // AABB tree over the original triangles, built on the first use of a sphere cursor.
+    std::unique_ptr<AABBTreeIndirect::Tree<3, float>> m_aabb_tree;
+
     // Private functions:
     bool select_triangle(int facet_idx, EnforcerBlockerType type,
                          bool recursive_call = false);
+    uint32_t next_visited_generation();
+    void mark_facets_in_cursor_bbox();
     int  vertices_inside(int facet_idx) const;
     bool faces_camera(int facet) const;
     void undivide_triangle(int facet_idx);
@@ -160,6 +185,7 @@ protected:
     bool is_edge_inside_cursor(int facet_idx) const;
     void push_triangle(int a, int b, int c);
     void perform_split(int facet_idx, EnforcerBlockerType old_state);
+    void serialize_recursive(int facet_idx, std::vector<bool> &data) const;
 };
 
 
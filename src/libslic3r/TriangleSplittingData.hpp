@@ -0,0 +1,80 @@
+#ifndef libslic3r_TriangleSplittingData_hpp_
+#define libslic3r_TriangleSplittingData_hpp_
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Slic3r {
+
+// Split trees of all painted triangles of a mesh, stored contiguously.
+// Produced by TriangleSelector::serialize() and stored by FacetsAnnotation of a ModelVolume.
+// Kept apart from TriangleSelector.hpp, so that Model.hpp does not need to include the TriangleSelector.
+struct TriangleSplittingData {
+    // Indices of the painted original triangles in increasing order, each paired
+    // with the offset of its split tree in the bitstream.
+    std::vector<std::pair<int, int>> triangles_to_split;
+    // Split trees of the painted triangles one after another, 4 bits per node, depth first.
+    std::vector<bool>                bitstream;
+
+    bool operator==(const TriangleSplittingData &rhs) const { return triangles_to_split == rhs.triangles_to_split && bitstream == rhs.bitstream; }
+    bool operator!=(const TriangleSplittingData &rhs) const { return ! (*this == rhs); }
+
+    bool empty() const { return triangles_to_split.empty(); }
+    void clear() { triangles_to_split.clear(); bitstream.clear(); }
+    void shrink_to_fit() { triangles_to_split.shrink_to_fit(); bitstream.shrink_to_fit(); }
+
+    // Range of bits [first, second) encoding the split tree of an original triangle, an empty range if it is not painted.
+    // Requires triangles_to_split to be sorted, see sort().
+    std::pair<int, int> bit_range(int triangle_idx) const;
+    // Number of bits encoding the split tree starting at the given bit offset.
+    // Returns zero if the tree is truncated by the end of the bitstream.
+    size_t tree_size(size_t bit_offset) const;
+    // Sort triangles_to_split by the triangle indices, moving their split trees in the bitstream accordingly.
+    // Split trees are expected to be appended in the order of triangles_to_split. If a triangle was added
+    // more than once, the split tree added last is kept.
+    void sort();
+
+    // Compact binary form stored into 3MF: the triangle indices as deltas in variable length
+    // encoding, followed by the bitstream packed into bytes. Appended to out.
+    void write_compact(std::string &out) const;
+    // Read the compact binary form written by write_compact(). Returns false if the data is damaged.
+    bool read_compact(const char *begin, const char *end);
+
+    // Undo / redo snapshots store the triangle indices as deltas and the bitstream packed into 64 bit words.
+    template<class Archive> void save(Archive &ar) const {
+        std::vector<int>      deltas(triangles_to_split.size());
+        for (size_t i = 0; i < deltas.size(); ++ i)
+            deltas[i] = triangles_to_split[i].first - (i == 0 ? 0 : triangles_to_split[i - 1].first);
+        std::vector<uint64_t> words((bitstream.size() + 63) / 64, 0);
+        for (size_t i = 0; i < bitstream.size(); ++ i)
+            if (bitstream[i])
+                words[i / 64] |= uint64_t(1) << (i % 64);
+        ar(deltas, uint64_t(bitstream.size()), words);
+    }
+    template<class Archive> void load(Archive &ar) {
+        std::vector<int>      deltas;
+        uint64_t              num_bits;
+        std::vector<uint64_t> words;
+        ar(deltas, num_bits, words);
+        bitstream.assign(size_t(num_bits), false);
+        for (size_t i = 0; i < bitstream.size(); ++ i)
+            bitstream[i] = (words[i / 64] >> (i % 64)) & 1;
+        // The bit offsets are not stored, they are recovered by walking the split trees.
+        triangles_to_split.clear();
+        triangles_to_split.reserve(deltas.size());
+        size_t offset = 0;
+        for (int delta : deltas) {
+            triangles_to_split.emplace_back((triangles_to_split.empty() ? 0 : triangles_to_split.back().first) + delta, int(offset));
+            offset += this->tree_size(offset);
+        }
+        assert(offset == bitstream.size());
+    }
+};
+
+} // namespace Slic3r
+
+#endif // libslic3r_TriangleSplittingData_hpp_
@@ -1630,6 +1630,59 @@ void _3DScene::extrusionentity_to_verts(const ExtrusionEntity *extrusion_entity,
     }
 }
 
+// Number of lines of the polyline after its duplicate points are removed.
+static size_t num_lines_without_duplicate_points(const Polyline &polyline)
+{
+    size_t num_lines = 0;
+    for (size_t i = 1; i < polyline.points.size(); ++ i)
+        if (polyline.points[i] != polyline.points[i - 1])
+            ++ num_lines;
+    return num_lines;
+}
+
+// Upper bound of the size of the geometry generated by thick_lines_to_indexed_vertex_array() for num_lines lines
+// coming from num_paths paths of possibly different heights.
+static GLIndexedVertexArray::Capacity thick_lines_capacity(size_t num_lines, size_t num_paths, bool closed)
+{
+    GLIndexedVertexArray::Capacity capacity;
+    if (num_lines == 0)
+        return capacity;
+    // Changes of the layer thickness, the first segment of a closed loop is capped as well.
+    size_t num_height_changes = num_paths + 1;
+    // 8 vertices for the first line, up to 6 vertices for the next ones, up to 3 vertices to close a loop.
+    capacity.vertices_and_normals_interleaved = 6 * (6 * num_lines + 2 + num_height_changes + (closed ? 3 : 0));
+    // 4 faces per line, the end caps of open paths and the caps at the changes of the layer thickness.
+    capacity.quad_indices = 4 * (4 * num_lines + 2 + 2 * num_height_changes + (closed ? 1 : 0));
+    // The wedges at the sharp turns.
+    capacity.triangle_indices = 3 * 2 * (num_lines + (closed ? 1 : 0));
+    return capacity;
+}
+
+GLIndexedVertexArray::Capacity _3DScene::extrusionentity_to_verts_capacity(const ExtrusionEntity *extrusion_entity)
+{
+    GLIndexedVertexArray::Capacity capacity;
+    if (extrusion_entity != nullptr) {
+        if (auto *extrusion_path = dynamic_cast<const ExtrusionPath*>(extrusion_entity))
+            capacity = thick_lines_capacity(num_lines_without_duplicate_points(extrusion_path->polyline), 1, false);
+        else if (auto *extrusion_loop = dynamic_cast<const ExtrusionLoop*>(extrusion_entity)) {
+            size_t num_lines = 0;
+            for (const ExtrusionPath &extrusion_path : extrusion_loop->paths)
+                num_lines += num_lines_without_duplicate_points(extrusion_path.polyline);
+            capacity = thick_lines_capacity(num_lines, extrusion_loop->paths.size(), true);
+        } else if (auto *extrusion_multi_path = dynamic_cast<const ExtrusionMultiPath*>(extrusion_entity)) {
+            size_t num_lines = 0;
+            for (const ExtrusionPath &extrusion_path : extrusion_multi_path->paths)
+                num_lines += num_lines_without_duplicate_points(extrusion_path.polyline);
+            capacity = thick_lines_capacity(num_lines, extrusion_multi_path->paths.size(), false);
+        } else if (auto *extrusion_entity_collection = dynamic_cast<const ExtrusionEntityCollection*>(extrusion_entity)) {
+            for (const ExtrusionEntity *ee : extrusion_entity_collection->entities)
+                capacity += extrusionentity_to_verts_capacity(ee);
+        } else
+            throw Slic3r::RuntimeError("Unexpected extrusion_entity type in to_verts_capacity()");
+    }
+    return capacity;
+}
+
 void _3DScene::polyline3_to_verts(const Polyline3& polyline, double width, double height, GLVolume& volume)
 {
     Lines3 lines = polyline.lines();
@@ -135,6 +135,28 @@ public:
         this->quad_indices.reserve(sz * 4);
     }
 
+    // Number of floats and indices to be stored, used to allocate the buffers once before filling them.
+    struct Capacity {
+        size_t vertices_and_normals_interleaved{ 0 };
+        size_t triangle_indices{ 0 };
+        size_t quad_indices{ 0 };
+
+        bool empty() const { return vertices_and_normals_interleaved == 0; }
+        Capacity& operator+=(const Capacity &rhs) {
+            this->vertices_and_normals_interleaved += rhs.vertices_and_normals_interleaved;
+            this->triangle_indices                 += rhs.triangle_indices;
+            this->quad_indices                     += rhs.quad_indices;
+            return *this;
+        }
+        Capacity operator*(size_t n) const { return { this->vertices_and_normals_interleaved * n, this->triangle_indices * n, this->quad_indices * n }; }
+    };
+
+    inline void reserve(const Capacity &capacity) {
+        this->vertices_and_normals_interleaved.reserve(capacity.vertices_and_normals_interleaved);
+        this->triangle_indices.reserve(capacity.triangle_indices);
+        this->quad_indices.reserve(capacity.quad_indices);
+    }
+
     inline void push_geometry(float x, float y, float z, float nx, float ny, float nz) {
         assert(this->vertices_and_normals_interleaved_VBO_id == 0);
         if (this->vertices_and_normals_interleaved_VBO_id != 0)
@@ -166,7 +188,7 @@ public:
         if (this->vertices_and_normals_interleaved_VBO_id != 0)
             return;
 
-        if (this->triangle_indices.size() + 3 > this->vertices_and_normals_interleaved.capacity())
+        if (this->triangle_indices.size() + 3 > this->triangle_indices.capacity())
             this->triangle_indices.reserve(next_highest_power_of_2(this->triangle_indices.size() + 3));
         this->triangle_indices.emplace_back(idx1);
         this->triangle_indices.emplace_back(idx2);
@@ -179,7 +201,7 @@ public:
         if (this->vertices_and_normals_interleaved_VBO_id != 0)
             return;
 
-        if (this->quad_indices.size() + 4 > this->vertices_and_normals_interleaved.capacity())
+        if (this->quad_indices.size() + 4 > this->quad_indices.capacity())
             this->quad_indices.reserve(next_highest_power_of_2(this->quad_indices.size() + 4));
         this->quad_indices.emplace_back(idx1);
         this->quad_indices.emplace_back(idx2);
@@ -607,6 +629,8 @@ struct _3DScene
     static void extrusionentity_to_verts(const ExtrusionMultiPath& extrusion_multi_path, float print_z, const Point& copy, GLVolume& volume);
     static void extrusionentity_to_verts(const ExtrusionEntityCollection& extrusion_entity_collection, float print_z, const Point& copy, GLVolume& volume);
     static void extrusionentity_to_verts(const ExtrusionEntity* extrusion_entity, float print_z, const Point& copy, GLVolume& volume);
+    // Upper bound of the size of the geometry generated by extrusionentity_to_verts() for a single copy of extrusion_entity.
+    static GLIndexedVertexArray::Capacity extrusionentity_to_verts_capacity(const ExtrusionEntity* extrusion_entity);
     static void polyline3_to_verts(const Polyline3& polyline, double width, double height, GLVolume& volume);
     static void point3_to_verts(const Vec3crd& point, double width, double height, GLVolume& volume);
 };
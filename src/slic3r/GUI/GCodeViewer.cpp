@@ -25,6 +25,8 @@
 #include <wx/progdlg.h>
 #include <wx/numformatter.h>
 
+#include <tbb/parallel_for.h>
+
 #include <array>
 #include <algorithm>
 #include <chrono>
@@ -152,18 +154,18 @@ void GCodeViewer::TBuffer::reset()
     render_paths = std::vector<RenderPath>();
 }
 
-void GCodeViewer::TBuffer::add_path(const GCodeProcessor::MoveVertex& move, unsigned int b_id, size_t i_id, size_t s_id)
+GCodeViewer::Path GCodeViewer::make_path(const GCodeProcessor::MoveVertex& move, unsigned int b_id, size_t i_id, size_t s_id)
 {
     Path::Endpoint endpoint = { b_id, i_id, s_id, move.position };
     // use rounding to reduce the number of generated paths
 #if ENABLE_TOOLPATHS_WIDTH_HEIGHT_FROM_GCODE
-    paths.push_back({ move.type, move.extrusion_role, endpoint, endpoint, move.delta_extruder,
+    return { move.type, move.extrusion_role, endpoint, endpoint, move.delta_extruder,
         round_to_nearest(move.height, 2), round_to_nearest(move.width, 2), move.feedrate, move.fan_speed,
-        move.volumetric_rate(), move.extruder_id, move.cp_color_id });
+        move.volumetric_rate(), move.extruder_id, move.cp_color_id };
 #else
-    paths.push_back({ move.type, move.extrusion_role, endpoint, endpoint, move.delta_extruder,
+    return { move.type, move.extrusion_role, endpoint, endpoint, move.delta_extruder,
         round_to_nearest(move.height, 2), round_to_nearest(move.width, 2), move.feedrate, move.fan_speed,
-        round_to_nearest(move.volumetric_rate(), 2), move.extruder_id, move.cp_color_id });
+        round_to_nearest(move.volumetric_rate(), 2), move.extruder_id, move.cp_color_id };
 #endif // ENABLE_TOOLPATHS_WIDTH_HEIGHT_FROM_GCODE
 }
 
@@ -480,6 +482,8 @@ void GCodeViewer::reset()
     m_layers_z_range = { 0, 0 };
     m_roles = std::vector<ExtrusionRole>();
     m_time_statistics.reset();
+    m_lod.reset();
+    m_options_zs = std::vector<float>();
 
 #if ENABLE_GCODE_VIEWER_STATISTICS
     m_statistics.reset_all();
@@ -537,6 +541,10 @@ void GCodeViewer::render() const
     if (m_roles.empty())
         return;
 
+    // switch the level of detail of the toolpaths if the camera zoom changed
+    if (update_lod_level(select_lod_level()))
+        refresh_render_paths(true, true);
+
     glsafe(::glEnable(GL_DEPTH_TEST));
     render_toolpaths();
     if (m_sequential_view.current.last != m_sequential_view.endpoints.last) {
@@ -590,6 +598,7 @@ void GCodeViewer::update_sequential_view_current(unsigned int first, unsigned in
     m_sequential_view.current.last = new_last;
     m_sequential_view.last_current = m_sequential_view.current;
 
+    update_lod_level(select_lod_level());
     refresh_render_paths(true, true);
 
     if (new_first != first || new_last != last)
@@ -654,6 +663,7 @@ void GCodeViewer::set_layers_z_range(const std::array<unsigned int, 2>& layers_z
     bool keep_sequential_current_first = layers_z_range[0] >= m_layers_z_range[0];
     bool keep_sequential_current_last = layers_z_range[1] <= m_layers_z_range[1];
     m_layers_z_range = layers_z_range;
+    update_lod_level(select_lod_level());
     refresh_render_paths(keep_sequential_current_first, keep_sequential_current_last);
     wxGetApp().plater()->update_preview_moves_slider();
 }
@@ -666,6 +676,10 @@ void GCodeViewer::export_toolpaths_to_obj(const char* filename) const
     if (!has_data())
         return;
 
+    // export the full resolution toolpaths
+    if (update_lod_level(0))
+        refresh_render_paths(true, true);
+
     wxBusyCursor busy;
 
     // the data needed is contained into the Extrude TBuffer
@@ -961,34 +975,9 @@ void GCodeViewer::init()
     // initializes non opengl data of TBuffers
     for (size_t i = 0; i < m_buffers.size(); ++i) {
         TBuffer& buffer = m_buffers[i];
-        switch (buffer_type(i))
-        {
-        default: { break; }
-        case EMoveType::Tool_change:
-        case EMoveType::Color_change:
-        case EMoveType::Pause_Print:
-        case EMoveType::Custom_GCode:
-        case EMoveType::Retract:
-        case EMoveType::Unretract:
-        {
-            buffer.render_primitive_type = TBuffer::ERenderPrimitiveType::Point;
-            buffer.vertices.format = VBuffer::EFormat::Position;
-            break;
-        }
-        case EMoveType::Wipe:
-        case EMoveType::Extrude:
-        {
-            buffer.render_primitive_type = TBuffer::ERenderPrimitiveType::Triangle;
-            buffer.vertices.format = VBuffer::EFormat::PositionNormal3;
-            break;
-        }
-        case EMoveType::Travel:
-        {
-            buffer.render_primitive_type = TBuffer::ERenderPrimitiveType::Line;
-            buffer.vertices.format = VBuffer::EFormat::PositionNormal1;
-            break;
-        }
-        }
+        BufferLayout layout = buffer_layout(buffer_type(i));
+        buffer.render_primitive_type = layout.render_primitive_type;
+        buffer.vertices.format = layout.format;
     }
 
     set_toolpath_move_type_visible(EMoveType::Extrude, true);
@@ -997,614 +986,605 @@ void GCodeViewer::init()
     m_initialized = true;
 }
 
-void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
+GCodeViewer::BufferLayout GCodeViewer::buffer_layout(EMoveType type)
 {
-#if ENABLE_GCODE_VIEWER_STATISTICS
-    auto start_time = std::chrono::high_resolution_clock::now();
-    m_statistics.results_size = SLIC3R_STDVEC_MEMSIZE(gcode_result.moves, GCodeProcessor::MoveVertex);
-    m_statistics.results_time = gcode_result.time;
-#endif // ENABLE_GCODE_VIEWER_STATISTICS
-
-    // vertices data
-    m_moves_count = gcode_result.moves.size();
-    if (m_moves_count == 0)
-        return;
-
-    unsigned int progress_count = 0;
-    static const unsigned int progress_threshold = 1000;
-    wxProgressDialog* progress_dialog = wxGetApp().is_gcode_viewer() ?
-        new wxProgressDialog(_L("Generating toolpaths"), "...",
-            100, wxGetApp().plater(), wxPD_AUTO_HIDE | wxPD_APP_MODAL) : nullptr;
-
-    m_extruders_count = gcode_result.extruders_count;
-
-    for (size_t i = 0; i < m_moves_count; ++i) {
-        const GCodeProcessor::MoveVertex& move = gcode_result.moves[i];
-        if (wxGetApp().is_gcode_viewer())
-            // for the gcode viewer we need all moves to correctly size the printbed
-            m_paths_bounding_box.merge(move.position.cast<double>());
-        else {
-            if (move.type == EMoveType::Extrude && move.width != 0.0f && move.height != 0.0f)
-                m_paths_bounding_box.merge(move.position.cast<double>());
-        }
+    BufferLayout layout;
+    switch (type)
+    {
+    default: { break; }
+    case EMoveType::Tool_change:
+    case EMoveType::Color_change:
+    case EMoveType::Pause_Print:
+    case EMoveType::Custom_GCode:
+    case EMoveType::Retract:
+    case EMoveType::Unretract:
+    {
+        layout.render_primitive_type = TBuffer::ERenderPrimitiveType::Point;
+        layout.format = VBuffer::EFormat::Position;
+        break;
     }
+    case EMoveType::Wipe:
+    case EMoveType::Extrude:
+    {
+        layout.render_primitive_type = TBuffer::ERenderPrimitiveType::Triangle;
+        layout.format = VBuffer::EFormat::PositionNormal3;
+        break;
+    }
+    case EMoveType::Travel:
+    {
+        layout.render_primitive_type = TBuffer::ERenderPrimitiveType::Line;
+        layout.format = VBuffer::EFormat::PositionNormal1;
+        break;
+    }
+    }
+    return layout;
+}
 
-    // max bounding box (account for tool marker)
-    m_max_bounding_box = m_paths_bounding_box;
-    m_max_bounding_box.merge(m_paths_bounding_box.max + m_sequential_view.marker.get_bounding_box().size()[2] * Vec3d::UnitZ());
+void GCodeViewer::generate_toolpaths_chunk(const std::vector<GCodeProcessor::MoveVertex>& moves, const std::vector<size_t>& move_ids,
+    const std::vector<BufferLayout>& layouts, ToolpathsChunk& chunk)
+{
+    using Buffer = ToolpathsChunk::Buffer;
 
-    auto log_memory_usage = [this](const std::string& label, const std::vector<std::vector<float>>& vertices, const std::vector<MultiIndexBuffer>& indices) {
-        int64_t vertices_size = 0;
-        for (size_t i = 0; i < vertices.size(); ++i) {
-            vertices_size += SLIC3R_STDVEC_MEMSIZE(vertices[i], float);
-        }
-        int64_t indices_size = 0;
-        for (size_t i = 0; i < indices.size(); ++i) {
-            for (size_t j = 0; j < indices[i].size(); ++j) {
-                indices_size += SLIC3R_STDVEC_MEMSIZE(indices[i][j], unsigned int);
-            }
-        }
-        log_memory_used(label, vertices_size + indices_size);
+    // direction of the last segment of the current path, for each buffer rendered as solid
+    struct SolidState
+    {
+        Vec3f prev_dir{ Vec3f::Zero() };
+        Vec3f prev_up{ Vec3f::Zero() };
+        float prev_length{ 0.0f };
+    };
+
+    auto starts_new_path = [](const GCodeProcessor::MoveVertex& prev, const GCodeProcessor::MoveVertex& curr, const Buffer& buffer) {
+        // the chunk starts at a change of the move type, so the first move of each buffer in the chunk starts a new path
+        return buffer.paths.empty() || prev.type != curr.type || !buffer.paths.back().matches(curr);
     };
 
     // format data into the buffers to be rendered as points
-    auto add_vertices_as_point = [](const GCodeProcessor::MoveVertex& curr, std::vector<float>& buffer_vertices) {
+    auto add_as_point = [](const GCodeProcessor::MoveVertex& curr, Buffer& buffer, size_t move_id) {
+        buffer.paths.push_back(make_path(curr, 0, buffer.indices.size(), move_id));
+        buffer.indices.push_back(static_cast<unsigned int>(buffer.vertices.size() / 3));
         for (int j = 0; j < 3; ++j) {
-            buffer_vertices.push_back(curr.position[j]);
+            buffer.vertices.push_back(curr.position[j]);
         }
     };
-    auto add_indices_as_point = [](const GCodeProcessor::MoveVertex& curr, TBuffer& buffer,
-        unsigned int index_buffer_id, IndexBuffer& buffer_indices, size_t move_id) {
-            buffer.add_path(curr, index_buffer_id, buffer_indices.size(), move_id);
-            buffer_indices.push_back(static_cast<unsigned int>(buffer_indices.size()));
-    };
 
     // format data into the buffers to be rendered as lines
-    auto add_vertices_as_line = [](const GCodeProcessor::MoveVertex& prev, const GCodeProcessor::MoveVertex& curr,
-        TBuffer& buffer, std::vector<float>& buffer_vertices) {
-            // x component of the normal to the current segment (the normal is parallel to the XY plane)
-            float normal_x = (curr.position - prev.position).normalized()[1];
-
-            auto add_vertex = [&buffer_vertices, normal_x](const GCodeProcessor::MoveVertex& vertex) {
-                // add position
-                for (int j = 0; j < 3; ++j) {
-                    buffer_vertices.push_back(vertex.position[j]);
-                }
-                // add normal x component
-                buffer_vertices.push_back(normal_x);
-            };
-
-            // add previous vertex
-            add_vertex(prev);
-            // add current vertex
-            add_vertex(curr);
-    };
-    auto add_indices_as_line = [](const GCodeProcessor::MoveVertex& prev, const GCodeProcessor::MoveVertex& curr, TBuffer& buffer,
-        unsigned int index_buffer_id, IndexBuffer& buffer_indices, size_t move_id) {
-            // x component of the normal to the current segment (the normal is parallel to the XY plane)
-            float normal_x = (curr.position - prev.position).normalized()[1];
-
-            if (prev.type != curr.type || !buffer.paths.back().matches(curr)) {
-                // add starting index
-                buffer_indices.push_back(static_cast<unsigned int>(buffer_indices.size()));
-                buffer.add_path(curr, index_buffer_id, buffer_indices.size() - 1, move_id - 1);
-                buffer.paths.back().first.position = prev.position;
+    auto add_as_line = [starts_new_path](const GCodeProcessor::MoveVertex& prev, const GCodeProcessor::MoveVertex& curr, Buffer& buffer,
+        size_t prev_move_id, size_t move_id) {
+        // x component of the normal to the current segment (the normal is parallel to the XY plane)
+        float normal_x = (curr.position - prev.position).normalized()[1];
+
+        auto add_vertex = [&buffer, normal_x](const GCodeProcessor::MoveVertex& vertex) {
+            // add position
+            for (int j = 0; j < 3; ++j) {
+                buffer.vertices.push_back(vertex.position[j]);
             }
+            // add normal x component
+            buffer.vertices.push_back(normal_x);
+        };
 
-            Path& last_path = buffer.paths.back();
-            if (last_path.first.i_id != last_path.last.i_id) {
-                // add previous index
-                buffer_indices.push_back(static_cast<unsigned int>(buffer_indices.size()));
-            }
+        if (starts_new_path(prev, curr, buffer)) {
+            buffer.paths.push_back(make_path(curr, 0, buffer.indices.size(), prev_move_id));
+            buffer.paths.back().first.position = prev.position;
+        }
+
+        // add previous and current indices, each segment owns its two vertices
+        unsigned int starting_vertices_size = static_cast<unsigned int>(buffer.vertices.size() / 4);
+        buffer.indices.push_back(starting_vertices_size);
+        buffer.indices.push_back(starting_vertices_size + 1);
 
-            // add current index
-            buffer_indices.push_back(static_cast<unsigned int>(buffer_indices.size()));
-            last_path.last = { index_buffer_id, buffer_indices.size() - 1, move_id, curr.position };
+        // add previous vertex
+        add_vertex(prev);
+        // add current vertex
+        add_vertex(curr);
+
+        buffer.paths.back().last = { 0, buffer.indices.size() - 1, move_id, curr.position };
     };
 
     // format data into the buffers to be rendered as solid
-    auto add_vertices_as_solid = [](const GCodeProcessor::MoveVertex& prev, const GCodeProcessor::MoveVertex& curr, TBuffer& buffer,
-        std::vector<float>& buffer_vertices, size_t move_id) {
-            static Vec3f prev_dir;
-            static Vec3f prev_up;
-            static float prev_length;
-            auto store_vertex = [](std::vector<float>& buffer_vertices, const Vec3f& position, const Vec3f& normal) {
-                // append position
-                for (int j = 0; j < 3; ++j) {
-                    buffer_vertices.push_back(position[j]);
-                }
-                // append normal
-                for (int j = 0; j < 3; ++j) {
-                    buffer_vertices.push_back(normal[j]);
-                }
-            };
-            auto extract_position_at = [](const std::vector<float>& vertices, size_t id) {
-                return Vec3f(vertices[id + 0], vertices[id + 1], vertices[id + 2]);
-            };
-            auto update_position_at = [](std::vector<float>& vertices, size_t id, const Vec3f& position) {
-                vertices[id + 0] = position[0];
-                vertices[id + 1] = position[1];
-                vertices[id + 2] = position[2];
-            };
-
-            if (prev.type != curr.type || !buffer.paths.back().matches(curr)) {
-                buffer.add_path(curr, 0, 0, move_id - 1);
-                buffer.paths.back().first.position = prev.position;
+    auto add_as_solid = [starts_new_path](const GCodeProcessor::MoveVertex& prev, const GCodeProcessor::MoveVertex& curr, Buffer& buffer,
+        size_t vertex_size_floats, SolidState& state, size_t prev_move_id, size_t move_id) {
+        auto store_vertex = [](std::vector<float>& buffer_vertices, const Vec3f& position, const Vec3f& normal) {
+            // append position
+            for (int j = 0; j < 3; ++j) {
+                buffer_vertices.push_back(position[j]);
+            }
+            // append normal
+            for (int j = 0; j < 3; ++j) {
+                buffer_vertices.push_back(normal[j]);
             }
+        };
+        auto extract_position_at = [](const std::vector<float>& vertices, size_t id) {
+            return Vec3f(vertices[id + 0], vertices[id + 1], vertices[id + 2]);
+        };
+        auto update_position_at = [](std::vector<float>& vertices, size_t id, const Vec3f& position) {
+            vertices[id + 0] = position[0];
+            vertices[id + 1] = position[1];
+            vertices[id + 2] = position[2];
+        };
+        auto store_triangle = [](IndexBuffer& buffer_indices, unsigned int i1, unsigned int i2, unsigned int i3) {
+            buffer_indices.push_back(i1);
+            buffer_indices.push_back(i2);
+            buffer_indices.push_back(i3);
+        };
+        auto append_dummy_cap = [store_triangle](IndexBuffer& buffer_indices, unsigned int id) {
+            store_triangle(buffer_indices, id, id, id);
+            store_triangle(buffer_indices, id, id, id);
+        };
 
-            unsigned int starting_vertices_size = static_cast<unsigned int>(buffer_vertices.size() / buffer.vertices.vertex_size_floats());
+        if (starts_new_path(prev, curr, buffer)) {
+            buffer.paths.push_back(make_path(curr, 0, buffer.indices.size(), prev_move_id));
+            buffer.paths.back().first.position = prev.position;
+        }
 
-            Vec3f dir = (curr.position - prev.position).normalized();
-            Vec3f right = (std::abs(std::abs(dir.dot(Vec3f::UnitZ())) - 1.0f) < EPSILON) ? -Vec3f::UnitY() : Vec3f(dir[1], -dir[0], 0.0f).normalized();
-            Vec3f left = -right;
-            Vec3f up = right.cross(dir);
-            Vec3f down = -up;
+        std::vector<float>& buffer_vertices = buffer.vertices;
+        IndexBuffer& buffer_indices = buffer.indices;
+        unsigned int starting_vertices_size = static_cast<unsigned int>(buffer_vertices.size() / vertex_size_floats);
 
-            Path& last_path = buffer.paths.back();
+        Vec3f dir = (curr.position - prev.position).normalized();
+        Vec3f right = (std::abs(std::abs(dir.dot(Vec3f::UnitZ())) - 1.0f) < EPSILON) ? -Vec3f::UnitY() : Vec3f(dir[1], -dir[0], 0.0f).normalized();
+        Vec3f left = -right;
+        Vec3f up = right.cross(dir);
+        Vec3f down = -up;
 
-            float half_width = 0.5f * last_path.width;
-            float half_height = 0.5f * last_path.height;
+        Path& last_path = buffer.paths.back();
 
-            Vec3f prev_pos = prev.position - half_height * up;
-            Vec3f curr_pos = curr.position - half_height * up;
+        float half_width = 0.5f * last_path.width;
+        float half_height = 0.5f * last_path.height;
 
-            float length = (curr_pos - prev_pos).norm();
-            if (last_path.vertices_count() == 1) {
-                // 1st segment
+        Vec3f prev_pos = prev.position - half_height * up;
+        Vec3f curr_pos = curr.position - half_height * up;
 
-                // vertices 1st endpoint
-                store_vertex(buffer_vertices, prev_pos + half_height * up, up);
-                store_vertex(buffer_vertices, prev_pos + half_width * right, right);
-                store_vertex(buffer_vertices, prev_pos + half_height * down, down);
-                store_vertex(buffer_vertices, prev_pos + half_width * left, left);
+        float length = (curr_pos - prev_pos).norm();
+        if (last_path.vertices_count() == 1) {
+            // 1st segment
 
-                // vertices 2nd endpoint
-                store_vertex(buffer_vertices, curr_pos + half_height * up, up);
-                store_vertex(buffer_vertices, curr_pos + half_width * right, right);
-                store_vertex(buffer_vertices, curr_pos + half_height * down, down);
-                store_vertex(buffer_vertices, curr_pos + half_width * left, left);
-            }
-            else {
-                // any other segment
-                float displacement = 0.0f;
-                float cos_dir = prev_dir.dot(dir);
-                if (cos_dir > -0.9998477f) {
-                    // if the angle between adjacent segments is smaller than 179 degrees
-                    Vec3f med_dir = (prev_dir + dir).normalized();
-                    displacement = half_width * ::tan(::acos(std::clamp(dir.dot(med_dir), -1.0f, 1.0f)));
-                }
+            // vertices 1st endpoint
+            store_vertex(buffer_vertices, prev_pos + half_height * up, up);
+            store_vertex(buffer_vertices, prev_pos + half_width * right, right);
+            store_vertex(buffer_vertices, prev_pos + half_height * down, down);
+            store_vertex(buffer_vertices, prev_pos + half_width * left, left);
 
-                Vec3f displacement_vec = displacement * prev_dir;
-                bool can_displace = displacement > 0.0f && displacement < prev_length&& displacement < length;
+            // vertices 2nd endpoint
+            store_vertex(buffer_vertices, curr_pos + half_height * up, up);
+            store_vertex(buffer_vertices, curr_pos + half_width * right, right);
+            store_vertex(buffer_vertices, curr_pos + half_height * down, down);
+            store_vertex(buffer_vertices, curr_pos + half_width * left, left);
 
-                size_t prev_right_id = (starting_vertices_size - 3) * buffer.vertices.vertex_size_floats();
-                size_t prev_left_id = (starting_vertices_size - 1) * buffer.vertices.vertex_size_floats();
-                Vec3f prev_right_pos = extract_position_at(buffer_vertices, prev_right_id);
-                Vec3f prev_left_pos = extract_position_at(buffer_vertices, prev_left_id);
+            // triangles starting cap
+            store_triangle(buffer_indices, starting_vertices_size + 0, starting_vertices_size + 2, starting_vertices_size + 1);
+            store_triangle(buffer_indices, starting_vertices_size + 0, starting_vertices_size + 3, starting_vertices_size + 2);
 
-                bool is_right_turn = prev_up.dot(prev_dir.cross(dir)) <= 0.0f;
-                // whether the angle between adjacent segments is greater than 45 degrees
-                bool is_sharp = cos_dir < 0.7071068f;
+            // dummy triangles outer corner cap
+            append_dummy_cap(buffer_indices, starting_vertices_size);
 
-                bool right_displaced = false;
-                bool left_displaced = false;
+            // triangles sides
+            store_triangle(buffer_indices, starting_vertices_size + 0, starting_vertices_size + 1, starting_vertices_size + 4);
+            store_triangle(buffer_indices, starting_vertices_size + 1, starting_vertices_size + 5, starting_vertices_size + 4);
+            store_triangle(buffer_indices, starting_vertices_size + 1, starting_vertices_size + 2, starting_vertices_size + 5);
+            store_triangle(buffer_indices, starting_vertices_size + 2, starting_vertices_size + 6, starting_vertices_size + 5);
+            store_triangle(buffer_indices, starting_vertices_size + 2, starting_vertices_size + 3, starting_vertices_size + 6);
+            store_triangle(buffer_indices, starting_vertices_size + 3, starting_vertices_size + 7, starting_vertices_size + 6);
+            store_triangle(buffer_indices, starting_vertices_size + 3, starting_vertices_size + 0, starting_vertices_size + 7);
+            store_triangle(buffer_indices, starting_vertices_size + 0, starting_vertices_size + 4, starting_vertices_size + 7);
 
-                // displace the vertex (inner with respect to the corner) of the previous segment 2nd enpoint, if possible
-                if (can_displace) {
-                    if (is_right_turn) {
-                        prev_right_pos -= displacement_vec;
-                        update_position_at(buffer_vertices, prev_right_id, prev_right_pos);
-                        right_displaced = true;
-                    }
-                    else {
-                        prev_left_pos -= displacement_vec;
-                        update_position_at(buffer_vertices, prev_left_id, prev_left_pos);
-                        left_displaced = true;
-                    }
-                }
+            // triangles ending cap
+            store_triangle(buffer_indices, starting_vertices_size + 4, starting_vertices_size + 6, starting_vertices_size + 7);
+            store_triangle(buffer_indices, starting_vertices_size + 4, starting_vertices_size + 5, starting_vertices_size + 6);
+        }
+        else {
+            // any other segment
+            float displacement = 0.0f;
+            float cos_dir = state.prev_dir.dot(dir);
+            if (cos_dir > -0.9998477f) {
+                // if the angle between adjacent segments is smaller than 179 degrees
+                Vec3f med_dir = (state.prev_dir + dir).normalized();
+                displacement = half_width * ::tan(::acos(std::clamp(dir.dot(med_dir), -1.0f, 1.0f)));
+            }
 
-                if (!is_sharp) {
-                    // displace the vertex (outer with respect to the corner) of the previous segment 2nd enpoint, if possible
-                    if (can_displace) {
-                        if (is_right_turn) {
-                            prev_left_pos += displacement_vec;
-                            update_position_at(buffer_vertices, prev_left_id, prev_left_pos);
-                            left_displaced = true;
-                        }
-                        else {
-                            prev_right_pos += displacement_vec;
-                            update_position_at(buffer_vertices, prev_right_id, prev_right_pos);
-                            right_displaced = true;
-                        }
-                    }
+            Vec3f displacement_vec = displacement * state.prev_dir;
+            bool can_displace = displacement > 0.0f && displacement < state.prev_length && displacement < length;
 
-                    // vertices 1st endpoint (top and bottom are from previous segment 2nd endpoint)
-                    // vertices position matches that of the previous segment 2nd endpoint, if displaced
-                    store_vertex(buffer_vertices, right_displaced ? prev_right_pos : prev_pos + half_width * right, right);
-                    store_vertex(buffer_vertices, left_displaced ? prev_left_pos : prev_pos + half_width * left, left);
+            size_t prev_right_id = (starting_vertices_size - 3) * vertex_size_floats;
+            size_t prev_left_id = (starting_vertices_size - 1) * vertex_size_floats;
+            Vec3f prev_right_pos = extract_position_at(buffer_vertices, prev_right_id);
+            Vec3f prev_left_pos = extract_position_at(buffer_vertices, prev_left_id);
+
+            bool is_right_turn = state.prev_up.dot(state.prev_dir.cross(dir)) <= 0.0f;
+            // whether the angle between adjacent segments is greater than 45 degrees
+            bool is_sharp = cos_dir < 0.7071068f;
+
+            bool right_displaced = false;
+            bool left_displaced = false;
+
+            // displace the vertex (inner with respect to the corner) of the previous segment 2nd enpoint, if possible
+            if (can_displace) {
+                if (is_right_turn) {
+                    prev_right_pos -= displacement_vec;
+                    update_position_at(buffer_vertices, prev_right_id, prev_right_pos);
+                    right_displaced = true;
                 }
                 else {
-                    // vertices 1st endpoint (top and bottom are from previous segment 2nd endpoint)
-                    // the inner corner vertex position matches that of the previous segment 2nd endpoint, if displaced
+                    prev_left_pos -= displacement_vec;
+                    update_position_at(buffer_vertices, prev_left_id, prev_left_pos);
+                    left_displaced = true;
+                }
+            }
+
+            if (!is_sharp) {
+                // displace the vertex (outer with respect to the corner) of the previous segment 2nd enpoint, if possible
+                if (can_displace) {
                     if (is_right_turn) {
-                        store_vertex(buffer_vertices, right_displaced ? prev_right_pos : prev_pos + half_width * right, right);
-                        store_vertex(buffer_vertices, prev_pos + half_width * left, left);
+                        prev_left_pos += displacement_vec;
+                        update_position_at(buffer_vertices, prev_left_id, prev_left_pos);
+                        left_displaced = true;
                     }
                     else {
-                        store_vertex(buffer_vertices, prev_pos + half_width * right, right);
-                        store_vertex(buffer_vertices, left_displaced ? prev_left_pos : prev_pos + half_width * left, left);
+                        prev_right_pos += displacement_vec;
+                        update_position_at(buffer_vertices, prev_right_id, prev_right_pos);
+                        right_displaced = true;
                     }
                 }
 
-                // vertices 2nd endpoint
-                store_vertex(buffer_vertices, curr_pos + half_height * up, up);
-                store_vertex(buffer_vertices, curr_pos + half_width * right, right);
-                store_vertex(buffer_vertices, curr_pos + half_height * down, down);
-                store_vertex(buffer_vertices, curr_pos + half_width * left, left);
-            }
-
-            last_path.last = { 0, 0, move_id, curr.position };
-            prev_dir = dir;
-            prev_up = up;
-            prev_length = length;
-    };
-
-    auto add_indices_as_solid = [](const GCodeProcessor::MoveVertex& prev, const GCodeProcessor::MoveVertex& curr, TBuffer& buffer,
-        size_t& buffer_vertices_size, unsigned int index_buffer_id, IndexBuffer& buffer_indices, size_t move_id) {
-            static Vec3f prev_dir;
-            static Vec3f prev_up;
-            static float prev_length;
-            auto store_triangle = [](IndexBuffer& buffer_indices, unsigned int i1, unsigned int i2, unsigned int i3) {
-                buffer_indices.push_back(i1);
-                buffer_indices.push_back(i2);
-                buffer_indices.push_back(i3);
-            };
-            auto append_dummy_cap = [store_triangle](IndexBuffer& buffer_indices, unsigned int id) {
-                store_triangle(buffer_indices, id, id, id);
-                store_triangle(buffer_indices, id, id, id);
-            };
-
-            if (prev.type != curr.type || !buffer.paths.back().matches(curr)) {
-                buffer.add_path(curr, index_buffer_id, buffer_indices.size(), move_id - 1);
-                buffer.paths.back().first.position = prev.position;
-            }
-
-            unsigned int starting_vertices_size = static_cast<unsigned int>(buffer_vertices_size);
-
-            Vec3f dir = (curr.position - prev.position).normalized();
-            Vec3f right = (std::abs(std::abs(dir.dot(Vec3f::UnitZ())) - 1.0f) < EPSILON) ? -Vec3f::UnitY() : Vec3f(dir[1], -dir[0], 0.0f).normalized();
-            Vec3f up = right.cross(dir);
-
-            Path& last_path = buffer.paths.back();
-
-            float half_width = 0.5f * last_path.width;
-            float half_height = 0.5f * last_path.height;
-
-            Vec3f prev_pos = prev.position - half_height * up;
-            Vec3f curr_pos = curr.position - half_height * up;
-
-            float length = (curr_pos - prev_pos).norm();
-            if (last_path.vertices_count() == 1) {
-                // 1st segment
-                buffer_vertices_size += 8;
-
-                // triangles starting cap
-                store_triangle(buffer_indices, starting_vertices_size + 0, starting_vertices_size + 2, starting_vertices_size + 1);
-                store_triangle(buffer_indices, starting_vertices_size + 0, starting_vertices_size + 3, starting_vertices_size + 2);
-
-                // dummy triangles outer corner cap
-                append_dummy_cap(buffer_indices, starting_vertices_size);
-
-                // triangles sides
-                store_triangle(buffer_indices, starting_vertices_size + 0, starting_vertices_size + 1, starting_vertices_size + 4);
-                store_triangle(buffer_indices, starting_vertices_size + 1, starting_vertices_size + 5, starting_vertices_size + 4);
-                store_triangle(buffer_indices, starting_vertices_size + 1, starting_vertices_size + 2, starting_vertices_size + 5);
-                store_triangle(buffer_indices, starting_vertices_size + 2, starting_vertices_size + 6, starting_vertices_size + 5);
-                store_triangle(buffer_indices, starting_vertices_size + 2, starting_vertices_size + 3, starting_vertices_size + 6);
-                store_triangle(buffer_indices, starting_vertices_size + 3, starting_vertices_size + 7, starting_vertices_size + 6);
-                store_triangle(buffer_indices, starting_vertices_size + 3, starting_vertices_size + 0, starting_vertices_size + 7);
-                store_triangle(buffer_indices, starting_vertices_size + 0, starting_vertices_size + 4, starting_vertices_size + 7);
-
-                // triangles ending cap
-                store_triangle(buffer_indices, starting_vertices_size + 4, starting_vertices_size + 6, starting_vertices_size + 7);
-                store_triangle(buffer_indices, starting_vertices_size + 4, starting_vertices_size + 5, starting_vertices_size + 6);
+                // vertices 1st endpoint (top and bottom are from previous segment 2nd endpoint)
+                // vertices position matches that of the previous segment 2nd endpoint, if displaced
+                store_vertex(buffer_vertices, right_displaced ? prev_right_pos : prev_pos + half_width * right, right);
+                store_vertex(buffer_vertices, left_displaced ? prev_left_pos : prev_pos + half_width * left, left);
             }
             else {
-                // any other segment
-                float displacement = 0.0f;
-                float cos_dir = prev_dir.dot(dir);
-                if (cos_dir > -0.9998477f) {
-                    // if the angle between adjacent segments is smaller than 179 degrees
-                    Vec3f med_dir = (prev_dir + dir).normalized();
-                    displacement = half_width * ::tan(::acos(std::clamp(dir.dot(med_dir), -1.0f, 1.0f)));
+                // vertices 1st endpoint (top and bottom are from previous segment 2nd endpoint)
+                // the inner corner vertex position matches that of the previous segment 2nd endpoint, if displaced
+                if (is_right_turn) {
+                    store_vertex(buffer_vertices, right_displaced ? prev_right_pos : prev_pos + half_width * right, right);
+                    store_vertex(buffer_vertices, prev_pos + half_width * left, left);
                 }
-
-                Vec3f displacement_vec = displacement * prev_dir;
-                bool can_displace = displacement > 0.0f && displacement < prev_length && displacement < length;
-
-                bool is_right_turn = prev_up.dot(prev_dir.cross(dir)) <= 0.0f;
-                // whether the angle between adjacent segments is greater than 45 degrees
-                bool is_sharp = cos_dir < 0.7071068f;
-
-                bool right_displaced = false;
-                bool left_displaced = false;
-
-                if (!is_sharp) {
-                    if (can_displace) {
-                        if (is_right_turn)
-                            left_displaced = true;
-                        else
-                            right_displaced = true;
-                    }
+                else {
+                    store_vertex(buffer_vertices, prev_pos + half_width * right, right);
+                    store_vertex(buffer_vertices, left_displaced ? prev_left_pos : prev_pos + half_width * left, left);
                 }
+            }
 
-                buffer_vertices_size += 6;
-
-                // triangles starting cap
-                store_triangle(buffer_indices, starting_vertices_size - 4, starting_vertices_size - 2, starting_vertices_size + 0);
-                store_triangle(buffer_indices, starting_vertices_size - 4, starting_vertices_size + 1, starting_vertices_size - 2);
-
-                // triangles outer corner cap
-                if (is_right_turn) {
-                    if (left_displaced)
-                        // dummy triangles
-                        append_dummy_cap(buffer_indices, starting_vertices_size);
-                    else {
-                        store_triangle(buffer_indices, starting_vertices_size - 4, starting_vertices_size + 1, starting_vertices_size - 1);
-                        store_triangle(buffer_indices, starting_vertices_size + 1, starting_vertices_size - 2, starting_vertices_size - 1);
-                    }
+            // vertices 2nd endpoint
+            store_vertex(buffer_vertices, curr_pos + half_height * up, up);
+            store_vertex(buffer_vertices, curr_pos + half_width * right, right);
+            store_vertex(buffer_vertices, curr_pos + half_height * down, down);
+            store_vertex(buffer_vertices, curr_pos + half_width * left, left);
+
+            // triangles starting cap
+            store_triangle(buffer_indices, starting_vertices_size - 4, starting_vertices_size - 2, starting_vertices_size + 0);
+            store_triangle(buffer_indices, starting_vertices_size - 4, starting_vertices_size + 1, starting_vertices_size - 2);
+
+            // triangles outer corner cap
+            if (is_right_turn) {
+                if (left_displaced)
+                    // dummy triangles
+                    append_dummy_cap(buffer_indices, starting_vertices_size);
+                else {
+                    store_triangle(buffer_indices, starting_vertices_size - 4, starting_vertices_size + 1, starting_vertices_size - 1);
+                    store_triangle(buffer_indices, starting_vertices_size + 1, starting_vertices_size - 2, starting_vertices_size - 1);
                 }
+            }
+            else {
+                if (right_displaced)
+                    // dummy triangles
+                    append_dummy_cap(buffer_indices, starting_vertices_size);
                 else {
-                    if (right_displaced)
-                        // dummy triangles
-                        append_dummy_cap(buffer_indices, starting_vertices_size);
-                    else {
-                        store_triangle(buffer_indices, starting_vertices_size - 4, starting_vertices_size - 3, starting_vertices_size + 0);
-                        store_triangle(buffer_indices, starting_vertices_size - 3, starting_vertices_size - 2, starting_vertices_size + 0);
-                    }
+                    store_triangle(buffer_indices, starting_vertices_size - 4, starting_vertices_size - 3, starting_vertices_size + 0);
+                    store_triangle(buffer_indices, starting_vertices_size - 3, starting_vertices_size - 2, starting_vertices_size + 0);
                 }
-
-                // triangles sides
-                store_triangle(buffer_indices, starting_vertices_size - 4, starting_vertices_size + 0, starting_vertices_size + 2);
-                store_triangle(buffer_indices, starting_vertices_size + 0, starting_vertices_size + 3, starting_vertices_size + 2);
-                store_triangle(buffer_indices, starting_vertices_size + 0, starting_vertices_size - 2, starting_vertices_size + 3);
-                store_triangle(buffer_indices, starting_vertices_size - 2, starting_vertices_size + 4, starting_vertices_size + 3);
-                store_triangle(buffer_indices, starting_vertices_size - 2, starting_vertices_size + 1, starting_vertices_size + 4);
-                store_triangle(buffer_indices, starting_vertices_size + 1, starting_vertices_size + 5, starting_vertices_size + 4);
-                store_triangle(buffer_indices, starting_vertices_size + 1, starting_vertices_size - 4, starting_vertices_size + 5);
-                store_triangle(buffer_indices, starting_vertices_size - 4, starting_vertices_size + 2, starting_vertices_size + 5);
-
-                // triangles ending cap
-                store_triangle(buffer_indices, starting_vertices_size + 2, starting_vertices_size + 4, starting_vertices_size + 5);
-                store_triangle(buffer_indices, starting_vertices_size + 2, starting_vertices_size + 3, starting_vertices_size + 4);
             }
 
-            last_path.last = { index_buffer_id, buffer_indices.size() - 1, move_id, curr.position };
-            prev_dir = dir;
-            prev_up = up;
-            prev_length = length;
+            // triangles sides
+            store_triangle(buffer_indices, starting_vertices_size - 4, starting_vertices_size + 0, starting_vertices_size + 2);
+            store_triangle(buffer_indices, starting_vertices_size + 0, starting_vertices_size + 3, starting_vertices_size + 2);
+            store_triangle(buffer_indices, starting_vertices_size + 0, starting_vertices_size - 2, starting_vertices_size + 3);
+            store_triangle(buffer_indices, starting_vertices_size - 2, starting_vertices_size + 4, starting_vertices_size + 3);
+            store_triangle(buffer_indices, starting_vertices_size - 2, starting_vertices_size + 1, starting_vertices_size + 4);
+            store_triangle(buffer_indices, starting_vertices_size + 1, starting_vertices_size + 5, starting_vertices_size + 4);
+            store_triangle(buffer_indices, starting_vertices_size + 1, starting_vertices_size - 4, starting_vertices_size + 5);
+            store_triangle(buffer_indices, starting_vertices_size - 4, starting_vertices_size + 2, starting_vertices_size + 5);
+
+            // triangles ending cap
+            store_triangle(buffer_indices, starting_vertices_size + 2, starting_vertices_size + 4, starting_vertices_size + 5);
+            store_triangle(buffer_indices, starting_vertices_size + 2, starting_vertices_size + 3, starting_vertices_size + 4);
+        }
+
+        last_path.last = { 0, buffer_indices.size() - 1, move_id, curr.position };
+        state.prev_dir = dir;
+        state.prev_up = up;
+        state.prev_length = length;
     };
 
-    wxBusyCursor busy;
-
-    // to reduce the peak in memory usage, we split the generation of the vertex and index buffers in two steps.
-    // the data are deleted as soon as they are sent to the gpu.
-    std::vector<std::vector<float>> vertices(m_buffers.size());
-    std::vector<MultiIndexBuffer> indices(m_buffers.size());
-    std::vector<float> options_zs;
-
-    // toolpaths data -> extract vertices from result
-    for (size_t i = 0; i < m_moves_count; ++i) {
+    chunk.buffers.assign(layouts.size(), Buffer());
+    std::vector<SolidState> solid_states(layouts.size());
+    for (size_t i = chunk.first_move_id; i < chunk.last_move_id; ++i) {
         // skip first vertex
         if (i == 0)
             continue;
 
-        ++progress_count;
-        if (progress_dialog != nullptr && progress_count % progress_threshold == 0) {
-            progress_dialog->Update(int(100.0f * float(i) / (2.0f * float(m_moves_count))),
-                _L("Generating vertex buffer") + ": " + wxNumberFormatter::ToString(100.0 * double(i) / double(m_moves_count), 0, wxNumberFormatter::Style_None) + "%");
-            progress_dialog->Fit();
-            progress_count = 0;
-        }
-
-        const GCodeProcessor::MoveVertex& prev = gcode_result.moves[i - 1];
-        const GCodeProcessor::MoveVertex& curr = gcode_result.moves[i];
+        size_t prev_move_id = move_ids.empty() ? i - 1 : move_ids[i - 1];
+        size_t move_id = move_ids.empty() ? i : move_ids[i];
+        const GCodeProcessor::MoveVertex& prev = moves[prev_move_id];
+        const GCodeProcessor::MoveVertex& curr = moves[move_id];
 
         unsigned char id = buffer_id(curr.type);
-        TBuffer& buffer = m_buffers[id];
-        std::vector<float>& buffer_vertices = vertices[id];
+        Buffer& buffer = chunk.buffers[id];
 
-        switch (buffer.render_primitive_type)
+        switch (layouts[id].render_primitive_type)
         {
         case TBuffer::ERenderPrimitiveType::Point: {
-            add_vertices_as_point(curr, buffer_vertices);
+            add_as_point(curr, buffer, move_id);
             break;
         }
         case TBuffer::ERenderPrimitiveType::Line: {
-            add_vertices_as_line(prev, curr, buffer, buffer_vertices);
+            add_as_line(prev, curr, buffer, prev_move_id, move_id);
             break;
         }
         case TBuffer::ERenderPrimitiveType::Triangle: {
-            add_vertices_as_solid(prev, curr, buffer, buffer_vertices, i);
+            add_as_solid(prev, curr, buffer, layouts[id].vertex_size_floats(), solid_states[id], prev_move_id, move_id);
             break;
         }
         }
-
-        EMoveType type = buffer_type(id);
-        if (type == EMoveType::Pause_Print || type == EMoveType::Custom_GCode) {
-            const float* const last_z = options_zs.empty() ? nullptr : &options_zs.back();
-            float z = static_cast<double>(curr.position[2]);
-            if (last_z == nullptr || z < *last_z - EPSILON || *last_z + EPSILON < z)
-                options_zs.emplace_back(curr.position[2]);
-        }
     }
 
     // move the wipe toolpaths half height up to render them on proper position
-    std::vector<float>& wipe_vertices = vertices[buffer_id(EMoveType::Wipe)];
+    std::vector<float>& wipe_vertices = chunk.buffers[buffer_id(EMoveType::Wipe)].vertices;
     for (size_t i = 2; i < wipe_vertices.size(); i += 3) {
         wipe_vertices[i] += 0.5f * GCodeProcessor::Wipe_Height;
     }
+}
 
-    log_memory_usage("Loaded G-code generated vertex buffers, ", vertices, indices);
+GCodeViewer::ToolpathsGeometry GCodeViewer::generate_toolpaths_geometry(const std::vector<GCodeProcessor::MoveVertex>& moves, const std::vector<size_t>& move_ids,
+    size_t chunk_size, size_t ibuffer_threshold, std::function<void(float)> progress)
+{
+    ToolpathsGeometry geometry;
+    size_t moves_count = move_ids.empty() ? moves.size() : move_ids.size();
+    if (moves_count == 0)
+        return geometry;
 
-    // toolpaths data -> send vertices data to gpu
-    for (size_t i = 0; i < m_buffers.size(); ++i) {
-        TBuffer& buffer = m_buffers[i];
+    auto move_type = [&moves, &move_ids](size_t i) {
+        return move_ids.empty() ? moves[i].type : moves[move_ids[i]].type;
+    };
 
-        const std::vector<float>& buffer_vertices = vertices[i];
-        buffer.vertices.count = buffer_vertices.size() / buffer.vertices.vertex_size_floats();
-#if ENABLE_GCODE_VIEWER_STATISTICS
-        m_statistics.total_vertices_gpu_size += buffer_vertices.size() * sizeof(float);
-        m_statistics.max_vbuffer_gpu_size = std::max(m_statistics.max_vbuffer_gpu_size, static_cast<int64_t>(buffer_vertices.size() * sizeof(float)));
-        m_statistics.max_vertices_in_vertex_buffer = std::max(m_statistics.max_vertices_in_vertex_buffer, static_cast<int64_t>(buffer.vertices.count));
-#endif // ENABLE_GCODE_VIEWER_STATISTICS
+    std::vector<BufferLayout> layouts;
+    for (size_t i = 0; i < static_cast<size_t>(EMoveType::Extrude); ++i) {
+        layouts.push_back(buffer_layout(buffer_type(static_cast<unsigned char>(i))));
+    }
 
-        if (buffer.vertices.count > 0) {
-#if ENABLE_GCODE_VIEWER_STATISTICS
-            ++m_statistics.vbuffers_count;
-#endif // ENABLE_GCODE_VIEWER_STATISTICS
-            glsafe(::glGenBuffers(1, &buffer.vertices.id));
-            glsafe(::glBindBuffer(GL_ARRAY_BUFFER, buffer.vertices.id));
-            glsafe(::glBufferData(GL_ARRAY_BUFFER, buffer_vertices.size() * sizeof(float), buffer_vertices.data(), GL_STATIC_DRAW));
-            glsafe(::glBindBuffer(GL_ARRAY_BUFFER, 0));
+    // split the moves into chunks, each of them starting at a change of the move type,
+    // where a new path is started anyway, so that the chunks can be processed independently
+    chunk_size = std::max<size_t>(chunk_size, 1);
+    for (size_t first = 0; first < moves_count;) {
+        size_t last = std::min(first + chunk_size, moves_count);
+        while (last < moves_count && move_type(last) == move_type(last - 1)) {
+            ++last;
         }
+        ToolpathsChunk& chunk = geometry.chunks.emplace_back();
+        chunk.first_move_id = first;
+        chunk.last_move_id = last;
+        first = last;
     }
 
-    // dismiss vertices data, no more needed
-    std::vector<std::vector<float>>().swap(vertices);
-
-    // toolpaths data -> extract indices from result
-    // paths may have been filled while extracting vertices,
-    // so reset them, they will be filled again while extracting indices
-    for (TBuffer& buffer : m_buffers) {
-        buffer.paths.clear();
+    // generate the chunks in parallel, a batch at a time to report the progress from the calling thread
+    static const size_t batch_size = 64;
+    for (size_t batch_begin = 0; batch_begin < geometry.chunks.size(); batch_begin += batch_size) {
+        size_t batch_end = std::min(batch_begin + batch_size, geometry.chunks.size());
+        tbb::parallel_for(tbb::blocked_range<size_t>(batch_begin, batch_end, 1),
+            [&moves, &move_ids, &layouts, &geometry](const tbb::blocked_range<size_t>& range) {
+                for (size_t i = range.begin(); i < range.end(); ++i) {
+                    generate_toolpaths_chunk(moves, move_ids, layouts, geometry.chunks[i]);
+                }
+            });
+        if (progress != nullptr)
+            progress(static_cast<float>(geometry.chunks[batch_end - 1].last_move_id) / static_cast<float>(moves_count));
+    }
+
+    // lay out the chunks into the vertex and index buffers
+    // vertices_offsets[i][j] is the index of the first vertex of the i-th chunk into the vertex buffer of the j-th TBuffer
+    std::vector<std::vector<unsigned int>> vertices_offsets(geometry.chunks.size(), std::vector<unsigned int>(layouts.size(), 0));
+    geometry.buffers.assign(layouts.size(), ToolpathsGeometry::Buffer());
+    for (size_t j = 0; j < layouts.size(); ++j) {
+        ToolpathsGeometry::Buffer& buffer = geometry.buffers[j];
+        size_t vertex_size_floats = layouts[j].vertex_size_floats();
+        size_t paths_count = 0;
+        for (const ToolpathsChunk& chunk : geometry.chunks) {
+            paths_count += chunk.buffers[j].paths.size();
+        }
+        buffer.paths.reserve(paths_count);
+
+        for (size_t i = 0; i < geometry.chunks.size(); ++i) {
+            ToolpathsChunk::Buffer& chunk_buffer = geometry.chunks[i].buffers[j];
+            vertices_offsets[i][j] = static_cast<unsigned int>(buffer.vertices_count);
+            buffer.vertices_count += chunk_buffer.vertices.size() / vertex_size_floats;
+
+            // the indices of a path are contiguous, a path is never split between two index buffers
+            for (const Path& chunk_path : chunk_buffer.paths) {
+                size_t path_indices_count = chunk_path.last.i_id + 1 - chunk_path.first.i_id;
+                if (buffer.index_buffers.empty() ||
+                    (buffer.index_buffers.back().count > 0 && buffer.index_buffers.back().count + path_indices_count > ibuffer_threshold))
+                    buffer.index_buffers.emplace_back();
+
+                ToolpathsGeometry::IndexBufferLayout& ibuffer = buffer.index_buffers.back();
+                if (ibuffer.ranges.empty() || ibuffer.ranges.back().chunk_id != i || ibuffer.ranges.back().end != chunk_path.first.i_id)
+                    ibuffer.ranges.push_back({ i, chunk_path.first.i_id, chunk_path.first.i_id });
+                ibuffer.ranges.back().end = chunk_path.last.i_id + 1;
+
+                Path& path = buffer.paths.emplace_back(chunk_path);
+                path.first.b_id = static_cast<unsigned int>(buffer.index_buffers.size() - 1);
+                path.first.i_id = ibuffer.count;
+                path.last.b_id = path.first.b_id;
+                path.last.i_id = ibuffer.count + path_indices_count - 1;
+                ibuffer.count += path_indices_count;
+            }
+            std::vector<Path>().swap(chunk_buffer.paths);
+        }
     }
 
-    // max index buffer size
-    const size_t IBUFFER_THRESHOLD = 1024 * 1024 * 32;
+    // rebase the indices of the chunks to the vertex buffers
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, geometry.chunks.size(), 1),
+        [&geometry, &vertices_offsets](const tbb::blocked_range<size_t>& range) {
+            for (size_t i = range.begin(); i < range.end(); ++i) {
+                for (size_t j = 0; j < geometry.chunks[i].buffers.size(); ++j) {
+                    unsigned int offset = vertices_offsets[i][j];
+                    if (offset > 0) {
+                        for (unsigned int& id : geometry.chunks[i].buffers[j].indices) {
+                            id += offset;
+                        }
+                    }
+                }
+            }
+        });
 
-    // variable used to keep track of the current size (in vertices) of the vertex buffer
-    std::vector<size_t> curr_buffer_vertices_size(m_buffers.size(), 0);
-    for (size_t i = 0; i < m_moves_count; ++i) {
-        // skip first vertex
-        if (i == 0)
-            continue;
+    return geometry;
+}
 
-        ++progress_count;
-        if (progress_dialog != nullptr && progress_count % progress_threshold == 0) {
-            progress_dialog->Update(int(100.0f * float(m_moves_count + i) / (2.0f * float(m_moves_count))),
-                _L("Generating index buffers") + ": " + wxNumberFormatter::ToString(100.0 * double(i) / double(m_moves_count), 0, wxNumberFormatter::Style_None) + "%");
-            progress_dialog->Fit();
-            progress_count = 0;
-        }
+const std::vector<float> GCodeViewer::ToolpathsLOD::Tolerances = { 0.025f, 0.1f, 0.4f };
 
-        const GCodeProcessor::MoveVertex& prev = gcode_result.moves[i - 1];
-        const GCodeProcessor::MoveVertex& curr = gcode_result.moves[i];
+std::vector<size_t> GCodeViewer::decimate_moves(const std::vector<GCodeProcessor::MoveVertex>& moves, float tolerance)
+{
+    // only the segments of extrusions and travels are merged, the moves rendered as points and the wipes are always kept
+    auto is_mergeable = [](const GCodeProcessor::MoveVertex& move) {
+        return move.type == EMoveType::Extrude || move.type == EMoveType::Travel;
+    };
+    // whether the segments ending at the given moves may be merged, the properties of the resulting path must not change
+    auto same_run = [](const GCodeProcessor::MoveVertex& prev, const GCodeProcessor::MoveVertex& curr) {
+        auto sign = [](float value) { return (value > 0.0f) - (value < 0.0f); };
+        if (prev.type != curr.type || prev.extruder_id != curr.extruder_id || prev.cp_color_id != curr.cp_color_id ||
+            prev.feedrate != curr.feedrate || sign(prev.delta_extruder) != sign(curr.delta_extruder))
+            return false;
+        return curr.type == EMoveType::Travel ||
+            (prev.extrusion_role == curr.extrusion_role && prev.position[2] == curr.position[2] && prev.width == curr.width &&
+             prev.height == curr.height && prev.fan_speed == curr.fan_speed && prev.mm3_per_mm == curr.mm3_per_mm);
+    };
 
-        unsigned char id = buffer_id(curr.type);
-        TBuffer& buffer = m_buffers[id];
-        MultiIndexBuffer& buffer_indices = indices[id];
-        if (buffer_indices.empty())
-            buffer_indices.push_back(IndexBuffer());
-
-        // if adding the indices for the current segment exceeds the threshold size of the current index buffer
-        // create another index buffer, and move the current path indices into it
-        if (buffer_indices.back().size() >= IBUFFER_THRESHOLD - static_cast<size_t>(buffer.indices_per_segment())) {
-            buffer_indices.push_back(IndexBuffer());
-            if (buffer.render_primitive_type != TBuffer::ERenderPrimitiveType::Point) {
-                if (!(prev.type != curr.type || !buffer.paths.back().matches(curr))) {
-                    Path& last_path = buffer.paths.back();
-                    size_t delta_id = last_path.last.i_id - last_path.first.i_id;
-
-                    // move indices of the last path from the previous into the new index buffer
-                    IndexBuffer& src_buffer = buffer_indices[buffer_indices.size() - 2];
-                    IndexBuffer& dst_buffer = buffer_indices[buffer_indices.size() - 1];
-                    std::move(src_buffer.begin() + last_path.first.i_id, src_buffer.end(), std::back_inserter(dst_buffer));
-                    src_buffer.erase(src_buffer.begin() + last_path.first.i_id, src_buffer.end());
-
-                    // updates path indices
-                    last_path.first.b_id = buffer_indices.size() - 1;
-                    last_path.first.i_id = 0;
-                    last_path.last.b_id = buffer_indices.size() - 1;
-                    last_path.last.i_id = delta_id;
+    // Douglas-Peucker simplification of the polyline moves[first] ... moves[last], clearing keep for the dropped moves
+    const float tolerance_sq = sqr(tolerance);
+    auto simplify = [&moves, tolerance_sq](size_t first, size_t last, std::vector<std::pair<size_t, size_t>>& stack, std::vector<unsigned char>& keep) {
+        stack.clear();
+        stack.emplace_back(first, last);
+        while (!stack.empty()) {
+            auto [a, b] = stack.back();
+            stack.pop_back();
+            if (b - a < 2)
+                continue;
+
+            const Vec3f& pa = moves[a].position;
+            Vec3f v = moves[b].position - pa;
+            float l2 = v.squaredNorm();
+            float max_dist_sq = -1.0f;
+            size_t max_id = a;
+            for (size_t i = a + 1; i < b; ++i) {
+                Vec3f w = moves[i].position - pa;
+                float t = (l2 > 0.0f) ? std::clamp(w.dot(v) / l2, 0.0f, 1.0f) : 0.0f;
+                float dist_sq = (w - t * v).squaredNorm();
+                if (dist_sq > max_dist_sq) {
+                    max_dist_sq = dist_sq;
+                    max_id = i;
                 }
             }
-        }
 
-        switch (buffer.render_primitive_type)
-        {
-        case TBuffer::ERenderPrimitiveType::Point: {
-            add_indices_as_point(curr, buffer, static_cast<unsigned int>(buffer_indices.size()) - 1, buffer_indices.back(), i);
-            break;
-        }
-        case TBuffer::ERenderPrimitiveType::Line: {
-            add_indices_as_line(prev, curr, buffer, static_cast<unsigned int>(buffer_indices.size()) - 1, buffer_indices.back(), i);
-            break;
-        }
-        case TBuffer::ERenderPrimitiveType::Triangle: {
-            add_indices_as_solid(prev, curr, buffer, curr_buffer_vertices_size[id], static_cast<unsigned int>(buffer_indices.size()) - 1, buffer_indices.back(), i);
-            break;
-        }
+            if (max_dist_sq > tolerance_sq) {
+                stack.emplace_back(a, max_id);
+                stack.emplace_back(max_id, b);
+            }
+            else {
+                for (size_t i = a + 1; i < b; ++i) {
+                    keep[i] = 0;
+                }
+            }
         }
-    }
+    };
 
-    if (progress_dialog != nullptr) {
-        progress_dialog->Update(100, "");
-        progress_dialog->Fit();
+    std::vector<unsigned char> keep(moves.size(), 1);
+
+    // runs never span a change of the move type, so the moves are split into independent ranges there
+    std::vector<std::pair<size_t, size_t>> ranges;
+    for (size_t first = 1; first < moves.size();) {
+        size_t last = std::min(first + 65536, moves.size());
+        while (last < moves.size() && moves[last].type == moves[last - 1].type) {
+            ++last;
+        }
+        ranges.emplace_back(first, last);
+        first = last;
     }
 
-    log_memory_usage("Loaded G-code generated indices buffers, ", vertices, indices);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, ranges.size(), 1),
+        [&moves, &ranges, &keep, &is_mergeable, &same_run, &simplify](const tbb::blocked_range<size_t>& range) {
+            std::vector<std::pair<size_t, size_t>> stack;
+            for (size_t r = range.begin(); r < range.end(); ++r) {
+                size_t i = ranges[r].first;
+                while (i < ranges[r].second) {
+                    if (!is_mergeable(moves[i])) {
+                        ++i;
+                        continue;
+                    }
+                    // the segments of the run [i, j) start at moves[i - 1]
+                    size_t j = i + 1;
+                    while (j < ranges[r].second && same_run(moves[j - 1], moves[j])) {
+                        ++j;
+                    }
+                    simplify(i - 1, j - 1, stack, keep);
+                    i = j;
+                }
+            }
+        });
 
-    // toolpaths data -> send indices data to gpu
-    for (size_t i = 0; i < m_buffers.size(); ++i) {
-        TBuffer& buffer = m_buffers[i];
+    std::vector<size_t> ids;
+    ids.reserve(std::count(keep.begin(), keep.end(), 1));
+    for (size_t i = 0; i < keep.size(); ++i) {
+        if (keep[i] != 0)
+            ids.push_back(i);
+    }
+    return ids;
+}
 
-        for (size_t j = 0; j < indices[i].size(); ++j) {
-            const IndexBuffer& buffer_indices = indices[i][j];
-            buffer.indices.push_back(IBuffer());
-            IBuffer& ibuffer = buffer.indices.back();
-            ibuffer.count = buffer_indices.size();
+void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
+{
 #if ENABLE_GCODE_VIEWER_STATISTICS
-            m_statistics.total_indices_gpu_size += ibuffer.count * sizeof(unsigned int);
-            m_statistics.max_ibuffer_gpu_size = std::max(m_statistics.max_ibuffer_gpu_size, static_cast<int64_t>(ibuffer.count * sizeof(unsigned int)));
-            m_statistics.max_indices_in_index_buffer = std::max(m_statistics.max_indices_in_index_buffer, static_cast<int64_t>(ibuffer.count));
+    auto start_time = std::chrono::high_resolution_clock::now();
+    m_statistics.results_size = SLIC3R_STDVEC_MEMSIZE(gcode_result.moves, GCodeProcessor::MoveVertex);
+    m_statistics.results_time = gcode_result.time;
 #endif // ENABLE_GCODE_VIEWER_STATISTICS
 
-            if (ibuffer.count > 0) {
-#if ENABLE_GCODE_VIEWER_STATISTICS
-                ++m_statistics.ibuffers_count;
-#endif // ENABLE_GCODE_VIEWER_STATISTICS
-                glsafe(::glGenBuffers(1, &ibuffer.id));
-                glsafe(::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibuffer.id));
-                glsafe(::glBufferData(GL_ELEMENT_ARRAY_BUFFER, buffer_indices.size() * sizeof(unsigned int), buffer_indices.data(), GL_STATIC_DRAW));
-                glsafe(::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
-            }
+    // vertices data
+    m_moves_count = gcode_result.moves.size();
+    if (m_moves_count == 0)
+        return;
+
+    wxProgressDialog* progress_dialog = wxGetApp().is_gcode_viewer() ?
+        new wxProgressDialog(_L("Generating toolpaths"), "...",
+            100, wxGetApp().plater(), wxPD_AUTO_HIDE | wxPD_APP_MODAL) : nullptr;
+
+    m_extruders_count = gcode_result.extruders_count;
+
+    for (size_t i = 0; i < m_moves_count; ++i) {
+        const GCodeProcessor::MoveVertex& move = gcode_result.moves[i];
+        if (wxGetApp().is_gcode_viewer())
+            // for the gcode viewer we need all moves to correctly size the printbed
+            m_paths_bounding_box.merge(move.position.cast<double>());
+        else {
+            if (move.type == EMoveType::Extrude && move.width != 0.0f && move.height != 0.0f)
+                m_paths_bounding_box.merge(move.position.cast<double>());
         }
-    }
 
-#if ENABLE_GCODE_VIEWER_STATISTICS
-    for (const TBuffer& buffer : m_buffers) {
-        m_statistics.paths_size += SLIC3R_STDVEC_MEMSIZE(buffer.paths, Path);
-    }
-    unsigned int travel_buffer_id = buffer_id(EMoveType::Travel);
-    const MultiIndexBuffer& travel_buffer_indices = indices[travel_buffer_id];
-    for (size_t i = 0; i < travel_buffer_indices.size(); ++i) {
-        m_statistics.travel_segments_count = travel_buffer_indices[i].size() / m_buffers[travel_buffer_id].indices_per_segment();
-    }
-    unsigned int wipe_buffer_id = buffer_id(EMoveType::Wipe);
-    const MultiIndexBuffer& wipe_buffer_indices = indices[wipe_buffer_id];
-    for (size_t i = 0; i < wipe_buffer_indices.size(); ++i) {
-        m_statistics.wipe_segments_count = wipe_buffer_indices[i].size() / m_buffers[wipe_buffer_id].indices_per_segment();
+        if (i > 0 && (move.type == EMoveType::Pause_Print || move.type == EMoveType::Custom_GCode)) {
+            const float* const last_z = m_options_zs.empty() ? nullptr : &m_options_zs.back();
+            float z = static_cast<double>(move.position[2]);
+            if (last_z == nullptr || z < *last_z - EPSILON || *last_z + EPSILON < z)
+                m_options_zs.emplace_back(move.position[2]);
+        }
     }
-    unsigned int extrude_buffer_id = buffer_id(EMoveType::Extrude);
-    const MultiIndexBuffer& extrude_buffer_indices = indices[extrude_buffer_id];
-    for (size_t i = 0; i < extrude_buffer_indices.size(); ++i) {
-        m_statistics.extrude_segments_count = extrude_buffer_indices[i].size() / m_buffers[extrude_buffer_id].indices_per_segment();
+
+    // max bounding box (account for tool marker)
+    m_max_bounding_box = m_paths_bounding_box;
+    m_max_bounding_box.merge(m_paths_bounding_box.max + m_sequential_view.marker.get_bounding_box().size()[2] * Vec3d::UnitZ());
+
+    wxBusyCursor busy;
+
+    // toolpaths data -> build the level of detail pyramid
+    for (float tolerance : ToolpathsLOD::Tolerances) {
+        m_lod.levels.emplace_back(decimate_moves(gcode_result.moves, tolerance));
     }
-#endif // ENABLE_GCODE_VIEWER_STATISTICS
 
-    // dismiss indices data, no more needed
-    std::vector<MultiIndexBuffer>().swap(indices);
 
     // layers zs / roles / extruder ids / cp color ids -> extract from result
     size_t last_travel_s_id = 0;
@@ -1636,15 +1616,55 @@ void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
     if (!m_layers.empty())
         m_layers_z_range = { 0, static_cast<unsigned int>(m_layers.size() - 1) };
 
-    // change color of paths whose layer contains option points
-    if (!options_zs.empty()) {
-        TBuffer& extrude_buffer = m_buffers[buffer_id(EMoveType::Extrude)];
-        for (Path& path : extrude_buffer.paths) {
-            float z = path.first.position[2];
-            if (std::find_if(options_zs.begin(), options_zs.end(), [z](float f) { return f - EPSILON <= z && z <= f + EPSILON; }) != options_zs.end())
-                path.cp_color_id = 255 - path.cp_color_id;
+    // max index buffer size
+    const size_t IBUFFER_THRESHOLD = 1024 * 1024 * 32;
+
+    // toolpaths data -> generate vertices, indices and paths of all the levels of detail on the cpu, once,
+    // so that switching the level while rendering only sends the data of the new level to the gpu
+    size_t lod_moves_count = m_moves_count;
+    for (const std::vector<size_t>& level : m_lod.levels) {
+        lod_moves_count += level.size();
+    }
+    m_lod.geometries.reserve(m_lod.levels_count());
+    float progress = 0.0f;
+    for (unsigned int level = 0; level < static_cast<unsigned int>(m_lod.levels_count()); ++level) {
+        size_t level_moves_count = (level == 0) ? m_moves_count : m_lod.levels[level - 1].size();
+        float progress_end = progress + 90.0f * static_cast<float>(level_moves_count) / static_cast<float>(lod_moves_count);
+        m_lod.geometries.emplace_back(generate_toolpaths_geometry(gcode_result.moves, (level == 0) ? std::vector<size_t>() : m_lod.levels[level - 1], 65536, IBUFFER_THRESHOLD,
+            [progress_dialog, progress, progress_end](float ratio) {
+            if (progress_dialog != nullptr) {
+                float percent = progress + (progress_end - progress) * ratio;
+                progress_dialog->Update(int(percent),
+                    _L("Generating vertex buffer") + ": " + wxNumberFormatter::ToString(double(percent) / 0.9, 0, wxNumberFormatter::Style_None) + "%");
+                progress_dialog->Fit();
+            }
+        }));
+        progress = progress_end;
+    }
+
+    int64_t geometry_size = 0;
+    for (const ToolpathsGeometry& geometry : m_lod.geometries) {
+        for (const ToolpathsChunk& chunk : geometry.chunks) {
+            for (const ToolpathsChunk::Buffer& buffer : chunk.buffers) {
+                geometry_size += SLIC3R_STDVEC_MEMSIZE(buffer.vertices, float) + SLIC3R_STDVEC_MEMSIZE(buffer.indices, unsigned int);
+            }
         }
     }
+    log_memory_used("Loaded G-code generated vertex and index buffers of all levels of detail, ", geometry_size);
+
+    if (progress_dialog != nullptr) {
+        progress_dialog->Update(90, _L("Generating index buffers"));
+        progress_dialog->Fit();
+    }
+
+    // toolpaths data -> send the level of detail matching the current camera to the gpu
+    m_lod.current = lod_level_from_camera();
+    send_toolpaths_level(m_lod.current);
+
+    if (progress_dialog != nullptr) {
+        progress_dialog->Update(100, "");
+        progress_dialog->Fit();
+    }
 
     // roles -> remove duplicates
     std::sort(m_roles.begin(), m_roles.end());
@@ -1656,7 +1676,7 @@ void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
     m_extruder_ids.erase(std::unique(m_extruder_ids.begin(), m_extruder_ids.end()), m_extruder_ids.end());
     m_extruder_ids.shrink_to_fit();
 
-    log_memory_usage("Loaded G-code generated extrusion paths, ", vertices, indices);
+    log_memory_used("Loaded G-code generated extrusion paths, ");
 
 #if ENABLE_GCODE_VIEWER_STATISTICS
     m_statistics.load_time = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::high_resolution_clock::now() - start_time).count();
@@ -1666,6 +1686,146 @@ void GCodeViewer::load_toolpaths(const GCodeProcessor::Result& gcode_result)
         progress_dialog->Destroy();
 }
 
+void GCodeViewer::send_toolpaths_level(unsigned int level) const
+{
+    // release the gpu memory of the previous level, if any
+    for (TBuffer& buffer : m_buffers) {
+        buffer.reset();
+    }
+#if ENABLE_GCODE_VIEWER_STATISTICS
+    int64_t results_size = m_statistics.results_size;
+    m_statistics.reset_sizes();
+    m_statistics.reset_others();
+    m_statistics.results_size = results_size;
+#endif // ENABLE_GCODE_VIEWER_STATISTICS
+
+    const ToolpathsGeometry& geometry = m_lod.geometries[level];
+
+    // toolpaths data -> send data to gpu, one chunk at a time, the cpu data are kept to be sent again when switching back to this level
+    for (size_t i = 0; i < m_buffers.size(); ++i) {
+        TBuffer& buffer = m_buffers[i];
+        const ToolpathsGeometry::Buffer& buffer_geometry = geometry.buffers[i];
+
+        buffer.vertices.count = buffer_geometry.vertices_count;
+#if ENABLE_GCODE_VIEWER_STATISTICS
+        m_statistics.total_vertices_gpu_size += buffer.vertices.data_size_bytes();
+        m_statistics.max_vbuffer_gpu_size = std::max(m_statistics.max_vbuffer_gpu_size, static_cast<int64_t>(buffer.vertices.data_size_bytes()));
+        m_statistics.max_vertices_in_vertex_buffer = std::max(m_statistics.max_vertices_in_vertex_buffer, static_cast<int64_t>(buffer.vertices.count));
+#endif // ENABLE_GCODE_VIEWER_STATISTICS
+
+        if (buffer.vertices.count > 0) {
+#if ENABLE_GCODE_VIEWER_STATISTICS
+            ++m_statistics.vbuffers_count;
+#endif // ENABLE_GCODE_VIEWER_STATISTICS
+            glsafe(::glGenBuffers(1, &buffer.vertices.id));
+            glsafe(::glBindBuffer(GL_ARRAY_BUFFER, buffer.vertices.id));
+            glsafe(::glBufferData(GL_ARRAY_BUFFER, buffer.vertices.data_size_bytes(), nullptr, GL_STATIC_DRAW));
+            size_t offset = 0;
+            for (const ToolpathsChunk& chunk : geometry.chunks) {
+                const std::vector<float>& chunk_vertices = chunk.buffers[i].vertices;
+                if (!chunk_vertices.empty()) {
+                    glsafe(::glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(chunk_vertices.size() * sizeof(float)), chunk_vertices.data()));
+                    offset += chunk_vertices.size() * sizeof(float);
+                }
+            }
+            glsafe(::glBindBuffer(GL_ARRAY_BUFFER, 0));
+        }
+
+        for (const ToolpathsGeometry::IndexBufferLayout& ibuffer_layout : buffer_geometry.index_buffers) {
+            buffer.indices.push_back(IBuffer());
+            IBuffer& ibuffer = buffer.indices.back();
+            ibuffer.count = ibuffer_layout.count;
+#if ENABLE_GCODE_VIEWER_STATISTICS
+            m_statistics.total_indices_gpu_size += ibuffer.count * sizeof(unsigned int);
+            m_statistics.max_ibuffer_gpu_size = std::max(m_statistics.max_ibuffer_gpu_size, static_cast<int64_t>(ibuffer.count * sizeof(unsigned int)));
+            m_statistics.max_indices_in_index_buffer = std::max(m_statistics.max_indices_in_index_buffer, static_cast<int64_t>(ibuffer.count));
+#endif // ENABLE_GCODE_VIEWER_STATISTICS
+
+            if (ibuffer.count > 0) {
+#if ENABLE_GCODE_VIEWER_STATISTICS
+                ++m_statistics.ibuffers_count;
+#endif // ENABLE_GCODE_VIEWER_STATISTICS
+                glsafe(::glGenBuffers(1, &ibuffer.id));
+                glsafe(::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibuffer.id));
+                glsafe(::glBufferData(GL_ELEMENT_ARRAY_BUFFER, ibuffer.count * sizeof(unsigned int), nullptr, GL_STATIC_DRAW));
+                size_t offset = 0;
+                for (const ToolpathsGeometry::IndicesRange& range : ibuffer_layout.ranges) {
+                    const IndexBuffer& chunk_indices = geometry.chunks[range.chunk_id].buffers[i].indices;
+                    size_t size = (range.end - range.begin) * sizeof(unsigned int);
+                    glsafe(::glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size), chunk_indices.data() + range.begin));
+                    offset += size;
+                }
+                glsafe(::glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0));
+            }
+        }
+
+        buffer.paths = buffer_geometry.paths;
+
+#if ENABLE_GCODE_VIEWER_STATISTICS
+        m_statistics.paths_size += SLIC3R_STDVEC_MEMSIZE(buffer.paths, Path);
+        size_t segments_count = 0;
+        for (const ToolpathsGeometry::IndexBufferLayout& ibuffer_layout : buffer_geometry.index_buffers) {
+            segments_count += ibuffer_layout.count / buffer.indices_per_segment();
+        }
+        switch (buffer_type(i))
+        {
+        case EMoveType::Travel:  { m_statistics.travel_segments_count = segments_count; break; }
+        case EMoveType::Wipe:    { m_statistics.wipe_segments_count = segments_count; break; }
+        case EMoveType::Extrude: { m_statistics.extrude_segments_count = segments_count; break; }
+        default: { break; }
+        }
+#endif // ENABLE_GCODE_VIEWER_STATISTICS
+    }
+
+
+    // change color of paths whose layer contains option points
+    if (!m_options_zs.empty()) {
+        TBuffer& extrude_buffer = m_buffers[buffer_id(EMoveType::Extrude)];
+        for (Path& path : extrude_buffer.paths) {
+            float z = path.first.position[2];
+            if (std::find_if(m_options_zs.begin(), m_options_zs.end(), [z](float f) { return f - EPSILON <= z && z <= f + EPSILON; }) != m_options_zs.end())
+                path.cp_color_id = 255 - path.cp_color_id;
+        }
+    }
+}
+
+unsigned int GCodeViewer::lod_level_from_camera() const
+{
+    // the coarsest level whose tolerance stays below half a pixel at the camera target
+    double pixel_size = wxGetApp().plater()->get_camera().get_inv_zoom();
+    unsigned int level = 0;
+    while (level < static_cast<unsigned int>(m_lod.levels.size()) && ToolpathsLOD::Tolerances[level] <= 0.5 * pixel_size) {
+        ++level;
+    }
+    return level;
+}
+
+unsigned int GCodeViewer::select_lod_level() const
+{
+    // the sequential view renders parts of paths, it needs all their segments
+    if (m_sequential_view.endpoints.first < m_sequential_view.current.first || m_sequential_view.current.last < m_sequential_view.endpoints.last)
+        return 0;
+
+    // a few layers selected by the layers slider are inspected in detail
+    static const unsigned int Lod_Min_Layers_Count = 4;
+    if (m_layers_z_range[1] - m_layers_z_range[0] + 1 < Lod_Min_Layers_Count)
+        return 0;
+
+    return lod_level_from_camera();
+}
+
+bool GCodeViewer::update_lod_level(unsigned int level) const
+{
+    if (level == m_lod.current || level >= static_cast<unsigned int>(m_lod.geometries.size()))
+        return false;
+
+    // no geometry is generated here, only the gpu buffers of the current level are replaced
+    wxBusyCursor busy;
+    send_toolpaths_level(level);
+    m_lod.current = level;
+    return true;
+}
+
 void GCodeViewer::load_shells(const Print& print, bool initialized)
 {
     if (print.objects().empty())
@@ -1871,7 +2031,11 @@ void GCodeViewer::refresh_render_paths(bool keep_sequential_current_first, bool
         for (const Path& path : buffer.paths) {
             if (path.contains(m_sequential_view.current.last)) {
                 unsigned int offset = static_cast<unsigned int>(m_sequential_view.current.last - path.first.s_id);
-                if (offset > 0) {
+                if (offset > 0 && m_sequential_view.current.last == path.last.s_id) {
+                    // end of the path, the decimated levels of detail keep fewer segments than moves
+                    offset = static_cast<unsigned int>(path.last.i_id - path.first.i_id) + 1 - buffer.indices_per_segment() + buffer.end_segment_vertex_offset();
+                }
+                else if (offset > 0) {
                     if (buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::Line)
                         offset = 2 * offset - 1;
                     else if (buffer.render_primitive_type == TBuffer::ERenderPrimitiveType::Triangle) {
@@ -1940,13 +2104,18 @@ void GCodeViewer::refresh_render_paths(bool keep_sequential_current_first, bool
             it->index_buffer_id = index_buffer_id;
         }
 
-        unsigned int segments_count = std::min(m_sequential_view.current.last, path.last.s_id) - std::max(m_sequential_view.current.first, path.first.s_id) + 1;
         unsigned int size_in_indices = 0;
-        switch (buffer->render_primitive_type)
-        {
-        case TBuffer::ERenderPrimitiveType::Point: { size_in_indices = segments_count; break; }
-        case TBuffer::ERenderPrimitiveType::Line:
-        case TBuffer::ERenderPrimitiveType::Triangle: { size_in_indices = buffer->indices_per_segment() * (segments_count - 1); break; }
+        if (m_sequential_view.current.first <= path.first.s_id && path.last.s_id <= m_sequential_view.current.last)
+            // whole path, the decimated levels of detail keep fewer segments than moves
+            size_in_indices = static_cast<unsigned int>(path.last.i_id - path.first.i_id) + 1;
+        else {
+            unsigned int segments_count = std::min(m_sequential_view.current.last, path.last.s_id) - std::max(m_sequential_view.current.first, path.first.s_id) + 1;
+            switch (buffer->render_primitive_type)
+            {
+            case TBuffer::ERenderPrimitiveType::Point: { size_in_indices = segments_count; break; }
+            case TBuffer::ERenderPrimitiveType::Line:
+            case TBuffer::ERenderPrimitiveType::Triangle: { size_in_indices = buffer->indices_per_segment() * (segments_count - 1); break; }
+            }
         }
         it->sizes.push_back(size_in_indices);
 
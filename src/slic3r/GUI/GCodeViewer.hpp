@@ -7,6 +7,9 @@
 
 #include <cstdint>
 #include <float.h>
+#include <functional>
+
+class wxProgressDialog;
 
 namespace Slic3r {
 
@@ -176,9 +179,10 @@ class GCodeViewer
         // b_id index of buffer contained in this->indices
         // i_id index of first index contained in this->indices[b_id]
         // s_id index of first vertex contained in this->vertices
-        void add_path(const GCodeProcessor::MoveVertex& move, unsigned int b_id, size_t i_id, size_t s_id);
-        unsigned int indices_per_segment() const {
-            switch (render_primitive_type)
+        void add_path(const GCodeProcessor::MoveVertex& move, unsigned int b_id, size_t i_id, size_t s_id) { paths.push_back(make_path(move, b_id, i_id, s_id)); }
+        unsigned int indices_per_segment() const { return indices_per_segment(render_primitive_type); }
+        static unsigned int indices_per_segment(ERenderPrimitiveType type) {
+            switch (type)
             {
             case ERenderPrimitiveType::Point:    { return 1; }
             case ERenderPrimitiveType::Line:     { return 2; }
@@ -208,6 +212,106 @@ class GCodeViewer
         bool has_data() const { return vertices.id != 0 && !indices.empty() && indices.front().id != 0; }
     };
 
+    static Path make_path(const GCodeProcessor::MoveVertex& move, unsigned int b_id, size_t i_id, size_t s_id);
+
+public:
+    // Primitive type and vertex format of the TBuffer used to render the given move type.
+    struct BufferLayout
+    {
+        TBuffer::ERenderPrimitiveType render_primitive_type{ TBuffer::ERenderPrimitiveType::Point };
+        VBuffer::EFormat format{ VBuffer::EFormat::Position };
+
+        size_t vertex_size_floats() const { VBuffer vbuffer; vbuffer.format = format; return vbuffer.vertex_size_floats(); }
+    };
+    static BufferLayout buffer_layout(EMoveType type);
+
+    // Toolpaths geometry generated on the cpu from a contiguous range of moves, without touching OpenGL.
+    // Chunks start at a change of the move type, so that no path spans two chunks.
+    // The indices and the paths' index buffer endpoints are relative to the chunk until merged into ToolpathsGeometry.
+    struct ToolpathsChunk
+    {
+        struct Buffer
+        {
+            std::vector<float> vertices;
+            IndexBuffer indices;
+            std::vector<Path> paths;
+        };
+
+        // range [first_move_id, last_move_id) of the rendered moves processed by this chunk
+        size_t first_move_id{ 0 };
+        size_t last_move_id{ 0 };
+        // one for each TBuffer
+        std::vector<Buffer> buffers;
+    };
+
+    // Toolpaths geometry of the whole G-code, generated in parallel over chunks of moves.
+    // The per buffer data describe how the chunks are laid out into the vertex and index buffers,
+    // so that the chunks may be sent to the gpu one by one, without being concatenated on the cpu first.
+    struct ToolpathsGeometry
+    {
+        // Range of indices [begin, end) of a chunk.
+        struct IndicesRange
+        {
+            size_t chunk_id{ 0 };
+            size_t begin{ 0 };
+            size_t end{ 0 };
+        };
+
+        struct IndexBufferLayout
+        {
+            size_t count{ 0 };
+            std::vector<IndicesRange> ranges;
+        };
+
+        struct Buffer
+        {
+            size_t vertices_count{ 0 };
+            std::vector<IndexBufferLayout> index_buffers;
+            // paths with endpoints referencing the index buffers above
+            std::vector<Path> paths;
+        };
+
+        std::vector<ToolpathsChunk> chunks;
+        // one for each TBuffer
+        std::vector<Buffer> buffers;
+    };
+
+    // Generate the toolpaths geometry of the given moves. Pure cpu stage of load_toolpaths(), safe to call without an OpenGL context.
+    // move_ids are the ids of the rendered moves (see ToolpathsLOD), all the moves are rendered if empty.
+    // chunk_size is the minimum number of moves processed by a single task, ibuffer_threshold is the maximum size of an index buffer
+    // (a path is never split, thus an index buffer may exceed the threshold if it contains a single path).
+    // progress is called from the calling thread with the ratio of the processed moves.
+    static ToolpathsGeometry generate_toolpaths_geometry(const std::vector<GCodeProcessor::MoveVertex>& moves, const std::vector<size_t>& move_ids,
+        size_t chunk_size = 65536, size_t ibuffer_threshold = 1024 * 1024 * 32, std::function<void(float)> progress = nullptr);
+
+    // Level of detail pyramid of the toolpaths, built on the cpu from GCodeProcessor::Result::moves.
+    // Level 0 renders all the moves, the higher levels merge the collinear and the short segments with increasing tolerances.
+    // Segments are merged only inside runs of moves of the same type, layer, role and of the other properties shown in the legend,
+    // so the paths are the same at all levels, only their segments differ.
+    struct ToolpathsLOD
+    {
+        // maximum distance of the dropped moves from the merged segments, in mm, of the levels 1, 2, ...
+        static const std::vector<float> Tolerances;
+
+        // ids of the moves rendered by the levels 1, 2, ...
+        std::vector<std::vector<size_t>> levels;
+        // cpu geometry of the levels 0, 1, 2, ..., all generated when the toolpaths are loaded.
+        // Only the geometry of the current level is sent to the gpu, switching the level replaces it with the geometry of the new level.
+        std::vector<ToolpathsGeometry> geometries;
+        // level whose geometry is in the TBuffers
+        unsigned int current{ 0 };
+
+        size_t levels_count() const { return levels.size() + 1; }
+        void reset() { levels = std::vector<std::vector<size_t>>(); geometries = std::vector<ToolpathsGeometry>(); current = 0; }
+    };
+
+    // Ids of the moves to render when merging the segments of the paths with the given tolerance, in mm.
+    static std::vector<size_t> decimate_moves(const std::vector<GCodeProcessor::MoveVertex>& moves, float tolerance);
+
+private:
+    static void generate_toolpaths_chunk(const std::vector<GCodeProcessor::MoveVertex>& moves, const std::vector<size_t>& move_ids,
+        const std::vector<BufferLayout>& layouts, ToolpathsChunk& chunk);
+
     // helper to render shells
     struct Shells
     {
@@ -460,6 +564,9 @@ private:
 #endif // ENABLE_GCODE_VIEWER_STATISTICS
     mutable std::array<float, 2> m_detected_point_sizes = { 0.0f, 0.0f };
     GCodeProcessor::Result::SettingsIds m_settings_ids;
+    mutable ToolpathsLOD m_lod;
+    // z of the layers containing pause prints or custom gcodes
+    std::vector<float> m_options_zs;
 
 public:
     GCodeViewer() = default;
@@ -510,6 +617,14 @@ public:
 private:
     void init();
     void load_toolpaths(const GCodeProcessor::Result& gcode_result);
+    // replace the gpu data of the TBuffers with the already generated geometry of the given level of detail
+    void send_toolpaths_level(unsigned int level) const;
+    // level of detail matching the camera zoom, the layers range and the sequential view
+    unsigned int select_lod_level() const;
+    unsigned int lod_level_from_camera() const;
+    // send the already generated geometry of the given level of detail to the gpu,
+    // returns true if the level changed, then the render paths need to be refreshed
+    bool update_lod_level(unsigned int level) const;
     void load_shells(const Print& print, bool initialized);
     void refresh_render_paths(bool keep_sequential_current_first, bool keep_sequential_current_last) const;
     void render_toolpaths() const;
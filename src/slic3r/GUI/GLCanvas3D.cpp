@@ -14,6 +14,7 @@
 #include "libslic3r/Tesselate.hpp"
 #include "libslic3r/PresetBundle.hpp"
 #include "slic3r/GUI/3DScene.hpp"
+#include "slic3r/GUI/ToolpathsPreview.hpp"
 #include "slic3r/GUI/BackgroundSlicingProcess.hpp"
 #include "slic3r/GUI/GLShader.hpp"
 #include "slic3r/GUI/GUI.hpp"
@@ -5882,133 +5883,57 @@ void GLCanvas3D::_load_print_object_toolpaths(const PrintObject& print_object, c
 
     const bool is_selected_separate_extruder = m_selected_extruder > 0 && ctxt.color_by_color_print();
 
-    //FIXME Improve the heuristics for a grain size.
-    size_t          grain_size = std::max(ctxt.layers.size() / 16, size_t(1));
-    tbb::spin_mutex new_volume_mutex;
-    auto            new_volume = [this, &new_volume_mutex](const float *color) -> GLVolume* {
-    	// Allocate the volume before locking.
-		GLVolume *volume = new GLVolume(color);
-		volume->is_extrusion_path = true;
-    	tbb::spin_mutex::scoped_lock lock;
-    	// Lock by ROII, so if the emplace_back() fails, the lock will be released.
-        lock.acquire(new_volume_mutex);
-        m_volumes.volumes.emplace_back(volume);
-        lock.release();
-        return volume;
-    };
-    const size_t    volumes_cnt_initial = m_volumes.volumes.size();
-    tbb::parallel_for(
-        tbb::blocked_range<size_t>(0, ctxt.layers.size(), grain_size),
-        [&ctxt, &new_volume, is_selected_separate_extruder, this](const tbb::blocked_range<size_t>& range) {
-        GLVolumePtrs 		vols;
-        std::vector<size_t>	color_print_layer_to_glvolume;
-        auto                volume = [&ctxt, &vols, &color_print_layer_to_glvolume, &range](size_t layer_idx, int extruder, int feature) -> GLVolume& {            
-            return *vols[ctxt.color_by_color_print()?
-                ctxt.color_print_color_idx_by_layer_idx_and_extruder(layer_idx, extruder) :
-				ctxt.color_by_tool() ? 
-					std::min<int>(ctxt.number_tools() - 1, std::max<int>(extruder - 1, 0)) : 
-					feature
-				];
-        };
-        if (ctxt.color_by_color_print() || ctxt.color_by_tool()) {
-            for (size_t i = 0; i < ctxt.number_tools(); ++i)
-                vols.emplace_back(new_volume(ctxt.color_tool(i)));
+    ToolpathsPreview::Params params;
+    params.layers         = ctxt.layers;
+    params.instances      = ctxt.shifted_copies;
+    params.has_perimeters = ctxt.has_perimeters;
+    params.has_infill     = ctxt.has_infill;
+    params.has_support    = ctxt.has_support;
+    if (ctxt.color_by_color_print() || ctxt.color_by_tool()) {
+        for (size_t i = 0; i < ctxt.number_tools(); ++i) {
+            const float *color = ctxt.color_tool(i);
+            params.colors.push_back({ color[0], color[1], color[2], color[3] });
         }
-        else
-            vols = { new_volume(ctxt.color_perimeters()), new_volume(ctxt.color_infill()), new_volume(ctxt.color_support()) };
-        for (GLVolume *vol : vols)
-			// Reserving number of vertices (3x position + 3x color)
-        	vol->indexed_vertex_array.reserve(VERTEX_BUFFER_RESERVE_SIZE / 6);
-        for (size_t idx_layer = range.begin(); idx_layer < range.end(); ++ idx_layer) {
-            const Layer *layer = ctxt.layers[idx_layer];
-
-            if (is_selected_separate_extruder)
-            {
-                bool at_least_one_has_correct_extruder = false;
-                for (const LayerRegion* layerm : layer->regions())
-                {
-                    if (layerm->slices.surfaces.empty())
-                        continue;
-                    const PrintRegionConfig& cfg = layerm->region()->config();
-                    if (cfg.perimeter_extruder.value    == m_selected_extruder ||
-                        cfg.infill_extruder.value       == m_selected_extruder ||
-                        cfg.solid_infill_extruder.value == m_selected_extruder ) {
-                        at_least_one_has_correct_extruder = true;
-                        break;
-                    }
-                }
-                if (!at_least_one_has_correct_extruder)
+    }
+    else {
+        for (const float *color : { ctxt.color_perimeters(), ctxt.color_infill(), ctxt.color_support() })
+            params.colors.push_back({ color[0], color[1], color[2], color[3] });
+    }
+    params.color_idx = [&ctxt](size_t layer_idx, int extruder, ToolpathsPreview::Feature feature) -> size_t {
+        return ctxt.color_by_color_print() ?
+            ctxt.color_print_color_idx_by_layer_idx_and_extruder(layer_idx, extruder) :
+            ctxt.color_by_tool() ?
+                std::min<int>(ctxt.number_tools() - 1, std::max<int>(extruder - 1, 0)) :
+                static_cast<size_t>(feature);
+    };
+    if (is_selected_separate_extruder) {
+        params.layer_filter = [this](const Layer& layer) {
+            for (const LayerRegion* layerm : layer.regions()) {
+                if (layerm->slices.surfaces.empty())
                     continue;
+                const PrintRegionConfig& cfg = layerm->region()->config();
+                if (cfg.perimeter_extruder.value    == m_selected_extruder ||
+                    cfg.infill_extruder.value       == m_selected_extruder ||
+                    cfg.solid_infill_extruder.value == m_selected_extruder)
+                    return true;
             }
+            return false;
+        };
+        params.region_filter = [this](const LayerRegion& layerm) {
+            const PrintRegionConfig& cfg = layerm.region()->config();
+            return cfg.perimeter_extruder.value    == m_selected_extruder &&
+                   cfg.infill_extruder.value       == m_selected_extruder &&
+                   cfg.solid_infill_extruder.value == m_selected_extruder;
+        };
+    }
+    params.max_vertex_buffer_size = MAX_VERTEX_BUFFER_SIZE;
 
-            for (GLVolume *vol : vols)
-                if (vol->print_zs.empty() || vol->print_zs.back() != layer->print_z) {
-                    vol->print_zs.emplace_back(layer->print_z);
-                    vol->offsets.emplace_back(vol->indexed_vertex_array.quad_indices.size());
-                    vol->offsets.emplace_back(vol->indexed_vertex_array.triangle_indices.size());
-                }
-            for (const PrintInstance &instance : *ctxt.shifted_copies) {
-                const Point &copy = instance.shift;
-                for (const LayerRegion *layerm : layer->regions()) {
-                    if (is_selected_separate_extruder)
-                    {
-                        const PrintRegionConfig& cfg = layerm->region()->config();
-                        if (cfg.perimeter_extruder.value    != m_selected_extruder ||
-                            cfg.infill_extruder.value       != m_selected_extruder ||
-                            cfg.solid_infill_extruder.value != m_selected_extruder)
-                            continue;
-                    }
-                    if (ctxt.has_perimeters)
-                        _3DScene::extrusionentity_to_verts(layerm->perimeters, float(layer->print_z), copy,
-                        	volume(idx_layer, layerm->region()->config().perimeter_extruder.value, 0));
-                    if (ctxt.has_infill) {
-                        for (const ExtrusionEntity *ee : layerm->fills.entities) {
-                            // fill represents infill extrusions of a single island.
-                            const auto *fill = dynamic_cast<const ExtrusionEntityCollection*>(ee);
-                            if (! fill->entities.empty())
-                                _3DScene::extrusionentity_to_verts(*fill, float(layer->print_z), copy,
-	                                volume(idx_layer, 
-		                                is_solid_infill(fill->entities.front()->role()) ?
-			                                layerm->region()->config().solid_infill_extruder :
-			                                layerm->region()->config().infill_extruder,
-		                                1));
-                        }
-                    }
-                }
-                if (ctxt.has_support) {
-                    const SupportLayer *support_layer = dynamic_cast<const SupportLayer*>(layer);
-                    if (support_layer) {
-                        for (const ExtrusionEntity *extrusion_entity : support_layer->support_fills.entities)
-                            _3DScene::extrusionentity_to_verts(extrusion_entity, float(layer->print_z), copy,
-	                            volume(idx_layer, 
-		                            (extrusion_entity->role() == erSupportMaterial) ?
-			                            support_layer->object()->config().support_material_extruder :
-			                            support_layer->object()->config().support_material_interface_extruder,
-		                            2));
-                    }
-                }
-            }
-            // Ensure that no volume grows over the limits. If the volume is too large, allocate a new one.
-	        for (size_t i = 0; i < vols.size(); ++i) {
-	            GLVolume &vol = *vols[i];
-	            if (vol.indexed_vertex_array.vertices_and_normals_interleaved.size() > MAX_VERTEX_BUFFER_SIZE) {
-	                vols[i] = new_volume(vol.color);
-	                reserve_new_volume_finalize_old_volume(*vols[i], vol, false);
-	            }
-	        }
-        }
-        for (GLVolume *vol : vols)
-        	// Ideally one would call vol->indexed_vertex_array.finalize() here to move the buffers to the OpenGL driver,
-        	// but this code runs in parallel and the OpenGL driver is not thread safe.
-            vol->indexed_vertex_array.shrink_to_fit();
-    });
+    // The geometry is generated on the CPU in parallel, the volumes are added to m_volumes and sent to the GPU afterwards.
+    const size_t volumes_cnt_initial = m_volumes.volumes.size();
+    GLVolumePtrs volumes = ToolpathsPreview::build(params);
+    m_volumes.volumes.insert(m_volumes.volumes.end(), volumes.begin(), volumes.end());
 
     BOOST_LOG_TRIVIAL(debug) << "Loading print object toolpaths in parallel - finalizing results" << m_volumes.log_memory_info() << log_memory_info();
-    // Remove empty volumes from the newly added volumes.
-    m_volumes.volumes.erase(
-        std::remove_if(m_volumes.volumes.begin() + volumes_cnt_initial, m_volumes.volumes.end(),
-        [](const GLVolume *volume) { return volume->empty(); }),
-        m_volumes.volumes.end());
     for (size_t i = volumes_cnt_initial; i < m_volumes.volumes.size(); ++i)
         m_volumes.volumes[i]->indexed_vertex_array.finalize_geometry(m_initialized);
 
@@ -138,6 +138,9 @@ void ArrangeJob::prepare_selected() {
 void ArrangeJob::prepare()
 {
     wxGetKeyState(WXK_SHIFT) ? prepare_selected() : prepare_all();
+
+    if (!m_nfp_cache)
+        m_nfp_cache = arrangement::make_nfp_cache();
 }
 
 void ArrangeJob::process()
@@ -150,6 +153,7 @@ void ArrangeJob::process()
     arrangement::ArrangeParams params;
     params.allow_rotations  = settings.enable_rotation;
     params.min_obj_distance = scaled(settings.distance);
+    params.nfp_cache        = m_nfp_cache;
 
     
     auto count = unsigned(m_selected.size() + m_unprintable.size());
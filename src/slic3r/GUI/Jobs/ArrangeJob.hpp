@@ -16,6 +16,9 @@ class ArrangeJob : public Job
     using ArrangePolygons = arrangement::ArrangePolygons;
 
     ArrangePolygons m_selected, m_unselected, m_unprintable;
+
+    // No-fit polygons reused by the next arrangements of the same objects.
+    std::shared_ptr<arrangement::NfpCache> m_nfp_cache;
     
     // clear m_selected and m_unselected, reserve space for next usage
     void clear_input();
@@ -44,6 +47,10 @@ public:
     void process() override;
     
     void finalize() override;
+
+    // Release the no-fit polygons kept for the next arrangements.
+    // Not to be called while the job is running.
+    void release_nfp_cache() { m_nfp_cache.reset(); }
 };
 
 std::optional<arrangement::ArrangePolygon> get_wipe_tower_arrangepoly(const Plater &);
@@ -1631,13 +1631,16 @@ struct Plater::priv
     {
         priv *m;
         size_t m_arrange_id, m_fill_bed_id, m_rotoptimize_id, m_sla_import_id;
+        ArrangeJob *m_arrange_job;
         
         void before_start() override { m->background_process.stop(); }
         
     public:
         Jobs(priv *_m) : m(_m)
         {
-            m_arrange_id = add_job(std::make_unique<ArrangeJob>(m->statusbar(), m->q));
+            auto arrange_job = std::make_unique<ArrangeJob>(m->statusbar(), m->q);
+            m_arrange_job = arrange_job.get();
+            m_arrange_id = add_job(std::move(arrange_job));
             m_fill_bed_id = add_job(std::make_unique<FillBedJob>(m->statusbar(), m->q));
             m_rotoptimize_id = add_job(std::make_unique<RotoptimizeJob>(m->statusbar(), m->q));
             m_sla_import_id = add_job(std::make_unique<SLAImportJob>(m->statusbar(), m->q));
@@ -1666,6 +1669,13 @@ struct Plater::priv
             m->take_snapshot(_(L("Import SLA archive")));
             start(m_sla_import_id);
         }
+
+        // Release the data kept by the jobs for their next runs.
+        void release_caches()
+        {
+            if (!is_any_running())
+                m_arrange_job->release_nfp_cache();
+        }
         
     } m_ui_jobs;
 
@@ -2794,6 +2804,9 @@ void Plater::priv::reset()
     reset_gcode_toolpaths();
     gcode_result.reset();
 
+    // The no-fit polygons of the arranged objects are of no use for the new project.
+    m_ui_jobs.release_caches();
+
     // Stop and reset the Print content.
     this->background_process.reset();
     model.clear_objects();
@@ -4522,7 +4535,10 @@ void Plater::priv::take_snapshot(const std::string& snapshot_name)
     this->undo_redo_stack().release_least_recently_used();
     // Save the last active preset name of a particular printer technology.
     ((this->printer_technology == ptFFF) ? m_last_fff_printer_profile_name : m_last_sla_printer_profile_name) = wxGetApp().preset_bundle->printers.get_selected_preset_name();
-    BOOST_LOG_TRIVIAL(info) << "Undo / Redo snapshot taken: " << snapshot_name << ", Undo / Redo stack memory: " << Slic3r::format_memsize_MB(this->undo_redo_stack().memsize()) << log_memory_info();
+    UndoRedo::MemoryStats undo_redo_stats = this->undo_redo_stack().memory_stats();
+    BOOST_LOG_TRIVIAL(info) << "Undo / Redo snapshot taken: " << snapshot_name << ", Undo / Redo stack memory: " << Slic3r::format_memsize_MB(undo_redo_stats.memsize) <<
+        ", deduplicated: " << Slic3r::format_memsize_MB(undo_redo_stats.deduplicated) <<
+        ", compressed: " << Slic3r::format_memsize_MB(undo_redo_stats.compressed_raw) << " to " << Slic3r::format_memsize_MB(undo_redo_stats.compressed) << log_memory_info();
 }
 
 void Plater::priv::undo()
@@ -0,0 +1,158 @@
+#include "ToolpathsPreview.hpp"
+
+#include "libslic3r/ExtrusionEntity.hpp"
+#include "libslic3r/ExtrusionEntityCollection.hpp"
+#include "libslic3r/Layer.hpp"
+#include "libslic3r/Print.hpp"
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+
+namespace Slic3r {
+namespace GUI {
+
+// Calls visit(extrusion_entity, color_idx) for the extrusions of a single copy of a layer, in the order they are previewed.
+template<typename Visitor>
+static void visit_layer_extrusions(const ToolpathsPreview::Params &params, size_t layer_idx, Visitor &&visit)
+{
+    using Feature = ToolpathsPreview::Feature;
+    const Layer *layer = params.layers[layer_idx];
+    for (const LayerRegion *layerm : layer->regions()) {
+        if (params.region_filter && ! params.region_filter(*layerm))
+            continue;
+        const PrintRegionConfig &cfg = layerm->region()->config();
+        if (params.has_perimeters)
+            visit(&layerm->perimeters, params.color_idx(layer_idx, cfg.perimeter_extruder.value, Feature::Perimeters));
+        if (params.has_infill) {
+            for (const ExtrusionEntity *ee : layerm->fills.entities) {
+                // fill represents infill extrusions of a single island.
+                const auto *fill = dynamic_cast<const ExtrusionEntityCollection*>(ee);
+                if (! fill->entities.empty())
+                    visit(fill, params.color_idx(layer_idx,
+                        is_solid_infill(fill->entities.front()->role()) ? cfg.solid_infill_extruder.value : cfg.infill_extruder.value,
+                        Feature::Infill));
+            }
+        }
+    }
+    if (params.has_support) {
+        if (const auto *support_layer = dynamic_cast<const SupportLayer*>(layer)) {
+            const PrintObjectConfig &cfg = support_layer->object()->config();
+            for (const ExtrusionEntity *ee : support_layer->support_fills.entities)
+                visit(ee, params.color_idx(layer_idx,
+                    (ee->role() == erSupportMaterial) ? cfg.support_material_extruder.value : cfg.support_material_interface_extruder.value,
+                    Feature::Support));
+        }
+    }
+}
+
+GLVolumePtrs ToolpathsPreview::build(const Params &params)
+{
+    using Capacity = GLIndexedVertexArray::Capacity;
+
+    const size_t num_layers = params.layers.size();
+    const size_t num_colors = params.colors.size();
+    const size_t num_copies = params.instances->size();
+    if (num_layers == 0 || num_colors == 0 || num_copies == 0)
+        return GLVolumePtrs();
+
+    auto is_layer_previewed = [&params](size_t layer_idx) {
+        return ! params.layer_filter || params.layer_filter(*params.layers[layer_idx]);
+    };
+
+    // 1) Counting pass: the size of the geometry of each layer and color.
+    std::vector<Capacity> layer_capacities(num_layers * num_colors);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers), [&params, &layer_capacities, &is_layer_previewed, num_colors, num_copies](const tbb::blocked_range<size_t> &range) {
+        for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx)
+            if (is_layer_previewed(layer_idx)) {
+                Capacity *capacities = layer_capacities.data() + layer_idx * num_colors;
+                visit_layer_extrusions(params, layer_idx, [capacities](const ExtrusionEntity *ee, size_t color_idx) {
+                    capacities[color_idx] += _3DScene::extrusionentity_to_verts_capacity(ee);
+                });
+                for (size_t i = 0; i < num_colors; ++ i)
+                    capacities[i] = capacities[i] * num_copies;
+            }
+    });
+
+    // 2) Split the layers into blocks, so that the volumes of a block do not grow over the limit, and allocate the volumes of the blocks.
+    struct Block
+    {
+        size_t       layer_begin;
+        size_t       layer_end;
+        GLVolumePtrs volumes;
+    };
+    const size_t       grain_size = (params.grain_size == 0) ? std::max(num_layers / 16, size_t(1)) : params.grain_size;
+    std::vector<Block> blocks;
+    {
+        std::vector<Capacity> block_capacities(num_colors);
+        auto close_block = [&params, &blocks, &block_capacities, num_colors](size_t layer_begin, size_t layer_end) {
+            Block block { layer_begin, layer_end, GLVolumePtrs(num_colors, nullptr) };
+            for (size_t i = 0; i < num_colors; ++ i)
+                if (! block_capacities[i].empty()) {
+                    GLVolume *volume = new GLVolume(params.colors[i].data());
+                    volume->is_extrusion_path = true;
+                    volume->indexed_vertex_array.reserve(block_capacities[i]);
+                    block.volumes[i] = volume;
+                }
+            blocks.emplace_back(std::move(block));
+            block_capacities.assign(num_colors, Capacity());
+        };
+        size_t layer_begin = 0;
+        for (size_t layer_idx = 0; layer_idx < num_layers; ++ layer_idx) {
+            bool full = layer_idx + 1 - layer_begin >= grain_size;
+            for (size_t i = 0; i < num_colors; ++ i) {
+                block_capacities[i] += layer_capacities[layer_idx * num_colors + i];
+                full |= block_capacities[i].vertices_and_normals_interleaved > params.max_vertex_buffer_size;
+            }
+            if (full || layer_idx + 1 == num_layers) {
+                close_block(layer_begin, layer_idx + 1);
+                layer_begin = layer_idx + 1;
+            }
+        }
+    }
+
+    // 3) Fill in the blocks in parallel. Each block owns its volumes and their buffers are already allocated.
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, blocks.size(), 1), [&params, &blocks, &is_layer_previewed](const tbb::blocked_range<size_t> &range) {
+        for (size_t block_idx = range.begin(); block_idx < range.end(); ++ block_idx) {
+            Block &block = blocks[block_idx];
+            for (size_t layer_idx = block.layer_begin; layer_idx < block.layer_end; ++ layer_idx) {
+                if (! is_layer_previewed(layer_idx))
+                    continue;
+                const Layer *layer = params.layers[layer_idx];
+                for (GLVolume *vol : block.volumes)
+                    if (vol != nullptr && (vol->print_zs.empty() || vol->print_zs.back() != layer->print_z)) {
+                        vol->print_zs.emplace_back(layer->print_z);
+                        vol->offsets.emplace_back(vol->indexed_vertex_array.quad_indices.size());
+                        vol->offsets.emplace_back(vol->indexed_vertex_array.triangle_indices.size());
+                    }
+                for (const PrintInstance &instance : *params.instances) {
+                    const Point &copy = instance.shift;
+                    visit_layer_extrusions(params, layer_idx, [&block, layer, &copy](const ExtrusionEntity *ee, size_t color_idx) {
+                        GLVolume *vol = block.volumes[color_idx];
+                        // A volume is allocated for each color with any extrusion.
+                        assert(vol != nullptr || _3DScene::extrusionentity_to_verts_capacity(ee).empty());
+                        if (vol != nullptr)
+                            _3DScene::extrusionentity_to_verts(ee, float(layer->print_z), copy, *vol);
+                    });
+                }
+            }
+            for (GLVolume *vol : block.volumes)
+                if (vol != nullptr)
+                    // The counting pass returns an upper bound of the geometry size.
+                    vol->indexed_vertex_array.shrink_to_fit();
+        }
+    });
+
+    GLVolumePtrs out;
+    for (Block &block : blocks)
+        for (GLVolume *vol : block.volumes)
+            if (vol == nullptr)
+                continue;
+            else if (vol->empty())
+                delete vol;
+            else
+                out.emplace_back(vol);
+    return out;
+}
+
+} // namespace GUI
+} // namespace Slic3r
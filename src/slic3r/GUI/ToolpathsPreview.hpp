@@ -0,0 +1,66 @@
+#ifndef slic3r_ToolpathsPreview_hpp_
+#define slic3r_ToolpathsPreview_hpp_
+
+#include "3DScene.hpp"
+
+#include <array>
+#include <functional>
+
+namespace Slic3r {
+
+class Layer;
+class LayerRegion;
+struct PrintInstance;
+typedef std::vector<PrintInstance> PrintInstances;
+
+namespace GUI {
+
+// Preview of the extrusions of a PrintObject, as shown before the G-code is exported.
+//
+// The geometry is built on the CPU only, no OpenGL context is needed, thus the builder may be tested and benchmarked headless.
+// The layers are split into blocks. The size of the geometry of each block and color is calculated by a counting pass,
+// then the GLVolumes of all the blocks are allocated upfront and the blocks are filled in parallel without any locking.
+struct ToolpathsPreview
+{
+    using Color = std::array<float, 4>;
+
+    enum class Feature : unsigned char
+    {
+        Perimeters,
+        Infill,
+        Support
+    };
+
+    struct Params
+    {
+        // Layers of the object and its supports, sorted by print_z.
+        std::vector<const Layer*> layers;
+        // Instances of the object, their extrusions are shifted by PrintInstance::shift.
+        const PrintInstances*     instances{ nullptr };
+        bool                      has_perimeters{ false };
+        bool                      has_infill{ false };
+        bool                      has_support{ false };
+        // Colors of the volumes.
+        std::vector<Color>        colors;
+        // Index into colors of the extrusions of a layer printed by an extruder (1 based).
+        std::function<size_t(size_t layer_idx, int extruder, Feature feature)> color_idx;
+        // Optional filters of the layers and of the regions of a layer.
+        std::function<bool(const Layer&)>       layer_filter;
+        std::function<bool(const LayerRegion&)> region_filter;
+        // A volume is not allowed to grow over this number of floats of interleaved vertices and normals,
+        // unless a single layer is bigger.
+        size_t                    max_vertex_buffer_size{ 131072 * 6 };
+        // Number of layers of a block, the layers of a block are processed by a single thread.
+        // Zero to split the layers into about 16 blocks.
+        size_t                    grain_size{ 0 };
+    };
+
+    // Returns the volumes of all the blocks, ordered by blocks and colors. Empty volumes are not returned.
+    // The caller takes the ownership of the volumes and it is responsible for finalizing their geometry.
+    static GLVolumePtrs build(const Params& params);
+};
+
+} // namespace GUI
+} // namespace Slic3r
+
+#endif // slic3r_ToolpathsPreview_hpp_
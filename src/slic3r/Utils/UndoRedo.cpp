@@ -5,8 +5,11 @@
 #include <fstream>
 #include <memory>
 #include <typeinfo> 
+#include <unordered_map>
 #include <cassert>
 #include <cstddef>
+#include <cstring>
+#include <limits>
 
 #include <cereal/types/polymorphic.hpp>
 #include <cereal/types/map.hpp> 
@@ -23,6 +26,8 @@
 
 #include <boost/foreach.hpp>
 
+#include <miniz.h>
+
 #ifndef NDEBUG
 // #define SLIC3R_UNDOREDO_DEBUG
 #endif /* NDEBUG */
@@ -56,6 +61,59 @@ bool Snapshot::is_topmost() const
 	return this->name == topmost_snapshot_name;
 }
 
+// 64bit hash of a memory block (MurmurHash64A), used to find snapshot data of the same content on the Undo / Redo stack.
+// The content is always compared byte by byte if the hashes match.
+static inline uint64_t hash_bytes(const char *data, size_t size, uint64_t seed = 0x8445d61a4e774912ull)
+{
+	const uint64_t m = 0xc6a4a7935bd1e995ull;
+	uint64_t 	   h = seed ^ (size * m);
+	const char    *end = data + (size & ~size_t(7));
+	for (const char *p = data; p != end; p += 8) {
+		uint64_t k;
+		memcpy(&k, p, 8);
+		k *= m;
+		k ^= k >> 47;
+		k *= m;
+		h ^= k;
+		h *= m;
+	}
+	if (size_t rest = size & 7; rest > 0) {
+		uint64_t k = 0;
+		memcpy(&k, end, rest);
+		h ^= k;
+		h *= m;
+	}
+	h ^= h >> 47;
+	h *= m;
+	h ^= h >> 47;
+	return h;
+}
+
+// Compress cold snapshot data with the fastest deflate level. Returns an empty string if the data does not compress.
+// miniz is used, as it is linked already for 3MF, while LZ4 is not a dependency of the slicer. The cold data is compressed
+// only once the stack exceeds its memory limit, thus the speed of deflate is sufficient.
+static std::string compress_bytes(const char *data, size_t size)
+{
+	if (size == 0 || size >= size_t(std::numeric_limits<mz_ulong>::max() / 2))
+		return std::string();
+	mz_ulong 	compressed_size = mz_compressBound(mz_ulong(size));
+	std::string out(compressed_size, 0);
+	if (mz_compress2((unsigned char*)out.data(), &compressed_size, (const unsigned char*)data, mz_ulong(size), MZ_BEST_SPEED) != MZ_OK || compressed_size >= size)
+		return std::string();
+	out.resize(compressed_size);
+	out.shrink_to_fit();
+	return out;
+}
+
+static std::string decompress_bytes(const std::string &compressed, size_t size)
+{
+	std::string out(size, 0);
+	mz_ulong    out_size = mz_ulong(size);
+	if (mz_uncompress((unsigned char*)out.data(), &out_size, (const unsigned char*)compressed.data(), mz_ulong(compressed.size())) != MZ_OK || out_size != size)
+		throw Slic3r::RuntimeError("Undo / Redo stack: Failed to decompress snapshot data");
+	return out;
+}
+
 // Time interval, start is closed, end is open.
 struct Interval
 {
@@ -112,9 +170,13 @@ public:
 	virtual size_t release_optional() = 0;
 	// Restore optional data possibly released by release_optional.
 	virtual void   restore_optional() = 0;
+	// Compress the data of this history, which is not shared with the scene. Return the amount of memory released.
+	virtual size_t compress() { return 0; }
 
 	// Estimated size in memory, to be used to drop least recently used snapshots.
 	virtual size_t memsize() const = 0;
+	// Accumulate the size of the data stored compressed by this history.
+	virtual void   collect_stats(MemoryStats & /* stats */) const {}
 
 #ifdef SLIC3R_UNDOREDO_DEBUG
 	// Human readable debug information.
@@ -184,25 +246,34 @@ public:
 		return mem_released;
 	}
 
+	const std::vector<T>& history() const { return m_history; }
+
 protected:
 	std::vector<T>	m_history;
 };
 
+// Content hash, comparison and compact serialization of the immutable objects,
+// used to deduplicate and to compress the immutable objects stored on the Undo / Redo stack.
+// Specialized for the TriangleMesh below.
+template<typename T> struct ImmutableObjectTraits;
+
 // Big objects (mainly the triangle meshes) are tracked by Slicer using the shared pointers
 // and they are immutable.
 // The Undo / Redo stack therefore may keep a shared pointer to these immutable objects
 // and as long as the ref counter of these objects is higher than 1 (1 reference is held
 // by the Undo / Redo stack), there is no cost associated to holding the object
 // at the Undo / Redo stack. Once the reference counter drops to 1 (only the Undo / Redo
-// stack holds the reference), the shared pointer may get serialized (and possibly compressed)
+// stack holds the reference), the shared pointer may get serialized and compressed
 // and the shared pointer may be released.
 // The history of a single immutable object may not be continuous, as an immutable object may
 // be removed from the scene while being kept at the Copy / Paste stack.
+// An object of the same content as an object held by the Undo / Redo stack only (for example a mesh reloaded from disk
+// or an operation reverted by the user) shares the history of the older object, see StackImpl::save_immutable_object().
 template<typename T>
 class ImmutableObjectHistory : public ObjectHistory<Interval>
 {
 public:
-	ImmutableObjectHistory(std::shared_ptr<const T>	shared_object, bool optional) : m_shared_object(shared_object), m_optional(optional) {}
+	ImmutableObjectHistory(std::shared_ptr<const T>	shared_object, bool optional, uint64_t hash) : m_shared_object(shared_object), m_optional(optional), m_hash(hash) {}
 	~ImmutableObjectHistory() override {}
 
 	bool is_mutable() const override { return false; }
@@ -210,6 +281,8 @@ public:
 	bool is_optional() const override { return m_optional; }
 	// If it is an immutable object, return its pointer. There is a map assigning a temporary ObjectID to the immutable object pointer.
 	const void* immutable_object_ptr() const { return (const void*)m_shared_object.get(); }
+	// Hash of the content of the immutable object.
+	uint64_t 	hash() const { return m_hash; }
 
 	// Estimated size in memory, to be used to drop least recently used snapshots.
 	size_t memsize() const override {
@@ -223,6 +296,13 @@ public:
 		return memsize;
 	}
 
+	void collect_stats(MemoryStats &stats) const override {
+		if (this->is_serialized() && m_compressed) {
+			stats.compressed_raw += m_serialized_size;
+			stats.compressed     += m_serialized.size();
+		}
+	}
+
 	void save(size_t active_snapshot_time, size_t current_time) {
 		assert(m_history.empty() || m_history.back().end() <= active_snapshot_time || 
 			// The snapshot of an immutable object may have already been taken from another mutable object.
@@ -233,6 +313,26 @@ public:
 			m_history.back().extend_end(current_time + 1);
 	}
 
+	// Replace the object captured by this history with another object of the same content.
+	// Only possible if the object captured is not shared with the scene, otherwise the two objects would be held in memory.
+	bool rebind(const std::shared_ptr<const T> &object) {
+		assert(object && object != m_shared_object);
+		if (m_shared_object.use_count() > 1)
+			return false;
+		if (this->is_serialized()) {
+			std::unique_ptr<T> deserialized = this->deserialize();
+			if (! ImmutableObjectTraits<T>::equal(*deserialized, *object))
+				return false;
+			m_serialized.clear();
+			m_serialized.shrink_to_fit();
+			m_compressed 	  = false;
+			m_serialized_size = 0;
+		} else if (! ImmutableObjectTraits<T>::equal(*m_shared_object, *object))
+			return false;
+		m_shared_object = object;
+		return true;
+	}
+
 	bool has_snapshot(size_t timestamp) {
 		if (m_history.empty())
 			return false;
@@ -276,15 +376,29 @@ public:
 			const_cast<T*>(m_shared_object.get())->restore_optional();
 	}
 
+	// Serialize and compress the object if it is not shared with the scene. Optional objects are rather released by release_optional().
+	size_t compress() override {
+		if (m_optional || this->is_serialized() || m_shared_object.use_count() > 1)
+			return 0;
+		size_t 		memsize_old = m_shared_object->memsize();
+		std::string serialized  = ImmutableObjectTraits<T>::serialize(*m_shared_object);
+		std::string compressed  = compress_bytes(serialized.data(), serialized.size());
+		m_serialized_size = serialized.size();
+		m_compressed 	  = ! compressed.empty();
+		m_serialized 	  = m_compressed ? std::move(compressed) : std::move(serialized);
+		m_shared_object.reset();
+		return memsize_old > m_serialized.size() ? memsize_old - m_serialized.size() : 0;
+	}
+
 	bool 						is_serialized() const { return m_shared_object.get() == nullptr; }
 	const std::string&			serialized_data() const { return m_serialized; }
-	std::shared_ptr<const T>& 	shared_ptr(StackImpl &stack);
+	std::shared_ptr<const T>& 	shared_ptr();
 
 #ifdef SLIC3R_UNDOREDO_DEBUG
 	std::string 				format() override {
 		std::string out = typeid(T).name();
 		out += this->is_serialized() ? 
-			std::string(" len:") + std::to_string(m_serialized.size()) : 
+			std::string(" len:") + std::to_string(m_serialized.size()) + (m_compressed ? " compressed" : "") :
 			std::string(" shared_ptr:") + ptr_to_string(m_shared_object.get());
 		for (const Interval &interval : m_history)
 			out += std::string(", <") + std::to_string(interval.begin()) + "," + std::to_string(interval.end()) + ")";
@@ -297,42 +411,138 @@ public:
 #endif /* NDEBUG */
 
 private:
+	std::unique_ptr<T> 			deserialize() const {
+		return ImmutableObjectTraits<T>::deserialize(m_compressed ? decompress_bytes(m_serialized, m_serialized_size) : m_serialized);
+	}
+
 	// Either the source object is held by a shared pointer and the m_serialized field is empty,
 	// or the shared pointer is null and the object is being serialized into m_serialized.
 	std::shared_ptr<const T>	m_shared_object;
 	// If this object is optional, then it may be deleted from the Undo / Redo stack and recalculated from other data (for example mesh convex hull).
 	bool 						m_optional;
+	// Is m_serialized compressed? Size of m_serialized before compression.
+	bool 						m_compressed { false };
+	size_t 						m_serialized_size { 0 };
 	std::string 				m_serialized;
+	uint64_t 					m_hash;
 };
 
-struct MutableHistoryInterval
+// Serialized data of the mutable objects, shared by reference counting between the history intervals of an object,
+// and between the histories of different objects if their content is the same (for example a ModelVolume deleted
+// and pasted back, or painting reverted to an older state). The data is indexed by its hash.
+class MutableDataPool
 {
-private:
+public:
 	struct Data
 	{
 		// Reference counter of this data chunk. We may have used shared_ptr, but the shared_ptr is thread safe
 		// with the associated cost of CPU cache invalidation on refcount change.
-		size_t		refcnt;
-		size_t		size;
-		char 		data[1];
+		size_t 			 refcnt;
+		uint64_t 		 hash;
+		// Size of the serialized data before compression.
+		size_t 			 size;
+		// First 8 bytes of the serialized data, available even if the data is compressed.
+		uint64_t 		 head;
+		bool 			 compressed;
+		// The compression was tried, but the data did not compress. It is not tried again.
+		bool 			 incompressible;
+		// Either the serialized data or its compressed form.
+		std::string 	 bytes;
+		MutableDataPool *pool;
 
 		// The serialized data matches the data stored here.
-		bool 		matches(const std::string& rhs) { return this->size == rhs.size() && memcmp(this->data, rhs.data(), this->size) == 0; }
+		bool 		matches(const std::string &rhs, uint64_t rhs_hash) const {
+			return this->hash == rhs_hash && this->size == rhs.size() &&
+				(this->compressed ? MutableDataPool::load(*this) == rhs : memcmp(this->bytes.data(), rhs.data(), this->size) == 0);
+		}
 
 		// The timestamp matches the timestamp serialized in the data stored here.
-		bool 		matches_timestamp(uint64_t timestamp) { assert(timestamp > 0);  assert(this->size > 8); return memcmp(this->data, &timestamp, 8) == 0; }
+		bool 		matches_timestamp(uint64_t timestamp) const { assert(timestamp > 0); assert(this->size > 8); return this->head == timestamp; }
 	};
 
+	MutableDataPool() = default;
+	~MutableDataPool() { assert(m_data.empty()); }
+
+	// Return data of the same content stored already, or allocate new data. The reference counter is incremented.
+	Data* 	acquire(const std::string &data, uint64_t hash) {
+		auto range = m_data.equal_range(hash);
+		for (auto it = range.first; it != range.second; ++ it)
+			if (it->second->matches(data, hash)) {
+				++ it->second->refcnt;
+				m_deduplicated += data.size();
+				return it->second;
+			}
+		uint64_t head = 0;
+		memcpy(&head, data.data(), std::min(data.size(), sizeof(head)));
+		Data *out = new Data { 1, hash, data.size(), head, false, false, data, this };
+		m_data.emplace(hash, out);
+		return out;
+	}
+
+	// Decrement the reference counter, release the data if not referenced anymore.
+	void 	release(Data *data) {
+		assert(data->pool == this);
+		if (-- data->refcnt == 0) {
+			auto range = m_data.equal_range(data->hash);
+			auto it    = std::find_if(range.first, range.second, [data](const auto &kvp) { return kvp.second == data; });
+			assert(it != range.second);
+			m_data.erase(it);
+			delete data;
+		}
+	}
+
+	static std::string load(const Data &data) { return data.compressed ? decompress_bytes(data.bytes, data.size) : data.bytes; }
+
+	// Compress all data not yet compressed except for the hot data (sorted), which will likely be compared against when taking the next snapshot.
+	// Return the amount of memory released.
+	size_t 	compress(const std::vector<const Data*> &hot) {
+		// Small data is not worth compressing.
+		static constexpr const size_t min_size = 256;
+		size_t released = 0;
+		for (auto &kvp : m_data) {
+			Data &data = *kvp.second;
+			if (! data.compressed && ! data.incompressible && data.size >= min_size && ! std::binary_search(hot.begin(), hot.end(), &data)) {
+				std::string compressed = compress_bytes(data.bytes.data(), data.size);
+				if (compressed.empty())
+					data.incompressible = true;
+				else {
+					released += data.bytes.size() - compressed.size();
+					data.bytes 	    = std::move(compressed);
+					data.compressed = true;
+				}
+			}
+		}
+		return released;
+	}
+
+	void 	collect_stats(MemoryStats &stats) const {
+		stats.deduplicated += m_deduplicated;
+		for (const auto &kvp : m_data)
+			if (kvp.second->compressed) {
+				stats.compressed_raw += kvp.second->size;
+				stats.compressed 	 += kvp.second->bytes.size();
+			}
+	}
+
+	void 	reset_stats() { m_deduplicated = 0; }
+
+private:
+	std::unordered_multimap<uint64_t, Data*> m_data;
+	// Total size of the serialized data, which was not stored again because data of the same content was stored already.
+	size_t 									 m_deduplicated { 0 };
+};
+
+struct MutableHistoryInterval
+{
+private:
+	using Data = MutableDataPool::Data;
+
 	Interval    m_interval;
 	Data	   *m_data;
 
 public:
-	MutableHistoryInterval(const Interval &interval, const std::string &input_data) : m_interval(interval), m_data(nullptr) {
-		m_data = (Data*)new char[offsetof(Data, data) + input_data.size()];
-		m_data->refcnt = 1;
-		m_data->size = input_data.size();
-		memcpy(m_data->data, input_data.data(), input_data.size());
-	}
+	// Take over a reference to data acquired from a MutableDataPool.
+	MutableHistoryInterval(const Interval &interval, Data *data) : m_interval(interval), m_data(data) {}
 
 	MutableHistoryInterval(const Interval &interval, MutableHistoryInterval &other) : m_interval(interval), m_data(other.m_data) {
 		++ m_data->refcnt;
@@ -342,11 +552,11 @@ public:
 	MutableHistoryInterval(const size_t begin, const size_t end) : m_interval(begin, end), m_data(nullptr) {}
 
 	MutableHistoryInterval(MutableHistoryInterval&& rhs) : m_interval(rhs.m_interval), m_data(rhs.m_data) { rhs.m_data = nullptr; }
-	MutableHistoryInterval& operator=(MutableHistoryInterval&& rhs) { m_interval = rhs.m_interval; m_data = rhs.m_data; rhs.m_data = nullptr; return *this; }
+	MutableHistoryInterval& operator=(MutableHistoryInterval&& rhs) { m_interval = rhs.m_interval; std::swap(m_data, rhs.m_data); return *this; }
 
 	~MutableHistoryInterval() {
-		if (m_data != nullptr && -- m_data->refcnt == 0)
-			delete[] (char*)m_data;
+		if (m_data != nullptr)
+			m_data->pool->release(m_data);
 	}
 
 	const Interval& interval() const { return m_interval; }
@@ -359,17 +569,19 @@ public:
 	bool		operator<(const MutableHistoryInterval& rhs) const { return m_interval < rhs.m_interval; }
 	bool 		operator==(const MutableHistoryInterval& rhs) const { return m_interval == rhs.m_interval; }
 
-	const char* data() const { return m_data->data; }
+	const Data* data() const { return m_data; }
+	// Size of the serialized data before compression.
 	size_t  	size() const { return m_data->size; }
 	size_t		refcnt() const { return m_data->refcnt; }
-	bool		matches(const std::string& data) { return m_data->matches(data); }
-	bool		matches_timestamp(uint64_t timestamp) { return m_data->matches_timestamp(timestamp); }
+	std::string load() const { return MutableDataPool::load(*m_data); }
+	bool		matches(const std::string& data, uint64_t hash) const { return m_data->matches(data, hash); }
+	bool		matches_timestamp(uint64_t timestamp) const { return m_data->matches_timestamp(timestamp); }
 	size_t 		memsize() const {
 		return m_data->refcnt == 1 ?
 			// Count just the size of the snapshot data.
-			m_data->size :
+			m_data->bytes.size() :
 			// Count the size of the snapshot data divided by the number of references, rounded up.
-			(m_data->size + m_data->refcnt - 1) / m_data->refcnt;
+			(m_data->bytes.size() + m_data->refcnt - 1) / m_data->refcnt;
 	}
 
 private:
@@ -424,24 +636,25 @@ public:
 		return false;
 	}
 
-	void save(size_t active_snapshot_time, size_t current_time, const std::string &data) {
+	void save(size_t active_snapshot_time, size_t current_time, const std::string &data, MutableDataPool &pool) {
 		assert(m_history.empty() || m_history.back().end() <= active_snapshot_time);
+		uint64_t hash = hash_bytes(data.data(), data.size());
 		if (m_history.empty() || m_history.back().end() < active_snapshot_time) {
-			if (! m_history.empty() && m_history.back().matches(data))
+			if (! m_history.empty() && m_history.back().matches(data, hash))
 				// Share the previous data by reference counting.
 				m_history.emplace_back(Interval(current_time, current_time + 1), m_history.back());
 			else
-				// Allocate new data.
-				m_history.emplace_back(Interval(current_time, current_time + 1), data);
+				// Share data of the same content stored with another snapshot or allocate new data.
+				m_history.emplace_back(Interval(current_time, current_time + 1), pool.acquire(data, hash));
 		} else {
 			assert(! m_history.empty());
 			assert(m_history.back().end() == active_snapshot_time);
-			if (m_history.back().matches(data))
+			if (m_history.back().matches(data, hash))
 				// Just extend the last interval using the old data.
 				m_history.back().extend_end(current_time + 1);
 			else
-				// Allocate new data time continuous with the previous data.
-				m_history.emplace_back(Interval(active_snapshot_time, current_time + 1), data);
+				// Share or allocate new data time continuous with the previous data.
+				m_history.emplace_back(Interval(active_snapshot_time, current_time + 1), pool.acquire(data, hash));
 		}
 	}
 
@@ -453,7 +666,7 @@ public:
 			-- it;
 		}
 		assert(timestamp >= it->begin() && timestamp < it->end());
-		return std::string(it->data(), it->data() + it->size());
+		return it->load();
 	}
 
 	// Currently all mutable snapshots are mandatory.
@@ -465,7 +678,7 @@ public:
 	std::string format() override {
 		std::string out = typeid(T).name();
 		for (const MutableHistoryInterval &interval : m_history)
-			out += std::string(", ptr:") + ptr_to_string(interval.data()) + " len:" + std::to_string(interval.size()) + " <" + std::to_string(interval.begin()) + "," + std::to_string(interval.end()) + ")";
+			out += std::string(", ptr:") + ptr_to_string(interval.data()) + " len:" + std::to_string(interval.size()) + (interval.data()->compressed ? " compressed" : "") + " <" + std::to_string(interval.begin()) + "," + std::to_string(interval.end()) + ")";
 		return out;
 	}
 #endif /* SLIC3R_UNDOREDO_DEBUG */
@@ -494,8 +707,9 @@ template<typename T>
 bool MutableObjectHistory<T>::valid()
 {
 	// Verify that the history intervals are sorted and do not overlap, and that the data reference counters are correct.
+	// The data may be shared with histories of other objects, therefore the data may be referenced more times than from this history.
 	if (! m_history.empty()) {
-		std::map<const char*, size_t> refcntrs;
+		std::map<const MutableDataPool::Data*, size_t> refcntrs;
 		assert(m_history.front().data() != nullptr);
 		++ refcntrs[m_history.front().data()];
 		for (size_t i = 1; i < m_history.size(); ++ i) {
@@ -504,7 +718,7 @@ bool MutableObjectHistory<T>::valid()
 		}
 		for (const auto &hi : m_history) {
 			assert(hi.data() != nullptr);
-			assert(refcntrs[hi.data()] == hi.refcnt());
+			assert(refcntrs[hi.data()] <= hi.refcnt());
 		}
 	}
 	return true;
@@ -521,6 +735,9 @@ public:
 	void clear() {
 		m_objects.clear();
 		m_shared_ptr_to_object_id.clear();
+		m_immutable_object_hashes.clear();
+		m_mutable_data.reset_stats();
+		m_deduplicated = 0;
 		m_snapshots.clear();
 		m_active_snapshot_time = 0;
 		m_current_time = 0;
@@ -536,6 +753,9 @@ public:
 	void set_memory_limit(size_t memsize) { m_memory_limit = memsize; }
 	size_t get_memory_limit() const { return m_memory_limit; }
 
+	void set_compression(bool enable) { m_compression = enable; }
+	bool get_compression() const { return m_compression; }
+
 	size_t memsize() const {
 		size_t memsize = 0;
 		for (const auto &object : m_objects)
@@ -543,16 +763,28 @@ public:
 		return memsize;
 	}
 
+	MemoryStats memory_stats() const {
+		MemoryStats stats;
+		stats.memsize 	   = this->memsize();
+		stats.deduplicated = m_deduplicated;
+		m_mutable_data.collect_stats(stats);
+		for (const auto &object : m_objects)
+			object.second->collect_stats(stats);
+		return stats;
+	}
+
     // Store the current application state onto the Undo / Redo stack, remove all snapshots after m_active_snapshot_time.
-    void take_snapshot(const std::string& snapshot_name, const Slic3r::Model& model, const Slic3r::GUI::Selection& selection, const Slic3r::GUI::GLGizmosManager& gizmos, const SnapshotData &snapshot_data);
-    void load_snapshot(size_t timestamp, Slic3r::Model& model, Slic3r::GUI::GLGizmosManager& gizmos);
+    // The selection and the gizmos are not stored / restored if null (a snapshot of the Model only).
+    void take_snapshot(const std::string& snapshot_name, const Slic3r::Model& model, const Slic3r::GUI::Selection* selection, const Slic3r::GUI::GLGizmosManager* gizmos, const SnapshotData &snapshot_data);
+    void load_snapshot(size_t timestamp, Slic3r::Model& model, Slic3r::GUI::GLGizmosManager* gizmos);
 
 	bool has_undo_snapshot() const;
 	bool has_undo_snapshot(size_t time_to_load) const;
 	bool has_redo_snapshot() const;
-    bool undo(Slic3r::Model &model, const Slic3r::GUI::Selection &selection, Slic3r::GUI::GLGizmosManager &gizmos, const SnapshotData &snapshot_data, size_t jump_to_time);
-    bool redo(Slic3r::Model &model, Slic3r::GUI::GLGizmosManager &gizmos, size_t jump_to_time);
+    bool undo(Slic3r::Model &model, const Slic3r::GUI::Selection *selection, Slic3r::GUI::GLGizmosManager *gizmos, const SnapshotData &snapshot_data, size_t jump_to_time);
+    bool redo(Slic3r::Model &model, Slic3r::GUI::GLGizmosManager *gizmos, size_t jump_to_time);
 	void release_least_recently_used();
+	size_t compress_cold_data();
 
 	// Snapshot history (names with timestamps).
 	const std::vector<Snapshot>& 	snapshots() const { return m_snapshots; }
@@ -620,16 +852,26 @@ private:
 		}
 		return it->second;
 	}
+	template<typename T> ImmutableObjectHistory<T>* find_immutable_object(const std::shared_ptr<const T> &object, uint64_t hash, bool optional);
 	void 							collect_garbage();
 
 	// Maximum memory allowed to be occupied by the Undo / Redo stack. If the limit is exceeded,
 	// least recently used snapshots will be released.
 	size_t 													m_memory_limit;
+	// Compress the cold snapshot data before releasing the least recently used snapshots.
+	bool 													m_compression { true };
+	// Serialized data of the mutable objects. Must outlive m_objects, which reference the data.
+	MutableDataPool 										m_mutable_data;
 	// Each individual object (Model, ModelObject, ModelInstance, ModelVolume, Selection, TriangleMesh)
 	// is stored with its own history, referenced by the ObjectID. Immutable objects do not provide
 	// their own IDs, therefore there are temporary IDs generated for them and stored to m_shared_ptr_to_object_id.
 	std::map<ObjectID, std::unique_ptr<ObjectHistoryBase>> 	m_objects;
 	std::map<const void*, ObjectID>							m_shared_ptr_to_object_id;
+	// Content hashes of the immutable objects, to share a history between immutable objects of the same content.
+	// May reference ObjectIDs of histories already released.
+	std::unordered_multimap<uint64_t, ObjectID> 			m_immutable_object_hashes;
+	// Total size of the immutable objects released, because an object of the same content was stored by the scene.
+	size_t 													m_deduplicated { 0 };
 	// Snapshot history (names with timestamps).
 	std::vector<Snapshot>									m_snapshots;
 	// Timestamp of the active snapshot.
@@ -753,18 +995,69 @@ namespace cereal
 namespace Slic3r {
 namespace UndoRedo {
 
-template<typename T> std::shared_ptr<const T>& 	ImmutableObjectHistory<T>::shared_ptr(StackImpl &stack)
+template<> struct ImmutableObjectTraits<TriangleMesh>
+{
+	// Of the facets, only the normals and the vertices are hashed and compared, the extra bytes of the facets are ignored.
+	static constexpr const size_t facet_geometry_size = offsetof(stl_facet, extra);
+
+	static uint64_t hash(const TriangleMesh &mesh) {
+		uint64_t hash = hash_bytes((const char*)&mesh.stl.stats.number_of_facets, sizeof(mesh.stl.stats.number_of_facets));
+		for (const stl_facet &facet : mesh.stl.facet_start)
+			hash = hash_bytes((const char*)&facet, facet_geometry_size, hash);
+		return hash;
+	}
+
+	// The statistics are serialized together with the facets, thus they have to match as well. They are compared bitwise
+	// except for the padding behind the header.
+	static bool stats_equal(const stl_stats &lhs, const stl_stats &rhs) {
+		const size_t offset = (const char*)&lhs.type - (const char*)&lhs;
+		return memcmp(lhs.header, rhs.header, sizeof(lhs.header)) == 0 &&
+			memcmp((const char*)&lhs + offset, (const char*)&rhs + offset, sizeof(stl_stats) - offset) == 0;
+	}
+
+	static bool equal(const TriangleMesh &lhs, const TriangleMesh &rhs) {
+		return lhs.repaired == rhs.repaired && stats_equal(lhs.stl.stats, rhs.stl.stats) &&
+			lhs.stl.facet_start.size() == rhs.stl.facet_start.size() &&
+			std::equal(lhs.stl.facet_start.begin(), lhs.stl.facet_start.end(), rhs.stl.facet_start.begin(),
+				[](const stl_facet &f1, const stl_facet &f2) { return memcmp(&f1, &f2, facet_geometry_size) == 0; });
+	}
+
+	// Only the facets and the statistics are stored. The shared vertices and the neighbors are recalculated
+	// by TriangleMesh::restore_optional() the same way as after TriangleMesh::release_optional().
+	static std::string serialize(const TriangleMesh &mesh) {
+		const stl_file &stl = mesh.stl;
+		std::string out(sizeof(stl_stats) + 1 + stl.facet_start.size() * sizeof(stl_facet), 0);
+		char *dst = out.data();
+		memcpy(dst, &stl.stats, sizeof(stl_stats));
+		dst[sizeof(stl_stats)] = mesh.repaired;
+		if (! stl.facet_start.empty())
+			memcpy(dst + sizeof(stl_stats) + 1, stl.facet_start.data(), stl.facet_start.size() * sizeof(stl_facet));
+		return out;
+	}
+
+	static std::unique_ptr<TriangleMesh> deserialize(const std::string &data) {
+		std::unique_ptr<TriangleMesh> mesh(new TriangleMesh());
+		stl_file &stl = mesh->stl;
+		assert(data.size() >= sizeof(stl_stats) + 1);
+		memcpy(&stl.stats, data.data(), sizeof(stl_stats));
+		mesh->repaired = data[sizeof(stl_stats)] != 0;
+		stl.facet_start.resize((data.size() - sizeof(stl_stats) - 1) / sizeof(stl_facet));
+		assert(stl.facet_start.size() == stl.stats.number_of_facets);
+		if (! stl.facet_start.empty())
+			memcpy(stl.facet_start.data(), data.data() + sizeof(stl_stats) + 1, stl.facet_start.size() * sizeof(stl_facet));
+		return mesh;
+	}
+};
+
+template<typename T> std::shared_ptr<const T>& 	ImmutableObjectHistory<T>::shared_ptr()
 {
 	if (m_shared_object.get() == nullptr && ! this->m_serialized.empty()) {
-		// Deserialize the object.
-		std::istringstream iss(m_serialized);
-		{
-			Slic3r::UndoRedo::InputArchive archive(stack, iss);
-			typedef typename std::remove_const<T>::type Type;
-			std::unique_ptr<Type> mesh(new Type());
-			archive(*mesh.get());
-			m_shared_object = std::move(mesh);
-		}
+		// Decompress and deserialize the object.
+		m_shared_object = this->deserialize();
+		m_serialized.clear();
+		m_serialized.shrink_to_fit();
+		m_compressed 	  = false;
+		m_serialized_size = 0;
 	}
 	return m_shared_object;
 }
@@ -791,23 +1084,67 @@ template<typename T> ObjectID StackImpl::save_mutable_object(const T &object)
 			Slic3r::UndoRedo::OutputArchive archive(*this, oss);
 			archive(object);
 		}
-		object_history->save(m_active_snapshot_time, m_current_time, oss.str());
+		object_history->save(m_active_snapshot_time, m_current_time, oss.str(), m_mutable_data);
 	}
 	return object.id();
 }
 
+// Find a history of an immutable object of the same content, which is not shared with the scene, and make it capture the object passed.
+template<typename T> ImmutableObjectHistory<T>* StackImpl::find_immutable_object(const std::shared_ptr<const T> &object, uint64_t hash, bool optional)
+{
+	auto range = m_immutable_object_hashes.equal_range(hash);
+	for (auto it = range.first; it != range.second;) {
+		auto it_object_history = m_objects.find(it->second);
+		if (it_object_history == m_objects.end()) {
+			// The history has been released already.
+			it = m_immutable_object_hashes.erase(it);
+			continue;
+		}
+		auto *object_history = dynamic_cast<ImmutableObjectHistory<T>*>(it_object_history->second.get());
+		if (object_history != nullptr && object_history->is_optional() == optional) {
+			const void *old_ptr     = object_history->immutable_object_ptr();
+			size_t      old_memsize = object_history->memsize();
+			if (object_history->rebind(object)) {
+				if (old_ptr != nullptr)
+					m_shared_ptr_to_object_id.erase(old_ptr);
+				m_shared_ptr_to_object_id[(const void*)object.get()] = it->second;
+				// The object captured before is released, the new object is held by the scene.
+				m_deduplicated += old_memsize - std::min(old_memsize, object_history->memsize());
+				return object_history;
+			}
+		}
+		++ it;
+	}
+	return nullptr;
+}
+
 template<typename T> ObjectID StackImpl::save_immutable_object(std::shared_ptr<const T> &object, bool optional)
 {
-	// First allocate a temporary ObjectID for this pointer.
-	ObjectID object_id = this->immutable_object_id(object);
-	// and find or allocate a history stack for the ObjectID associated to this shared_ptr.
-	auto it_object_history = m_objects.find(object_id);
-	if (it_object_history == m_objects.end())
-		it_object_history = m_objects.emplace_hint(it_object_history, object_id, std::unique_ptr<ImmutableObjectHistory<T>>(new ImmutableObjectHistory<T>(object, optional)));
-	else
+	ImmutableObjectHistory<T> *object_history = nullptr;
+	ObjectID 				   object_id;
+	auto it_object_id = m_shared_ptr_to_object_id.find((const void*)object.get());
+	if (it_object_id != m_shared_ptr_to_object_id.end() && m_objects.find(it_object_id->second) != m_objects.end()) {
+		// This object is already tracked by the Undo / Redo stack.
+		object_id = it_object_id->second;
+		auto it_object_history = m_objects.find(object_id);
 		assert(it_object_history->second.get()->is_optional() == optional);
+		object_history = static_cast<ImmutableObjectHistory<T>*>(it_object_history->second.get());
+	} else {
+		// A new object. Its content may be the same as the content of an object tracked by the Undo / Redo stack,
+		// for example if a mesh was reloaded from disk, or if an operation was reverted by an operation producing the same mesh.
+		uint64_t hash = ImmutableObjectTraits<T>::hash(*object);
+		object_history = this->find_immutable_object(object, hash, optional);
+		if (object_history == nullptr) {
+			// Allocate a new temporary ObjectID for this pointer and a history stack.
+			object_id = this->immutable_object_id(object);
+			object_history = new ImmutableObjectHistory<T>(object, optional, hash);
+			m_objects.emplace(object_id, std::unique_ptr<ImmutableObjectHistory<T>>(object_history));
+			m_immutable_object_hashes.emplace(hash, object_id);
+		} else
+			object_id = m_shared_ptr_to_object_id[(const void*)object.get()];
+	}
 	// Then save the interval.
-	static_cast<ImmutableObjectHistory<T>*>(it_object_history->second.get())->save(m_active_snapshot_time, m_current_time);
+	object_history->save(m_active_snapshot_time, m_current_time);
 	return object_id;
 }
 
@@ -827,8 +1164,13 @@ template<typename T> std::shared_ptr<const T> StackImpl::load_immutable_object(c
 		return std::shared_ptr<const T>();
 	auto *object_history = static_cast<ImmutableObjectHistory<T>*>(it_object_history->second.get());
 	assert(object_history->has_snapshot(m_active_snapshot_time));
+	// Deserialize the object first if it was compressed, then let it restore its optional data.
+	std::shared_ptr<const T> &ptr = object_history->shared_ptr();
 	object_history->restore_optional();
-	return object_history->shared_ptr(*this);
+	if (ptr)
+		// A deserialized object is assigned a new address.
+		m_shared_ptr_to_object_id[(const void*)ptr.get()] = id;
+	return ptr;
 }
 
 template<typename T> void StackImpl::load_mutable_object(const Slic3r::ObjectID id, T &target)
@@ -845,7 +1187,7 @@ template<typename T> void StackImpl::load_mutable_object(const Slic3r::ObjectID
 }
 
 // Store the current application state onto the Undo / Redo stack, remove all snapshots after m_active_snapshot_time.
-void StackImpl::take_snapshot(const std::string& snapshot_name, const Slic3r::Model& model, const Slic3r::GUI::Selection& selection, const Slic3r::GUI::GLGizmosManager& gizmos, const SnapshotData &snapshot_data)
+void StackImpl::take_snapshot(const std::string& snapshot_name, const Slic3r::Model& model, const Slic3r::GUI::Selection* selection, const Slic3r::GUI::GLGizmosManager* gizmos, const SnapshotData &snapshot_data)
 {
 	// Release old snapshot data.
 	assert(m_active_snapshot_time <= m_current_time);
@@ -857,13 +1199,16 @@ void StackImpl::take_snapshot(const std::string& snapshot_name, const Slic3r::Mo
 	}
 	// Take new snapshots.
 	this->save_mutable_object<Slic3r::Model>(model);
-	m_selection.volumes_and_instances.clear();
-	m_selection.volumes_and_instances.reserve(selection.get_volume_idxs().size());
-	m_selection.mode = selection.get_mode();
-	for (unsigned int volume_idx : selection.get_volume_idxs())
-		m_selection.volumes_and_instances.emplace_back(selection.get_volume(volume_idx)->geometry_id);
+	m_selection.clear();
+	if (selection != nullptr) {
+		m_selection.volumes_and_instances.reserve(selection->get_volume_idxs().size());
+		m_selection.mode = selection->get_mode();
+		for (unsigned int volume_idx : selection->get_volume_idxs())
+			m_selection.volumes_and_instances.emplace_back(selection->get_volume(volume_idx)->geometry_id);
+	}
 	this->save_mutable_object<Selection>(m_selection);
-    this->save_mutable_object<Slic3r::GUI::GLGizmosManager>(gizmos);
+	if (gizmos != nullptr)
+		this->save_mutable_object<Slic3r::GUI::GLGizmosManager>(*gizmos);
     // Save the snapshot info.
 	m_snapshots.emplace_back(snapshot_name, m_current_time ++, model.id().id, snapshot_data);
 	m_active_snapshot_time = m_current_time;
@@ -879,7 +1224,7 @@ void StackImpl::take_snapshot(const std::string& snapshot_name, const Slic3r::Mo
 #endif /* SLIC3R_UNDOREDO_DEBUG */
 }
 
-void StackImpl::load_snapshot(size_t timestamp, Slic3r::Model& model, Slic3r::GUI::GLGizmosManager& gizmos)
+void StackImpl::load_snapshot(size_t timestamp, Slic3r::Model& model, Slic3r::GUI::GLGizmosManager* gizmos)
 {
 	// Find the snapshot by time. It must exist.
 	const auto it_snapshot = std::lower_bound(m_snapshots.begin(), m_snapshots.end(), Snapshot(timestamp));
@@ -894,7 +1239,8 @@ void StackImpl::load_snapshot(size_t timestamp, Slic3r::Model& model, Slic3r::GU
 	m_selection.volumes_and_instances.clear();
 	this->load_mutable_object<Selection>(m_selection.id(), m_selection);
     //gizmos.reset_all_states(); FIXME: is this really necessary? It is quite unpleasant for the gizmo undo/redo substack
-    this->load_mutable_object<Slic3r::GUI::GLGizmosManager>(gizmos.id(), gizmos);
+    if (gizmos != nullptr)
+        this->load_mutable_object<Slic3r::GUI::GLGizmosManager>(gizmos->id(), *gizmos);
     // Sort the volumes so that we may use binary search.
 	std::sort(m_selection.volumes_and_instances.begin(), m_selection.volumes_and_instances.end());
 	this->m_active_snapshot_time = timestamp;
@@ -920,7 +1266,7 @@ bool StackImpl::has_redo_snapshot() const
 	return ++ it != m_snapshots.end();
 }
 
-bool StackImpl::undo(Slic3r::Model &model, const Slic3r::GUI::Selection &selection, Slic3r::GUI::GLGizmosManager &gizmos, const SnapshotData &snapshot_data, size_t time_to_load)
+bool StackImpl::undo(Slic3r::Model &model, const Slic3r::GUI::Selection *selection, Slic3r::GUI::GLGizmosManager *gizmos, const SnapshotData &snapshot_data, size_t time_to_load)
 {
 	assert(this->valid());
 	if (time_to_load == SIZE_MAX) {
@@ -960,7 +1306,7 @@ bool StackImpl::undo(Slic3r::Model &model, const Slic3r::GUI::Selection &selecti
 	return true;
 }
 
-bool StackImpl::redo(Slic3r::Model& model, Slic3r::GUI::GLGizmosManager& gizmos, size_t time_to_load)
+bool StackImpl::redo(Slic3r::Model& model, Slic3r::GUI::GLGizmosManager* gizmos, size_t time_to_load)
 {
 	assert(this->valid());
 	if (time_to_load == SIZE_MAX) {
@@ -1019,6 +1365,11 @@ void StackImpl::release_least_recently_used()
 		else
 			current_memsize = 0;
 	}
+	if (m_compression && current_memsize > m_memory_limit) {
+		// Then compress the data, which is not shared with the scene and which is not needed to take the next snapshot.
+		this->compress_cold_data();
+		current_memsize = this->memsize();
+	}
 	while (current_memsize > m_memory_limit && m_snapshots.size() >= 3) {
 		// From which side to remove a snapshot?
 		assert(m_snapshots.front().timestamp < m_active_snapshot_time);
@@ -1076,6 +1427,29 @@ void StackImpl::release_least_recently_used()
 #endif /* SLIC3R_UNDOREDO_DEBUG */
 }
 
+size_t StackImpl::compress_cold_data()
+{
+	// The last data of each mutable object is compared against the state of the object when taking the next snapshot.
+	std::vector<const MutableDataPool::Data*> hot;
+	for (const auto &kvp : m_objects)
+		if (kvp.second->is_mutable()) {
+			const auto &history = static_cast<const ObjectHistory<MutableHistoryInterval>*>(kvp.second.get())->history();
+			if (! history.empty())
+				hot.emplace_back(history.back().data());
+		}
+	std::sort(hot.begin(), hot.end());
+	size_t mem_released = m_mutable_data.compress(hot);
+	for (auto &kvp : m_objects) {
+		const void *ptr 	 = kvp.second->immutable_object_ptr();
+		size_t      released = kvp.second->compress();
+		if (released > 0 && ptr != nullptr)
+			// The object was released, its address may be reused by a new object.
+			m_shared_ptr_to_object_id.erase(ptr);
+		mem_released += released;
+	}
+	return mem_released;
+}
+
 // Wrappers of the private implementation.
 Stack::Stack() : pimpl(new StackImpl()) {}
 Stack::~Stack() {}
@@ -1085,15 +1459,23 @@ bool Stack::empty() const { return pimpl->empty(); }
 void Stack::set_memory_limit(size_t memsize) { pimpl->set_memory_limit(memsize); }
 size_t Stack::get_memory_limit() const { return pimpl->get_memory_limit(); }
 size_t Stack::memsize() const { return pimpl->memsize(); }
+MemoryStats Stack::memory_stats() const { return pimpl->memory_stats(); }
+void Stack::set_compression(bool enable) { pimpl->set_compression(enable); }
+bool Stack::get_compression() const { return pimpl->get_compression(); }
 void Stack::release_least_recently_used() { pimpl->release_least_recently_used(); }
 void Stack::take_snapshot(const std::string& snapshot_name, const Slic3r::Model& model, const Slic3r::GUI::Selection& selection, const Slic3r::GUI::GLGizmosManager& gizmos, const SnapshotData &snapshot_data)
-	{ pimpl->take_snapshot(snapshot_name, model, selection, gizmos, snapshot_data); }
+	{ pimpl->take_snapshot(snapshot_name, model, &selection, &gizmos, snapshot_data); }
+void Stack::take_snapshot(const std::string& snapshot_name, const Slic3r::Model& model, const SnapshotData &snapshot_data)
+	{ pimpl->take_snapshot(snapshot_name, model, nullptr, nullptr, snapshot_data); }
 bool Stack::has_undo_snapshot() const { return pimpl->has_undo_snapshot(); }
 bool Stack::has_undo_snapshot(size_t time_to_load) const { return pimpl->has_undo_snapshot(time_to_load); }
 bool Stack::has_redo_snapshot() const { return pimpl->has_redo_snapshot(); }
 bool Stack::undo(Slic3r::Model& model, const Slic3r::GUI::Selection& selection, Slic3r::GUI::GLGizmosManager& gizmos, const SnapshotData &snapshot_data, size_t time_to_load)
-	{ return pimpl->undo(model, selection, gizmos, snapshot_data, time_to_load); }
-bool Stack::redo(Slic3r::Model& model, Slic3r::GUI::GLGizmosManager& gizmos, size_t time_to_load) { return pimpl->redo(model, gizmos, time_to_load); }
+	{ return pimpl->undo(model, &selection, &gizmos, snapshot_data, time_to_load); }
+bool Stack::undo(Slic3r::Model& model, const SnapshotData &snapshot_data, size_t time_to_load)
+	{ return pimpl->undo(model, nullptr, nullptr, snapshot_data, time_to_load); }
+bool Stack::redo(Slic3r::Model& model, Slic3r::GUI::GLGizmosManager& gizmos, size_t time_to_load) { return pimpl->redo(model, &gizmos, time_to_load); }
+bool Stack::redo(Slic3r::Model& model, size_t time_to_load) { return pimpl->redo(model, nullptr, time_to_load); }
 const Selection& Stack::selection_deserialized() const { return pimpl->selection_deserialized(); }
 
 const std::vector<Snapshot>& Stack::snapshots() const { return pimpl->snapshots(); }
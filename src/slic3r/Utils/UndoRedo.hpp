@@ -70,6 +70,18 @@ struct Snapshot
 	bool 		is_topmost_captured() const { assert(this->is_topmost()); return model_id > 0; }
 };
 
+// Memory consumed by the Undo / Redo stack and saved by sharing and compressing the snapshot data, for diagnostics.
+struct MemoryStats
+{
+	// Estimated size of the RAM consumed by the Undo / Redo stack, see Stack::memsize().
+	size_t 		memsize 		= 0;
+	// Total size of the snapshot data not stored again since the stack was cleared, because data of the same content was found on the stack.
+	size_t 		deduplicated 	= 0;
+	// Size of the snapshot data stored compressed, before and after compression.
+	size_t 		compressed_raw 	= 0;
+	size_t 		compressed 		= 0;
+};
+
 // Excerpt of Slic3r::GUI::Selection for serialization onto the Undo / Redo stack.
 struct Selection : public Slic3r::ObjectBase {
 	void clear() { mode = 0; volumes_and_instances.clear(); }
@@ -97,8 +109,15 @@ public:
 
 	// Estimate size of the RAM consumed by the Undo / Redo stack.
 	size_t memsize() const;
+	// Memory consumed by the Undo / Redo stack and saved by sharing and compressing the snapshot data.
+	MemoryStats memory_stats() const;
+
+	// Compress the snapshot data not shared with the scene before releasing the least recently used snapshots. Enabled by default.
+	void set_compression(bool enable);
+	bool get_compression() const;
 
 	// Release least recently used snapshots up to the memory limit set above.
+	// If the compression is enabled, the cold snapshot data is compressed first.
 	void release_least_recently_used();
 
 	// Store the current application state onto the Undo / Redo stack, remove all snapshots after m_active_snapshot_time.
@@ -117,6 +136,12 @@ public:
 	// Jump forward in time. If time_to_load is SIZE_MAX, the next snapshot is activated.
     bool redo(Slic3r::Model& model, Slic3r::GUI::GLGizmosManager& gizmos, size_t time_to_load = SIZE_MAX);
 
+	// Variants of take_snapshot(), undo() and redo() storing and restoring the Model only, without the selection and the gizmos.
+	// For use without the 3D scene, for example by the tests. Not to be mixed with the variants above on a single stack.
+	void take_snapshot(const std::string& snapshot_name, const Slic3r::Model& model, const SnapshotData &snapshot_data);
+	bool undo(Slic3r::Model& model, const SnapshotData &snapshot_data, size_t time_to_load = SIZE_MAX);
+	bool redo(Slic3r::Model& model, size_t time_to_load = SIZE_MAX);
+
 	// Snapshot history (names with timestamps).
 	// Each snapshot indicates start of an interval in which this operation is performed.
 	// There is one additional snapshot taken at the very end, which indicates the current unnamed state.
@@ -0,0 +1,270 @@
+#include <catch2/catch.hpp>
+
+#include <cstdio>
+
+#include "libslic3r/GCodeReader.hpp"
+#include "libslic3r/GCode/LayerGCode.hpp"
+#include "libslic3r/GCode/SpiralVase.hpp"
+
+#include "test_data.hpp"
+
+using namespace Slic3r;
+
+SCENARIO("LayerGCode tokenizes the G-code of a layer", "[LayerGCode]") {
+    GIVEN("G-code of a layer with cooling markers") {
+        std::string gcode =
+            "G1 Z0.300 F7800.000\n"
+            ";_BRIDGE_FAN_START\n"
+            "G1 X10.000 Y5.000 E0.50000 F1800 ;_EXTRUDE_SET_SPEED ;_EXTERNAL_PERIMETER\n"
+            "G1 X11.000 Y5.000 E0.03000\n"
+            ";_EXTRUDE_END\n"
+            ";_BRIDGE_FAN_END\n"
+            "  G1 X12 ; indented\r\n"
+            "G4 S1\n"
+            "G92 E0\n"
+            "T1\n"
+            "G1 X1 Y1 ;_WIPE";
+        LayerGCode layer(gcode, 'E');
+        const std::vector<LayerGCode::Line> &lines = layer.lines();
+        THEN("the lines cover the complete text") {
+            REQUIRE(lines.size() == 11);
+            std::string text;
+            for (const LayerGCode::Line &line : lines)
+                text += std::string(layer.text(line));
+            REQUIRE(text == gcode);
+            REQUIRE(layer.raw(lines[6]) == "  G1 X12 ; indented");
+        }
+        THEN("the commands, axes and markers are typed") {
+            REQUIRE(lines[0].opcode == LayerGCode::Opcode::G1);
+            REQUIRE(lines[0].canonical);
+            REQUIRE(lines[0].has(Z));
+            REQUIRE(! lines[0].has(X));
+            REQUIRE(lines[0].value(Z) == Approx(0.3));
+            REQUIRE(lines[0].value(F) == Approx(7800.));
+            REQUIRE(lines[1].has_marker(LayerGCode::MARKER_BRIDGE_FAN_START));
+            REQUIRE(lines[2].has_marker(LayerGCode::MARKER_EXTRUDE_SET_SPEED));
+            REQUIRE(lines[2].has_marker(LayerGCode::MARKER_EXTERNAL_PERIMETER));
+            REQUIRE(! lines[2].has_marker(LayerGCode::MARKER_WIPE));
+            REQUIRE(lines[2].value(E) == Approx(0.5));
+            REQUIRE(lines[3].markers == 0);
+            REQUIRE(lines[4].has_marker(LayerGCode::MARKER_EXTRUDE_END));
+            REQUIRE(lines[5].has_marker(LayerGCode::MARKER_BRIDGE_FAN_END));
+            REQUIRE(lines[6].opcode == LayerGCode::Opcode::G1);
+            REQUIRE(! lines[6].canonical);
+            REQUIRE(lines[6].value(X) == Approx(12.));
+            REQUIRE(lines[7].opcode == LayerGCode::Opcode::G4);
+            REQUIRE(lines[8].opcode == LayerGCode::Opcode::G92);
+            REQUIRE(lines[8].has(E));
+            REQUIRE(lines[9].opcode == LayerGCode::Opcode::Other);
+            REQUIRE(lines[10].has_marker(LayerGCode::MARKER_WIPE));
+        }
+    }
+}
+
+TEST_CASE("LayerGCode::set_axis() produces the same text as GCodeReader", "[LayerGCode]") {
+    const char *lines[] = {
+        "G1 Z0.300 F7800.000",
+        "G1 X10.000 Y5.000 E0.50000",
+        "G1 X10.000 Y5.000 E0.50000 ; comment",
+        "G1 E-2.00000 F2400.00000",
+        "G1",
+    };
+    for (const char *src : lines) {
+        for (Axis axis : { Z, E }) {
+            GCodeReader reader;
+            std::string expected;
+            reader.parse_line(std::string(src), [&expected, axis](GCodeReader &reader, const GCodeReader::GCodeLine &l) {
+                GCodeReader::GCodeLine line = l;
+                line.set(reader, axis, 1.23456f);
+                expected = line.raw();
+            });
+            LayerGCode layer(src, 'E');
+            REQUIRE(layer.lines().size() == 1);
+            LayerGCode::Line line = layer.lines().front();
+            std::string raw(layer.raw(line));
+            LayerGCode::set_axis(raw, line, axis, 1.23456f, 'E');
+            REQUIRE(raw == expected);
+            REQUIRE(line.has(axis));
+            REQUIRE(line.value(axis) == 1.23456f);
+        }
+    }
+}
+
+// SpiralVase as implemented over GCodeReader before the layer G-code was tokenized by LayerGCode,
+// kept as a reference for the byte identical output.
+class SpiralVaseReference {
+public:
+    SpiralVaseReference(const PrintConfig &config) : m_config(&config)
+    {
+        m_reader.z() = (float)m_config->z_offset;
+        m_reader.apply_config(*m_config);
+    };
+
+    void enable(bool en) {
+        m_transition_layer = en && ! m_enabled;
+        m_enabled          = en;
+    }
+
+    std::string process_layer(const std::string &gcode)
+    {
+        if (! m_enabled) {
+            m_reader.parse_buffer(gcode);
+            return gcode;
+        }
+        float total_layer_length = 0;
+        float layer_height = 0;
+        float z = 0.f;
+        {
+            GCodeReader r = m_reader;
+            bool set_z = false;
+            r.parse_buffer(gcode, [&total_layer_length, &layer_height, &z, &set_z]
+                (GCodeReader &reader, const GCodeReader::GCodeLine &line) {
+                if (line.cmd_is("G1")) {
+                    if (line.extruding(reader)) {
+                        total_layer_length += line.dist_XY(reader);
+                    } else if (line.has(Z)) {
+                        layer_height += line.dist_Z(reader);
+                        if (!set_z) {
+                            z = line.new_Z(reader);
+                            set_z = true;
+                        }
+                    }
+                }
+            });
+        }
+        z -= layer_height;
+        std::string new_gcode;
+        bool  transition = m_transition_layer && m_config->use_relative_e_distances.value;
+        float layer_height_factor = layer_height / total_layer_length;
+        float len = 0.f;
+        m_reader.parse_buffer(gcode, [&new_gcode, &z, total_layer_length, layer_height_factor, transition, &len]
+            (GCodeReader &reader, GCodeReader::GCodeLine line) {
+            if (line.cmd_is("G1")) {
+                if (line.has_z()) {
+                    line.set(reader, Z, z);
+                    new_gcode += line.raw() + '\n';
+                    return;
+                } else {
+                    float dist_XY = line.dist_XY(reader);
+                    if (dist_XY > 0) {
+                        if (line.extruding(reader)) {
+                            len += dist_XY;
+                            line.set(reader, Z, z + len * layer_height_factor);
+                            if (transition && line.has(E))
+                                line.set(reader, E, line.value(E) * len / total_layer_length);
+                            new_gcode += line.raw() + '\n';
+                        }
+                        return;
+                    }
+                }
+            }
+            new_gcode += line.raw() + '\n';
+        });
+        return new_gcode;
+    }
+
+private:
+    const PrintConfig  *m_config;
+    GCodeReader         m_reader;
+    bool                m_enabled = false;
+    bool                m_transition_layer = false;
+};
+
+// G-code of a layer of a vase: a travel to the seam, a single loop with the corners jittered from layer to layer,
+// a retraction and a lift, with either relative or absolute extrusion distances.
+static std::string vase_layer_gcode(size_t layer_id, bool relative_e, double &e)
+{
+    char buf[128];
+    std::string out;
+    auto emit = [&out, &buf](int n) { out.append(buf, size_t(n)); };
+    double z = 0.2 + 0.2 * double(layer_id);
+    emit(sprintf(buf, "G1 Z%.3f F7800.000\n", z));
+    double r = 10. + 0.1 * double(layer_id % 3);
+    double corners[4][2] = { { -r, -r }, { r, -r + 0.05 * double(layer_id % 5) }, { r, r }, { -r, r } };
+    emit(sprintf(buf, "G1 X%.3f Y%.3f F7800.000\n", corners[0][0], corners[0][1]));
+    if (relative_e)
+        emit(sprintf(buf, "G1 E0.80000 F2100.00000\n"));
+    else {
+        e += 0.8;
+        emit(sprintf(buf, "G1 E%.5f F2100.00000\n", e));
+    }
+    emit(sprintf(buf, "G1 F1800\n;_EXTRUDE_SET_SPEED\n"));
+    for (size_t i = 1; i <= 4; ++ i) {
+        const double *p = corners[i % 4];
+        double de = 0.6 + 0.01 * double(i);
+        if (relative_e)
+            emit(sprintf(buf, "G1 X%.3f Y%.3f E%.5f ; perimeter\n", p[0], p[1], de));
+        else {
+            e += de;
+            emit(sprintf(buf, "G1 X%.3f Y%.3f E%.5f ; perimeter\n", p[0], p[1], e));
+        }
+    }
+    emit(sprintf(buf, ";_EXTRUDE_END\n"));
+    if (relative_e)
+        emit(sprintf(buf, "G1 E-0.80000 F2100.00000\n"));
+    else {
+        e -= 0.8;
+        emit(sprintf(buf, "G1 E%.5f F2100.00000\n", e));
+    }
+    // Lift Z after the retraction. SpiralVase rewrites the lift, while the tracked position has to follow the lifted Z.
+    emit(sprintf(buf, "G1 Z%.3f F7800.000\n", z + 0.4));
+    return out;
+}
+
+TEST_CASE("SpiralVase over LayerGCode produces the same G-code as over GCodeReader", "[LayerGCode]") {
+    for (bool relative_e : { true, false }) {
+        DynamicPrintConfig dyn_config = DynamicPrintConfig::full_print_config();
+        dyn_config.set_deserialize({ { "use_relative_e_distances", relative_e ? "1" : "0" }, { "z_offset", "0.05" } });
+        PrintConfig config;
+        config.apply(dyn_config, true);
+        SpiralVase          spiral_vase(config);
+        SpiralVaseReference reference(config);
+        double e = 0.;
+        // The first layers are not spiralized, the third one is the transition layer.
+        for (size_t layer_id = 0; layer_id < 12; ++ layer_id) {
+            std::string gcode = vase_layer_gcode(layer_id, relative_e, e);
+            spiral_vase.enable(layer_id >= 2);
+            reference.enable(layer_id >= 2);
+            std::string expected = reference.process_layer(gcode);
+            LayerGCode layer(gcode, config.get_extrusion_axis()[0]);
+            spiral_vase.process_layer(layer);
+            INFO("relative_e: " << relative_e << ", layer " << layer_id);
+            REQUIRE(layer.gcode() == expected);
+        }
+    }
+}
+
+SCENARIO("Spiral vase with cooling slowdown", "[LayerGCode]") {
+    GIVEN("A 20mm cube printed as a vase, slowed down by the CoolingBuffer") {
+        std::string gcode = Test::slice({ Test::TestMesh::cube_20x20x20 }, {
+            { "spiral_vase",                true },
+            { "perimeters",                 1 },
+            { "top_solid_layers",           0 },
+            { "bottom_solid_layers",        1 },
+            { "fill_density",               0 },
+            { "cooling",                    true },
+            { "slowdown_below_layer_time",  100 },
+            { "min_print_speed",            1 },
+            { "layer_height",               0.2 },
+            { "first_layer_height",         0.2 }
+        });
+        THEN("the cooling markers are consumed") {
+            REQUIRE(gcode.find(";_EXTRUDE_SET_SPEED") == std::string::npos);
+            REQUIRE(gcode.find(";_EXTRUDE_END") == std::string::npos);
+        }
+        THEN("the spiral never goes down and ends at the top of the object") {
+            GCodeReader reader;
+            float max_z      = 0.f;
+            bool  z_down     = false;
+            reader.parse_buffer(gcode, [&max_z, &z_down](GCodeReader &reader, const GCodeReader::GCodeLine &line) {
+                if (line.cmd_is("G1") && line.extruding(reader) && line.has(Z)) {
+                    if (line.z() < max_z - EPSILON)
+                        z_down = true;
+                    max_z = std::max(max_z, line.z());
+                }
+            });
+            REQUIRE(! z_down);
+            REQUIRE(max_z == Approx(20.).margin(0.21));
+        }
+    }
+}
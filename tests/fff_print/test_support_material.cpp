@@ -2,8 +2,10 @@
 
 #include "libslic3r/GCodeReader.hpp"
 #include "libslic3r/Layer.hpp"
+#include "libslic3r/SupportMaterial.hpp"
 
 #include "test_data.hpp" // get access to init_print, etc
+#include <test_utils.hpp>
 
 using namespace Slic3r::Test;
 using namespace Slic3r;
@@ -119,6 +121,130 @@ SCENARIO("SupportMaterial: support_layers_z and contact_distance", "[SupportMate
     }
 }
 
+TEST_CASE("SupportMaterial: Supports regenerated after adding a support enforcer", "[SupportMaterial]")
+{
+    // Two boxes stacked, h = 20mm each, hole bottoms at 5mm and 25mm, hole heights 10mm (top edges at 15mm and 35mm).
+    TriangleMesh mesh = Slic3r::Test::mesh(Slic3r::Test::TestMesh::cube_with_hole);
+    mesh.rotate_x(float(M_PI / 2));
+    {
+        TriangleMesh upper = mesh;
+        upper.translate(0.f, 0.f, float(mesh.bounding_box().size().z()));
+        mesh.merge(upper);
+        mesh.repair();
+    }
+
+    // Only the enforced supports are generated.
+    DynamicPrintConfig config = Slic3r::DynamicPrintConfig::full_print_config();
+    config.set_deserialize({
+        { "support_material",       1 },
+        { "support_material_auto",  0 },
+        { "layer_height",           0.2 },
+        { "first_layer_height",     0.2 }
+        });
+
+    Slic3r::Print print;
+    Slic3r::Model model;
+    Slic3r::Test::init_print({ mesh }, print, model, config);
+    print.process();
+    const PrintObjectSupportMaterialCache *cache = print.objects().front()->support_material_cache();
+    REQUIRE(cache != nullptr);
+    REQUIRE(cache->top_contacts_reused == 0);
+    REQUIRE(cache->top_contacts_generated > 0);
+    REQUIRE(print.objects().front()->support_layers().empty());
+
+    // Enforce supports below the top edge of a hole. Only the supports of the object are invalidated.
+    ModelObject *object  = model.objects.front();
+    ModelVolume *part    = object->volumes.front();
+    BoundingBoxf3 bbox   = part->mesh().bounding_box();
+    auto add_enforcer = [object, part, &bbox](double z) {
+        TriangleMesh enforcer_mesh = make_cube(bbox.size().x() + 10., bbox.size().y() + 10., 4.);
+        enforcer_mesh.translate(float(bbox.min.x() - 5.), float(bbox.min.y() - 5.), float(bbox.min.z() + z));
+        ModelVolume *enforcer = object->add_volume(std::move(enforcer_mesh));
+        enforcer->set_type(ModelVolumeType::SUPPORT_ENFORCER);
+        enforcer->set_offset(part->get_offset() + enforcer->get_offset());
+    };
+    // The supports are the same as the supports generated from scratch.
+    auto check_supports = [&print, &model, &config]() {
+        Slic3r::Print print_reference;
+        print_reference.apply(model, config);
+        print_reference.process();
+        const SupportLayerPtrs &support_layers           = print.objects().front()->support_layers();
+        const SupportLayerPtrs &support_layers_reference = print_reference.objects().front()->support_layers();
+        REQUIRE(! support_layers.empty());
+        REQUIRE(support_layers.size() == support_layers_reference.size());
+        for (size_t i = 0; i < support_layers.size(); ++ i) {
+            REQUIRE(support_layers[i]->print_z == Approx(support_layers_reference[i]->print_z));
+            REQUIRE(support_layers[i]->support_fills.entities.size() == support_layers_reference[i]->support_fills.entities.size());
+            REQUIRE(support_layers[i]->support_fills.total_volume() == Approx(support_layers_reference[i]->support_fills.total_volume()));
+            REQUIRE(support_layers[i]->support_islands.expolygons.size() == support_layers_reference[i]->support_islands.expolygons.size());
+        }
+    };
+
+    add_enforcer(13.);
+    print.apply(model, config);
+    print.process();
+
+    REQUIRE(print.objects().front()->support_material_cache() == cache);
+    // The object layers did not change, the contacts of the layers out of the enforcer are reused.
+    REQUIRE(cache->layers_changed == 0);
+    REQUIRE(cache->top_contacts_reused > 0);
+    REQUIRE(cache->top_contacts_generated > 0);
+    REQUIRE(cache->top_contacts_generated < cache->top_contacts_reused);
+    // There were no support layers before.
+    REQUIRE(cache->toolpaths_reused == 0);
+    REQUIRE(cache->toolpaths_generated > 0);
+    check_supports();
+
+    // Enforce supports in the upper hole. The supports in the lower hole are not affected.
+    size_t toolpaths_lower_hole = cache->toolpaths_generated;
+    add_enforcer(33.);
+    print.apply(model, config);
+    print.process();
+
+    REQUIRE(cache->layers_changed == 0);
+    REQUIRE(cache->support_areas_reused > 0);
+    REQUIRE(cache->toolpaths_reused > 0);
+    REQUIRE(cache->toolpaths_reused <= toolpaths_lower_hole);
+    REQUIRE(cache->toolpaths_generated > 0);
+    check_supports();
+}
+
+TEST_CASE("SupportMaterial: Projection sweep over blocks of layers generates the same supports as the sequential sweep", "[SupportMaterial]")
+{
+    // A real part with overhangs at many heights, which are supported both from the bed and from the top surfaces of the part.
+    TriangleMesh mesh = load_model("extruder_idler.obj");
+    mesh.repair();
+
+    auto process = [&mesh](Slic3r::Print &print, int sweep_block_size) {
+        const int sweep_block_size_default = PrintObjectSupportMaterial::sweep_block_size;
+        PrintObjectSupportMaterial::sweep_block_size = sweep_block_size;
+        Slic3r::Test::init_and_process_print({ mesh }, print, {
+            { "support_material",       1 },
+            { "layer_height",           0.2 },
+            { "first_layer_height",     0.2 }
+            });
+        PrintObjectSupportMaterial::sweep_block_size = sweep_block_size_default;
+    };
+    // One layer at a time is the order of the sequential sweep.
+    Slic3r::Print print_sequential;
+    process(print_sequential, 1);
+    const SupportLayerPtrs &support_layers_sequential = print_sequential.objects().front()->support_layers();
+    REQUIRE(! support_layers_sequential.empty());
+
+    for (int sweep_block_size : { 7, PrintObjectSupportMaterial::sweep_block_size }) {
+        Slic3r::Print print;
+        process(print, sweep_block_size);
+        const SupportLayerPtrs &support_layers = print.objects().front()->support_layers();
+        REQUIRE(support_layers.size() == support_layers_sequential.size());
+        for (size_t i = 0; i < support_layers.size(); ++ i) {
+            REQUIRE(support_layers[i]->print_z == support_layers_sequential[i]->print_z);
+            REQUIRE(support_layers[i]->support_islands.expolygons == support_layers_sequential[i]->support_islands.expolygons);
+            REQUIRE(support_layers[i]->support_fills.entities.size() == support_layers_sequential[i]->support_fills.entities.size());
+            REQUIRE(support_layers[i]->support_fills.total_volume() == support_layers_sequential[i]->support_fills.total_volume());
+        }
+    }
+}
+
 #if 0
 // Test 8.
 TEST_CASE("SupportMaterial: forced support is generated", "[SupportMaterial]")
@@ -347,6 +347,32 @@ SCENARIO( "TriangleMesh: Mesh merge functions") {
     }
 }
 
+SCENARIO( "TriangleMesh: Convex hull") {
+    GIVEN( "A finely tesselated sphere with a cube inside") {
+        TriangleMesh sphere = make_sphere(10., PI / 90.);
+        TriangleMesh mesh   = sphere;
+        TriangleMesh cube   = make_cube(10., 10., 10.);
+        cube.translate(-5.f, -5.f, -5.f);
+        mesh.merge(cube);
+        mesh.repair();
+        WHEN( "The convex hull is calculated") {
+            TriangleMesh hull        = mesh.convex_hull_3d();
+            TriangleMesh sphere_hull = sphere.convex_hull_3d();
+            THEN( "The vertices inside are discarded") {
+                REQUIRE(hull.its.vertices.size() == sphere_hull.its.vertices.size());
+                REQUIRE(hull.facets_count() == sphere_hull.facets_count());
+            }
+            THEN( "The hull is a repaired, closed and outward oriented mesh with shared vertices") {
+                REQUIRE(hull.repaired);
+                REQUIRE(hull.has_shared_vertices());
+                REQUIRE(hull.its.indices.size() == hull.facets_count());
+                REQUIRE(hull.is_manifold());
+                REQUIRE(hull.volume() == Approx(sphere.volume()).epsilon(0.01));
+            }
+        }
+    }
+}
+
 SCENARIO( "TriangleMeshSlicer: Cut behavior.") {
     GIVEN( "A 20mm cube with one corner on the origin") {
         const std::vector<Vec3d> vertices { {20,20,0}, {20,0,0}, {0,0,0}, {0,20,0}, {20,20,20}, {0,20,20}, {0,0,20}, {20,0,20} };
@@ -380,6 +406,31 @@ SCENARIO( "TriangleMeshSlicer: Cut behavior.") {
         }
     }
 }
+
+SCENARIO( "TriangleMeshSlicer: Slicing an indexed triangle set.") {
+    GIVEN( "A 20mm cube with a 10mm cube stacked on top of it, mirrored and rotated") {
+        TriangleMesh mesh = make_cube(20., 20., 20.);
+        TriangleMesh top  = make_cube(10., 10., 10.);
+        top.translate(5.f, 5.f, 20.f);
+        mesh.merge(top);
+        mesh.repair();
+        mesh.transform(Geometry::assemble_transform(Vec3d::Zero(), Vec3d(0., 0., 0.5), Vec3d::Ones(), Vec3d(-1., 1., 1.)), true);
+        std::vector<float> z { 0.5f, 10.f, 19.5f, 20.5f, 25.f, 29.5f };
+        WHEN( "The mesh and its indexed triangle set are sliced") {
+            std::vector<ExPolygons> layers_mesh, layers_its;
+            TriangleMeshSlicer(&mesh).slice(z, SlicingMode::Regular, 0.f, &layers_mesh, [](){});
+            TriangleMeshSlicer(&mesh.its).slice(z, SlicingMode::Regular, 0.f, &layers_its, [](){});
+            THEN( "The slices are the same") {
+                REQUIRE(layers_its.size() == z.size());
+                for (size_t i = 0; i < z.size(); ++ i) {
+                    REQUIRE(layers_its[i].size() == 1);
+                    REQUIRE(layers_its[i] == layers_mesh[i]);
+                    REQUIRE(layers_its[i].front().area() == Approx((z[i] < 20.f ? 400. : 100.) / (SCALING_FACTOR * SCALING_FACTOR)));
+                }
+            }
+        }
+    }
+}
 #ifdef TEST_PERFORMANCE
 TEST_CASE("Regression test for issue #4486 - files take forever to slice") {
     TriangleMesh mesh;
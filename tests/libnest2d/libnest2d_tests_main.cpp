@@ -688,6 +688,89 @@ TEST_CASE("Items can be preloaded", "[Nesting]") {
     }
 }
 
+TEST_CASE("Shared NFP cache does not change the arrangement", "[Nesting]") {
+    auto bin = Box(250000000, 210000000);
+
+    // A few parts, each of them twice.
+    std::vector<Item> input;
+    for (size_t i = 0; i < 8; ++i) {
+        input.emplace_back(prusaParts()[i]);
+        input.emplace_back(prusaParts()[i]);
+    }
+
+    std::vector<Item> reference = input;
+    size_t bins = libnest2d::nest(reference, bin);
+    REQUIRE(bins > 0u);
+
+    NestConfig<> cfg;
+    cfg.placer_config.nfp_cache = std::make_shared<placers::NfpCache<PolygonImpl>>();
+
+    auto check = [&reference](const std::vector<Item> &items) {
+        for (size_t i = 0; i < items.size(); ++i) {
+            REQUIRE(items[i].binId() == reference[i].binId());
+            REQUIRE(items[i].translation() == reference[i].translation());
+            REQUIRE(double(items[i].rotation()) == double(reference[i].rotation()));
+        }
+    };
+
+    std::vector<Item> first = input;
+    REQUIRE(libnest2d::nest(first, bin, 0, cfg) == bins);
+    check(first);
+    REQUIRE(cfg.placer_config.nfp_cache->size() > 0u);
+
+    // The second arrangement of the same parts finds all its polygons.
+    size_t misses = cfg.placer_config.nfp_cache->misses();
+    std::vector<Item> second = input;
+    REQUIRE(libnest2d::nest(second, bin, 0, cfg) == bins);
+    check(second);
+    REQUIRE(cfg.placer_config.nfp_cache->misses() == misses);
+    REQUIRE(cfg.placer_config.nfp_cache->hits() > 0u);
+}
+
+TEST_CASE("NFP cache compares the shapes of the items", "[Nesting]") {
+    placers::NfpCache<PolygonImpl> cache;
+
+    RectangleItem stationary(100, 100), orbiter(50, 20);
+    PolygonImpl nfp = RectangleItem(150, 120).rawShape();
+    cache.insert(stationary, orbiter, nfp);
+
+    // A copy of the same shapes finds the polygon.
+    RectangleItem stationary_copy(100, 100), orbiter_copy(50, 20);
+    PolygonImpl found;
+    REQUIRE(cache.find(stationary_copy, orbiter_copy, found));
+    REQUIRE(sl::contourVertexCount(found) == sl::contourVertexCount(nfp));
+
+    // A different shape with the same number of vertices does not.
+    Item other = orbiter;
+    other.setVertex(1, {getX(other.vertex(1)) + 1, getY(other.vertex(1))});
+    REQUIRE(! cache.find(stationary, other, found));
+
+    // Neither does a different shape of the same hash. With the identity
+    // std::hash of the integers, the last coordinate colliding the hash of
+    // the orbiter can be solved for.
+    using Coord = TCoord<PointImpl>;
+    if (std::hash<Coord>()(Coord(123456789)) == size_t(123456789)) {
+        const size_t K = 0x9e3779b97f4a7c15ull;
+        std::vector<Coord> coords;
+        sl::foreachVertex(other.rawShape(), [&coords](const PointImpl &v) {
+            coords.emplace_back(getX(v));
+            coords.emplace_back(getY(v));
+        });
+        size_t h = sl::contourVertexCount(other.rawShape());
+        for (size_t i = 0; i + 1 < coords.size(); ++i)
+            h ^= size_t(coords[i]) + K + (h << 6) + (h >> 2);
+        Coord y = Coord((orbiter.shapeHash() ^ h) - K - (h << 6) - (h >> 2));
+        size_t last = sl::contourVertexCount(other.rawShape()) - 1;
+        other.setVertex(last, {getX(other.vertex(last)), y});
+        REQUIRE(other.shapeHash() == orbiter.shapeHash());
+        REQUIRE(! cache.find(stationary, other, found));
+    }
+
+    // Items of the same shape share the shapes stored in the keys.
+    cache.insert(stationary_copy, orbiter_copy, nfp);
+    REQUIRE(cache.size() == 1u);
+}
+
 namespace {
 
 struct ItemPair {
@@ -1,6 +1,7 @@
 #include <catch2/catch.hpp>
 
 #include "libslic3r/Model.hpp"
+#include "libslic3r/TriangleSelector.hpp"
 #include "libslic3r/Format/3mf.hpp"
 #include "libslic3r/Format/STL.hpp"
 
@@ -85,3 +86,74 @@ SCENARIO("Export+Import geometry to/from 3mf file cycle", "[3mf]") {
         }
     }
 }
+
+SCENARIO("Export+Import painted facets to/from 3mf file cycle", "[3mf]") {
+    GIVEN("a cube with painted supports and seam") {
+        Model src_model;
+        ModelObject *src_object = src_model.add_object();
+        TriangleMesh mesh = make_cube(10., 10., 10.);
+        mesh.repair();
+        ModelVolume *src_volume = src_object->add_volume(mesh);
+        src_model.add_default_instances();
+
+        // Paint around a corner of the cube, the geometry of the volume is centered.
+        const indexed_triangle_set &its = src_volume->mesh().its;
+        Vec3f corner = src_volume->mesh().bounding_box().max.cast<float>();
+        int   corner_facet = int(std::find_if(its.indices.begin(), its.indices.end(),
+            [&its, &corner](const stl_triangle_vertex_indices &f) {
+                return its.vertices[f[0]].isApprox(corner) || its.vertices[f[1]].isApprox(corner) || its.vertices[f[2]].isApprox(corner); }) - its.indices.begin());
+        REQUIRE(corner_facet < int(its.indices.size()));
+        TriangleSelector supports(src_volume->mesh());
+        supports.select_patch(corner, corner_facet, corner + Vec3f(10.f, 10.f, 10.f), 3.f, TriangleSelector::SPHERE, EnforcerBlockerType::ENFORCER, Transform3d::Identity());
+        supports.set_facet(int(mesh.its.indices.size()) - 1, EnforcerBlockerType::BLOCKER);
+        src_volume->supported_facets.set(supports);
+        TriangleSelector seam(src_volume->mesh());
+        seam.set_facet(0, EnforcerBlockerType::ENFORCER);
+        src_volume->seam_facets.set(seam);
+
+        THEN("the painted facets survive serialization into the bitstream") {
+            const TriangleSelector::TriangleSplittingData &data = src_volume->supported_facets.get_data();
+            REQUIRE(data.triangles_to_split.size() > 1);
+            TriangleSelector deserialized(src_volume->mesh());
+            deserialized.deserialize(data);
+            REQUIRE(deserialized.serialize() == data);
+            for (size_t i = 0; i < data.triangles_to_split.size(); ++ i)
+                REQUIRE(data.tree_size(data.triangles_to_split[i].second) ==
+                    size_t((i + 1 == data.triangles_to_split.size() ? int(data.bitstream.size()) : data.triangles_to_split[i + 1].second) - data.triangles_to_split[i].second));
+        }
+        THEN("the painted facets survive the compact encoding stored into 3mf") {
+            const TriangleSplittingData &data = src_volume->supported_facets.get_data();
+            std::string compact;
+            data.write_compact(compact);
+            TriangleSplittingData decoded;
+            REQUIRE(decoded.read_compact(compact.data(), compact.data() + compact.size()));
+            REQUIRE(decoded == data);
+            REQUIRE(! decoded.read_compact(compact.data(), compact.data() + compact.size() - 1));
+        }
+        THEN("the painted facets set from strings out of order are sorted") {
+            const FacetsAnnotation &src_facets = src_volume->supported_facets;
+            ModelVolume *volume = src_object->add_volume(mesh);
+            const std::vector<std::pair<int, int>> &triangles = src_facets.get_data().triangles_to_split;
+            for (auto it = triangles.rbegin(); it != triangles.rend(); ++ it)
+                volume->supported_facets.set_triangle_from_string(it->first, src_facets.get_triangle_as_string(it->first));
+            volume->supported_facets.finalize_set_from_strings();
+            REQUIRE(volume->supported_facets.get_data() == src_facets.get_data());
+        }
+        WHEN("model is saved+loaded to/from 3mf file") {
+            std::string test_file = std::string(TEST_DATA_DIR) + "/test_3mf/painted.3mf";
+            store_3mf(test_file.c_str(), &src_model, nullptr, false);
+            Model dst_model;
+            DynamicPrintConfig dst_config;
+            load_3mf(test_file.c_str(), &dst_config, &dst_model, false);
+            boost::filesystem::remove(test_file);
+
+            THEN("the painted facets match") {
+                REQUIRE(dst_model.objects.size() == 1);
+                REQUIRE(dst_model.objects.front()->volumes.size() == 1);
+                const ModelVolume &dst_volume = *dst_model.objects.front()->volumes.front();
+                REQUIRE(dst_volume.supported_facets.get_data() == src_volume->supported_facets.get_data());
+                REQUIRE(dst_volume.seam_facets.get_data() == src_volume->seam_facets.get_data());
+            }
+        }
+    }
+}
@@ -3,6 +3,7 @@
 
 #include <libslic3r/TriangleMesh.hpp>
 #include <libslic3r/AABBTreeIndirect.hpp>
+#include <libslic3r/AABBTreeWide.hpp>
 
 using namespace Slic3r;
 
@@ -59,3 +60,115 @@ TEST_CASE("Building a tree over a box, ray caster and closest query", "[AABBIndi
     REQUIRE(closest_point.y() == Approx(0.5));
     REQUIRE(closest_point.z() == Approx(1.));
 }
+
+TEST_CASE("Casting a batch of rays returns the same hits as casting them one by one", "[AABBIndirect]")
+{
+    TriangleMesh tmesh = load_model("frog_legs.obj");
+    tmesh.repair();
+
+    auto tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(tmesh.its.vertices, tmesh.its.indices);
+    REQUIRE(! tree.empty());
+
+    // Rings of rays cast from the vertices of the mesh along the vertex normals, some of them missing the mesh.
+    std::vector<Vec3d> origins, dirs;
+    BoundingBoxf3 bbox = tmesh.bounding_box();
+    for (size_t i = 0; i < tmesh.its.vertices.size(); i += 7) {
+        Vec3d center = tmesh.its.vertices[i].cast<double>();
+        for (int j = 0; j < 13; ++ j) {
+            double phi = 2. * PI * j / 13.;
+            origins.emplace_back(center + Vec3d(std::cos(phi), std::sin(phi), 0.1 * j));
+            dirs.emplace_back((bbox.center() - origins.back() + Vec3d(0., 0., double(j % 3) - 1.)).normalized());
+        }
+        // Axis aligned rays to test the inverse directions with infinite components.
+        origins.emplace_back(center + Vec3d(0., 0., -1.));
+        dirs.emplace_back(0., 0., 1.);
+    }
+
+    std::vector<igl::Hit> hits;
+    size_t num_hits = AABBTreeIndirect::intersect_rays_first_hit(tmesh.its.vertices, tmesh.its.indices, tree, origins, dirs, hits);
+    REQUIRE(hits.size() == origins.size());
+
+    size_t num_hits_single = 0;
+    for (size_t i = 0; i < origins.size(); ++ i) {
+        igl::Hit hit;
+        if (AABBTreeIndirect::intersect_ray_first_hit(tmesh.its.vertices, tmesh.its.indices, tree, origins[i], dirs[i], hit)) {
+            ++ num_hits_single;
+            REQUIRE(hits[i].id == hit.id);
+            REQUIRE(hits[i].t == hit.t);
+            REQUIRE(hits[i].u == hit.u);
+            REQUIRE(hits[i].v == hit.v);
+        } else
+            REQUIRE(hits[i].id == -1);
+    }
+    REQUIRE(num_hits > 0);
+    REQUIRE(num_hits == num_hits_single);
+}
+
+template<typename WideTreeType>
+static void require_same_hits_as_binary_tree(const TriangleMesh &tmesh, const AABBTreeIndirect::Tree3f &tree, const WideTreeType &wide)
+{
+    BoundingBoxf3 bbox = tmesh.bounding_box();
+    for (size_t i = 0; i < tmesh.its.vertices.size(); i += 11) {
+        // Points around the vertices of the mesh, rays towards the center of the mesh and along the axes.
+        const Vec3d pt = tmesh.its.vertices[i].cast<double>() + Vec3d(0.3, -0.2, 0.5);
+        for (const Vec3d &dir : { Vec3d((bbox.center() - pt).normalized()), Vec3d(0., 0., -1.), Vec3d(1., 0., 0.) }) {
+            igl::Hit hit, wide_hit;
+            bool intersected      = AABBTreeIndirect::intersect_ray_first_hit(tmesh.its.vertices, tmesh.its.indices, tree, pt, dir, hit);
+            bool wide_intersected = AABBTreeIndirect::intersect_ray_first_hit(tmesh.its.vertices, tmesh.its.indices, wide, pt, dir, wide_hit);
+            REQUIRE(intersected == wide_intersected);
+            if (intersected)
+                REQUIRE(hit.t == wide_hit.t);
+
+            std::vector<igl::Hit> hits, wide_hits;
+            AABBTreeIndirect::intersect_ray_all_hits(tmesh.its.vertices, tmesh.its.indices, tree, pt, dir, hits);
+            AABBTreeIndirect::intersect_ray_all_hits(tmesh.its.vertices, tmesh.its.indices, wide, pt, dir, wide_hits);
+            REQUIRE(hits.size() == wide_hits.size());
+            for (size_t j = 0; j < hits.size(); ++ j)
+                REQUIRE(hits[j].t == wide_hits[j].t);
+        }
+
+        size_t hit_idx, wide_hit_idx;
+        Vec3d  closest_point, wide_closest_point;
+        double squared_distance = AABBTreeIndirect::squared_distance_to_indexed_triangle_set(
+            tmesh.its.vertices, tmesh.its.indices, tree, pt, hit_idx, closest_point);
+        double wide_squared_distance = AABBTreeIndirect::squared_distance_to_indexed_triangle_set(
+            tmesh.its.vertices, tmesh.its.indices, wide, pt, wide_hit_idx, wide_closest_point);
+        REQUIRE(squared_distance == Approx(wide_squared_distance));
+
+        for (double radius : { 0.01, 0.1, 1. }) {
+            double r = radius;
+            bool in_radius = AABBTreeIndirect::is_any_triangle_in_radius(tmesh.its.vertices, tmesh.its.indices, tree, pt, r);
+            r = radius;
+            REQUIRE(in_radius == AABBTreeIndirect::is_any_triangle_in_radius(tmesh.its.vertices, tmesh.its.indices, wide, pt, r));
+        }
+    }
+}
+
+TEST_CASE("Wide quantized tree returns the same closest hits as the binary tree", "[AABBIndirect]")
+{
+    TriangleMesh tmesh = load_model("frog_legs.obj");
+    tmesh.repair();
+
+    auto tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(tmesh.its.vertices, tmesh.its.indices);
+
+    SECTION("4-ary tree referencing the source triangles") {
+        AABBTreeIndirect::WideTree3f wide;
+        wide.build(tree, tmesh.its.vertices, tmesh.its.indices);
+        REQUIRE(! wide.empty());
+        REQUIRE(! wide.has_triangles());
+        require_same_hits_as_binary_tree(tmesh, tree, wide);
+    }
+    SECTION("4-ary tree with a copy of the triangles") {
+        AABBTreeIndirect::WideTree3f wide;
+        wide.build(tree, tmesh.its.vertices, tmesh.its.indices, true);
+        REQUIRE(wide.triangles().size() == tmesh.its.indices.size());
+        require_same_hits_as_binary_tree(tmesh, tree, wide);
+    }
+    SECTION("8-ary tree") {
+        AABBTreeIndirect::WideTree8x3f wide;
+        wide.build(tree, tmesh.its.vertices, tmesh.its.indices);
+        REQUIRE(! wide.empty());
+        REQUIRE(wide.nodes().size() < tree.nodes().size() / 6);
+        require_same_hits_as_binary_tree(tmesh, tree, wide);
+    }
+}
@@ -299,3 +299,74 @@ TEST_CASE("Traversing Clipper PolyTree", "[ClipperUtils]") {
         REQUIRE(count_polys(output) == reference.size());
     }
 }
+
+TEST_CASE("Feeding Slic3r paths to Clipper without conversion", "[ClipperUtils]") {
+    // Closed contour with a duplicate closing point and a duplicate vertex, which are to be removed by the Clipper library.
+    Polygon square { { 0, 0 }, { 1000, 0 }, { 1000, 0 }, { 1000, 1000 }, { 0, 1000 }, { 0, 0 } };
+    Polygon hole   { { 200, 200 }, { 200, 800 }, { 800, 800 }, { 800, 200 } };
+    Polygon shifted = square;
+    shifted.translate(500, 500);
+    Polygons   subject { square, hole };
+    Polygons   clip    { shifted };
+    ExPolygons expolys { ExPolygon(square, hole), ExPolygon(shifted) };
+
+    auto execute = [](ClipperLib::Clipper &clipper) {
+        ClipperLib::Paths out;
+        clipper.Execute(ClipperLib::ctDifference, out, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+        return ClipperPaths_to_Slic3rPolygons(out);
+    };
+
+    SECTION("Path providers produce the same result as ClipperLib::Paths") {
+        ClipperLib::Clipper c1, c2;
+        c1.AddPaths(Slic3rMultiPoints_to_ClipperPaths(subject), ClipperLib::ptSubject, true);
+        c1.AddPaths(Slic3rMultiPoints_to_ClipperPaths(clip), ClipperLib::ptClip, true);
+        c2.AddPaths(ClipperUtils::PolygonsProvider(subject), ClipperLib::ptSubject, true);
+        c2.AddPaths(ClipperUtils::PolygonsProvider(clip), ClipperLib::ptClip, true);
+        REQUIRE(execute(c1) == execute(c2));
+    }
+
+    SECTION("ExPolygonsProvider enumerates contours and holes") {
+        Polygons polygons;
+        for (const Points &pts : ClipperUtils::ExPolygonsProvider(expolys))
+            polygons.emplace_back(pts);
+        REQUIRE(polygons == to_polygons(expolys));
+    }
+
+    SECTION("ScaledPath scales and reverses") {
+        ClipperUtils::ScaledPath path(hole.points, true);
+        REQUIRE(path.size() == hole.points.size());
+        REQUIRE(path[0] == ClipperLib::IntPoint(ClipperLib::cInt(800) << CLIPPER_OFFSET_POWER_OF_2, ClipperLib::cInt(200) << CLIPPER_OFFSET_POWER_OF_2));
+    }
+
+    SECTION("Output collected through OutPtRange matches ClipperLib::Paths") {
+        ClipperLib::Clipper clipper;
+        clipper.AddPaths(ClipperUtils::PolygonsProvider(subject), ClipperLib::ptSubject, true);
+        clipper.AddPaths(ClipperUtils::PolygonsProvider(clip), ClipperLib::ptClip, true);
+        Polygons out;
+        clipper.Execute(ClipperLib::ctDifference, ClipperLib::pftNonZero, ClipperLib::pftNonZero, [&out](const ClipperLib::OutPtRange &path) {
+            out.emplace_back();
+            for (const ClipperLib::IntPoint &pt : path)
+                out.back().points.emplace_back(pt.X, pt.Y);
+        });
+        clipper.Clear();
+        clipper.AddPaths(ClipperUtils::PolygonsProvider(subject), ClipperLib::ptSubject, true);
+        clipper.AddPaths(ClipperUtils::PolygonsProvider(clip), ClipperLib::ptClip, true);
+        REQUIRE(out == execute(clipper));
+        REQUIRE(out == diff(subject, clip));
+    }
+
+    SECTION("ExPolygons are clipped without conversion to Polygons") {
+        ExPolygons a { ExPolygon(square, hole) };
+        ExPolygons b { ExPolygon(shifted) };
+        REQUIRE(diff(a, b) == diff(to_polygons(a), to_polygons(b)));
+        REQUIRE(intersection_ex(a, b) == intersection_ex(to_polygons(a), to_polygons(b)));
+        REQUIRE(union_ex(expolys) == union_ex(to_polygons(expolys)));
+    }
+
+    SECTION("Offset of Polygons matches offset of ClipperLib::Paths") {
+        Polygons polygons { square, shifted };
+        REQUIRE(offset(polygons, 50.f) == ClipperPaths_to_Slic3rPolygons(_offset(Slic3rMultiPoints_to_ClipperPaths(polygons), ClipperLib::etClosedPolygon, 50.f, ClipperLib::jtMiter, 3.)));
+        Polylines polylines { Polyline(square.points) };
+        REQUIRE(offset(polylines, 20.f) == ClipperPaths_to_Slic3rPolygons(_offset(Slic3rMultiPoints_to_ClipperPaths(polylines), ClipperLib::etOpenButt, 20.f, ClipperLib::jtSquare, 3.)));
+    }
+}
@@ -1,6 +1,12 @@
 #include <catch2/catch.hpp>
 
 #include "libslic3r/PrintConfig.hpp"
+#include "libslic3r/ConfigBundleCache.hpp"
+
+#include <boost/filesystem.hpp>
+#include <boost/nowide/fstream.hpp>
+#include <boost/property_tree/ini_parser.hpp>
+#include <boost/property_tree/ptree.hpp>
 
 using namespace Slic3r;
 
@@ -201,3 +207,65 @@ SCENARIO("Config ini load/save interface", "[Config]") {
         }
     }
 }
+
+SCENARIO("Config bundle cache round trip", "[Config]") {
+    namespace fs = boost::filesystem;
+    namespace pt = boost::property_tree;
+    GIVEN("A config bundle file and its flattened property tree") {
+        fs::path dir         = fs::temp_directory_path() / fs::unique_path();
+        fs::create_directories(dir);
+        fs::path source_path = dir / "Vendor.ini";
+        {
+            boost::nowide::ofstream f(source_path.string());
+            f << "[vendor]\nname = Vendor\nconfig_version = 0.0.1\n\n[print:0.20mm]\nlayer_height = 0.2\nperimeters = 2\n";
+        }
+        pt::ptree tree;
+        pt::read_ini(source_path.string(), tree);
+        fs::path cache_path  = ConfigBundleCache::cache_file_path(dir / "cache", source_path);
+        WHEN("the tree is saved into the cache") {
+            ConfigBundleCache::save(cache_path, source_path, tree);
+            THEN("the same tree is loaded back") {
+                pt::ptree loaded;
+                REQUIRE(ConfigBundleCache::load(cache_path, source_path, loaded));
+                REQUIRE(loaded == tree);
+            }
+            AND_WHEN("the source file is touched without being modified") {
+                fs::last_write_time(source_path, fs::last_write_time(source_path) + 10);
+                THEN("the cache is still accepted") {
+                    pt::ptree loaded;
+                    REQUIRE(ConfigBundleCache::load(cache_path, source_path, loaded));
+                    REQUIRE(loaded == tree);
+                }
+            }
+            AND_WHEN("the source file is moved and its new location is cached") {
+                fs::create_directories(dir / "moved");
+                fs::path moved_path = dir / "moved" / "Vendor.ini";
+                fs::rename(source_path, moved_path);
+                fs::path moved_cache_path = ConfigBundleCache::cache_file_path(dir / "cache", moved_path);
+                ConfigBundleCache::save(moved_cache_path, moved_path, tree);
+                THEN("the snapshot of the old location is removed") {
+                    REQUIRE(fs::exists(moved_cache_path));
+                    REQUIRE(! fs::exists(cache_path));
+                }
+            }
+            AND_WHEN("the source file is modified") {
+                {
+                    boost::nowide::ofstream f(source_path.string(), std::ios::app);
+                    f << "infill_density = 20%\n";
+                }
+                THEN("the cache is rejected") {
+                    pt::ptree loaded;
+                    REQUIRE(! ConfigBundleCache::load(cache_path, source_path, loaded));
+                    REQUIRE(loaded.empty());
+                }
+            }
+        }
+        WHEN("the cache does not exist") {
+            pt::ptree loaded;
+            THEN("nothing is loaded") {
+                REQUIRE(! ConfigBundleCache::load(cache_path, source_path, loaded));
+            }
+        }
+        fs::remove_all(dir);
+    }
+}
@@ -1,5 +1,6 @@
 #include <iostream>
 #include <fstream>
+#include <map>
 #include <catch2/catch.hpp>
 
 #include <libslic3r/TriangleMesh.hpp>
@@ -10,6 +11,8 @@
 #include <libnest2d/tools/benchmark.h>
 
 #include <libslic3r/SimplifyMesh.hpp>
+#include <libslic3r/ClipperUtils.hpp>
+#include <libslic3r/MeshBoolean.hpp>
 
 #if defined(WIN32) || defined(_WIN32)
 #define PATH_SEPARATOR R"(\)"
@@ -44,3 +47,177 @@ TEST_CASE("Negative 3D offset should produce smaller object.", "[Hollowing]")
     in_mesh.WriteOBJFile("merged_out.obj");
 }
 
+
+TEST_CASE("Hollowing in tiles matches hollowing the whole mesh", "[Hollowing]")
+{
+    Slic3r::TriangleMesh in_mesh = load_model("20mm_cube.obj");
+    
+    Slic3r::sla::HollowingConfig cfg;
+    cfg.tile_height = -1.;
+    std::unique_ptr<Slic3r::TriangleMesh> whole =
+        Slic3r::sla::generate_interior(in_mesh, cfg);
+    
+    cfg.tile_height = 5.;
+    std::unique_ptr<Slic3r::TriangleMesh> tiled =
+        Slic3r::sla::generate_interior(in_mesh, cfg);
+    
+    REQUIRE(whole);
+    REQUIRE(tiled);
+    REQUIRE(! tiled->empty());
+    
+    whole->repair();
+    tiled->repair();
+    REQUIRE(tiled->is_manifold());
+    REQUIRE(std::abs(tiled->volume()) == Approx(std::abs(whole->volume())).epsilon(0.01));
+}
+
+TEST_CASE("Interior stitched from tiles of a real model is closed", "[Hollowing]")
+{
+    // 38mm tall with holes and overhangs, 5mm tiles cut it in several places
+    Slic3r::TriangleMesh in_mesh = load_model("extruder_idler.obj");
+    
+    Slic3r::sla::HollowingConfig cfg;
+    cfg.tile_height = 5.;
+    
+    Slic3r::sla::Contour3D interior =
+        Slic3r::sla::generate_interior_tiles(in_mesh, cfg);
+    
+    REQUIRE(! interior.empty());
+    
+    // Every edge of a closed surface is shared by exactly two faces, an edge
+    // used once is a crack left between two tiles.
+    std::map<std::pair<int, int>, int> edges;
+    auto add_face = [&edges](const auto &face) {
+        for (int i = 0; i < face.size(); ++i) {
+            int a = face(i), b = face((i + 1) % face.size());
+            if (a != b) ++edges[std::minmax(a, b)];
+        }
+    };
+    for (const Slic3r::Vec3i &f : interior.faces3) add_face(f);
+    for (const Slic3r::Vec4i &f : interior.faces4) add_face(f);
+    
+    size_t open_edges = 0;
+    for (const auto &e : edges)
+        if (e.second != 2) ++open_edges;
+    
+    REQUIRE(open_edges == 0);
+    
+    std::unique_ptr<Slic3r::TriangleMesh> tiled =
+        Slic3r::sla::generate_interior(in_mesh, cfg);
+    
+    cfg.tile_height = -1.;
+    std::unique_ptr<Slic3r::TriangleMesh> whole =
+        Slic3r::sla::generate_interior(in_mesh, cfg);
+    
+    REQUIRE(whole);
+    REQUIRE(tiled);
+    
+    whole->repair();
+    tiled->repair();
+    REQUIRE(tiled->is_manifold());
+    REQUIRE(std::abs(tiled->volume()) == Approx(std::abs(whole->volume())).epsilon(0.01));
+}
+
+TEST_CASE("Interior sliced from the distance field matches the sliced interior mesh", "[Hollowing]")
+{
+    Slic3r::TriangleMesh in_mesh = load_model("20mm_cube.obj");
+    
+    Slic3r::sla::InteriorPtr field;
+    std::unique_ptr<Slic3r::TriangleMesh> interior =
+        Slic3r::sla::generate_interior(in_mesh, {}, {}, &field);
+    
+    REQUIRE(interior);
+    REQUIRE(field);
+    
+    std::vector<float> slicegrid;
+    for (float z = 3.f; z < 17.f; z += 0.5f) slicegrid.emplace_back(z);
+    
+    interior->repair(true);
+    std::vector<Slic3r::ExPolygons> mesh_slices;
+    Slic3r::TriangleMeshSlicer slicer(interior.get());
+    slicer.slice(slicegrid, Slic3r::SlicingMode::Regular, 0.f, &mesh_slices, []{});
+    
+    std::vector<Slic3r::ExPolygons> field_slices =
+        Slic3r::sla::slice_interior(*field, slicegrid, 0.f, []{});
+    
+    REQUIRE(field_slices.size() == slicegrid.size());
+    for (size_t i = 0; i < slicegrid.size(); ++i) {
+        REQUIRE(field_slices[i].size() == 1);
+        double area = 0.;
+        for (const Slic3r::ExPolygon &expoly : mesh_slices[i]) area += expoly.area();
+        REQUIRE(field_slices[i].front().area() == Approx(area).epsilon(0.02));
+    }
+}
+
+TEST_CASE("Interior with an island sliced from the distance field matches the sliced interior mesh", "[Hollowing]")
+{
+    // 60 x 60 x 30 mm box with a 30 x 30 mm hole through it. Its cavity is
+    // a ring around the hole, thus each section of the cavity has a hole.
+    Slic3r::TriangleMesh in_mesh = load_model("cube_with_hole.obj");
+    in_mesh.scale(3.f);
+    
+    Slic3r::sla::InteriorPtr field;
+    std::unique_ptr<Slic3r::TriangleMesh> interior =
+        Slic3r::sla::generate_interior(in_mesh, {}, {}, &field);
+    
+    REQUIRE(interior);
+    REQUIRE(field);
+    
+    std::vector<float> slicegrid;
+    for (float z = 5.f; z < 25.f; z += 1.f) slicegrid.emplace_back(z);
+    
+    interior->repair(true);
+    std::vector<Slic3r::ExPolygons> mesh_slices;
+    Slic3r::TriangleMeshSlicer slicer(interior.get());
+    slicer.slice(slicegrid, Slic3r::SlicingMode::Regular, 0.f, &mesh_slices, []{});
+    
+    std::vector<Slic3r::ExPolygons> field_slices =
+        Slic3r::sla::slice_interior(*field, slicegrid, 0.f, []{});
+    
+    // Inside the cavity, inside the hole and outside of the box.
+    const Slic3r::Point in_cavity  = Slic3r::Point::new_scale(7.5, 30.);
+    const Slic3r::Point in_hole    = Slic3r::Point::new_scale(30., 30.);
+    const Slic3r::Point in_outside = Slic3r::Point::new_scale(-5., 30.);
+    
+    REQUIRE(field_slices.size() == slicegrid.size());
+    for (size_t i = 0; i < slicegrid.size(); ++i) {
+        REQUIRE(mesh_slices[i].size() == 1);
+        REQUIRE(field_slices[i].size() == 1);
+        
+        // The ring around the island is traced in the opposite direction,
+        // the union keeps the island as a hole.
+        const Slic3r::ExPolygon &slice = field_slices[i].front();
+        REQUIRE(slice.holes.size() == 1);
+        REQUIRE(slice.contains(in_cavity));
+        REQUIRE(! slice.contains(in_hole));
+        REQUIRE(! slice.contains(in_outside));
+        
+        const Slic3r::ExPolygon &reference = mesh_slices[i].front();
+        REQUIRE(reference.holes.size() == 1);
+        REQUIRE(slice.area() == Approx(reference.area()).epsilon(0.02));
+        REQUIRE(std::abs(slice.holes.front().area()) ==
+                Approx(std::abs(reference.holes.front().area())).epsilon(0.02));
+    }
+}
+
+TEST_CASE("Merging drain holes unions only the overlapping ones", "[Hollowing]")
+{
+    using Slic3r::sla::DrainHole;
+    
+    Slic3r::sla::DrainHoles holes = {
+        DrainHole{{0.f, 0.f, 0.f}, {0.f, 0.f, 1.f}, 1.f, 5.f},
+        DrainHole{{1.f, 0.f, 0.f}, {0.f, 0.f, 1.f}, 1.f, 5.f},
+        DrainHole{{10.f, 0.f, 0.f}, {0.f, 0.f, 1.f}, 1.f, 5.f}
+    };
+    
+    Slic3r::TriangleMesh single = Slic3r::sla::to_triangle_mesh(holes.back().to_mesh());
+    single.require_shared_vertices();
+    
+    Slic3r::TriangleMesh merged = Slic3r::sla::merged_holes_mesh(holes);
+    merged.repair();
+    
+    REQUIRE(merged.is_manifold());
+    REQUIRE(merged.volume() > 2.f * single.volume());
+    REQUIRE(merged.volume() < 3.f * single.volume());
+    REQUIRE(! Slic3r::MeshBoolean::cgal::does_self_intersect(merged));
+}
@@ -1,11 +1,52 @@
 #include <catch2/catch.hpp>
 #include <test_utils.hpp>
 
-//#include <libslic3r/MeshSimplify.hpp>
+#include <libslic3r/SimplifyMesh.hpp>
 
-//TEST_CASE("Mesh simplification", "[mesh_simplify]") {
-//    Simplify::load_obj(TEST_DATA_DIR PATH_SEPARATOR "zaba.obj");
-//    Simplify::simplify_mesh_lossless();
-//    Simplify::write_obj("zaba_simplified.obj");
-//}
+using namespace Slic3r;
 
+// Decimate to a tenth of the faces, the mesh shall not open up and it shall keep its volume.
+static void check_simplified_to_face_count(TriangleMesh mesh, double max_volume_error)
+{
+    mesh.repair();
+    mesh.require_shared_vertices();
+    float  volume      = mesh.volume();
+    size_t faces       = mesh.its.indices.size();
+    int    target      = int(faces / 10);
+
+    indexed_triangle_set its = mesh.its;
+    simplify_mesh(its, target);
+
+    REQUIRE(its.indices.size() <= size_t(target));
+    REQUIRE(its.indices.size() > size_t(target / 2));
+
+    TriangleMesh simplified{its};
+    simplified.repair();
+    if (mesh.is_manifold())
+        REQUIRE(simplified.is_manifold());
+    REQUIRE(simplified.volume() == Approx(volume).epsilon(max_volume_error));
+}
+
+TEST_CASE("Mesh simplification to a face count", "[mesh_simplify]") {
+    SECTION("Finely tesselated sphere, processed in parallel in spatial cells") {
+        check_simplified_to_face_count(make_sphere(10., PI / 200.), 0.01);
+    }
+
+    SECTION("Model with sharp features") {
+        TriangleMesh mesh = load_model("frog_legs.obj");
+        REQUIRE(! mesh.empty());
+        check_simplified_to_face_count(mesh, 0.05);
+    }
+}
+
+TEST_CASE("Lossless mesh simplification keeps the shape", "[mesh_simplify]") {
+    TriangleMesh mesh = make_sphere(10., PI / 100.);
+    mesh.require_shared_vertices();
+    float volume = mesh.volume();
+
+    // The sphere has no flat regions, nothing may be removed.
+    indexed_triangle_set its = mesh.its;
+    simplify_mesh(its);
+    REQUIRE(its.indices.size() == mesh.its.indices.size());
+    REQUIRE(TriangleMesh{its}.volume() == Approx(volume));
+}
@@ -53,3 +53,44 @@ TEST_CASE("PNG read", "[PNG]") {
         REQUIRE(sum == rstsum);
     }
 }
+
+TEST_CASE("PNG mask encoder", "[PNG]") {
+    sla::RasterBase::Resolution res{1000, 500};
+    sla::RasterBase::PixelDim pixdim{0.05, 0.05};
+    sla::RasterBase::Trafo trafo;
+    trafo.center_x = scaled(25.);
+    trafo.center_y = scaled(12.5);
+    sla::RasterGrayscaleAAGammaPower rst{res, pixdim, trafo, 1.};
+
+    // Anti-aliased shapes with a hole over a black background.
+    ExPolygon square;
+    square.contour = Polygon::new_scale({{2., 2.}, {20., 2.}, {20., 20.}, {2., 20.}});
+    square.holes.emplace_back(Polygon::new_scale({{5., 5.}, {5., 15.}, {15., 15.}, {15., 5.}}));
+    rst.draw(square);
+    ExPolygon triangle;
+    triangle.contour = Polygon::new_scale({{25., 3.}, {48., 7.3}, {31.7, 24.1}});
+    rst.draw(triangle);
+
+    auto enc_rst = rst.encode(sla::PNGMaskRasterEncoder{});
+    REQUIRE(Slic3r::png::is_png({enc_rst.data(), enc_rst.size()}));
+
+    png::ImageGreyscale img;
+    REQUIRE(png::decode_png({enc_rst.data(), enc_rst.size()}, img));
+    REQUIRE(img.rows == res.height_px);
+    REQUIRE(img.cols == res.width_px);
+
+    size_t num_mismatches = 0, num_gray = 0;
+    for (size_t r = 0; r < img.rows; ++r)
+        for (size_t c = 0; c < img.cols; ++c) {
+            uint8_t px = rst.read_pixel(c, r);
+            if (img.get(r, c) != px) ++num_mismatches;
+            if (px != 0 && px != 255) ++num_gray;
+        }
+
+    REQUIRE(num_gray > 0);
+    REQUIRE(num_mismatches == 0);
+
+    // Masks compress at least as well as with the generic PNG encoder.
+    auto png_rst = rst.encode(sla::PNGRasterEncoder{});
+    REQUIRE(enc_rst.size() < png_rst.size() * 11 / 10);
+}
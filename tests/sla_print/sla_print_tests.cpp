@@ -2,6 +2,7 @@
 #include <unordered_map>
 #include <random>
 #include <cstdint>
+#include <atomic>
 
 #include "sla_test_utils.hpp"
 
@@ -223,6 +224,72 @@ TEST_CASE("RasterizedPolygonAreaShouldMatch", "[SLARasterOutput]") {
     REQUIRE(raster_pxsum(raster0) == 0);
 }
 
+namespace {
+
+// Printer counting the rasters drawn, to check that rasters of unchanged layers are reused.
+class CountingPrinter: public SLAPrinter {
+    uqptr<sla::RasterBase> create_raster() const override
+    {
+        sla::RasterBase::Resolution res{256, 144};
+        sla::RasterBase::PixelDim   pixdim{12. / res.width_px, 6.8 / res.height_px};
+        return sla::create_raster_grayscale_aa(res, pixdim, gamma, {});
+    }
+    sla::RasterEncoder get_encoder() const override { return sla::PNGMaskRasterEncoder{}; }
+    std::string raster_params() const override { return std::to_string(gamma); }
+
+public:
+    double gamma = 1.;
+
+    void apply(const SLAPrinterConfig &) override {}
+
+    const std::vector<sla::EncodedRaster> &layers() const { return m_layers; }
+};
+
+} // namespace
+
+TEST_CASE("Rasters of unchanged layers are reused", "[SLARasterOutput]") {
+    CountingPrinter printer;
+    std::vector<size_t> contents = {1, 2, 2, 3};
+    std::atomic<size_t> drawn{0};
+    std::atomic<size_t> reused{0};
+
+    auto draw = [&printer, &contents, &drawn, &reused](const std::vector<size_t> &layer_contents) {
+        contents = layer_contents;
+        drawn  = 0;
+        reused = 0;
+        printer.draw_layers(contents.size(),
+            [&contents, &drawn](sla::RasterBase &raster, size_t idx) {
+                ExPolygon poly = square_with_hole(double(contents[idx]));
+                poly.translate(scaled(6.), scaled(3.4));
+                raster.draw(poly);
+                ++drawn;
+            },
+            [&contents](size_t idx) { return std::to_string(contents[idx]); },
+            [&reused](size_t) { ++reused; });
+        // Each layer is either drawn or reused, both advance the progress.
+        REQUIRE(drawn + reused == contents.size());
+        return size_t(drawn);
+    };
+
+    REQUIRE(draw({1, 2, 2, 3}) == 4);
+    std::vector<size_t> sizes;
+    for (const sla::EncodedRaster &rst : printer.layers()) sizes.emplace_back(rst.size());
+
+    // Same contents, nothing is redrawn.
+    REQUIRE(draw({1, 2, 2, 3}) == 0);
+    REQUIRE(printer.layers().size() == sizes.size());
+    for (size_t i = 0; i < sizes.size(); ++i)
+        REQUIRE(printer.layers()[i].size() == sizes[i]);
+
+    // Only the new contents are drawn, reordered layers are reused.
+    REQUIRE(draw({3, 2, 1, 4, 3}) == 1);
+    REQUIRE(printer.layers()[0].size() == sizes[3]);
+
+    // Different raster parameters invalidate all the layers.
+    printer.gamma = 0.5;
+    REQUIRE(draw({3, 2, 1, 4, 3}) == 5);
+}
+
 TEST_CASE("Triangle mesh conversions should be correct", "[SLAConversions]")
 {
     sla::Contour3D cntr;
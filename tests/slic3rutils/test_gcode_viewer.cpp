@@ -0,0 +1,179 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+
+#include "libslic3r/libslic3r.h"
+#include "slic3r/GUI/GCodeViewer.hpp"
+
+using namespace Slic3r;
+using namespace Slic3r::GUI;
+
+using MoveVertex = GCodeProcessor::MoveVertex;
+
+// Square perimeters of a few layers with travels, retractions and wipes in between.
+static std::vector<MoveVertex> make_moves(size_t layers_count)
+{
+    std::vector<MoveVertex> moves;
+    auto add_move = [&moves](EMoveType type, float x, float y, float z, float width) {
+        MoveVertex move;
+        move.type = type;
+        move.extrusion_role = type == EMoveType::Extrude ? erPerimeter : erNone;
+        move.position = Vec3f(x, y, z);
+        move.feedrate = type == EMoveType::Travel ? 120.0f : 40.0f;
+        move.width = width;
+        move.height = 0.2f;
+        move.mm3_per_mm = 0.05f;
+        moves.push_back(move);
+    };
+
+    add_move(EMoveType::Noop, 0.0f, 0.0f, 0.0f, 0.0f);
+    for (size_t layer = 0; layer < layers_count; ++layer) {
+        float z = 0.2f * float(layer + 1);
+        add_move(EMoveType::Travel, 10.0f, 10.0f, z, 0.0f);
+        add_move(EMoveType::Unretract, 10.0f, 10.0f, z, 0.0f);
+        for (int loop = 0; loop < 3; ++loop) {
+            float o = 10.0f + 0.45f * float(loop);
+            float e = 30.0f - 0.45f * float(loop);
+            // the width changes between loops to start new paths
+            float width = loop == 1 ? 0.5f : 0.45f;
+            add_move(EMoveType::Extrude, e, o, z, width);
+            add_move(EMoveType::Extrude, e, e, z, width);
+            add_move(EMoveType::Extrude, o, e, z, width);
+            add_move(EMoveType::Extrude, o, o, z, width);
+        }
+        add_move(EMoveType::Wipe, 12.0f, 10.0f, z, 0.0f);
+        add_move(EMoveType::Wipe, 14.0f, 10.0f, z, 0.0f);
+        add_move(EMoveType::Retract, 14.0f, 10.0f, z, 0.0f);
+    }
+    return moves;
+}
+
+struct FlatBuffer
+{
+    std::vector<float> vertices;
+    std::vector<std::vector<unsigned int>> indices;
+};
+
+// Concatenate the chunks the same way they are sent to the gpu.
+static std::vector<FlatBuffer> flatten(const GCodeViewer::ToolpathsGeometry& geometry)
+{
+    std::vector<FlatBuffer> out(geometry.buffers.size());
+    for (size_t i = 0; i < geometry.buffers.size(); ++i) {
+        for (const auto& chunk : geometry.chunks)
+            out[i].vertices.insert(out[i].vertices.end(), chunk.buffers[i].vertices.begin(), chunk.buffers[i].vertices.end());
+        for (const auto& ibuffer : geometry.buffers[i].index_buffers) {
+            std::vector<unsigned int>& dst = out[i].indices.emplace_back();
+            for (const auto& range : ibuffer.ranges) {
+                const auto& src = geometry.chunks[range.chunk_id].buffers[i].indices;
+                dst.insert(dst.end(), src.begin() + range.begin, src.begin() + range.end);
+            }
+            REQUIRE(dst.size() == ibuffer.count);
+        }
+    }
+    return out;
+}
+
+TEST_CASE("Toolpaths geometry does not depend on the chunking", "[GCodeViewer]") {
+    std::vector<MoveVertex> moves = make_moves(20);
+
+    GCodeViewer::ToolpathsGeometry serial   = GCodeViewer::generate_toolpaths_geometry(moves, {}, moves.size());
+    GCodeViewer::ToolpathsGeometry parallel = GCodeViewer::generate_toolpaths_geometry(moves, {}, 1);
+    REQUIRE(serial.chunks.size() == 1);
+    REQUIRE(parallel.chunks.size() > 20);
+
+    std::vector<FlatBuffer> serial_flat   = flatten(serial);
+    std::vector<FlatBuffer> parallel_flat = flatten(parallel);
+    REQUIRE(serial_flat.size() == parallel_flat.size());
+    for (size_t i = 0; i < serial_flat.size(); ++i) {
+        REQUIRE(serial.buffers[i].vertices_count == parallel.buffers[i].vertices_count);
+        REQUIRE(serial_flat[i].vertices == parallel_flat[i].vertices);
+        REQUIRE(serial_flat[i].indices == parallel_flat[i].indices);
+
+        const auto& serial_paths   = serial.buffers[i].paths;
+        const auto& parallel_paths = parallel.buffers[i].paths;
+        REQUIRE(serial_paths.size() == parallel_paths.size());
+        for (size_t j = 0; j < serial_paths.size(); ++j) {
+            REQUIRE(serial_paths[j].type == parallel_paths[j].type);
+            REQUIRE(serial_paths[j].first.s_id == parallel_paths[j].first.s_id);
+            REQUIRE(serial_paths[j].last.s_id == parallel_paths[j].last.s_id);
+            REQUIRE(serial_paths[j].first.b_id == parallel_paths[j].first.b_id);
+            REQUIRE(serial_paths[j].first.i_id == parallel_paths[j].first.i_id);
+            REQUIRE(serial_paths[j].last.i_id == parallel_paths[j].last.i_id);
+        }
+    }
+
+    // the perimeters of a layer are split into three paths of three to four segments each
+    const auto& extrude = serial.buffers[size_t(EMoveType::Extrude) - size_t(EMoveType::Retract)];
+    REQUIRE(extrude.paths.size() == 3 * 20);
+    REQUIRE(extrude.index_buffers.size() == 1);
+}
+
+TEST_CASE("Toolpaths index buffers are split between paths", "[GCodeViewer]") {
+    std::vector<MoveVertex> moves = make_moves(20);
+    const size_t threshold = 500;
+    GCodeViewer::ToolpathsGeometry geometry = GCodeViewer::generate_toolpaths_geometry(moves, {}, 7, threshold);
+    std::vector<FlatBuffer> flat = flatten(geometry);
+
+    for (size_t i = 0; i < geometry.buffers.size(); ++i) {
+        const auto& buffer = geometry.buffers[i];
+        for (const auto& ibuffer : buffer.index_buffers)
+            REQUIRE(ibuffer.count <= threshold);
+        // all indices reference the single vertex buffer
+        for (const std::vector<unsigned int>& indices : flat[i].indices)
+            for (unsigned int id : indices)
+                REQUIRE(id < buffer.vertices_count);
+        // paths are contiguous and never span two index buffers
+        for (const auto& path : buffer.paths) {
+            REQUIRE(path.first.b_id == path.last.b_id);
+            REQUIRE(path.last.i_id < buffer.index_buffers[path.first.b_id].count);
+        }
+    }
+    REQUIRE(geometry.buffers[size_t(EMoveType::Extrude) - size_t(EMoveType::Retract)].index_buffers.size() > 1);
+}
+
+TEST_CASE("Toolpaths level of detail merges collinear and short moves", "[GCodeViewer]") {
+    std::vector<MoveVertex> moves = make_moves(20);
+    // split the edges of the perimeters into many short collinear moves with a small noise
+    std::vector<MoveVertex> dense;
+    for (size_t i = 0; i < moves.size(); ++i) {
+        if (i > 0 && moves[i].type == EMoveType::Extrude && moves[i - 1].type == EMoveType::Extrude) {
+            for (int k = 1; k < 10; ++k) {
+                MoveVertex move = moves[i];
+                move.position = moves[i - 1].position + (moves[i].position - moves[i - 1].position) * (0.1f * float(k));
+                move.position.x() += (k % 2) ? 0.005f : -0.005f;
+                dense.push_back(move);
+            }
+        }
+        dense.push_back(moves[i]);
+    }
+
+    GCodeViewer::ToolpathsGeometry full = GCodeViewer::generate_toolpaths_geometry(dense, {});
+    size_t prev_count = dense.size();
+    for (float tolerance : GCodeViewer::ToolpathsLOD::Tolerances) {
+        std::vector<size_t> ids = GCodeViewer::decimate_moves(dense, tolerance);
+        REQUIRE(ids.size() < dense.size());
+        REQUIRE(ids.size() <= prev_count);
+        REQUIRE(ids.front() == 0);
+        REQUIRE(ids.back() == dense.size() - 1);
+        // all the moves of the sparse toolpaths and the corners of the perimeters are kept
+        for (size_t i = 0; i < moves.size(); ++i)
+            REQUIRE(std::find_if(ids.begin(), ids.end(), [&](size_t id) { return dense[id].position == moves[i].position && dense[id].type == moves[i].type; }) != ids.end());
+        prev_count = ids.size();
+
+        // the paths are the same as the full resolution ones, only their segments are fewer
+        GCodeViewer::ToolpathsGeometry lod = GCodeViewer::generate_toolpaths_geometry(dense, ids);
+        for (size_t i = 0; i < full.buffers.size(); ++i) {
+            const auto& full_paths = full.buffers[i].paths;
+            const auto& lod_paths  = lod.buffers[i].paths;
+            REQUIRE(full_paths.size() == lod_paths.size());
+            for (size_t j = 0; j < full_paths.size(); ++j) {
+                REQUIRE(full_paths[j].first.s_id == lod_paths[j].first.s_id);
+                REQUIRE(full_paths[j].last.s_id == lod_paths[j].last.s_id);
+                REQUIRE(lod_paths[j].last.i_id - lod_paths[j].first.i_id <= full_paths[j].last.i_id - full_paths[j].first.i_id);
+            }
+            REQUIRE(lod.buffers[i].vertices_count <= full.buffers[i].vertices_count);
+        }
+    }
+    // the perimeters' edges are reduced to a single segment at the coarsest level
+    REQUIRE(prev_count == moves.size());
+}
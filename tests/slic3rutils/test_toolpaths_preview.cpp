@@ -0,0 +1,135 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <array>
+
+#include "libslic3r/libslic3r.h"
+#include "libslic3r/Layer.hpp"
+#include "libslic3r/Model.hpp"
+#include "libslic3r/Print.hpp"
+#include "libslic3r/TriangleMesh.hpp"
+#include "slic3r/GUI/ToolpathsPreview.hpp"
+
+using namespace Slic3r;
+using namespace Slic3r::GUI;
+
+// Two copies of a sliced cylinder with supports under its overhanging rim.
+static void process_print(Print &print, Model &model)
+{
+    DynamicPrintConfig config = DynamicPrintConfig::full_print_config();
+    config.set_deserialize({ { "support_material", "1" }, { "fill_density", "20%" } });
+
+    TriangleMesh mesh = make_cylinder(10., 10.);
+    TriangleMesh rim  = make_cylinder(15., 2.);
+    rim.translate(0.f, 0.f, 8.f);
+    mesh.merge(rim);
+    ModelObject *object = model.add_object();
+    object->add_volume(std::move(mesh));
+    object->add_instance()->set_offset(Vec3d(70., 100., 0.));
+    object->add_instance()->set_offset(Vec3d(130., 100., 0.));
+    object->ensure_on_bed();
+    print.apply(model, config);
+    print.process();
+}
+
+static ToolpathsPreview::Params make_params(const PrintObject &print_object)
+{
+    ToolpathsPreview::Params params;
+    for (const Layer *layer : print_object.layers())
+        params.layers.emplace_back(layer);
+    for (const Layer *layer : print_object.support_layers())
+        params.layers.emplace_back(layer);
+    std::sort(params.layers.begin(), params.layers.end(), [](const Layer *l1, const Layer *l2) { return l1->print_z < l2->print_z; });
+    params.instances      = &print_object.instances();
+    params.has_perimeters = true;
+    params.has_infill     = true;
+    params.has_support    = true;
+    params.colors         = { { 1.f, 1.f, 0.f, 1.f }, { 1.f, 0.5f, 0.5f, 1.f }, { 0.5f, 1.f, 0.5f, 1.f } };
+    params.color_idx      = [](size_t, int, ToolpathsPreview::Feature feature) { return size_t(feature); };
+    return params;
+}
+
+struct Totals
+{
+    size_t vertices { 0 };
+    size_t triangle_indices { 0 };
+    size_t quad_indices { 0 };
+};
+
+static Totals totals(const GLVolumePtrs &volumes)
+{
+    Totals out;
+    for (const GLVolume *volume : volumes) {
+        REQUIRE(! volume->empty());
+        REQUIRE(volume->is_extrusion_path);
+        // one layer is never split among volumes of the same color
+        REQUIRE(std::is_sorted(volume->print_zs.begin(), volume->print_zs.end()));
+        REQUIRE(volume->offsets.size() == 2 * volume->print_zs.size());
+        out.vertices         += volume->indexed_vertex_array.vertices_and_normals_interleaved.size();
+        out.triangle_indices += volume->indexed_vertex_array.triangle_indices.size();
+        out.quad_indices     += volume->indexed_vertex_array.quad_indices.size();
+    }
+    return out;
+}
+
+TEST_CASE("Toolpaths preview does not depend on the blocks of layers", "[ToolpathsPreview]") {
+    Print print;
+    Model model;
+    process_print(print, model);
+    REQUIRE(print.objects().size() == 1);
+    const PrintObject &print_object = *print.objects().front();
+    REQUIRE(! print_object.support_layers().empty());
+
+    ToolpathsPreview::Params params = make_params(print_object);
+
+    // Reference: the whole object in three volumes filled by a single thread, growing the buffers while filling them.
+    Totals reference;
+    std::array<size_t, 3> reference_vertices { 0, 0, 0 };
+    {
+        std::vector<GLVolume> volumes;
+        volumes.reserve(params.colors.size());
+        for (const ToolpathsPreview::Color &color : params.colors)
+            volumes.emplace_back(color.data());
+        for (const Layer *layer : params.layers)
+            for (const PrintInstance &instance : print_object.instances()) {
+                for (const LayerRegion *layerm : layer->regions()) {
+                    _3DScene::extrusionentity_to_verts(layerm->perimeters, float(layer->print_z), instance.shift, volumes[0]);
+                    _3DScene::extrusionentity_to_verts(layerm->fills, float(layer->print_z), instance.shift, volumes[1]);
+                }
+                if (const auto *support_layer = dynamic_cast<const SupportLayer*>(layer))
+                    _3DScene::extrusionentity_to_verts(support_layer->support_fills, float(layer->print_z), instance.shift, volumes[2]);
+            }
+        for (size_t i = 0; i < volumes.size(); ++ i) {
+            reference_vertices[i]       = volumes[i].indexed_vertex_array.vertices_and_normals_interleaved.size();
+            reference.vertices         += volumes[i].indexed_vertex_array.vertices_and_normals_interleaved.size();
+            reference.triangle_indices += volumes[i].indexed_vertex_array.triangle_indices.size();
+            reference.quad_indices     += volumes[i].indexed_vertex_array.quad_indices.size();
+        }
+    }
+    REQUIRE(reference_vertices[0] > 0);
+    REQUIRE(reference_vertices[1] > 0);
+    REQUIRE(reference_vertices[2] > 0);
+
+    for (size_t grain_size : { size_t(0), size_t(1), size_t(7), params.layers.size() }) {
+        params.grain_size = grain_size;
+        GLVolumePtrs volumes = ToolpathsPreview::build(params);
+        Totals t = totals(volumes);
+        REQUIRE(t.vertices == reference.vertices);
+        REQUIRE(t.triangle_indices == reference.triangle_indices);
+        REQUIRE(t.quad_indices == reference.quad_indices);
+        if (grain_size == 1)
+            // a block per layer
+            REQUIRE(volumes.size() >= params.layers.size());
+        for (GLVolume *volume : volumes)
+            delete volume;
+    }
+
+    // Volumes are split if they grow over the limit.
+    params.grain_size             = params.layers.size();
+    params.max_vertex_buffer_size = reference.vertices / 10;
+    GLVolumePtrs volumes = ToolpathsPreview::build(params);
+    REQUIRE(volumes.size() > params.colors.size());
+    REQUIRE(totals(volumes).vertices == reference.vertices);
+    for (GLVolume *volume : volumes)
+        delete volume;
+}
@@ -0,0 +1,115 @@
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+#include "libslic3r/libslic3r.h"
+#include "libslic3r/Model.hpp"
+#include "libslic3r/TriangleMesh.hpp"
+#include "slic3r/Utils/UndoRedo.hpp"
+
+using namespace Slic3r;
+using namespace Slic3r::UndoRedo;
+
+// Grid of cubes, which compresses well: the coordinates are integers and the normals are axis aligned.
+static TriangleMesh make_mesh()
+{
+    TriangleMesh mesh;
+    for (int i = 0; i < 20; ++ i)
+        for (int j = 0; j < 20; ++ j) {
+            TriangleMesh cube = make_cube(5., 5., 5.);
+            cube.translate(float(10 * i), float(10 * j), 0.f);
+            mesh.merge(cube);
+        }
+    mesh.repair();
+    return mesh;
+}
+
+static bool same_facets(const TriangleMesh &lhs, const TriangleMesh &rhs)
+{
+    return lhs.stl.facet_start.size() == rhs.stl.facet_start.size() &&
+        std::equal(lhs.stl.facet_start.begin(), lhs.stl.facet_start.end(), rhs.stl.facet_start.begin(),
+            [](const stl_facet &f1, const stl_facet &f2) { return f1.normal == f2.normal && f1.vertex[0] == f2.vertex[0] && f1.vertex[1] == f2.vertex[1] && f1.vertex[2] == f2.vertex[2]; });
+}
+
+// Compress the data held by the stack only by lowering the memory limit just below the current size.
+// The optional data (the shared vertices of the meshes) may be released first, then the data is compressed.
+static void compress_cold_data(Stack &stack)
+{
+    size_t memory_limit   = stack.get_memory_limit();
+    size_t compressed_raw = stack.memory_stats().compressed_raw;
+    for (int i = 0; i < 2 && stack.memory_stats().compressed_raw == compressed_raw; ++ i) {
+        stack.set_memory_limit(stack.memsize() - 1);
+        stack.release_least_recently_used();
+    }
+    stack.set_memory_limit(memory_limit);
+}
+
+TEST_CASE("Undo / Redo stack deduplicates and compresses the snapshot data", "[UndoRedo]")
+{
+    Model        model;
+    Stack        stack;
+    SnapshotData snapshot_data;
+    stack.take_snapshot("New Project", model, snapshot_data);
+
+    ModelObject *object = model.add_object();
+    object->add_volume(make_mesh());
+    object->add_instance();
+    // The mesh as centered by the ModelVolume.
+    TriangleMesh mesh = object->volumes.front()->mesh();
+    const size_t facets_size = mesh.stl.facet_start.size() * sizeof(stl_facet);
+    stack.take_snapshot("Add Object", model, snapshot_data);
+    const size_t add_object_time = stack.snapshots()[1].timestamp;
+    model.delete_object(size_t(0));
+    // The mesh is held by the stack only.
+    stack.take_snapshot("Delete Object", model, snapshot_data);
+
+    SECTION("Compressed mesh is restored") {
+        size_t num_snapshots = stack.snapshots().size();
+        compress_cold_data(stack);
+        MemoryStats stats = stack.memory_stats();
+        REQUIRE(stack.snapshots().size() == num_snapshots);
+        REQUIRE(stats.compressed_raw >= facets_size);
+        REQUIRE(stats.compressed < stats.compressed_raw);
+
+        REQUIRE(stack.undo(model, snapshot_data, add_object_time));
+        REQUIRE(model.objects.size() == 1);
+        REQUIRE(model.objects.front()->volumes.size() == 1);
+        const TriangleMesh &restored = model.objects.front()->volumes.front()->mesh();
+        REQUIRE(same_facets(restored, mesh));
+        REQUIRE(restored.repaired == mesh.repaired);
+        REQUIRE(restored.stl.stats.number_of_facets == mesh.stl.stats.number_of_facets);
+        REQUIRE(restored.stl.stats.volume == mesh.stl.stats.volume);
+    }
+
+    SECTION("Mesh of the same content shares the history of the compressed mesh") {
+        compress_cold_data(stack);
+        MemoryStats stats = stack.memory_stats();
+        REQUIRE(stats.compressed_raw >= facets_size);
+
+        // Same facets, but different statistics: Not the same mesh.
+        TriangleMesh other = make_mesh();
+        ++ other.stl.stats.degenerate_facets;
+        model.add_object()->add_volume(std::move(other));
+        model.objects.back()->add_instance();
+        stack.take_snapshot("Add Other Object", model, snapshot_data);
+        MemoryStats stats_other = stack.memory_stats();
+        REQUIRE(stats_other.compressed_raw == stats.compressed_raw);
+        REQUIRE(stats_other.deduplicated < stats.deduplicated + facets_size);
+
+        // Same content: The compressed copy held by the stack is released.
+        model.add_object()->add_volume(make_mesh());
+        model.objects.back()->add_instance();
+        stack.take_snapshot("Add Same Object", model, snapshot_data);
+        MemoryStats stats_same = stack.memory_stats();
+        REQUIRE(stats_same.compressed_raw + facets_size <= stats_other.compressed_raw);
+        REQUIRE(stats_same.deduplicated > stats_other.deduplicated);
+
+        // The history of the older mesh is taken over by the new mesh.
+        REQUIRE(stack.undo(model, snapshot_data, add_object_time));
+        REQUIRE(model.objects.size() == 1);
+        REQUIRE(same_facets(model.objects.front()->volumes.front()->mesh(), mesh));
+        REQUIRE(stack.redo(model));
+        REQUIRE(model.objects.empty());
+    }
+}